@@ -66,7 +66,7 @@ void uart_transmit(struct uart_periph* p, uint8_t data ) {
   uint16_t temp;
   unsigned cpsr;
 
-  temp = (p->tx_insert_idx + 1) % UART_TX_BUFFER_SIZE;
+  temp = (p->tx_insert_idx + 1) & UART_TX_BUFFER_MASK;
 
   if (temp == p->tx_extract_idx)
     return;                          // no room
@@ -112,7 +112,7 @@ static inline void uart_ISR(struct uart_periph* p)
           uint16_t temp;
 
           // calc next insert index & store character
-          temp = (p->rx_insert_idx + 1) % UART_RX_BUFFER_SIZE;
+          temp = (p->rx_insert_idx + 1) & UART_RX_BUFFER_MASK;
           p->rx_buf[p->rx_insert_idx] = ((uartRegs_t *)(p->reg_addr))->rbr;
 
           // check for more room in queue
@@ -131,7 +131,7 @@ static inline void uart_ISR(struct uart_periph* p)
           {
             ((uartRegs_t *)(p->reg_addr))->thr = p->tx_buf[p->tx_extract_idx];
             p->tx_extract_idx++;
-            p->tx_extract_idx %= UART_TX_BUFFER_SIZE;
+            p->tx_extract_idx &= UART_TX_BUFFER_MASK;
           }
           else
           {
@@ -51,7 +51,7 @@ void uart_periph_set_baudrate(struct uart_periph* p, uint16_t baud) {
 }
 
 void uart_transmit(struct uart_periph* p, uint8_t data ) {
-  uint16_t temp = (p->tx_insert_idx + 1) % UART_TX_BUFFER_SIZE;
+  uint16_t temp = (p->tx_insert_idx + 1) & UART_TX_BUFFER_MASK;
 
   if (temp == p->tx_extract_idx)
     return;                          // no room
@@ -82,7 +82,7 @@ static inline void uart_handler(struct uart_periph* p) {
     write(fd,&(p->tx_buf[p->tx_extract_idx]),1);
     //printf("w %x\n",p->tx_buf[p->tx_extract_idx]);
     p->tx_extract_idx++;
-    p->tx_extract_idx %= UART_TX_BUFFER_SIZE;
+    p->tx_extract_idx &= UART_TX_BUFFER_MASK;
   }
   else {
     p->tx_running = FALSE;   // clear running flag
@@ -90,7 +90,7 @@ static inline void uart_handler(struct uart_periph* p) {
 
   if(read(fd,&c,1) > 0){
     //printf("r %x %c\n",c,c);
-    uint16_t temp = (p->rx_insert_idx + 1) % UART_RX_BUFFER_SIZE;
+    uint16_t temp = (p->rx_insert_idx + 1) & UART_RX_BUFFER_MASK;
     p->rx_buf[p->rx_insert_idx] = c;
     // check for more room in queue
     if (temp != p->rx_extract_idx)
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "unix_transport.h"
+#include "generated/airframe.h"
+
+struct DownlinkTransport *unix_tp = NULL;
+
+
+static void put_bytes(void *impl, enum DownlinkDataType data_type __attribute__((unused)), uint8_t len, const void *buf)
+{
+  struct unix_transport *ut = (struct unix_transport *) impl;
+  const uint8_t *bytes = (const uint8_t *) buf;
+  if (ut->overflow)
+    return;
+  if (ut->idx + len > UNIX_TRANSPORT_BUF_LEN - 2) {
+    ut->overflow = TRUE;
+    return;
+  }
+  for (int i = 0; i < len; i++) {
+    ut->ck_a += bytes[i];
+    ut->ck_b += ut->ck_a;
+  }
+  memcpy(&ut->buf[ut->idx], bytes, len);
+  ut->idx += len;
+}
+
+static void header(struct unix_transport *ut, uint8_t payload_len)
+{
+  uint8_t msg_len = payload_len + 4;
+  ut->buf[0] = UNIX_TRANSPORT_STX;
+  ut->buf[1] = msg_len;
+  ut->idx = 2;
+  ut->ck_a = ut->ck_b = msg_len;
+  ut->overflow = FALSE;
+}
+
+static void start_message(void *impl, char *name __attribute__((unused)), uint8_t msg_id, uint8_t payload_len)
+{
+  struct unix_transport *ut = (struct unix_transport *) impl;
+  uint8_t ids[2] = { AC_ID, msg_id };
+  header(ut, 2 + payload_len);
+  put_bytes(ut, DL_TYPE_UINT8, 2, ids);
+}
+
+static void overrun(void *impl __attribute__((unused)))
+{
+  downlink_nb_ovrn++;
+}
+
+static void end_message(void *impl)
+{
+  struct unix_transport *ut = (struct unix_transport *) impl;
+  /* a truncated frame would only be rejected by the bridge */
+  if (ut->overflow) {
+    overrun(impl);
+    ut->idx = 0;
+    return;
+  }
+  ut->buf[ut->idx++] = ut->ck_a;
+  ut->buf[ut->idx++] = ut->ck_b;
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, ut->path, sizeof(addr.sun_path) - 1);
+  /* nobody listening is not an error, the frame is just dropped */
+  if (sendto(ut->fd, ut->buf, ut->idx, MSG_DONTWAIT,
+             (struct sockaddr *) &addr, sizeof(addr)) < 0)
+    ut->nb_err++;
+  ut->idx = 0;
+}
+
+static void count_bytes(void *impl __attribute__((unused)), uint8_t bytes __attribute__((unused)))
+{
+
+}
+
+static int check_free_space(void *impl __attribute__((unused)), uint8_t bytes __attribute__((unused)))
+{
+  return TRUE;
+}
+
+static uint8_t size_of(void *impl __attribute__((unused)), uint8_t len)
+{
+  return len + 4;
+}
+
+static void periodic(void *impl __attribute__((unused)))
+{
+
+}
+
+struct DownlinkTransport *unix_transport_new(const char *path)
+{
+  struct DownlinkTransport *tp = (struct DownlinkTransport *) calloc(1, sizeof(struct DownlinkTransport));
+  struct unix_transport *ut = (struct unix_transport *) calloc(1, sizeof(struct unix_transport));
+
+  ut->fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  strncpy(ut->path, path, sizeof(ut->path) - 1);
+  tp->impl = ut;
+
+  tp->StartMessage = start_message;
+  tp->EndMessage = end_message;
+  tp->PutBytes = put_bytes;
+
+  tp->Overrun = overrun;
+  tp->CountBytes = count_bytes;
+  tp->SizeOf = size_of;
+  tp->CheckFreeSpace = check_free_space;
+  tp->Periodic = periodic;
+
+  return tp;
+}
+
+
+/*
+ * Channel interface
+ * the header size given by the messages.h macros already includes ac_id and msg_id
+ */
+void unix_transport_header(uint8_t payload_len)
+{
+  if (!unix_tp)
+    unix_tp = unix_transport_new(UNIX_TRANSPORT_PATH);
+  header((struct unix_transport *) unix_tp->impl, payload_len);
+}
+
+void unix_transport_trailer(void)
+{
+  end_message(unix_tp->impl);
+}
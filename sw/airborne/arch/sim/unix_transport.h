@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/** \file unix_transport.h
+ *  \brief Binary SITL downlink on a Unix datagram socket
+ *
+ *  Each message is sent as one raw pprz frame (STX, length, ac_id,
+ *  msg_id, payload, ck_a, ck_b) to the socket of the ground bridge
+ *  (sw/ground_segment/tmtc/sitl_bridge), which forwards it to Ivy.
+ *  Used instead of ivy_transport.h when SITL_UNIX_TRANSPORT is defined.
+ */
+
+#ifndef UNIX_TRANSPORT_H
+#define UNIX_TRANSPORT_H
+
+#include <inttypes.h>
+#include "std.h"
+#include "downlink_transport.h"
+
+#ifndef UNIX_TRANSPORT_PATH
+#define UNIX_TRANSPORT_PATH "/tmp/paparazzi_sitl"
+#endif
+
+#define UNIX_TRANSPORT_STX 0x99
+#define UNIX_TRANSPORT_BUF_LEN 260
+
+struct unix_transport {
+  int fd;
+  char path[108];
+  uint8_t buf[UNIX_TRANSPORT_BUF_LEN];
+  uint16_t idx;
+  uint8_t ck_a, ck_b;
+  bool_t overflow;  ///< the current frame did not fit in buf, it is dropped
+  uint32_t nb_err;
+};
+
+extern struct DownlinkTransport *unix_transport_new(const char *path);
+
+/** Counter of messages not sent (downlink.c), frames too long are counted here */
+extern uint8_t downlink_nb_ovrn;
+
+/*
+ * Channel interface, for the DOWNLINK_SEND_* macros of messages.h
+ * (-DDOWNLINK_TRANSPORT=UnixTransport)
+ */
+extern struct DownlinkTransport *unix_tp;
+extern void unix_transport_header(uint8_t payload_len);
+extern void unix_transport_trailer(void);
+
+#define UnixTransportPutBytes(_type, _len, _bytes) unix_tp->PutBytes(unix_tp->impl, _type, _len, _bytes)
+
+#define UnixTransportCheckFreeSpace(_) TRUE
+#define UnixTransportSizeOf(_payload) ((_payload)+4)
+
+#define UnixTransportHeader(_payload_len) unix_transport_header(_payload_len)
+#define UnixTransportTrailer() unix_transport_trailer()
+
+#define UnixTransportPutUint8(_x) { \
+    uint8_t _b = (_x); \
+    UnixTransportPutBytes(DL_TYPE_UINT8, 1, &_b); \
+  }
+#define UnixTransportPutNamedUint8(_name, _x) UnixTransportPutUint8(_x)
+
+#define UnixTransportPutInt8ByAddr(_x) UnixTransportPutBytes(DL_TYPE_INT8, 1, _x)
+#define UnixTransportPutUint8ByAddr(_x) UnixTransportPutBytes(DL_TYPE_UINT8, 1, _x)
+#define UnixTransportPutInt16ByAddr(_x) UnixTransportPutBytes(DL_TYPE_INT16, 2, _x)
+#define UnixTransportPutUint16ByAddr(_x) UnixTransportPutBytes(DL_TYPE_UINT16, 2, _x)
+#define UnixTransportPutInt32ByAddr(_x) UnixTransportPutBytes(DL_TYPE_INT32, 4, _x)
+#define UnixTransportPutUint32ByAddr(_x) UnixTransportPutBytes(DL_TYPE_UINT32, 4, _x)
+#define UnixTransportPutFloatByAddr(_x) UnixTransportPutBytes(DL_TYPE_FLOAT, 4, _x)
+#define UnixTransportPutDoubleByAddr(_x) UnixTransportPutBytes(DL_TYPE_DOUBLE, 8, _x)
+
+/* arrays are copied in one go, elements being already little endian on the host */
+#define UnixTransportPutArray(_type, _size, _n, _x) { \
+    UnixTransportPutUint8(_n); \
+    UnixTransportPutBytes(_type, (_n) * (_size), _x); \
+  }
+
+#define UnixTransportPutUint8Array(_n, _x) UnixTransportPutArray(DL_TYPE_UINT8, 1, _n, _x)
+#define UnixTransportPutInt16Array(_n, _x) UnixTransportPutArray(DL_TYPE_INT16, 2, _n, _x)
+#define UnixTransportPutUint16Array(_n, _x) UnixTransportPutArray(DL_TYPE_UINT16, 2, _n, _x)
+#define UnixTransportPutInt32Array(_n, _x) UnixTransportPutArray(DL_TYPE_INT32, 4, _n, _x)
+#define UnixTransportPutUint32Array(_n, _x) UnixTransportPutArray(DL_TYPE_UINT32, 4, _n, _x)
+#define UnixTransportPutFloatArray(_n, _x) UnixTransportPutArray(DL_TYPE_FLOAT, 4, _n, _x)
+#define UnixTransportPutDoubleArray(_n, _x) UnixTransportPutArray(DL_TYPE_DOUBLE, 8, _n, _x)
+
+#endif /* UNIX_TRANSPORT_H */
@@ -27,9 +27,26 @@
 #include <stm32/misc.h>
 #include <stm32/usart.h>
 #include <stm32/gpio.h>
+#include <stm32/dma.h>
+#include <string.h>
 #include "std.h"
 #include "pprz_baudrate.h"
 
+#ifdef USE_UART5_DMA
+#error "UART5 has no DMA channel"
+#endif
+
+/* a DMA irq handler of the uarts would be defined twice with the one of the driver (imu, spi link) using the channel */
+#if defined USE_UART1_DMA && defined USE_DMA1_C4_IRQ
+#error "USE_UART1_DMA uses DMA1 channel 4, already used by USE_DMA1_C4_IRQ"
+#endif
+#if defined USE_UART2_DMA && defined USE_DMA1_C7_IRQ
+#error "USE_UART2_DMA uses DMA1 channel 7, already used by USE_DMA1_C7_IRQ"
+#endif
+#if defined USE_UART3_DMA && defined USE_DMA1_C2_IRQ
+#error "USE_UART3_DMA uses DMA1 channel 2, already used by USE_DMA1_C2_IRQ"
+#endif
+
 void uart_periph_set_baudrate(struct uart_periph* p, uint32_t baud) {
 
   /* Configure USART */
@@ -41,8 +58,9 @@ void uart_periph_set_baudrate(struct uart_periph* p, uint32_t baud) {
   usart.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
   usart.USART_Mode                = USART_Mode_Rx | USART_Mode_Tx;
   USART_Init(p->reg_addr, &usart);
-  /* Enable USART1 Receive interrupts */
-  USART_ITConfig(p->reg_addr, USART_IT_RXNE, ENABLE);
+  /* Enable Receive interrupts, unless received by DMA */
+  if (p->rx_dma == NULL)
+    USART_ITConfig(p->reg_addr, USART_IT_RXNE, ENABLE);
 
   pprz_usart_set_baudrate(p->reg_addr, baud);
 
@@ -52,27 +70,136 @@ void uart_periph_set_baudrate(struct uart_periph* p, uint32_t baud) {
 }
 // TODO set_mode function
 
-void uart_transmit(struct uart_periph* p, uint8_t data ) {
-
-  uint16_t temp = (p->tx_insert_idx + 1) % UART_TX_BUFFER_SIZE;
+/*
+ * DMA
+ *
+ * With USE_UARTx_DMA, reception is done by a circular DMA transfer into
+ * rx_buf: rx_insert_idx is read back from the DMA counter when the buffer
+ * is polled (UartRxUpdate), without any interrupt. The buffer must be
+ * polled before it wraps, so use a larger UART_RX_BUFFER_SIZE at high
+ * baudrates.
+ * Transmission sends each contiguous part of tx_buf with one DMA transfer,
+ * the next one is started by the transfer complete interrupt.
+ * Channels (DMA1) are shared with SPI1 and SPI2:
+ *   USART1 TX 4, RX 5
+ *   USART2 TX 7, RX 6
+ *   USART3 TX 2, RX 3
+ */
 
-  if (temp == p->tx_extract_idx)
-    return;                          // no room
+/* Start the transmission of the next contiguous part of tx_buf,
+ * called with interrupts disabled */
+static void uart_dma_tx_next(struct uart_periph* p) {
+  DMA_Channel_TypeDef* ch = p->tx_dma;
+  uint16_t extract = p->tx_extract_idx;
+  uint16_t insert = p->tx_insert_idx;
 
-  USART_ITConfig(p->reg_addr, USART_IT_TXE, DISABLE);
+  if (insert == extract) {
+    p->tx_running = FALSE;
+    return;
+  }
+  p->tx_dma_len = (insert > extract ? insert : UART_TX_BUFFER_SIZE) - extract;
+  p->tx_running = TRUE;
+  DMA_Cmd(ch, DISABLE);
+  ch->CMAR = (uint32_t)&p->tx_buf[extract];
+  ch->CNDTR = p->tx_dma_len;
+  DMA_Cmd(ch, ENABLE);
+}
 
-  // check if in process of sending data
-  if (p->tx_running) { // yes, add to queue
-    p->tx_buf[p->tx_insert_idx] = data;
-    p->tx_insert_idx = temp;
+static inline void uart_dma_tx_irq_handler(struct uart_periph* p, uint32_t tc_flag) {
+  if (DMA_GetITStatus(tc_flag) != RESET) {
+    DMA_ClearITPendingBit(tc_flag);
+    p->tx_extract_idx = (p->tx_extract_idx + p->tx_dma_len) & UART_TX_BUFFER_MASK;
+    p->tx_dma_len = 0;
+    uart_dma_tx_next(p);
   }
-  else { // no, set running flag and write to output register
-    p->tx_running = TRUE;
-    USART_SendData(p->reg_addr, data);
+}
+
+#if defined USE_UART1_DMA || defined USE_UART2_DMA || defined USE_UART3_DMA
+void uart_dma_rx_update(struct uart_periph* p) {
+  if (p->rx_dma != NULL)
+    p->rx_insert_idx = (UART_RX_BUFFER_SIZE - DMA_GetCurrDataCounter(p->rx_dma)) & UART_RX_BUFFER_MASK;
+}
+
+static void uart_dma_init(struct uart_periph* p, DMA_Channel_TypeDef* rx_ch,
+                          DMA_Channel_TypeDef* tx_ch, IRQn_Type tx_irq) {
+  RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+  /* RX: circular transfer into rx_buf */
+  DMA_DeInit(rx_ch);
+  DMA_InitTypeDef dma;
+  dma.DMA_PeripheralBaseAddr = (uint32_t)&((USART_TypeDef*)p->reg_addr)->DR;
+  dma.DMA_MemoryBaseAddr     = (uint32_t)p->rx_buf;
+  dma.DMA_DIR                = DMA_DIR_PeripheralSRC;
+  dma.DMA_BufferSize         = UART_RX_BUFFER_SIZE;
+  dma.DMA_PeripheralInc      = DMA_PeripheralInc_Disable;
+  dma.DMA_MemoryInc          = DMA_MemoryInc_Enable;
+  dma.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  dma.DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte;
+  dma.DMA_Mode               = DMA_Mode_Circular;
+  dma.DMA_Priority           = DMA_Priority_Medium;
+  dma.DMA_M2M                = DMA_M2M_Disable;
+  DMA_Init(rx_ch, &dma);
+  DMA_Cmd(rx_ch, ENABLE);
+
+  /* TX: address and length are set for each transfer */
+  DMA_DeInit(tx_ch);
+  dma.DMA_MemoryBaseAddr     = (uint32_t)p->tx_buf;
+  dma.DMA_DIR                = DMA_DIR_PeripheralDST;
+  dma.DMA_BufferSize         = 1;
+  dma.DMA_Mode               = DMA_Mode_Normal;
+  dma.DMA_Priority           = DMA_Priority_Low;
+  DMA_Init(tx_ch, &dma);
+  DMA_ITConfig(tx_ch, DMA_IT_TC, ENABLE);
+
+  NVIC_InitTypeDef nvic;
+  nvic.NVIC_IRQChannel = tx_irq;
+  nvic.NVIC_IRQChannelPreemptionPriority = 2;
+  nvic.NVIC_IRQChannelSubPriority = 1;
+  nvic.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&nvic);
+
+  USART_DMACmd(p->reg_addr, USART_DMAReq_Rx | USART_DMAReq_Tx, ENABLE);
+  p->rx_dma = rx_ch;
+  p->tx_dma = tx_ch;
+}
+#endif
+
+/* Start transmitting if idle */
+static inline void uart_tx_start(struct uart_periph* p) {
+  __disable_irq();
+  if (!p->tx_running) {
+    if (p->tx_dma != NULL)
+      uart_dma_tx_next(p);
+    else {
+      p->tx_running = TRUE;
+      USART_ITConfig(p->reg_addr, USART_IT_TXE, ENABLE);
+    }
   }
+  __enable_irq();
+}
 
-  USART_ITConfig(p->reg_addr, USART_IT_TXE, ENABLE);
+uint16_t uart_write_bulk(struct uart_periph* p, uint8_t* data, uint16_t len) {
+  uint16_t n = 0;
+  uint16_t space = (p->tx_extract_idx - p->tx_insert_idx - 1) & UART_TX_BUFFER_MASK;
+
+  if (len > space)
+    len = space;
+  while (n < len) {
+    uint16_t insert = p->tx_insert_idx;
+    uint16_t chunk = UART_TX_BUFFER_SIZE - insert;
+    if (chunk > len - n)
+      chunk = len - n;
+    memcpy(&p->tx_buf[insert], &data[n], chunk);
+    n += chunk;
+    p->tx_insert_idx = (insert + chunk) & UART_TX_BUFFER_MASK;
+  }
+  if (len > 0)
+    uart_tx_start(p);
+  return len;
+}
 
+void uart_transmit(struct uart_periph* p, uint8_t data ) {
+  uart_write_bulk(p, &data, 1);
 }
 
 static inline void usart_irq_handler(struct uart_periph* p) {
@@ -82,7 +209,7 @@ static inline void usart_irq_handler(struct uart_periph* p) {
     if (p->tx_insert_idx != p->tx_extract_idx) {
       USART_SendData(p->reg_addr,p->tx_buf[p->tx_extract_idx]);
       p->tx_extract_idx++;
-      p->tx_extract_idx %= UART_TX_BUFFER_SIZE;
+      p->tx_extract_idx &= UART_TX_BUFFER_MASK;
     }
     else {
       p->tx_running = FALSE;   // clear running flag
@@ -91,7 +218,7 @@ static inline void usart_irq_handler(struct uart_periph* p) {
   }
 
   if(USART_GetITStatus(p->reg_addr, USART_IT_RXNE) != RESET){
-    uint16_t temp = (p->rx_insert_idx + 1) % UART_RX_BUFFER_SIZE;;
+    uint16_t temp = (p->rx_insert_idx + 1) & UART_RX_BUFFER_MASK;
     p->rx_buf[p->rx_insert_idx] = USART_ReceiveData(p->reg_addr);
     // check for more room in queue
     if (temp != p->rx_extract_idx)
@@ -136,12 +263,20 @@ void uart1_init( void ) {
   gpio.GPIO_Mode  = GPIO_Mode_IN_FLOATING;
   GPIO_Init(UART1_RxPort, &gpio);
 
+#ifdef USE_UART1_DMA
+  uart_dma_init(&uart1, DMA1_Channel5, DMA1_Channel4, DMA1_Channel4_IRQn);
+#endif
+
   /* Configure USART1 */
   uart_periph_set_baudrate(&uart1, UART1_BAUD);
 }
 
 void usart1_irq_handler(void) { usart_irq_handler(&uart1); }
 
+#ifdef USE_UART1_DMA
+void dma1_c4_irq_handler(void) { uart_dma_tx_irq_handler(&uart1, DMA1_IT_TC4); }
+#endif
+
 #endif /* USE_UART1 */
 
 #ifdef USE_UART2
@@ -170,12 +305,20 @@ void uart2_init( void ) {
   gpio.GPIO_Mode  = GPIO_Mode_IN_FLOATING;
   GPIO_Init(UART2_RxPort, &gpio);
 
+#ifdef USE_UART2_DMA
+  uart_dma_init(&uart2, DMA1_Channel6, DMA1_Channel7, DMA1_Channel7_IRQn);
+#endif
+
   /* Configure USART2 */
   uart_periph_set_baudrate(&uart2, UART2_BAUD);
 }
 
 void usart2_irq_handler(void) { usart_irq_handler(&uart2); }
 
+#ifdef USE_UART2_DMA
+void dma1_c7_irq_handler(void) { uart_dma_tx_irq_handler(&uart2, DMA1_IT_TC7); }
+#endif
+
 #endif /* USE_UART2 */
 
 #ifdef USE_UART3
@@ -206,12 +349,20 @@ void uart3_init( void ) {
   gpio.GPIO_Mode  = GPIO_Mode_IN_FLOATING;
   GPIO_Init(UART3_RxPort, &gpio);
 
+#ifdef USE_UART3_DMA
+  uart_dma_init(&uart3, DMA1_Channel3, DMA1_Channel2, DMA1_Channel2_IRQn);
+#endif
+
   /* Configure USART3 */
   uart_periph_set_baudrate(&uart3, UART3_BAUD);
 }
 
 void usart3_irq_handler(void) { usart_irq_handler(&uart3); }
 
+#ifdef USE_UART3_DMA
+void dma1_c2_irq_handler(void) { uart_dma_tx_irq_handler(&uart3, DMA1_IT_TC2); }
+#endif
+
 #endif /* USE_UART3 */
 
 #ifdef USE_UART5
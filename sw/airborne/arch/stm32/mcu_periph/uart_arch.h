@@ -129,6 +129,16 @@ extern void usart3_irq_handler(void);
 extern void usart5_irq_handler(void);
 #endif
 
+/* Bulk transmission from the TX buffer, see uart_arch.c */
+#define UART_ARCH_WRITE_BULK 1
+
+/* Reception by DMA is polled */
+#if defined USE_UART1_DMA || defined USE_UART2_DMA || defined USE_UART3_DMA
+struct uart_periph;
+extern void uart_dma_rx_update(struct uart_periph* p);
+#define UartRxUpdate(_p) uart_dma_rx_update(_p)
+#endif
+
 //void uart_init( void );
 
 #endif /* STM32_UART_ARCH_H */
@@ -138,20 +138,27 @@ extern void exti15_10_irq_handler(void);
 #endif
 
 
-#ifdef USE_DMA1_C2_IRQ
+#if defined USE_DMA1_C2_IRQ || defined USE_UART3_DMA
 extern void dma1_c2_irq_handler(void);
 #define DMA1_C2_IRQ_HANDLER dma1_c2_irq_handler
 #else
 #define DMA1_C2_IRQ_HANDLER null_handler
 #endif
 
-#ifdef USE_DMA1_C4_IRQ
+#if defined USE_DMA1_C4_IRQ || defined USE_UART1_DMA
 extern void dma1_c4_irq_handler(void);
 #define DMA1_C4_IRQ_HANDLER dma1_c4_irq_handler
 #else
 #define DMA1_C4_IRQ_HANDLER null_handler
 #endif
 
+#if defined USE_DMA1_C7_IRQ || defined USE_UART2_DMA
+extern void dma1_c7_irq_handler(void);
+#define DMA1_C7_IRQ_HANDLER dma1_c7_irq_handler
+#else
+#define DMA1_C7_IRQ_HANDLER null_handler
+#endif
+
 #ifdef USE_ADC1_2_IRQ_HANDLER
 extern void adc1_2_irq_handler(void);
 #define ADC1_2_IRQ_HANDLER adc1_2_irq_handler
@@ -233,7 +240,7 @@ void (* const vector_table[])(void) = {
     DMA1_C4_IRQ_HANDLER,      /* dma1_channel4_irq_handler */
     null_handler,             /* dma1_channel5_irq_handler */
     null_handler,             /* dma1_channel6_irq_handler */
-    null_handler,             /* dma1_channel7_irq_handler */
+    DMA1_C7_IRQ_HANDLER,      /* dma1_channel7_irq_handler */
     ADC1_2_IRQ_HANDLER,       /* adc1_2_irq_handler */
     USB_HP_CAN1_TX_IRQ_HANDLER, /* usb_hp_can_tx_irq_handler */
     USB_LP_CAN1_RX0_IRQ_HANDLER, /* usb_lp_can_rx0_irq_handler */
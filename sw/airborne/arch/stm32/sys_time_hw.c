@@ -35,6 +35,11 @@ void sys_time_init( void ) {
   NVIC_SetPriority(SysTick_IRQn, 0x0);
   sys_time_period_elapsed = FALSE;
 
+  /* Start the cycle counter used by the timer macros */
+  SYS_TIME_DEMCR |= (1 << 24);  /* TRCENA */
+  SYS_TIME_DWT_CYCCNT = 0;
+  SYS_TIME_DWT_CTRL |= 1;       /* CYCCNTENA */
+
   cpu_time_sec = 0;
   cpu_time_ticks = 0;
 }
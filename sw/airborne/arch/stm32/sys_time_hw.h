@@ -50,6 +50,17 @@ extern uint32_t cpu_time_ticks;
 #define SYS_TICS_OF_SEC(s)        (uint32_t)((s) * AHB_CLK + 0.5)
 #define SIGNED_SYS_TICS_OF_SEC(s)  (int32_t)((s) * AHB_CLK + 0.5)
 
+#define USEC_OF_SYS_TICS(st) ((st) / (AHB_CLK/1000000))
+
+/* Generic timer macros, on the core cycle counter (DWT_CYCCNT)
+ * enabled in sys_time_init */
+#define SYS_TIME_DWT_CTRL   (*(volatile uint32_t*)0xE0001000)
+#define SYS_TIME_DWT_CYCCNT (*(volatile uint32_t*)0xE0001004)
+#define SYS_TIME_DEMCR      (*(volatile uint32_t*)0xE000EDFC)
+#define SysTimeTimerStart(_t) { _t = SYS_TIME_DWT_CYCCNT; }
+#define SysTimeTimer(_t) ((uint32_t)(SYS_TIME_DWT_CYCCNT - _t))
+#define SysTimeTimerStop(_t) { _t = (SYS_TIME_DWT_CYCCNT - _t); }
+
 static inline bool_t sys_time_periodic( void ) {
   if (sys_time_period_elapsed) {
     sys_time_period_elapsed = FALSE;
@@ -42,6 +42,9 @@
 #include "sim_uart.h"
 #include "pprz_transport.h"
 #include "xbee.h"
+#elif defined SITL_UNIX_TRANSPORT
+/** Binary pprz frames on a unix socket, forwarded to IVY by sitl_bridge */
+#include "unix_transport.h"
 #else /* SIM_UART */
 /** Software In The Loop simulation uses IVY bus directly as the transport layer */
 #include "ivy_transport.h"
@@ -9,6 +9,10 @@
 #include "mcu_periph/i2c.h"
 #include "sys_time.h"
 
+/* priority of the motor controllers on a shared bus, see mcu_periph/i2c.h */
+#ifndef ACTUATORS_ASCTEC_I2C_PRIO
+#define ACTUATORS_ASCTEC_I2C_PRIO I2C_SCHED_PRIO_HIGH
+#endif
 
 struct ActuatorsAsctec actuators_asctec;
 
@@ -28,6 +32,7 @@ void actuators_init(void) {
   actuators_asctec.i2c_trans.len_w = 4;
 #endif
   actuators_asctec.nb_err = 0;
+  I2CSchedRegister(ACTUATORS_ASCTEC_DEVICE, actuators_asctec.i2c_trans, ACTUATORS_ASCTEC_I2C_PRIO, 0, 0);
 
 #if defined BOOZ_START_DELAY && ! defined SITL
   actuators_delay_done = FALSE;
@@ -106,7 +111,7 @@ void actuators_set(bool_t motors_on) {
   }
   actuators_asctec.cmd = NONE;
 
-  i2c_submit(&ACTUATORS_ASCTEC_DEVICE, &actuators_asctec.i2c_trans);
+  I2CSubmit(ACTUATORS_ASCTEC_DEVICE, actuators_asctec.i2c_trans);
 
 }
 #else /* ! ACTUATORS_ASCTEC_V2_PROTOCOL */
@@ -128,7 +133,7 @@ void actuators_set(bool_t motors_on) {
                                              actuators_asctec.i2c_trans.buf[2] + actuators_asctec.i2c_trans.buf[3];
 #endif
 
-  i2c_submit(&ACTUATORS_ASCTEC_DEVICE, &actuators_asctec.i2c_trans);
+  I2CSubmit(ACTUATORS_ASCTEC_DEVICE, actuators_asctec.i2c_trans);
 
 }
 #endif /* ACTUATORS_ASCTEC_V2_PROTOCOL */
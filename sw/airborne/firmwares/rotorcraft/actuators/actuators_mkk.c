@@ -28,6 +28,10 @@
 #include "mcu_periph/i2c.h"
 #include "sys_time.h"
 
+/* priority of the motor controllers on a shared bus, see mcu_periph/i2c.h */
+#ifndef ACTUATORS_MKK_I2C_PRIO
+#define ACTUATORS_MKK_I2C_PRIO I2C_SCHED_PRIO_HIGH
+#endif
 
 struct ActuatorsMkk actuators_mkk;
 
@@ -44,6 +48,7 @@ void actuators_init(void) {
     actuators_mkk.trans[i].len_w = 1;
     actuators_mkk.trans[i].slave_addr = actuators_addr[i];
     actuators_mkk.trans[i].status = I2CTransSuccess;
+    I2CSchedRegister(ACTUATORS_MKK_DEVICE, actuators_mkk.trans[i], ACTUATORS_MKK_I2C_PRIO, 0, 0);
   }
 
 #if defined BOOZ_START_DELAY && ! defined SITL
@@ -72,6 +77,6 @@ void actuators_set(bool_t motors_on) {
 #else
     actuators_mkk.trans[i].buf[0] = supervision.commands[i];
 #endif
-    i2c_submit(&ACTUATORS_MKK_DEVICE, &actuators_mkk.trans[i]);
+    I2CSubmit(ACTUATORS_MKK_DEVICE, actuators_mkk.trans[i]);
   }
 }
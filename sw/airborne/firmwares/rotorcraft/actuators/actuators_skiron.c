@@ -26,6 +26,10 @@
 #include "mcu_periph/i2c.h"
 #include "sys_time.h"
 
+/* priority of the motor controllers on a shared bus, see mcu_periph/i2c.h */
+#ifndef ACTUATORS_SKIRON_I2C_PRIO
+#define ACTUATORS_SKIRON_I2C_PRIO I2C_SCHED_PRIO_HIGH
+#endif
 
 struct ActuatorsSkiron actuators_skiron;
 
@@ -40,6 +44,7 @@ void actuators_init(void) {
   actuators_skiron.trans.len_w = ACTUATORS_SKIRON_NB;
   actuators_skiron.trans.slave_addr = ACTUATORS_SKIRON_I2C_ADDR;
   actuators_skiron.trans.status = I2CTransDone;
+  I2CSchedRegister(ACTUATORS_SKIRON_DEVICE, actuators_skiron.trans, ACTUATORS_SKIRON_I2C_PRIO, 0, 0);
   const uint8_t actuators_idx[ACTUATORS_SKIRON_NB] = ACTUATORS_SKIRON_IDX;
   for (uint8_t i=0; i<ACTUATORS_SKIRON_NB; i++) {
     actuators_skiron.actuators_idx[i] = actuators_idx[i];
@@ -72,5 +77,5 @@ void actuators_set(bool_t motors_on) {
     actuators_skiron.trans.buf[idx] = supervision.commands[i];
 #endif
   }
-  i2c_submit(&ACTUATORS_SKIRON_DEVICE, &actuators_skiron.trans);
+  I2CSubmit(ACTUATORS_SKIRON_DEVICE, actuators_skiron.trans);
 }
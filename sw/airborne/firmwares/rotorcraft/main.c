@@ -210,7 +210,9 @@ static inline void on_accel_event( void ) {
   ImuScaleAccel(imu);
 
   if (ahrs.status != AHRS_UNINIT) {
+    SysProfStart(SYS_PROF_AHRS_UPDATE_ACCEL);
     ahrs_update_accel();
+    SysProfStop(SYS_PROF_AHRS_UPDATE_ACCEL);
   }
 }
 
@@ -224,11 +226,15 @@ static inline void on_gyro_event( void ) {
       ahrs_align();
   }
   else {
+    SysProfStart(SYS_PROF_AHRS_PROPAGATE);
     ahrs_propagate();
+    SysProfStop(SYS_PROF_AHRS_PROPAGATE);
 #ifdef SITL
     if (nps_bypass_ahrs) sim_overwrite_ahrs();
 #endif
+    SysProfStart(SYS_PROF_INS_PROPAGATE);
     ins_propagate();
+    SysProfStop(SYS_PROF_INS_PROPAGATE);
   }
 #ifdef USE_VEHICLE_INTERFACE
   vi_notify_imu_available();
@@ -236,7 +242,9 @@ static inline void on_gyro_event( void ) {
 }
 
 static inline void on_baro_abs_event( void ) {
+  SysProfStart(SYS_PROF_INS_UPDATE_BARO);
   ins_update_baro();
+  SysProfStop(SYS_PROF_INS_UPDATE_BARO);
 #ifdef USE_VEHICLE_INTERFACE
   vi_notify_baro_abs_available();
 #endif
@@ -247,7 +255,9 @@ static inline void on_baro_dif_event( void ) {
 }
 
 static inline void on_gps_event(void) {
+  SysProfStart(SYS_PROF_INS_UPDATE_GPS);
   ins_update_gps();
+  SysProfStop(SYS_PROF_INS_UPDATE_GPS);
 #ifdef USE_VEHICLE_INTERFACE
   if (gps.fix == GPS_FIX_3D)
     vi_notify_gps_available();
@@ -256,8 +266,11 @@ static inline void on_gps_event(void) {
 
 static inline void on_mag_event(void) {
   ImuScaleMag(imu);
-  if (ahrs.status == AHRS_RUNNING)
+  if (ahrs.status == AHRS_RUNNING) {
+    SysProfStart(SYS_PROF_AHRS_UPDATE_MAG);
     ahrs_update_mag();
+    SysProfStop(SYS_PROF_AHRS_UPDATE_MAG);
+  }
 #ifdef USE_VEHICLE_INTERFACE
   vi_notify_mag_available();
 #endif
@@ -528,9 +528,9 @@ extern uint8_t telemetry_mode_Main_DefaultChannel;
 #ifdef GPS_LAG
 #define PERIODIC_SEND_HFF_GPS(_chan) {	\
     DOWNLINK_SEND_HFF_GPS(_chan,			\
-							  &b2_hff_rb_last->lag_counter,		\
-							  &lag_counter_err,	\
-							  &save_counter);	\
+							  &b2_hff_gps_lag_n,		\
+							  &b2_hff_gps_lag_err,	\
+							  &b2_hff_hist_n);	\
   }
 #else
 #define PERIODIC_SEND_HFF_GPS(_chan) {}
@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <sys/time.h>
+
+#include  "i86_vor_audio.h"
+
+#include "vor_int_demod_decim.h"
+#include "vor_float_demod.h"
+
+/*
+ * Decodes a wav file with the block versions of the int (decimated)
+ * and float demodulators and reports how much faster than real time
+ * they run.
+ */
+
+static double now(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+int main(int argc, char** argv) {
+
+  const char* filename = argc > 1 ? argv[1] : "signal_VOR_BF_50_200dB.wav";
+  const int nb_loops = argc > 2 ? atoi(argv[2]) : 100;
+
+  vor_audio_read_wav(filename);
+
+  int16_t* int_buf = malloc(sizeof(int16_t)*nb_samples);
+  int i;
+  for (i=0; i<nb_samples; i++)
+    int_buf[i] = adc_buf[i];
+
+  vor_int_demod_init();
+  double t0 = now();
+  for (i=0; i<nb_loops; i++)
+    vor_int_demod_run_block(int_buf, nb_samples);
+  double dt = now() - t0;
+  const float int_te = 512./15000000.;
+  printf("int   : %u samples x %d in %.3fs, %.0fx real time, qdr %d\n",
+	 nb_samples, nb_loops, dt, nb_loops * nb_samples * int_te / dt, vid_qdr);
+
+  vor_float_demod_init();
+  t0 = now();
+  for (i=0; i<nb_loops; i++)
+    vor_float_demod_run_block(float_buf, nb_samples);
+  dt = now() - t0;
+  printf("float : %u samples x %d in %.3fs, %.0fx real time, qdr %f\n",
+	 nb_samples, nb_loops, dt, nb_loops * nb_samples * vfd_te / dt, vfd_qdr);
+
+  return 0;
+}
@@ -0,0 +1,47 @@
+#ifndef VOR_FILTERS_BLOCK_H
+#define VOR_FILTERS_BLOCK_H
+
+/*
+ * Helpers for the block versions of the demodulators.
+ *
+ * The feedforward (FIR) part of an IIR filter does not depend on its
+ * output, it is computed for a whole block of samples in a first loop
+ * and only the recursive part is left to run sample per sample.
+ * Sums are done in the same order as in the per sample filters, results
+ * are identical.
+ */
+
+/* maximum number of samples handled by one pass of the filters */
+#ifndef VOR_BLOCK_SIZE
+#define VOR_BLOCK_SIZE 128
+#endif
+
+/*
+ * loop evaluating body for k = 0..n-1.
+ * On ARM, CMSIS style: unrolled by 4 to keep the MACs back to back.
+ * On the host, plain loop left to the vectorizer (-O3).
+ */
+#if defined(__arm__)
+#define VOR_BLOCK_FOR(k, n, body) {                 \
+    uint32_t _vbf_cnt = (n) >> 2;                   \
+    k = 0;                                          \
+    while (_vbf_cnt--) {                            \
+      body; k++;                                    \
+      body; k++;                                    \
+      body; k++;                                    \
+      body; k++;                                    \
+    }                                               \
+    _vbf_cnt = (n) & 3;                             \
+    while (_vbf_cnt--) {                            \
+      body; k++;                                    \
+    }                                               \
+  }
+#else
+#define VOR_BLOCK_FOR(k, n, body) {                 \
+    for (k = 0; k < (n); k++) {                     \
+      body;                                         \
+    }                                               \
+  }
+#endif
+
+#endif /* VOR_FILTERS_BLOCK_H */
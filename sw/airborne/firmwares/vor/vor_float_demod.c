@@ -46,7 +46,9 @@ void vor_float_demod_init( void) {
 
 }
 
-void vor_float_demod_run ( float sample) {
+// PLLs and decimation, run once per input sample on the outputs
+// of the bandpass filters
+static inline void vor_float_demod_step ( float vfd_ref_sig) {
 
   const float ti = i * vfd_te;
 
@@ -57,9 +59,6 @@ void vor_float_demod_run ( float sample) {
   // local oscillator signal
   const float vfd_ref_local_sig = sin(vfd_ref_phase);
 
-  // get REF signal by bandpassing input signal
-  const float vfd_ref_sig = vor_float_filter_bp_ref(sample);
-
   // multiply input signal by local oscillator signal
   const float vfd_ref_y = vfd_ref_sig * vfd_ref_local_sig;
 
@@ -69,10 +68,6 @@ void vor_float_demod_run ( float sample) {
   // filter 30 REF before decimating it
   const float vfd_ref_err_decim = vor_float_filter_lp_decim(vfd_ref_err);
 
-  // get VAR signal by bandpassing input signal
-  //  const float vfd_var_sig = vor_float_filter_bp_var(sample);
-  vfd_var_sig = vor_float_filter_bp_var(sample);
-
   if (decim >= vfd_DECIM) {
     decim = 0;
 
@@ -97,3 +92,31 @@ void vor_float_demod_run ( float sample) {
   decim++;
 
 }
+
+void vor_float_demod_run ( float sample) {
+  vor_float_demod_run_block(&sample, 1);
+}
+
+void vor_float_demod_run_block ( const float* samples, uint32_t nb) {
+
+  float var_sig[VOR_BLOCK_SIZE];
+  float ref_sig[VOR_BLOCK_SIZE];
+  uint32_t k;
+
+  while (nb > 0) {
+    const uint32_t n = nb < VOR_BLOCK_SIZE ? nb : VOR_BLOCK_SIZE;
+
+    // get VAR and REF signals by bandpassing input signal
+    vor_float_filter_bp_var_block(samples, var_sig, n);
+    vor_float_filter_bp_ref_block(samples, ref_sig, n);
+
+    for (k = 0; k < n; k++) {
+      vfd_var_sig = var_sig[k];
+      vor_float_demod_step(ref_sig[k]);
+    }
+
+    samples += n;
+    nb -= n;
+  }
+
+}
@@ -25,8 +25,12 @@
 #ifndef VOR_FLOAT_DEMOD_H
 #define VOR_FLOAT_DEMOD_H
 
+#include <inttypes.h>
+
 extern void vor_float_demod_init( void);
 extern void vor_float_demod_run ( float sample);
+/* same as vor_float_demod_run on nb consecutive samples */
+extern void vor_float_demod_run_block ( const float* samples, uint32_t nb);
 
 extern const float vfd_te;
 
@@ -1,6 +1,8 @@
 #ifndef VOR_FLOAT_FILTERS_H
 #define VOR_FLOAT_FILTERS_H
 
+#include "vor_filters_block.h"
+
 //typedef float (*vor_float_filter_fun)( float xn);
 
 inline float vor_float_filter_bp_var( float xn) {
@@ -307,4 +309,104 @@ inline float vor_float_filter_lp_fm( float xn) {
 
 }
 
+/* block versions of the bandpass filters (n <= VOR_BLOCK_SIZE) */
+
+inline void vor_float_filter_bp_var_block( const float* xn, float* yn, uint32_t n) {
+
+  const float a0 =  0.0000294918571461433008684162315748977790;
+  const float a1 =  0.0000884755714384299093815122727590960494;
+  const float a2 =  0.0000884755714384299093815122727590960494;
+  const float a3 =  0.0000294918571461433008684162315748977790;
+
+  const float b1 = -2.8738524677701420273479016032069921493530;
+  const float b2 =  2.7555363566291544152875303552718833088875;
+  const float b3 = -0.8814479540018430592240861187747213989496;
+
+  /* x[0..2] : last 3 inputs of the previous block, x3 first */
+  static float x[VOR_BLOCK_SIZE + 3];
+
+  static float y1 = 0;
+  static float y2 = 0;
+  static float y3 = 0;
+
+  float ff[VOR_BLOCK_SIZE];
+  uint32_t k;
+
+  for (k = 0; k < n; k++)
+    x[k+3] = xn[k];
+
+  VOR_BLOCK_FOR(k, n, ff[k] = a0 * x[k+3] + a1 * x[k+2] + a2 * x[k+1] + a3 * x[k])
+
+  for (k = 0; k < n; k++) {
+    float y = ff[k]
+            - b1 * y1
+            - b2 * y2
+            - b3 * y3;
+
+    y3 = y2;
+    y2 = y1;
+    y1 = y;
+
+    yn[k] = y;
+  }
+
+  for (k = 0; k < 3; k++)
+    x[k] = x[n+k];
+}
+
+inline void vor_float_filter_bp_ref_block( const float* xn, float* yn, uint32_t n) {
+
+  const float a0 =  0.0175489156490784836694984960558940656483;
+  const float a2 = -0.0526467469472354510084954881676821969450;
+  const float a4 =  0.0526467469472354510084954881676821969450;
+  const float a6 = -0.0175489156490784836694984960558940656483;
+
+  const float b1 =  2.5508195725874163173330089193768799304962;
+  const float b2 =  3.9857308274503626677187639870680868625641;
+  const float b3 =  3.8245798569419009460546021728077903389931;
+  const float b4 =  2.6296760724926846464200025366153568029404;
+  const float b5 =  1.0926715614934312537087635064381174743176;
+  const float b6 =  0.2825578543465128156242371915141120553017;
+
+  /* x[0..5] : last 6 inputs of the previous block, x6 first */
+  static float x[VOR_BLOCK_SIZE + 6];
+
+  static float y1 = 0;
+  static float y2 = 0;
+  static float y3 = 0;
+  static float y4 = 0;
+  static float y5 = 0;
+  static float y6 = 0;
+
+  float ff[VOR_BLOCK_SIZE];
+  uint32_t k;
+
+  for (k = 0; k < n; k++)
+    x[k+6] = xn[k];
+
+  VOR_BLOCK_FOR(k, n, ff[k] = a0 * x[k+6] + a2 * x[k+4] + a4 * x[k+2] + a6 * x[k])
+
+  for (k = 0; k < n; k++) {
+    float y = ff[k]
+            - b1 * y1
+            - b2 * y2
+            - b3 * y3
+            - b4 * y4
+            - b5 * y5
+            - b6 * y6;
+
+    y6 = y5;
+    y5 = y4;
+    y4 = y3;
+    y3 = y2;
+    y2 = y1;
+    y1 = y;
+
+    yn[k] = y;
+  }
+
+  for (k = 0; k < 6; k++)
+    x[k] = x[n+k];
+}
+
 #endif /* VOR_FLOAT_FILTERS_H */
@@ -129,19 +129,12 @@ void vor_int_demod_init( void) {
   vid_qdr_available = FALSE;
 }
 
-void vor_int_demod_run ( int16_t sample) {
+// PLLs and decimation chain, run once per input sample
+// on the outputs of the bandpass filters (vid_var_sig, vid_ref_sig)
+static inline void vor_int_demod_decim( void) {
 
   decim1++;
 
-  // Le signal arrive sur 10 bits, on le met sur 16 bits
-  sample = sample*(1<<6);
-
-  // get VAR signal by bandpassing input signal
-  vid_var_sig = vor_int_filter_bp_var(sample);
-
-  // get REF signal by bandpassing input signal
-  vid_ref_sig = vor_int_filter_bp_ref(sample);
-
   //=================================================================
   switch (decim1) {
 
@@ -255,3 +248,36 @@ void vor_int_demod_run ( int16_t sample) {
 
 }
 
+void vor_int_demod_run ( int16_t sample) {
+  vor_int_demod_run_block(&sample, 1);
+}
+
+void vor_int_demod_run_block ( const int16_t* samples, uint32_t nb) {
+
+  int16_t in[VOR_BLOCK_SIZE];
+  int32_t var_sig[VOR_BLOCK_SIZE];
+  int32_t ref_sig[VOR_BLOCK_SIZE];
+  uint32_t k;
+
+  while (nb > 0) {
+    const uint32_t n = nb < VOR_BLOCK_SIZE ? nb : VOR_BLOCK_SIZE;
+
+    // Le signal arrive sur 10 bits, on le met sur 16 bits
+    for (k = 0; k < n; k++)
+      in[k] = samples[k]*(1<<6);
+
+    // get VAR and REF signals by bandpassing input signal
+    vor_int_filter_bp_var_block(in, var_sig, n);
+    vor_int_filter_bp_ref_block(in, ref_sig, n);
+
+    for (k = 0; k < n; k++) {
+      vid_var_sig = var_sig[k];
+      vid_ref_sig = ref_sig[k];
+      vor_int_demod_decim();
+    }
+
+    samples += n;
+    nb -= n;
+  }
+
+}
@@ -7,6 +7,8 @@
 
 extern void vor_int_demod_init( void);
 extern void vor_int_demod_run( int16_t sample);
+/* same as vor_int_demod_run on nb consecutive samples */
+extern void vor_int_demod_run_block( const int16_t* samples, uint32_t nb);
 
 extern       int32_t vid_ref_sig;
 
@@ -1,6 +1,8 @@
 #ifndef VOR_INT_FILTERS_DECIM_H
 #define VOR_INT_FILTERS_DECIM_H
 
+#include "vor_filters_block.h"
+
 extern inline int32_t vor_int_filter_bp_ref( int16_t xn);
 extern inline int32_t vor_int_filter_lp_ref( int16_t xn);
 extern inline int32_t vor_int_filter_bp_var( int16_t xn);
@@ -13,6 +15,9 @@ extern inline int32_t vor_int_filter_lp_fm3( int16_t xn);
 extern inline int32_t vor_int_filter_lp_var4( int16_t xn);
 extern inline int32_t vor_int_filter_lp_fm4( int16_t xn);
 
+extern inline void vor_int_filter_bp_ref_block( const int16_t* xn, int32_t* yn, uint32_t n);
+extern inline void vor_int_filter_bp_var_block( const int16_t* xn, int32_t* yn, uint32_t n);
+
 #undef VIF_RES
 #define VIF_RES  14
 #define VIF_FACT (1<<VIF_RES)
@@ -589,4 +594,118 @@ inline int32_t vor_int_filter_lp_fm4( int16_t xn) {
   return (_yn);
 }
 
+//-Filtres d'entree par blocs (n <= VOR_BLOCK_SIZE)----------------//
+
+inline void vor_int_filter_bp_ref_block( const int16_t* xn, int32_t* yn, uint32_t n) {
+
+#undef VIF_RES
+#define VIF_RES  12
+
+  const int32_t a0 = VIF_PCOEF(0.0175489156490784840000000000000000000000);
+  const int32_t a2 = VIF_NCOEF(-0.0526467469472354510000000000000000000000);
+  const int32_t a4 = VIF_PCOEF(0.0526467469472354510000000000000000000000);
+  const int32_t a6 = VIF_NCOEF(-0.0175489156490784840000000000000000000000);
+
+  const int32_t b1 = VIF_PCOEF(2.5508195725874163000000000000000000000000);
+  const int32_t b2 = VIF_PCOEF(3.9857308274503627000000000000000000000000);
+  const int32_t b3 = VIF_PCOEF(3.8245798569419009000000000000000000000000);
+  const int32_t b4 = VIF_PCOEF(2.6296760724926846000000000000000000000000);
+  const int32_t b5 = VIF_PCOEF(1.0926715614934313000000000000000000000000);
+  const int32_t b6 = VIF_PCOEF(0.2825578543465128200000000000000000000000);
+
+  // x[0..5] : last 6 inputs of the previous block, x6 first
+  static int16_t x[VOR_BLOCK_SIZE + 6];
+
+  static int32_t _y1 = 0;
+  static int32_t _y2 = 0;
+  static int32_t _y3 = 0;
+  static int32_t _y4 = 0;
+  static int32_t _y5 = 0;
+  static int32_t _y6 = 0;
+
+  int32_t ff[VOR_BLOCK_SIZE];
+  uint32_t k;
+
+  for (k = 0; k < n; k++)
+    x[k+6] = xn[k];
+
+  VOR_BLOCK_FOR(k, n, ff[k] = a0 * x[k+6] + a2 * x[k+4] + a4 * x[k+2] + a6 * x[k])
+
+  for (k = 0; k < n; k++) {
+    int32_t _yn = ff[k]
+                - b1 * _y1
+                - b2 * _y2
+                - b3 * _y3
+                - b4 * _y4
+                - b5 * _y5
+                - b6 * _y6;
+
+    _y6 = _y5;
+    _y5 = _y4;
+    _y4 = _y3;
+    _y3 = _y2;
+    _y2 = _y1;
+    _y1 = _yn / VIF_FACT;
+
+#undef VIF_RES
+#define VIF_RES  11
+
+    yn[k] = _yn / VIF_FACT;
+
+#undef VIF_RES
+#define VIF_RES  12
+  }
+
+  for (k = 0; k < 6; k++)
+    x[k] = x[n+k];
+}
+
+inline void vor_int_filter_bp_var_block( const int16_t* xn, int32_t* yn, uint32_t n) {
+
+#undef VIF_RES
+#define VIF_RES  13
+
+  const int32_t a0 = VIF_PCOEF(0.0029300958945794793000000000000000000000);
+  const int32_t a1 = VIF_PCOEF(0.0087902876837384382000000000000000000000);
+  const int32_t a2 = VIF_PCOEF(0.0087902876837384382000000000000000000000);
+  const int32_t a3 = VIF_PCOEF(0.0029300958945794793000000000000000000000);
+
+  const int32_t b1 = VIF_NCOEF(-2.3715994101489439000000000000000000000000);
+  const int32_t b2 = VIF_PCOEF(1.9257572822812750000000000000000000000000);
+  const int32_t b3 = VIF_NCOEF(-0.5307171049756953500000000000000000000000);
+
+  // x[0..2] : last 3 inputs of the previous block, x3 first
+  static int16_t x[VOR_BLOCK_SIZE + 3];
+
+  static int32_t _y1 = 0;
+  static int32_t _y2 = 0;
+  static int32_t _y3 = 0;
+
+  int32_t ff[VOR_BLOCK_SIZE];
+  uint32_t k;
+
+  for (k = 0; k < n; k++)
+    x[k+3] = xn[k];
+
+  VOR_BLOCK_FOR(k, n, ff[k] = a0 * x[k+3] + a1 * x[k+2] + a2 * x[k+1] + a3 * x[k])
+
+  for (k = 0; k < n; k++) {
+    int32_t _yn = ff[k]
+                - b1 * _y1
+                - b2 * _y2
+                - b3 * _y3;
+
+    _yn = (_yn/VIF_FACT);
+
+    _y3 = _y2;
+    _y2 = _y1;
+    _y1 = _yn;
+
+    yn[k] = _yn;
+  }
+
+  for (k = 0; k < 3; k++)
+    x[k] = x[n+k];
+}
+
 #endif /* VOR_INT_FILTERS_DECIM_H */
@@ -42,13 +42,57 @@ basic_ins_qkf::basic_ins_qkf(
 	avg_state.orientation = initial_orientation;
 	avg_state.velocity = vel_estimate;
 
+#if INS_QKF_SQRT_COV
+	cov_sqrt = Matrix<double, 12, 12>::Zero();
+	cov_sqrt.block<3, 3>(0, 0) = Matrix3d::Identity()*std::abs(bias_error);
+	cov_sqrt.block<3, 3>(3, 3) = Matrix3d::Identity()*M_PI*M_SQRT1_2;
+	cov_sqrt.block<3, 3>(6, 6) = Matrix3d::Identity()*std::abs(pos_error);
+	cov_sqrt.block<3, 3>(9, 9) = Matrix3d::Identity()*std::abs(v_error);
+#else
 	cov << Matrix3d::Identity()*bias_error*bias_error, Matrix<double, 3, 9>::Zero(),
 		Matrix3d::Zero(), Matrix3d::Identity()*M_PI*M_PI*0.5, Matrix<double, 3, 6>::Zero(),
 		Matrix<double, 3, 6>::Zero(), Matrix3d::Identity()*pos_error*pos_error, Matrix3d::Zero(),
 		Matrix<double, 3, 9>::Zero(), Matrix3d::Identity()*v_error*v_error;
+#endif
 	assert(is_real());
 }
 
+Matrix<double, 12, 12>
+basic_ins_qkf::covariance(void) const
+{
+#if INS_QKF_SQRT_COV
+	return cov_sqrt * cov_sqrt.transpose();
+#else
+	return cov;
+#endif
+}
+
+void
+basic_ins_qkf::set_covariance(const Matrix<double, 12, 12>& _cov)
+{
+#if INS_QKF_SQRT_COV
+	// Cholesky decomposition. Null pivots (perfectly known states) leave a
+	// null column.
+	cov_sqrt = Matrix<double, 12, 12>::Zero();
+	for (int j = 0; j < 12; ++j) {
+		double d = _cov(j, j);
+		for (int k = 0; k < j; ++k)
+			d -= cov_sqrt(j, k)*cov_sqrt(j, k);
+		if (d <= 0)
+			continue;
+		cov_sqrt(j, j) = std::sqrt(d);
+		for (int i = j+1; i < 12; ++i) {
+			double a = _cov(i, j);
+			for (int k = 0; k < j; ++k)
+				a -= cov_sqrt(i, k)*cov_sqrt(j, k);
+			cov_sqrt(i, j) = a / cov_sqrt(j, j);
+		}
+	}
+#else
+	cov = _cov;
+#endif
+}
+
 void
 basic_ins_qkf::counter_rotate_cov(const Quaterniond&)
 {
@@ -101,7 +145,11 @@ basic_ins_qkf::average_sigma_points(const std::vector<state, aligned_allocator<s
 bool
 basic_ins_qkf::is_real(void) const
 {
+#if INS_QKF_SQRT_COV
+	return !(hasNaN(cov_sqrt) || hasInf(cov_sqrt)) && avg_state.is_real();
+#else
 	return !(hasNaN(cov) || hasInf(cov)) && avg_state.is_real();
+#endif
 }
 
 Quaterniond
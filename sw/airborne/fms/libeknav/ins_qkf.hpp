@@ -26,6 +26,16 @@
 
 #define BARO_CENTER_OF_MASS 1
 
+/**
+ * Keep the lower triangular square root of the covariance instead of the
+ * dense matrix (cov = cov_sqrt * cov_sqrt^T). The factor can not lose its
+ * symmetry nor its positive definiteness, at the price of a few more flops
+ * in predict().
+ */
+#ifndef INS_QKF_SQRT_COV
+#define INS_QKF_SQRT_COV 0
+#endif
+
 using Eigen::Vector3f;
 using Eigen::Vector3d;
 using Eigen::Vector2d;
@@ -144,8 +154,22 @@ struct basic_ins_qkf
 	/// The average state of the filter at any time t.
 	state avg_state;
 
+#if INS_QKF_SQRT_COV
+	/// Lower triangular square root of the covariance term, with a non negative diagonal
+	Matrix<double, 12, 12> cov_sqrt;
+#else
 	/// Covariance term.  Elements are ordered exactly as in struct state
 	Matrix<double, 12, 12> cov;
+#endif
+
+	/// @return The covariance matrix, whatever its representation
+	Matrix<double, 12, 12> covariance(void) const;
+
+	/**
+	 * Set the covariance matrix, whatever its representation
+	 * @param cov A symmetric positive semi-definite matrix
+	 */
+	void set_covariance(const Matrix<double, 12, 12>& cov);
 
 	/**
 	 * Initialize a new basic INS QKF
@@ -302,6 +326,27 @@ public:
 	  */
 	void counter_rotate_cov(const Quaterniond& update);
 
+#if INS_QKF_SQRT_COV
+	/**
+	 * Square root form of a scalar observation z = h^T * x + v, var(v) = error.
+	 * The factor is updated in place and stays lower triangular.
+	 * @return The Kalman gain
+	 */
+	Matrix<double, 12, 1> sqrt_cov_scalar_update(const Matrix<double, 12, 1>& h, double error);
+
+	/**
+	 * Square root form of cov += v * v^T
+	 * @param v The update vector, zero before index first
+	 */
+	void sqrt_cov_rank_one_update(Matrix<double, 12, 1> v, int first);
+
+	/**
+	 * Restore the triangular shape of the factor by rotating its columns
+	 * first..last, for the rows first..last.
+	 */
+	void sqrt_cov_triangularize(int first, int last);
+#endif
+
 	/**
 	 * Verify that the covariance and average state are niether NaN nor Inf
 	 * @return True, iff no element in the covariance or mean are NaN or Inf
@@ -38,7 +38,16 @@ basic_ins_qkf::obs_gps_p_report(const Vector3d& pos, const Vector3d& p_error)
 	Matrix<double, 3, 1> residual = pos - avg_state.position;	
 
 
-#ifdef RANK_ONE_UPDATES
+#if INS_QKF_SQRT_COV
+	Matrix<double, 12, 1> update = Matrix<double, 12, 1>::Zero();
+	for (int i = 0; i < 3; ++i) {
+		Matrix<double, 12, 1> h = Matrix<double, 12, 1>::Zero();
+		h[6+i] = 1;
+		Matrix<double, 12, 1> gain = sqrt_cov_scalar_update(h, p_error[i]);
+		update += gain * (residual[i] - update[6+i]);
+	}
+
+#elif defined(RANK_ONE_UPDATES)
 	Matrix<double, 12, 1> update = Matrix<double, 12, 1>::Zero();
 	for (int i = 0; i < 3; ++i) {
 		double innovation_cov_inv = 1.0/(cov(6+i, 6+i) + p_error[i]);
@@ -67,6 +76,13 @@ void
 basic_ins_qkf::obs_baro_report(double altitude, double baro_error){
   double height_state = avg_state.position.norm();
   Matrix<double, 1, 3> H = avg_state.position.transpose()/height_state;
+#if INS_QKF_SQRT_COV
+  Matrix<double, 12, 1> h = Matrix<double, 12, 1>::Zero();
+  h.segment<3>(6) = H.transpose();
+  Matrix<double, 12, 1> update = sqrt_cov_scalar_update(h, baro_error) * (altitude - height_state);
+	Quaterniond rotor = avg_state.apply_kalman_vec_update(update);
+	counter_rotate_cov(rotor);
+#else
   Matrix<double, 1, 1> innovation_cov = H * cov.block<3,3>(6,6) * H.transpose();
   
   Matrix<double, 12, 1> kalman_gain = cov.block<12, 3>(0,6) * H.transpose() / (innovation_cov(0)+baro_error);
@@ -78,21 +94,30 @@ basic_ins_qkf::obs_baro_report(double altitude, double baro_error){
 	counter_rotate_cov(rotor);
   
   cov.part<Eigen::SelfAdjoint>() -= kalman_gain * H * cov.block<3, 12>(6, 0);
+#endif
   
 }
 #else  /* BARO_CENTER_OF_MASS */
 void
 basic_ins_qkf::obs_baro_report(double altitude, double baro_error, Matrix<double, 3, 3> ecef2enu, const Vector3d& pos_0){
   Matrix<double, 1, 3> h = ecef2enu.block<1, 3>(2,0);
+#if INS_QKF_SQRT_COV
+  Matrix<double, 12, 1> h_state = Matrix<double, 12, 1>::Zero();
+  h_state.segment<3>(6) = h.transpose();
+  Matrix<double, 12, 1> kalman_gain = sqrt_cov_scalar_update(h_state, baro_error);
+#else
   Matrix<double, 1, 1> innovation_cov = h * cov.block<3,3>(6,6) * h.transpose();
   double innovation_cov_scalar = innovation_cov(0)+baro_error;
   Matrix<double, 12, 1> kalman_gain = cov.block<12, 3>(0,6) * h.transpose() / innovation_cov_scalar;
+#endif
   
   Matrix<double, 1, 1> state_projection = h*(avg_state.position-pos_0);
   double residual = altitude - state_projection(0);
   
   Matrix<double, 12, 1> update = kalman_gain * residual;
+#if !INS_QKF_SQRT_COV
   cov.part<Eigen::SelfAdjoint>() -= kalman_gain * h * cov.block<3, 12>(6, 0);
+#endif
 	Quaterniond rotor = avg_state.apply_kalman_vec_update(update);
 	counter_rotate_cov(rotor);
 }
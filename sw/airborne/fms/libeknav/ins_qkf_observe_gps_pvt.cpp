@@ -38,7 +38,15 @@ basic_ins_qkf::obs_gps_v_report(const Vector3d& vel, const Vector3d& v_error)
 	Vector3d residual = vel - avg_state.velocity;
 	//std::cout << "diff_v(" <<residual(0) << ", " << residual(1) << ", " << residual(2) <<")\n";
 
-#ifdef RANK_ONE_UPDATES
+#if INS_QKF_SQRT_COV
+	Matrix<double, 12, 1> update = Matrix<double, 12, 1>::Zero();
+	for (int i = 0; i < 3; ++i) {
+		Matrix<double, 12, 1> h = Matrix<double, 12, 1>::Zero();
+		h[9+i] = 1;
+		Matrix<double, 12, 1> gain = sqrt_cov_scalar_update(h, v_error[i]);
+		update += gain * (residual[i] - update[9+i]);
+	}
+#elif defined(RANK_ONE_UPDATES)
 	Matrix<double, 12, 1> update = Matrix<double, 12, 1>::Zero();
 	for (int i = 0; i < 3; ++i) {
 		double innovation_cov_inv = 1.0/(cov(9+i, 9+i) + v_error[i]);
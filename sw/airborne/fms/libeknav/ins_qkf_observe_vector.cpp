@@ -35,6 +35,17 @@ using namespace Eigen;
 void
 basic_ins_qkf::obs_gyro_bias(const Vector3d& bias, const Vector3d& bias_error)
 {
+#if INS_QKF_SQRT_COV
+	Vector3d innovation = bias - avg_state.gyro_bias;
+	Matrix<double, 12, 1> update = Matrix<double, 12, 1>::Zero();
+	for (int i = 0; i < 3; ++i) {
+		Matrix<double, 12, 1> h = Matrix<double, 12, 1>::Zero();
+		h[i] = 1;
+		Matrix<double, 12, 1> gain = sqrt_cov_scalar_update(h, bias_error[i]);
+		update += gain * (innovation[i] - update[i]);
+	}
+	avg_state.apply_kalman_vec_update(update);
+#else
 	Matrix<double, 12, 3> kalman_gain = cov.block<12, 3>(0, 0) 
 			* (cov.block<3, 3>(0, 0) + bias_error.asDiagonal()).inverse();
 	cov -= kalman_gain * cov.block<3, 12>(0, 0);
@@ -42,6 +53,7 @@ basic_ins_qkf::obs_gyro_bias(const Vector3d& bias, const Vector3d& bias_error)
 
 	// Apply the Kalman gain to obtain the posterior state and error estimates.
 	avg_state.apply_kalman_vec_update(kalman_gain * innovation);
+#endif
 }
 
 void
@@ -153,7 +165,15 @@ basic_ins_qkf::obs_vector(const Vector3d& ref, const Vector3d& obs, double error
 	assert(!hasNaN(h_trans));
 	assert(h_trans.isUnitary());
 	Vector2d innovation = h_trans.transpose() * v_residual;
-#ifdef RANK_ONE_UPDATES
+#if INS_QKF_SQRT_COV
+	Matrix<double, 12, 1> update = Matrix<double, 12, 1>::Zero();
+	for (int i = 0; i < 2; ++i) {
+		Matrix<double, 12, 1> h = Matrix<double, 12, 1>::Zero();
+		h.segment<3>(3) = h_trans.col(i);
+		Matrix<double, 12, 1> gain = sqrt_cov_scalar_update(h, error);
+		update += gain * h_trans.col(i).transpose() * v_residual;
+	}
+#elif defined(RANK_ONE_UPDATES)
 	// Running a rank-one update here is a strict win.
 	Matrix<double, 12, 1> update = Matrix<double, 12, 1>::Zero();
 	for (int i = 0; i < 2; ++i) {
@@ -173,7 +193,7 @@ basic_ins_qkf::obs_vector(const Vector3d& ref, const Vector3d& obs, double error
 #endif
 
 	// Apply the Kalman gain to obtain the posterior state and error estimates.
-#ifndef RANK_ONE_UPDATES
+#if !defined(RANK_ONE_UPDATES) && !INS_QKF_SQRT_COV
 	Matrix<double, 12, 1> update = (kalman_gain * innovation);
 #endif
 
@@ -100,7 +100,31 @@ linear_predict(basic_ins_qkf& _this, const Vector3d& gyro_meas, const Vector3d&
 	// Then, only one 3x3 block ever gets updated in the A matrix below.
 
 	// The linearized Kalman state projection matrix.
-#if 0
+#if INS_QKF_SQRT_COV
+	// cov_sqrt <- A * cov_sqrt, with the same A as below. Thanks to the
+	// triangular shape only the position rows fill the upper part, which
+	// is rotated back in the position/velocity columns.
+	const Matrix3d dtR = dt * _this.avg_state.orientation.conjugate().toRotationMatrix();
+	const Matrix3d dtQ = accel_cov * dt;
+	Matrix<double, 12, 12>& S = _this.cov_sqrt;
+
+	S.block<3, 12>(6, 0) += dt * S.block<3, 12>(9, 0);
+	S.block<3, 6>(9, 0) -= dtQ * S.block<3, 6>(3, 0);
+	S.block<3, 3>(3, 0) -= dtR * S.block<3, 3>(0, 0);
+	_this.sqrt_cov_triangularize(6, 11);
+
+	// Process noise, one rank-one update per diagonal term
+	Matrix<double, 12, 1> noise;
+	noise << _this.gyro_stability_noise * dt,
+		_this.gyro_white_noise * dt,
+		_this.accel_white_noise * 0.5*dt*dt,
+		_this.accel_white_noise * dt;
+	for (int i = 0; i < 12; ++i) {
+		Matrix<double, 12, 1> v = Matrix<double, 12, 1>::Zero();
+		v[i] = std::sqrt(noise[i]);
+		_this.sqrt_cov_rank_one_update(v, i);
+	}
+#elif 0
 	Matrix<double, 12, 12> A;
 	     // gyro bias row
 	A << Matrix<double, 3, 3>::Identity(), Matrix<double, 3, 9>::Zero(),
@@ -146,10 +170,12 @@ linear_predict(basic_ins_qkf& _this, const Vector3d& gyro_meas, const Vector3d&
 	_this.cov.block<3, 3>(9, 6) = _this.cov.block<3, 3>(6, 9).transpose();
 #endif
 
+#if !INS_QKF_SQRT_COV
 	_this.cov.block<3, 3>(0, 0) += _this.gyro_stability_noise.asDiagonal() * dt;
 	_this.cov.block<3, 3>(3, 3) += _this.gyro_white_noise.asDiagonal() * dt;
 	_this.cov.block<3, 3>(6, 6) += _this.accel_white_noise.asDiagonal() * 0.5*dt*dt;
 	_this.cov.block<3, 3>(9, 9) += _this.accel_white_noise.asDiagonal() * dt;
+#endif
 
 	Quaterniond orientation = exp<double>((gyro_meas - _this.avg_state.gyro_bias) * dt)
 			* _this.avg_state.orientation;
@@ -0,0 +1,116 @@
+/*
+ * ins_qkf_sqrt_cov.cpp
+ *
+ *          This file is part of libeknav.
+ *
+ *  Libeknav is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, version 3.
+ *
+ *  Libeknav is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+
+ *  You should have received a copy of the GNU General Public License
+ *  along with libeknav.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Square root form of the covariance operations (INS_QKF_SQRT_COV).
+ * cov_sqrt = S is lower triangular, cov = S * S^T.
+ *
+ * All the observations of the filter are processed as sequences of scalar
+ * updates, so the only measurement update needed is the scalar one:
+ * with f = S^T h and a_k = error + sum_{i>=k} f_i^2,
+ *   S' = S * L,  L(k,k) = sqrt(a_{k+1}/a_k),
+ *                L(i,k) = -f_i f_k / sqrt(a_k a_{k+1})  for i > k
+ * L is lower triangular, so is S', and L * L^T = I - f f^T / a_0.
+ */
+
+#include "ins_qkf.hpp"
+#include "assertions.hpp"
+
+#if INS_QKF_SQRT_COV
+
+using namespace Eigen;
+
+Matrix<double, 12, 1>
+basic_ins_qkf::sqrt_cov_scalar_update(const Matrix<double, 12, 1>& h, double error)
+{
+	Matrix<double, 12, 12>& S = cov_sqrt;
+	double f[12], a[13];
+
+	// f = S^T * h
+	for (int k = 0; k < 12; ++k) {
+		f[k] = 0;
+		for (int i = k; i < 12; ++i)
+			f[k] += S(i, k) * h[i];
+	}
+	a[12] = error;
+	for (int k = 11; k >= 0; --k)
+		a[k] = a[k+1] + f[k]*f[k];
+
+	// w accumulates sum_{i>k} f_i * S.col(i), non zero from row k+1
+	Matrix<double, 12, 1> w = Matrix<double, 12, 1>::Zero();
+	for (int k = 11; k >= 0; --k) {
+		const double l_kk = std::sqrt(a[k+1] / a[k]);
+		const double l_k = f[k] / std::sqrt(a[k] * a[k+1]);
+		for (int i = k; i < 12; ++i) {
+			const double s_ik = S(i, k);
+			S(i, k) = l_kk * s_ik - l_k * w[i];
+			w[i] += f[k] * s_ik;
+		}
+	}
+	// w = S * f = cov * h
+	return w / a[0];
+}
+
+void
+basic_ins_qkf::sqrt_cov_rank_one_update(Matrix<double, 12, 1> v, int first)
+{
+	Matrix<double, 12, 12>& S = cov_sqrt;
+
+	// Rotate v into the columns of S, one column at a time. The columns
+	// are contiguous (column major storage).
+	for (int k = first; k < 12; ++k) {
+		if (v[k] == 0)
+			continue;
+		double* col = &S.coeffRef(0, k);
+		const double r = std::sqrt(col[k]*col[k] + v[k]*v[k]);
+		const double c = col[k] / r;
+		const double s = v[k] / r;
+		col[k] = r;
+		for (int i = k+1; i < 12; ++i) {
+			const double s_ik = col[i];
+			col[i] = c * s_ik + s * v[i];
+			v[i] = c * v[i] - s * s_ik;
+		}
+	}
+}
+
+void
+basic_ins_qkf::sqrt_cov_triangularize(int first, int last)
+{
+	Matrix<double, 12, 12>& S = cov_sqrt;
+
+	// Givens rotations of the columns k and j zero S(k, j), the rows above
+	// first are expected to be zero in the columns first..last
+	for (int k = first; k < last; ++k) {
+		for (int j = k+1; j <= last; ++j) {
+			if (S(k, j) == 0)
+				continue;
+			const double r = std::sqrt(S(k, k)*S(k, k) + S(k, j)*S(k, j));
+			const double c = S(k, k) / r;
+			const double s = S(k, j) / r;
+			for (int i = k; i < 12; ++i) {
+				const double s_ik = S(i, k);
+				const double s_ij = S(i, j);
+				S(i, k) = c * s_ik + s * s_ij;
+				S(i, j) = c * s_ij - s * s_ik;
+			}
+		}
+	}
+}
+
+#endif /* INS_QKF_SQRT_COV */
@@ -1,295 +1,475 @@
-
 #include "libeknav_from_log.hpp"
 
 // NOTE: This in the headfile?
 struct LtpDef_d current_ltp;
 // NOTE-END
 
-unsigned int entry_counter;
-
-FILE* ins_logfile;		// note: initilaized in init_ins_state
-
-//useless initialization (I hate C++)
-static basic_ins_qkf ins = basic_ins_qkf(Vector3d::Zero(), 0, 0, 0,
-					 gyro_stability_noise,gyroscope_noise, accelerometer_noise);
-
 // import most common Eigen types 
 USING_PART_OF_NAMESPACE_EIGEN
 
-int main(int, char *argv[]) {
-  
-  entry_counter = 0;
+/** The log is decoded once by a reader thread and fed to one filter
+ *  thread per parameter set, each through its own single producer single
+ *  consumer ring. The filters run concurrently and write their state in
+ *  a binary file of struct replay_output (and optionally in the old .data
+ *  format).
+ */
+
+static const struct raw_log_entry* log_entries;
+static size_t nb_log_entries;
+
+static struct replay_filter* filters;
+static int nb_filters;
+
+int main(int argc, char *argv[]) {
+  const char* params_file = NULL;
+  const char* out_prefix = INS_LOG_FILE;
+  int ascii = 0;
+  int opt, i;
+
+  while ((opt = getopt(argc, argv, "p:o:a")) != -1) {
+    switch (opt) {
+      case 'p': params_file = optarg; break;
+      case 'o': out_prefix = optarg; break;
+      case 'a': ascii = 1; break;
+      default:
+        fprintf(stderr, "usage: %s [-p params_file] [-o output_prefix] [-a] log.bin\n", argv[0]);
+        return -1;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr, "usage: %s [-p params_file] [-o output_prefix] [-a] log.bin\n", argv[0]);
+    return -1;
+  }
+
   printf("==============================\nRunning libeknav from File...\n==============================\n");
-  
-  int raw_log_fd = open(argv[1], O_RDONLY); 
-  
+
+  int raw_log_fd = open(argv[optind], O_RDONLY);
   if (raw_log_fd == -1) {
     perror("opening log\n");
     return -1;
   }
-  
+  struct stat st;
+  fstat(raw_log_fd, &st);
+  nb_log_entries = st.st_size / sizeof(struct raw_log_entry);
+  if (nb_log_entries == 0) {
+    fprintf(stderr, "empty log\n");
+    return -1;
+  }
+  void* m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, raw_log_fd, 0);
+  if (m == MAP_FAILED) {
+    perror("mapping log\n");
+    return -1;
+  }
+  madvise(m, st.st_size, MADV_SEQUENTIAL);
+  log_entries = (const struct raw_log_entry*)m;
+
+  struct replay_params* params;
+  nb_filters = replay_read_params(params_file, &params);
+  if (nb_filters <= 0) {
+    fprintf(stderr, "no parameter set\n");
+    return -1;
+  }
+
+  printf("FILTER output will be in ");
+#if FILTER_OUTPUT_IN_NED
+  printf("NED\n");
+#else /* FILTER_OUTPUT_IN_ECEF */
+  printf("ECEF\n");
+#endif /* FILTER_OUTPUT_IN_NED / ECEF */
+#if UPDATE_WITH_GRAVITY
+  printf("the orientation becomes UPDATED with the GRAVITY\n");
+#endif /* UPDATE_WITH_GRAVITY */
+
   printf("Initialisation...\n");
-  struct raw_log_entry e = first_entry_after_initialisation(raw_log_fd);
-  printf("Starting at t = %5.2f s\n", e.time);
-  printf("entry counter: %i\n", entry_counter);
-  main_init();
-  printf("Running filter from file...\n");
-  main_run_from_file(raw_log_fd, e);
-  
+  struct replay_init init;
+  init.first_entry = replay_initial_averages(log_entries, nb_log_entries, &init);
+  if (init.first_entry >= nb_log_entries) {
+    fprintf(stderr, "not enough measurements to initialise\n");
+    return -1;
+  }
+  printf("Starting at t = %5.2f s\n", log_entries[init.first_entry].time);
+  printf("entry counter: %u\n", (unsigned int)init.first_entry);
+  set_reference_direction();
+
+  filters = new struct replay_filter[nb_filters];
+  for (i = 0; i < nb_filters; i++) {
+    char name[256];
+    struct replay_filter* f = &filters[i];
+    f->params = params[i];
+    f->ascii = ascii;
+    f->nb_steps = 0;
+    f->queue = new struct replay_queue;
+    f->queue->head = f->queue->tail = 0;
+    f->queue->done = 0;
+    snprintf(name, sizeof(name), "%s_%d.%s", out_prefix, i, ascii ? "data" : "bin");
+    f->out = fopen(name, ascii ? "w" : "wb");
+    if (f->out == NULL) {
+      perror(name);
+      return -1;
+    }
+    replay_init_filter(f, &init);
+  }
+  delete[] params;
+
+  printf("Running %d filter(s) from file...\n", nb_filters);
+  for (i = 0; i < nb_filters; i++)
+    pthread_create(&filters[i].thread, NULL, replay_filter_run, &filters[i]);
+  pthread_t reader;
+  pthread_create(&reader, NULL, replay_reader, &init);
+
+  pthread_join(reader, NULL);
+  for (i = 0; i < nb_filters; i++) {
+    pthread_join(filters[i].thread, NULL);
+    fclose(filters[i].out);
+    printf("filter %d: %u steps\n", i, filters[i].nb_steps);
+    delete filters[i].ins;
+    delete filters[i].queue;
+  }
+  delete[] filters;
+
+  munmap(m, st.st_size);
+  close(raw_log_fd);
   printf("Finished\n");
   return 0;
-
 }
 
 
-static void main_init(void) {
-	printf("FILTER output will be in ");
-	#if FILTER_OUTPUT_IN_NED
-		printf("NED\n");
-  #else /* FILTER_OUTPUT_IN_ECEF */
-		printf("ECEF\n");
-	#endif /* FILTER_OUTPUT_IN_NED / ECEF */
-	
-	#if UPDATE_WITH_GRAVITY
-	printf("the orientation becomes UPDATED with the GRAVITY\n");
-  #endif /* UPDATE_WITH_GRAVITY */
+/** Parameter sets, the constants of the header if no file is given */
+static int replay_read_params(const char* file, struct replay_params** params) {
+  struct replay_params p;
+  p.gyroscope_noise      = gyroscope_noise;
+  p.gyro_stability_noise = gyro_stability_noise;
+  p.accelerometer_noise  = accelerometer_noise;
+  p.magnetometer_noise   = magnetometer_noise;
+  p.gps_pos_noise        = gps_pos_noise;
+  p.gps_speed_noise      = gps_speed_noise;
+  p.baro_noise           = baro_noise;
+
+  if (file == NULL) {
+    *params = new struct replay_params[1];
+    (*params)[0] = p;
+    return 1;
+  }
+
+  FILE* f = fopen(file, "r");
+  if (f == NULL) {
+    perror(file);
+    return -1;
+  }
+  int nb = 0, size = 8;
+  char line[1024];
+  *params = new struct replay_params[size];
+  while (fgets(line, sizeof(line), f)) {
+    double v[19];
+    if (line[0] == '#')
+      continue;
+    int n = sscanf(line, "%lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf",
+                   &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9],
+                   &v[10], &v[11], &v[12], &v[13], &v[14], &v[15], &v[16], &v[17], &v[18]);
+    if (n <= 0)
+      continue;
+    if (n != 19) {
+      fprintf(stderr, "%s: parameter set %d: expected 19 values, got %d\n", file, nb, n);
+      continue;
+    }
+    if (nb == size) {
+      struct replay_params* bigger = new struct replay_params[2*size];
+      for (int i = 0; i < size; i++)
+        bigger[i] = (*params)[i];
+      delete[] *params;
+      *params = bigger;
+      size *= 2;
+    }
+    p.gyroscope_noise      = Vector3d(v[0],  v[1],  v[2]);
+    p.gyro_stability_noise = Vector3d(v[3],  v[4],  v[5]);
+    p.accelerometer_noise  = Vector3d(v[6],  v[7],  v[8]);
+    p.magnetometer_noise   = Vector3d(v[9],  v[10], v[11]);
+    p.gps_pos_noise        = Vector3d(v[12], v[13], v[14]);
+    p.gps_speed_noise      = Vector3d(v[15], v[16], v[17]);
+    p.baro_noise           = v[18];
+    (*params)[nb++] = p;
+  }
+  fclose(f);
+  return nb;
+}
 
-  init_ins_state();
-  set_reference_direction();
 
+static void replay_decode(const struct raw_log_entry* e, struct replay_sample* s) {
+  s->time = e->time;
+  s->valid_sensors = e->message.valid_sensors;
+  RATES_FLOAT_OF_BFP(s->gyro, e->message.gyro);
+  ACCELS_FLOAT_OF_BFP(s->accel, e->message.accel);
+  MAGS_FLOAT_OF_BFP(s->mag, e->message.mag);
+  s->baro_height = -BARO_FLOAT_OF_BFP(e->message.pressure_absolute);
+  VECT3_COPY(s->ecef_pos, e->message.ecef_pos);
+  VECT3_COPY(s->ecef_vel, e->message.ecef_vel);
 }
 
-static struct raw_log_entry first_entry_after_initialisation(int file_descriptor){
-  int        imu_measurements = 0,      // => Gyro + Accel
+
+/** Averages the first measurements of the log: gyro bias, position,
+ *  speed, baro height and the attitude profile matrix.
+ *  Returns the index of the first entry to replay.
+ */
+static size_t replay_initial_averages(const struct raw_log_entry* log, size_t nb, struct replay_init* init) {
+  int          imu_measurements = 0,      // => Gyro + Accel
     magnetometer_measurements = 0,
             baro_measurements = 0,
              gps_measurements = 0;      // only the position
-  
-  struct DoubleMat33 attitude_profile_matrix, sigmaB;   // the attitude profile matrix is often called "B"
-  struct Orientation_Measurement  gravity,
-                                  magneto,
-                                  fake;  
-  struct DoubleQuat q_ned2body, sigma_q;
-  
+  struct Orientation_Measurement fake;
+  size_t i = 0;
+
   /* Prepare the attitude profile matrix */
-  FLOAT_MAT33_ZERO(attitude_profile_matrix);
-  FLOAT_MAT33_ZERO(sigmaB);
-  
+  FLOAT_MAT33_ZERO(init->attitude_profile_matrix);
+
   // for faster converging, but probably more rounding error
   #define MEASUREMENT_WEIGHT_SCALE 10
-  
+
   /* set the gravity measurement */
-  VECT3_ASSIGN(gravity.reference_direction, 0,0,-1);
-  gravity.weight_of_the_measurement = MEASUREMENT_WEIGHT_SCALE/(double)(imu_frequency);    // originally 1/(imu_frequency*gravity.norm()
-  //gravity.weight_of_the_measurement = 1;
-  
+  VECT3_ASSIGN(init->gravity.reference_direction, 0,0,-1);
+  init->gravity.weight_of_the_measurement = MEASUREMENT_WEIGHT_SCALE/(double)(imu_frequency);    // originally 1/(imu_frequency*gravity.norm()
+
   /* set the magneto - measurement */
-  EARTHS_GEOMAGNETIC_FIELD_NORMED(magneto.reference_direction);
-  magneto.weight_of_the_measurement = MEASUREMENT_WEIGHT_SCALE/(double)(mag_frequency);    // originally 1/(mag_frequency*reference_direction.norm()
-  //magneto.weight_of_the_measurement = 1;
-  
-  uint8_t read_ok;
+  EARTHS_GEOMAGNETIC_FIELD_NORMED(init->magneto.reference_direction);
+  init->magneto.weight_of_the_measurement = MEASUREMENT_WEIGHT_SCALE/(double)(mag_frequency);    // originally 1/(mag_frequency*reference_direction.norm()
+
   #if WITH_GPS
-  struct raw_log_entry e = next_GPS(file_descriptor);
+  while (i < nb && !GPS_READY(log[i].message.valid_sensors))
+    i++;
   #else /* WITH_GPS */
-  struct raw_log_entry e = read_raw_log_entry(file_descriptor, &read_ok);
   pos_0_ecef = Vector3d(4627578.56, 119659.25, 4373248.00);
   pos_cov_0 = Vector3d::Ones()*100;
   speed_0_ecef    = Vector3d::Zero();
   speed_cov_0 = Vector3d::Ones();
   #endif /* WITH_GPS */
-  
-  #ifdef EKNAV_FROM_LOG_DEBUG
-    int imu_ready = 0, 
-        mag_ready = 0,
-        baro_ready = 0,
-        gps_ready = 0;
-  #endif /* EKNAV_FROM_LOG_DEBUG */
-  
-  for(read_ok = 1; (read_ok) && NOT_ENOUGH_MEASUREMENTS(imu_measurements, magnetometer_measurements, baro_measurements, gps_measurements); e = read_raw_log_entry(file_descriptor, &read_ok)){
-    if(IMU_READY(e.message.valid_sensors)){
+
+  for (; i < nb && NOT_ENOUGH_MEASUREMENTS(imu_measurements, magnetometer_measurements, baro_measurements, gps_measurements); i++) {
+    const struct AutopilotMessageVIUp* msg = &log[i].message;
+    if(IMU_READY(msg->valid_sensors)){
       imu_measurements++;
-      
+
       // update the estimated bias
-      bias_0 = NEW_MEAN(bias_0, RATES_BFP_AS_VECTOR3D(e.message.gyro), imu_measurements);
-      
+      bias_0 = NEW_MEAN(bias_0, RATES_BFP_AS_VECTOR3D(msg->gyro), imu_measurements);
+
       // update the attitude profile matrix
-      ACCELS_FLOAT_OF_BFP(gravity.measured_direction,e.message.accel);
-      add_orientation_measurement(&attitude_profile_matrix, gravity);
+      ACCELS_FLOAT_OF_BFP(init->gravity.measured_direction,msg->accel);
+      add_orientation_measurement(&init->attitude_profile_matrix, init->gravity);
     }
-    if(MAG_READY(e.message.valid_sensors)){
+    if(MAG_READY(msg->valid_sensors)){
       magnetometer_measurements++;
       // update the attitude profile matrix
-      MAGS_FLOAT_OF_BFP(magneto.measured_direction,e.message.mag);
-      add_orientation_measurement(&attitude_profile_matrix, magneto);
-      
+      MAGS_FLOAT_OF_BFP(init->magneto.measured_direction,msg->mag);
+      add_orientation_measurement(&init->attitude_profile_matrix, init->magneto);
+
       // now, generate fake measurement with the last gravity measurement
-      fake = fake_orientation_measurement(gravity, magneto);
-      add_orientation_measurement(&attitude_profile_matrix, fake);
+      fake = fake_orientation_measurement(init->gravity, init->magneto);
+      add_orientation_measurement(&init->attitude_profile_matrix, fake);
     }
-    if(BARO_READY(e.message.valid_sensors)){
+    if(BARO_READY(msg->valid_sensors)){
       baro_measurements++;
-      // TODO: Fix it!
-      //NEW_MEAN(baro_0_height, BARO_FLOAT_OF_BFP(e.message.pressure_absolute), baro_measurements);
-      baro_0_height = (baro_0_height*(baro_measurements-1)+BARO_FLOAT_OF_BFP(e.message.pressure_absolute))/baro_measurements;
+      baro_0_height = (baro_0_height*(baro_measurements-1)+BARO_FLOAT_OF_BFP(msg->pressure_absolute))/baro_measurements;
     }
-    if(GPS_READY(e.message.valid_sensors)){
+    if(GPS_READY(msg->valid_sensors)){
       gps_measurements++;
-      // update the estimated bias
-      pos_0_ecef = NEW_MEAN(pos_0_ecef, VECT3_AS_VECTOR3D(e.message.ecef_pos)/100, gps_measurements);
-      speed_0_ecef = NEW_MEAN(speed_0_ecef, VECT3_AS_VECTOR3D(e.message.ecef_vel)/100, gps_measurements);
+      pos_0_ecef = NEW_MEAN(pos_0_ecef, VECT3_AS_VECTOR3D(msg->ecef_pos)/100, gps_measurements);
+      speed_0_ecef = NEW_MEAN(speed_0_ecef, VECT3_AS_VECTOR3D(msg->ecef_vel)/100, gps_measurements);
     }
-    
-    #ifdef EKNAV_FROM_LOG_DEBUG
-    if(imu_ready==0){
-      if(!NOT_ENOUGH_IMU_MEASUREMENTS(imu_measurements)){
-        printf("IMU READY %3i %3i %3i %3i\n", imu_measurements, magnetometer_measurements, baro_measurements, gps_measurements);
-        imu_ready = 1;
-      }
-    }
-    if(mag_ready==0){
-      if(!NOT_ENOUGH_MAGNETIC_FIELD_MEASUREMENTS(magnetometer_measurements)){
-        printf("MAG READY %3i %3i %3i %3i\n", imu_measurements, magnetometer_measurements, baro_measurements, gps_measurements);
-        mag_ready = 1;
-      }
-    }
-    if(baro_ready==0){
-      if(!NOT_ENOUGH_BARO_MEASUREMENTS(baro_measurements)){
-        printf("BARO READY %3i %3i %3i %3i\n", imu_measurements, magnetometer_measurements, baro_measurements, gps_measurements);
-        baro_ready = 1;
-      }
-    }
-    if(gps_ready==0){
-      if(!NOT_ENOUGH_GPS_MEASUREMENTS(gps_measurements)){
-        printf("GPS READY %3i %3i %3i %3i\n", imu_measurements, magnetometer_measurements, baro_measurements, gps_measurements);
-        gps_ready = 1;
-      }
-    }
-    #endif /* EKNAV_FROM_LOG_DEBUG */
   }
+  if (NOT_ENOUGH_MEASUREMENTS(imu_measurements, magnetometer_measurements, baro_measurements, gps_measurements))
+    return nb;
+
+  init->gravity.weight_of_the_measurement *= imu_measurements;
+  init->magneto.weight_of_the_measurement *= magnetometer_measurements;
+  init->imu_measurements = imu_measurements;
+  init->magnetometer_measurements = magnetometer_measurements;
+  init->gps_measurements = gps_measurements;
+
+  #ifdef EKNAV_FROM_LOG_DEBUG
+  DISPLAY_FLOAT_RMAT("     B", init->attitude_profile_matrix);
+  #endif /* EKNAV_FROM_LOG_DEBUG */
+
+  baro_0_height += pos_0_ecef.norm();
+  return i;
+}
+
+
+/** Initial attitude and covariance of one parameter set */
+static void replay_init_filter(struct replay_filter* f, const struct replay_init* init) {
+  struct DoubleMat33 sigmaB;
+  struct DoubleQuat q_ned2body, sigma_q;
+  struct Orientation_Measurement gravity = init->gravity,
+                                 magneto = init->magneto;
+  const struct replay_params* p = &f->params;
+
   // setting the covariance
-  gravity.weight_of_the_measurement *= imu_measurements;
-  VECTOR_AS_VECT3(gravity.measured_direction, accelerometer_noise);
-  magneto.weight_of_the_measurement *= magnetometer_measurements;
-  VECTOR_AS_VECT3(magneto.measured_direction, magnetometer_noise);
+  FLOAT_MAT33_ZERO(sigmaB);
+  VECTOR_AS_VECT3(gravity.measured_direction, p->accelerometer_noise);
+  VECTOR_AS_VECT3(magneto.measured_direction, p->magnetometer_noise);
   add_set_of_three_measurements(&sigmaB, gravity, magneto);
-  
+
   #ifdef EKNAV_FROM_LOG_DEBUG
-  DISPLAY_FLOAT_RMAT("     B", attitude_profile_matrix);
   DISPLAY_FLOAT_RMAT("sigmaB", sigmaB);
   #endif /* EKNAV_FROM_LOG_DEBUG */
-  
+
   //  setting the initial orientation
-  q_ned2body = estimated_attitude(attitude_profile_matrix, 1000, 1e-6, sigmaB, &sigma_q);
-	orientation_0 = ecef2body_from_pprz_ned2body(pos_0_ecef,q_ned2body);
-  
-  baro_0_height += pos_0_ecef.norm();
-  
+  q_ned2body = estimated_attitude(init->attitude_profile_matrix, 1000, 1e-6, sigmaB, &sigma_q);
+  Quaterniond orientation = ecef2body_from_pprz_ned2body(pos_0_ecef, q_ned2body);
+
   struct DoubleEulers sigma_eu = sigma_euler_from_sigma_q(q_ned2body, sigma_q);
-  orientation_cov_0 = EULER_AS_VECTOR3D(sigma_eu);
+  Vector3d orientation_cov = EULER_AS_VECTOR3D(sigma_eu);
+  Vector3d pos_cov = pos_cov_0;
+  Vector3d speed_cov = speed_cov_0;
   #if WITH_GPS
-  pos_cov_0 = 10*gps_pos_noise / gps_measurements;
-  speed_cov_0 = 10*gps_speed_noise / gps_measurements;
+  pos_cov = 10*p->gps_pos_noise / init->gps_measurements;
+  speed_cov = 10*p->gps_speed_noise / init->gps_measurements;
   #endif  // WITH_GPS
-  
-  return e;
+
+  f->ins = new basic_ins_qkf(Vector3d::Zero(), 0, 0, 0,
+                             p->gyro_stability_noise, p->gyroscope_noise, p->accelerometer_noise);
+  f->ins->avg_state.gyro_bias   = bias_0;
+  f->ins->avg_state.orientation = orientation;
+  f->ins->avg_state.position    = pos_0_ecef;
+  f->ins->avg_state.velocity    = speed_0_ecef;
+
+  struct DoubleQuat ecef2body;
+  struct DoubleEulers eu_ecef2body;
+  QUATERNIOND_AS_DOUBLEQUAT(ecef2body, orientation);
+  DOUBLE_EULERS_OF_QUAT(eu_ecef2body, ecef2body);
+
+  printf("Initial state of filter %d\n\n", (int)(f - filters));
+  printf("Bias        % 6.1f°/s       +-%7.2f°/s\n", bias_0(0)*180*M_1_PI, bias_cov_0(0)*180*M_1_PI);
+  printf("Bias        % 6.1f°/s       +-%7.2f°/s\n", bias_0(1)*180*M_1_PI, bias_cov_0(1)*180*M_1_PI);
+  printf("Bias        % 6.1f°/s       +-%7.2f°/s\n", bias_0(2)*180*M_1_PI, bias_cov_0(2)*180*M_1_PI);
+  printf("\n");
+  printf("Orientation % 7.2f\n", orientation.w());
+  printf("Orientation % 7.2f %6.1f° +-%6.1f°\n", orientation.x(),   eu_ecef2body.phi*180*M_1_PI, orientation_cov(0)*180*M_1_PI);
+  printf("Orientation % 7.2f %6.1f° +-%6.1f°\n", orientation.y(), eu_ecef2body.theta*180*M_1_PI, orientation_cov(1)*180*M_1_PI);
+  printf("Orientation % 7.2f %6.1f° +-%6.1f°\n", orientation.z(),   eu_ecef2body.psi*180*M_1_PI, orientation_cov(2)*180*M_1_PI);
+  printf("\n");
+  printf("Position    % 9.0f m     +-%7.2f\n", pos_0_ecef(0), pos_cov(0));
+  printf("Position    % 9.0f m     +-%7.2f\n", pos_0_ecef(1), pos_cov(1));
+  printf("Position    % 9.0f m     +-%7.2f\n", pos_0_ecef(2), pos_cov(2));
+  printf("\n");
+  printf("Velocity    % 7.2f m/s     +-%7.2f\n", speed_0_ecef(0), speed_cov(0));
+  printf("Velocity    % 7.2f m/s     +-%7.2f\n", speed_0_ecef(1), speed_cov(1));
+  printf("Velocity    % 7.2f m/s     +-%7.2f\n", speed_0_ecef(2), speed_cov(2));
+  printf("\n");
+
+  Matrix<double, 12, 1> diag_cov;
+  diag_cov << p->gyro_stability_noise,
+              orientation_cov,
+              pos_cov,
+              speed_cov;
+  f->ins->set_covariance((diag_cov.cwise()*diag_cov).asDiagonal());
 }
 
 
-static void main_run_from_file(int file_descriptor, struct raw_log_entry first_entry){
-  struct raw_log_entry e = first_entry;
-  uint8_t read_ok = 1;
-  int t = 10*(int)(1+e.time*0.1);
-  while (read_ok) {
-    if(e.time>t){
-      printf("%6.2fs %6i\n", e.time, entry_counter);
+/** Reader thread: decodes a batch of entries once, then pushes it to
+ *  every filter queue. The filters are only waited for when their ring
+ *  is full.
+ */
+static void* replay_reader(void* arg) {
+  const struct replay_init* init = (const struct replay_init*)arg;
+  struct replay_sample batch[REPLAY_BATCH_SIZE];
+  size_t i = init->first_entry;
+  int t = 10*(int)(1+log_entries[i].time*0.1);
+
+  while (i < nb_log_entries) {
+    unsigned int n = 0, k;
+    for (; i < nb_log_entries && n < REPLAY_BATCH_SIZE; i++) {
+      const struct raw_log_entry* e = &log_entries[i];
+      if ((e->time<68.48)||(e->time>68.51))
+        replay_decode(e, &batch[n++]);
+    }
+    if (n > 0 && batch[n-1].time > t) {
+      printf("%6.2fs %6u\n", batch[n-1].time, (unsigned int)i);
       t += 10;
     }
-    if ((e.time<68.48)||(e.time>68.51)){
-      print_estimator_state(e.time);
-      main_run_ins(e.message.valid_sensors);
-    } 
-    e = read_raw_log_entry(file_descriptor, &read_ok);
+    for (int j = 0; j < nb_filters; j++) {
+      struct replay_queue* q = filters[j].queue;
+      unsigned int head = q->head;
+      for (k = 0; k < n; k++) {
+        while (head - q->tail == REPLAY_QUEUE_SIZE)
+          sched_yield();
+        q->buf[head & REPLAY_QUEUE_MASK] = batch[k];
+        if (((k + 1) & 63) == 0 || k == n - 1) {
+          __sync_synchronize();
+          q->head = head + 1;
+        }
+        head++;
+      }
+    }
+  }
+  for (int j = 0; j < nb_filters; j++) {
+    __sync_synchronize();
+    filters[j].queue->done = 1;
   }
+  return NULL;
 }
 
-static void main_run_ins(uint8_t data_valid) {
-  
-  double dt_imu_freq = 0.001953125; //  1/512; // doesn't work?
-  ins.predict(RATES_AS_VECTOR3D(imu_float.gyro), VECT3_AS_VECTOR3D(imu_float.accel), dt_imu_freq);
-  
-  if(MAG_READY(data_valid)){
-		ins.obs_vector(reference_direction, VECT3_AS_VECTOR3D(imu_float.mag), magnetometer_noise.norm());
-	}
-  
-  #if UPDATE_WITH_GRAVITY
-  if(CLOSE_TO_GRAVITY(imu_float.accel)){
-		// use the gravity as reference
-		ins.obs_vector(ins.avg_state.position.normalized(), VECT3_AS_VECTOR3D(imu_float.accel), accelerometer_noise.norm());
-	}
-  #endif /* UPDATE_WITH_GRAVITY */
-  
-   if(BARO_READY(data_valid)){
-    ins.obs_baro_report(baro_0_height+imu_baro_height, baro_noise);
-  }   // comment out multiple lines */
-  
-  if(GPS_READY(data_valid)){
-		ins.obs_gps_pv_report(VECT3_AS_VECTOR3D(imu_ecef_pos)/100, VECT3_AS_VECTOR3D(imu_ecef_vel)/100, 10*gps_pos_noise, 10*gps_speed_noise);
-	}   // comment out multiple lines */
+
+static void* replay_filter_run(void* arg) {
+  struct replay_filter* f = (struct replay_filter*)arg;
+  struct replay_queue* q = f->queue;
+
+  for (;;) {
+    unsigned int tail = q->tail;
+    unsigned int head = q->head;
+    if (tail == head) {
+      if (q->done) {
+        __sync_synchronize();
+        if (q->head == tail)
+          break;
+      }
+      sched_yield();
+      continue;
+    }
+    __sync_synchronize();
+    for (; tail != head; tail++) {
+      const struct replay_sample* s = &q->buf[tail & REPLAY_QUEUE_MASK];
+      replay_output_state(f, s->time);
+      replay_filter_step(f, s);
+      f->nb_steps++;
+      if ((tail & 63) == 63) {
+        __sync_synchronize();
+        q->tail = tail + 1;
+      }
+    }
+    __sync_synchronize();
+    q->tail = tail;
+  }
+  return NULL;
 }
 
 
+static void replay_filter_step(struct replay_filter* f, const struct replay_sample* s) {
+  basic_ins_qkf& ins = *f->ins;
+  const struct replay_params* p = &f->params;
+  uint8_t data_valid = s->valid_sensors;
 
+  double dt_imu_freq = 0.001953125; //  1/512; // doesn't work?
+  ins.predict(RATES_AS_VECTOR3D(s->gyro), VECT3_AS_VECTOR3D(s->accel), dt_imu_freq);
 
-static void init_ins_state(void){
-	
-	ins_logfile = fopen(INS_LOG_FILE, "w");
-	
-	ins.avg_state.gyro_bias   = bias_0;
-	ins.avg_state.orientation = orientation_0;
-	ins.avg_state.position    = pos_0_ecef;
-	ins.avg_state.velocity    = speed_0_ecef;
-  
-  struct DoubleQuat ecef2body;
-  struct DoubleEulers eu_ecef2body;
-  QUATERNIOND_AS_DOUBLEQUAT(ecef2body, orientation_0);
-  DOUBLE_EULERS_OF_QUAT(eu_ecef2body, ecef2body);
+  if(MAG_READY(data_valid)){
+    ins.obs_vector(reference_direction, VECT3_AS_VECTOR3D(s->mag), p->magnetometer_noise.norm());
+  }
 
-  
-	printf("Initial state\n\n");
-  printf("Bias        % 6.1f°/s       +-%7.2f°/s\n", bias_0(0)*180*M_1_PI, bias_cov_0(0)*180*M_1_PI);
-  printf("Bias        % 6.1f°/s       +-%7.2f°/s\n", bias_0(1)*180*M_1_PI, bias_cov_0(1)*180*M_1_PI);
-  printf("Bias        % 6.1f°/s       +-%7.2f°/s\n", bias_0(2)*180*M_1_PI, bias_cov_0(2)*180*M_1_PI);
-  printf("\n");
-  printf("Orientation % 7.2f\n", orientation_0.w());
-  printf("Orientation % 7.2f %6.1f° +-%6.1f°\n", orientation_0.x(),   eu_ecef2body.phi*180*M_1_PI, orientation_cov_0(0)*180*M_1_PI);
-  printf("Orientation % 7.2f %6.1f° +-%6.1f°\n", orientation_0.y(), eu_ecef2body.theta*180*M_1_PI, orientation_cov_0(1)*180*M_1_PI);
-  printf("Orientation % 7.2f %6.1f° +-%6.1f°\n", orientation_0.z(),   eu_ecef2body.psi*180*M_1_PI, orientation_cov_0(2)*180*M_1_PI); 
-  printf("\n");
-  printf("Position    % 9.0f m     +-%7.2f\n", pos_0_ecef(0), pos_cov_0(0));
-  printf("Position    % 9.0f m     +-%7.2f\n", pos_0_ecef(1), pos_cov_0(1));
-  printf("Position    % 9.0f m     +-%7.2f\n", pos_0_ecef(2), pos_cov_0(2));
-  printf("\n");
-  printf("Velocity    % 7.2f m/s     +-%7.2f\n", speed_0_ecef(0), speed_cov_0(0));
-  printf("Velocity    % 7.2f m/s     +-%7.2f\n", speed_0_ecef(1), speed_cov_0(1));
-  printf("Velocity    % 7.2f m/s     +-%7.2f\n", speed_0_ecef(2), speed_cov_0(2));
-  printf("\n");
-	
-	Matrix<double, 12, 1> diag_cov;
-  
-	/*diag_cov << Vector3d::Ones() * bias_cov_0  * bias_cov_0 ,
-            //Vector3d::Ones() *  M_PI*0.5   *  M_PI*0.5  ,
-              Vector3d::Ones() *  angle_cov  *  angle_cov ,
-							Vector3d::Ones() *  pos_cov_0  *  pos_cov_0 ,
-							Vector3d::Ones() * speed_cov_0 * speed_cov_0;*/
-  diag_cov << gyro_stability_noise,
-              orientation_cov_0,
-							pos_cov_0,
-							speed_cov_0;
-	ins.cov = (diag_cov.cwise()*diag_cov).asDiagonal();
-	
+  #if UPDATE_WITH_GRAVITY
+  if(CLOSE_TO_GRAVITY(s->accel)){
+    // use the gravity as reference
+    ins.obs_vector(ins.avg_state.position.normalized(), VECT3_AS_VECTOR3D(s->accel), p->accelerometer_noise.norm());
+  }
+  #endif /* UPDATE_WITH_GRAVITY */
+
+  if(BARO_READY(data_valid)){
+    ins.obs_baro_report(baro_0_height+s->baro_height, p->baro_noise);
+  }
+
+  if(GPS_READY(data_valid)){
+    ins.obs_gps_pv_report(VECT3_AS_VECTOR3D(s->ecef_pos)/100, VECT3_AS_VECTOR3D(s->ecef_vel)/100, 10*p->gps_pos_noise, 10*p->gps_speed_noise);
+  }
 }
 
+
 static void set_reference_direction(void){
 	struct NedCoor_d	ref_dir_ned;
 	struct EcefCoor_d pos_0_ecef_pprz,
@@ -364,122 +544,71 @@ struct DoubleEulers sigma_euler_from_sigma_q(struct DoubleQuat q, struct DoubleQ
 
 /** Logging **/
 
-static struct raw_log_entry read_raw_log_entry(int file_descriptor, uint8_t *read_ok){
-  struct raw_log_entry e;
-  ssize_t nb_read = read(file_descriptor, &e, sizeof(e));
-  *read_ok =  (nb_read == sizeof(e));
-  entry_counter ++;
-  
-  COPY_BARO_TO_IMU(e.message);
-  COPY_RATES_ACCEL_TO_IMU_FLOAT(e.message);
-  COPY_MAG_TO_IMU_FLOAT(e.message);
-  COPY_GPS_TO_IMU(e.message);
-  return e;
-}
-
-static struct raw_log_entry next_GPS(int file_descriptor){
-  uint8_t read_ok;
-  struct raw_log_entry e = read_raw_log_entry(file_descriptor, &read_ok);
-  while ((read_ok)&&(!GPS_READY(e.message.valid_sensors))) {
-    e = read_raw_log_entry(file_descriptor, &read_ok);
-  }
-  return e;
-}
-
-static void print_estimator_state(double time) {
+static void replay_output_state(struct replay_filter* f, double time) {
+  const basic_ins_qkf& ins = *f->ins;
+  struct replay_output o;
+  int i;
 
+  o.time = time;
 #if FILTER_OUTPUT_IN_NED
-	
-	struct EcefCoor_d pos_ecef,
-										cur_pos_ecef,
-										cur_vel_ecef;
-	struct NedCoor_d	pos_ned,
-										vel_ned;
-										
-	struct DoubleQuat q_ecef2body,
-										q_ecef2enu,
-										q_enu2body,
-										q_ned2enu,
-										q_ned2body;
-										
-	VECTOR_AS_VECT3(pos_ecef,pos_0_ecef);
-	VECTOR_AS_VECT3(cur_pos_ecef,ins.avg_state.position);
-	VECTOR_AS_VECT3(cur_vel_ecef,ins.avg_state.velocity);
-	
-	ned_of_ecef_point_d(&pos_ned, &current_ltp, &cur_pos_ecef);
-	ned_of_ecef_vect_d(&vel_ned, &current_ltp, &cur_vel_ecef);
-	
-  int32_t xdd = 0;
-  int32_t ydd = 0;
-  int32_t zdd = 0;
-  
-  int32_t xd = vel_ned.x/0.0000019073;
-  int32_t yd = vel_ned.y/0.0000019073;
-  int32_t zd = vel_ned.z/0.0000019073;
-  
-  int32_t x = pos_ned.x/0.0039;
-  int32_t y = pos_ned.y/0.0039;
-  int32_t z = pos_ned.z/0.0039;
-
-  fprintf(ins_logfile, "%f %d BOOZ2_INS2 %d %d %d %d %d %d %d %d %d\n", time, AC_ID, xdd, ydd, zdd, xd, yd, zd, x, y, z);
-  #if 0
-  QUAT_ASSIGN(q_ecef2body, ins.avg_state.orientation.w(), -ins.avg_state.orientation.x(),
-	         -ins.avg_state.orientation.y(), -ins.avg_state.orientation.z());
-  QUAT_ASSIGN(q_ned2enu, 0, M_SQRT1_2, M_SQRT1_2, 0);
-  
-  FLOAT_QUAT_OF_RMAT(q_ecef2enu, current_ltp.ltp_of_ecef);
-	FLOAT_QUAT_INV_COMP(q_enu2body, q_ecef2enu, q_ecef2body);		// q_enu2body = q_ecef2body * (q_ecef2enu)^*
-  FLOAT_QUAT_COMP(q_ned2body, q_ned2enu, q_enu2body);					// q_ned2body = q_enu2body * q_ned2enu
+  struct EcefCoor_d cur_pos_ecef,
+                    cur_vel_ecef;
+  struct NedCoor_d  pos_ned,
+                    vel_ned;
+  struct DoubleQuat q_ecef2body,
+                    q_ecef2enu,
+                    q_enu2body,
+                    q_ned2body;
+
+  VECTOR_AS_VECT3(cur_pos_ecef,ins.avg_state.position);
+  VECTOR_AS_VECT3(cur_vel_ecef,ins.avg_state.velocity);
+  ned_of_ecef_point_d(&pos_ned, &current_ltp, &cur_pos_ecef);
+  ned_of_ecef_vect_d(&vel_ned, &current_ltp, &cur_vel_ecef);
+  VECT3_ASSIGN_ARRAY(o.pos, pos_ned);
+  VECT3_ASSIGN_ARRAY(o.vel, vel_ned);
 
-  #else /* if 0 */
   QUATERNIOND_AS_DOUBLEQUAT(q_ecef2body, ins.avg_state.orientation);
   DOUBLE_QUAT_OF_RMAT(q_ecef2enu, current_ltp.ltp_of_ecef);
   FLOAT_QUAT_INV_COMP(q_enu2body, q_ecef2enu, q_ecef2body);
   QUAT_ENU_FROM_TO_NED(q_enu2body, q_ned2body);
-  
-  #endif /* if 0 */
-  
+
   struct FloatEulers e;
   FLOAT_EULERS_OF_QUAT(e, q_ned2body);
-  
-  
-	#if PRINT_EULER_NED
-		printf("EULER % 6.1f % 6.1f % 6.1f\n", e.phi*180*M_1_PI, e.theta*180*M_1_PI, e.psi*180*M_1_PI);
-	#endif /* PRINT_EULER_NED */
-  fprintf(ins_logfile, "%f %d AHRS_EULER %f %f %f\n", time, AC_ID, e.phi, e.theta, e.psi);
-  fprintf(ins_logfile, "%f %d DEBUG_COVARIANCE %f %f %f %f %f %f %f %f %f %f %f %f\n", time, AC_ID,
-				sqrt(ins.cov( 0, 0)),  sqrt(ins.cov( 1, 1)),  sqrt(ins.cov( 2, 2)), 
-				sqrt(ins.cov( 3, 3)),  sqrt(ins.cov( 4, 4)),  sqrt(ins.cov( 5, 5)), 
-				sqrt(ins.cov( 6, 6)),  sqrt(ins.cov( 7, 7)),  sqrt(ins.cov( 8, 8)), 
-				sqrt(ins.cov( 9, 9)),  sqrt(ins.cov(10,10)),  sqrt(ins.cov(11,11)));
-  fprintf(ins_logfile, "%f %d BOOZ_SIM_GYRO_BIAS %f %f %f\n", time, AC_ID, ins.avg_state.gyro_bias(0), ins.avg_state.gyro_bias(1), ins.avg_state.gyro_bias(2));
-
+  #if PRINT_EULER_NED
+  printf("EULER % 6.1f % 6.1f % 6.1f\n", e.phi*180*M_1_PI, e.theta*180*M_1_PI, e.psi*180*M_1_PI);
+  #endif /* PRINT_EULER_NED */
 #else /* FILTER_OUTPUT_IN_ECEF */
-  int32_t xdd = 0;
-  int32_t ydd = 0;
-  int32_t zdd = 0;
-
-  int32_t xd = ins.avg_state.velocity(0)/0.0000019073;
-  int32_t yd = ins.avg_state.velocity(1)/0.0000019073;
-  int32_t zd = ins.avg_state.velocity(2)/0.0000019073;
-  int32_t x = ins.avg_state.position(0)/0.0039;
-  int32_t y = ins.avg_state.position(1)/0.0039;
-  int32_t z = ins.avg_state.position(2)/0.0039;
-
-  fprintf(ins_logfile, "%f %d BOOZ2_INS2 %d %d %d %d %d %d %d %d %d\n", time, AC_ID, xdd, ydd, zdd, xd, yd, zd, x, y, z);
-  
+  for (i = 0; i < 3; i++) {
+    o.pos[i] = ins.avg_state.position(i);
+    o.vel[i] = ins.avg_state.velocity(i);
+  }
   struct FloatQuat q_ecef2body;
   QUAT_ASSIGN(q_ecef2body, ins.avg_state.orientation.w(), ins.avg_state.orientation.x(),
-	         ins.avg_state.orientation.y(), ins.avg_state.orientation.z());
-  struct FloatEulers e_ecef2body;
-  FLOAT_EULERS_OF_QUAT(e_ecef2body, q_ecef2body);
-
-  fprintf(ins_logfile, "%f %d AHRS_EULER %f %f %f\n", time, AC_ID, e_ecef2body.phi, e_ecef2body.theta, e_ecef2body.psi);
-  fprintf(ins_logfile, "%f %d DEBUG_COVARIANCE %f %f %f %f %f %f %f %f %f %f %f %f\n", time, AC_ID,
-				sqrt(ins.cov( 0, 0)),  sqrt(ins.cov( 1, 1)),  sqrt(ins.cov( 2, 2)), 
-				sqrt(ins.cov( 3, 3)),  sqrt(ins.cov( 4, 4)),  sqrt(ins.cov( 5, 5)), 
-				sqrt(ins.cov( 6, 6)),  sqrt(ins.cov( 7, 7)),  sqrt(ins.cov( 8, 8)), 
-				sqrt(ins.cov( 9, 9)),  sqrt(ins.cov(10,10)),  sqrt(ins.cov(11,11)));
-  fprintf(ins_logfile, "%f %d BOOZ_SIM_GYRO_BIAS %f %f %f\n", time, AC_ID, ins.avg_state.gyro_bias(0), ins.avg_state.gyro_bias(1), ins.avg_state.gyro_bias(2));
+              ins.avg_state.orientation.y(), ins.avg_state.orientation.z());
+  struct FloatEulers e;
+  FLOAT_EULERS_OF_QUAT(e, q_ecef2body);
 #endif /* FILTER_OUTPUT_IN_NED / ECEF */
+  o.eulers[0] = e.phi;
+  o.eulers[1] = e.theta;
+  o.eulers[2] = e.psi;
+  for (i = 0; i < 3; i++)
+    o.gyro_bias[i] = ins.avg_state.gyro_bias(i);
+  Matrix<double, 12, 12> cov = ins.covariance();
+  for (i = 0; i < 12; i++)
+    o.sigma[i] = sqrt(cov(i, i));
+
+  if (!f->ascii) {
+    fwrite(&o, sizeof(o), 1, f->out);
+    return;
+  }
+
+  /* the .data format of the former version, readable by the plotter */
+  fprintf(f->out, "%f %d BOOZ2_INS2 %d %d %d %d %d %d %d %d %d\n", time, AC_ID, 0, 0, 0,
+          (int32_t)(o.vel[0]/0.0000019073), (int32_t)(o.vel[1]/0.0000019073), (int32_t)(o.vel[2]/0.0000019073),
+          (int32_t)(o.pos[0]/0.0039), (int32_t)(o.pos[1]/0.0039), (int32_t)(o.pos[2]/0.0039));
+  fprintf(f->out, "%f %d AHRS_EULER %f %f %f\n", time, AC_ID, o.eulers[0], o.eulers[1], o.eulers[2]);
+  fprintf(f->out, "%f %d DEBUG_COVARIANCE %f %f %f %f %f %f %f %f %f %f %f %f\n", time, AC_ID,
+          o.sigma[0], o.sigma[1], o.sigma[2], o.sigma[3], o.sigma[4],  o.sigma[5],
+          o.sigma[6], o.sigma[7], o.sigma[8], o.sigma[9], o.sigma[10], o.sigma[11]);
+  fprintf(f->out, "%f %d BOOZ_SIM_GYRO_BIAS %f %f %f\n", time, AC_ID, o.gyro_bias[0], o.gyro_bias[1], o.gyro_bias[2]);
 }
@@ -31,11 +31,9 @@
 #include "subsystems/imu.h"
 #include "fms/fms_autopilot_msg.h"
 #include "fms/libeknav/raw_log.h"
-  /* our sensors            */
-  struct ImuFloat imu_float;
-  double imu_baro_height;
-  struct EcefCoor_i imu_ecef_pos,
-										imu_ecef_vel;
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
 
 
 
@@ -62,10 +60,6 @@ static void set_reference_direction(void);
 #define GRAVITY 9.81
 #define MAX_DISTANCE_FROM_GRAVITY_FOR_UPDATE 0.03
 
-/* Initialisation */
-static void main_init(void);
-static struct raw_log_entry first_entry_after_initialisation(int);
-
 /** initial state **/
 struct LlaCoor_f pos_0_lla;
 double baro_0_height      = 0;
@@ -73,7 +67,6 @@ Vector3d pos_0_ecef       = Vector3d::Zero();
 Vector3d speed_0_ecef     = Vector3d::Zero();
 Vector3d bias_0           = Vector3d::Zero();
 Quaterniond orientation_0 = Quaterniond::Identity();
-static void init_ins_state(void);
 
 /** initial covariance **/
 //  const double orientation_cov_0 =  RadOfDeg(5.)*RadOfDeg(5.);
@@ -114,18 +107,87 @@ const double baro_noise             =  0.25;
 //const Vector3d accel_white_noise    (  2.3707*2.3707e-4,    2.4575*2.4575e-4,    2.5139*2.5139e-4);
 
 
-/* libeknav */
-static void main_run_from_file(int, struct raw_log_entry);
-static void main_run_ins(uint8_t);
-
-
-/* Logging */
-static struct raw_log_entry read_raw_log_entry(int, uint8_t *);
-static struct raw_log_entry next_GPS(int);
+/* Replay */
+
+/** A set of filter parameters, the defaults are the constants above.
+ *  Several sets can be given in a file, one set per line:
+ *  gyroscope_noise(3) gyro_stability_noise(3) accelerometer_noise(3)
+ *  magnetometer_noise(3) gps_pos_noise(3) gps_speed_noise(3) baro_noise
+ */
+struct replay_params {
+  Vector3d gyroscope_noise;
+  Vector3d gyro_stability_noise;
+  Vector3d accelerometer_noise;
+  Vector3d magnetometer_noise;
+  Vector3d gps_pos_noise;
+  Vector3d gps_speed_noise;
+  double baro_noise;
+};
+
+/** A log entry converted to float units, as decoded by the reader thread */
+struct replay_sample {
+  double time;
+  uint8_t valid_sensors;
+  struct DoubleRates gyro;
+  struct DoubleVect3 accel;
+  struct DoubleVect3 mag;
+  double baro_height;
+  struct EcefCoor_i ecef_pos;
+  struct EcefCoor_i ecef_vel;
+};
+
+/** Single producer single consumer ring between the reader and one filter.
+ *  head is only written by the reader, tail only by the filter. */
+#define REPLAY_QUEUE_SIZE  4096
+#define REPLAY_QUEUE_MASK  (REPLAY_QUEUE_SIZE-1)
+#define REPLAY_BATCH_SIZE  256
+
+struct replay_queue {
+  struct replay_sample buf[REPLAY_QUEUE_SIZE];
+  volatile unsigned int head __attribute__ ((aligned(64)));
+  volatile unsigned int tail __attribute__ ((aligned(64)));
+  volatile int done;
+};
+
+/** Filter output, one record per replayed entry */
+struct __attribute__ ((packed)) replay_output {
+  float time;
+  float pos[3];          ///< NED (or ECEF) position, m
+  float vel[3];          ///< NED (or ECEF) velocity, m/s
+  float eulers[3];       ///< phi theta psi, rad
+  float gyro_bias[3];    ///< rad/s
+  float sigma[12];       ///< square root of the covariance diagonal
+};
+
+struct replay_filter {
+  struct replay_params params;
+  basic_ins_qkf* ins;
+  struct replay_queue* queue;
+  FILE* out;
+  int ascii;
+  unsigned int nb_steps;
+  pthread_t thread;
+};
+
+/** Results of the initial averaging, common to all parameter sets */
+struct replay_init {
+  struct DoubleMat33 attitude_profile_matrix;
+  struct Orientation_Measurement gravity, magneto;
+  int imu_measurements, magnetometer_measurements, gps_measurements;
+  size_t first_entry;
+};
+
+static void replay_decode(const struct raw_log_entry*, struct replay_sample*);
+static size_t replay_initial_averages(const struct raw_log_entry*, size_t, struct replay_init*);
+static void replay_init_filter(struct replay_filter*, const struct replay_init*);
+static void* replay_reader(void*);
+static void* replay_filter_run(void*);
+static void replay_filter_step(struct replay_filter*, const struct replay_sample*);
+static void replay_output_state(struct replay_filter*, double);
+static int replay_read_params(const char*, struct replay_params**);
 
-static void print_estimator_state(double);
 #define AC_ID 210
-#define INS_LOG_FILE "log_ins_test3.data"
+#define INS_LOG_FILE "log_ins_test3"
 
 
 
@@ -151,16 +213,6 @@ static void print_estimator_state(double);
 #define INT32_BARO_FRAC 8
 #define BARO_FLOAT_OF_BFP(_ai) (FLOAT_OF_BFP((_ai), INT32_BARO_FRAC)*BARO_SCALING)
 
-#define COPY_RATES_ACCEL_TO_IMU_FLOAT(pointer){						\
-  RATES_FLOAT_OF_BFP(imu_float.gyro, pointer.gyro);			\
-  ACCELS_FLOAT_OF_BFP(imu_float.accel, pointer.accel); 	\
-}
-#define COPY_MAG_TO_IMU_FLOAT(pointer) MAGS_FLOAT_OF_BFP(imu_float.mag, pointer.mag)
-#define COPY_BARO_TO_IMU(pointer) imu_baro_height = -BARO_FLOAT_OF_BFP(pointer.pressure_absolute)
-#define COPY_GPS_TO_IMU(pointer){													\
-  VECT3_COPY(imu_ecef_pos, pointer.ecef_pos);						\
-  VECT3_COPY(imu_ecef_vel, pointer.ecef_vel);						\
-}
 
 
 #define IMU_READY(data_valid) (data_valid & (1<<VI_IMU_DATA_VALID))
@@ -168,6 +220,8 @@ static void print_estimator_state(double);
 #define BARO_READY(data_valid) (data_valid & (1<<VI_BARO_ABS_DATA_VALID))
 #define GPS_READY(data_valid) (data_valid & (1<<VI_GPS_DATA_VALID))
 
+#define VECT3_ASSIGN_ARRAY(_a, _v) { (_a)[0] = (_v).x; (_a)[1] = (_v).y; (_a)[2] = (_v).z; }
+
 #define CLOSE_TO_GRAVITY(accel) (ABS(FLOAT_VECT3_NORM(accel)-GRAVITY)<MAX_DISTANCE_FROM_GRAVITY_FOR_UPDATE)
 
 	/** Conversions	**/
@@ -0,0 +1,113 @@
+/*
+ * test_libeknav_5.cpp
+ *
+ * Benchmark of the covariance representations of basic_ins_qkf:
+ * a hovering vehicle is simulated at the IMU rate with magnetometer,
+ * gravity and GPS updates. The time spent in predict() and in the
+ * observations is reported, with the state of the covariance at the end.
+ *
+ * Build it twice, with -DINS_QKF_SQRT_COV=0 (dense) and
+ * -DINS_QKF_SQRT_COV=1 (square root), see the Makefile.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include <Eigen/Core>
+#include "ins_qkf.hpp"
+
+using namespace Eigen;
+
+#define IMU_FREQ 512
+#define MAG_DIV   40
+#define GPS_DIV  128
+#define DURATION 600
+
+static double gaussian(void) {
+  double u1 = (rand() + 1.) / (RAND_MAX + 2.);
+  double u2 = (rand() + 1.) / (RAND_MAX + 2.);
+  return sqrt(-2. * log(u1)) * cos(2. * M_PI * u2);
+}
+
+static Vector3d noise3(double sigma) {
+  return Vector3d(gaussian(), gaussian(), gaussian()) * sigma;
+}
+
+static double elapsed(const struct timespec* t0, const struct timespec* t1) {
+  return (t1->tv_sec - t0->tv_sec) + 1e-9 * (t1->tv_nsec - t0->tv_nsec);
+}
+
+int main(int, char *[]) {
+  const Vector3d pos(4627578.56, 119659.25, 4373248.00);
+  const Vector3d up = pos.normalized();
+  const Vector3d mag_ref = Vector3d(0.5, -0.05, 0.85).normalized();
+  const Vector3d gyro_noise(1e-2, 1e-2, 1e-2);
+  const Vector3d gyro_stability(1e-6, 1e-6, 1e-6);
+  const Vector3d accel_noise(0.25, 0.25, 0.25);
+
+  basic_ins_qkf ins(pos, 10, 0.1, 1, gyro_noise, gyro_stability, accel_noise);
+
+  struct timespec t0, t1;
+  double t_predict = 0, t_obs = 0;
+  unsigned int nb_obs = 0;
+  const double dt = 1. / IMU_FREQ;
+
+  srand(1);
+  for (unsigned int i = 0; i < DURATION * IMU_FREQ; i++) {
+    const Vector3d gyro = noise3(0.1);
+    const Vector3d accel = up * 9.81 + noise3(0.5);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    ins.predict(gyro, accel, dt);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    t_predict += elapsed(&t0, &t1);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (i % MAG_DIV == 0) {
+      ins.obs_vector(mag_ref, mag_ref + noise3(0.01), 1e-4);
+      nb_obs++;
+    }
+    if (i % GPS_DIV == 0) {
+      ins.obs_gps_pv_report(pos + noise3(2.), noise3(0.2), Vector3d::Ones() * 4., Vector3d::Ones() * 0.04);
+      ins.obs_baro_report(pos.norm() + gaussian(), 1.);
+      nb_obs++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    t_obs += elapsed(&t0, &t1);
+  }
+
+  const Matrix<double, 12, 12> cov = ins.covariance();
+  double asymmetry = 0, min_pivot = 1e300;
+  for (int i = 0; i < 12; i++)
+    for (int j = 0; j < i; j++)
+      asymmetry = std::max(asymmetry, fabs(cov(i, j) - cov(j, i)));
+  // smallest pivot of the Cholesky decomposition, <= 0 if not positive definite
+  Matrix<double, 12, 12> L = Matrix<double, 12, 12>::Zero();
+  for (int j = 0; j < 12; j++) {
+    double d = cov(j, j);
+    for (int k = 0; k < j; k++)
+      d -= L(j, k) * L(j, k);
+    min_pivot = std::min(min_pivot, d);
+    if (d <= 0)
+      break;
+    L(j, j) = sqrt(d);
+    for (int i = j + 1; i < 12; i++) {
+      double a = cov(i, j);
+      for (int k = 0; k < j; k++)
+        a -= L(i, k) * L(j, k);
+      L(i, j) = a / L(j, j);
+    }
+  }
+
+  printf("covariance: %s\n", INS_QKF_SQRT_COV ? "square root" : "dense");
+  printf("predict: %8.3f us/call\n", 1e6 * t_predict / (DURATION * IMU_FREQ));
+  printf("observe: %8.3f us/call\n", 1e6 * t_obs / nb_obs);
+  printf("sigma:");
+  for (int i = 0; i < 12; i++)
+    printf(" %.3g", sqrt(fabs(cov(i, i))));
+  printf("\nasymmetry %.3g, min Cholesky pivot %.3g\n", asymmetry, min_pivot);
+  printf("position error %.3f m\n", (ins.avg_state.position - pos).norm());
+  return ins.is_real() && min_pivot > 0 ? 0 : 1;
+}
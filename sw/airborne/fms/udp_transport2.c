@@ -63,7 +63,7 @@ static void end_message(void *impl)
 
 static void overrun(void *impl __attribute__((unused)))
 {
-
+  downlink_nb_ovrn++;
 }
 
 static void count_bytes(void *udp __attribute__((unused)), uint8_t bytes __attribute__((unused)))
@@ -16,6 +16,9 @@
 
 struct DownlinkTransport *udp_transport_new(struct FmsNetwork *network);
 
+/** Counter of messages not sent (downlink.c), read by the rate feedback of PeriodicSend */
+extern uint8_t downlink_nb_ovrn;
+
 #define UDPT_TX_BUF_LEN 1496
 #define UDPT_TX_BUF_WATERMARK 1024
 #define UDP_DL_PAYLOAD_LEN 256
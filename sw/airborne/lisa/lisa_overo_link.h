@@ -100,6 +100,10 @@ extern uint8_t overo_link_telemetry_buf[OVERO_LINK_TELEMETRY_BUF_SIZE];
       overo_link_telemetry_insert_idx = temp;				\
     }									\
   }
+#define OveroLinkTelemetryTransmitBuffer(_b, _l) {			\
+    uint16_t _i;							\
+    for (_i = 0; _i < (_l); _i++) OveroLinkTelemetryTransmit((_b)[_i]); \
+  }
 #define OveroLinkTelemetrySendMessage() {}
 
 extern uint8_t overo_link_telemetry_get(char* buf, int len);
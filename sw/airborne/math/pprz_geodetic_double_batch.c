@@ -0,0 +1,159 @@
+#include "pprz_geodetic_double_batch.h"
+
+#include <math.h>
+
+/* FIXME : make an ellipsoid struct */
+#define GEO_A    6378137.0                      /* earth semimajor axis in meters */
+#define GEO_F    (1./298.257223563)             /* reciprocal flattening          */
+#define GEO_B    (GEO_A*(1.-GEO_F))             /* semi-minor axis                */
+#define GEO_E2   (2.*GEO_F-GEO_F*GEO_F)         /* first eccentricity squared     */
+#define GEO_EP2  (GEO_F*(2.-GEO_F)/((1.-GEO_F)*(1.-GEO_F))) /* second eccentricity squared */
+
+/*
+ * The kernels take restrict pointers to separate arrays: read through
+ * the array structs or through def, the compiler would have to assume
+ * aliasing between inputs and outputs and would not vectorize.
+ */
+
+/*
+ * Bowring's method with one iteration, closed form and branchless, so the
+ * first loop vectorizes. Within 1e-11 rad and 0.1 mm of lla_of_ecef_d
+ * between -10km and 100km of altitude.
+ * atan2 has no vector version in most libm: the tangents are stored in the
+ * output arrays and the angles computed by a second, scalar, loop.
+ */
+static void lla_of_ecef_kernel(double* restrict lat, double* restrict lon, double* restrict alt,
+                               const double* restrict x, const double* restrict y,
+                               const double* restrict z, uint32_t n) {
+  uint32_t i;
+
+  for (i = 0; i < n; i++) {
+    const double p = sqrt(x[i]*x[i] + y[i]*y[i]);
+    /* parametric latitude */
+    const double pb = p * GEO_B;
+    const double za = z[i] * GEO_A;
+    const double r = sqrt(pb*pb + za*za);
+    const double su = za / r;
+    const double cu = pb / r;
+    /* geodetic latitude */
+    const double num = z[i] + GEO_EP2 * GEO_B * su*su*su;
+    const double den = p - GEO_E2 * GEO_A * cu*cu*cu;
+    const double h = sqrt(num*num + den*den);
+    const double sin_lat = num / h;
+    const double cos_lat = den / h;
+    alt[i] = p * cos_lat + z[i] * sin_lat - GEO_A * sqrt(1. - GEO_E2 * sin_lat*sin_lat);
+    lat[i] = num;
+    lon[i] = den;
+  }
+
+  for (i = 0; i < n; i++) {
+    lat[i] = atan2(lat[i], lon[i]);
+    lon[i] = atan2(y[i], x[i]);
+  }
+}
+
+/*
+ * ecef_of_lla, followed by out = r * (ecef - pre).
+ * Only vectorized with a libm providing vector sin/cos (glibc with
+ * -ffast-math).
+ */
+static void ltp_of_lla_kernel(double* restrict o0, double* restrict o1, double* restrict o2,
+                              const double* r, const double* pre,
+                              const double* restrict lat, const double* restrict lon,
+                              const double* restrict alt, uint32_t n) {
+  const double r0 = r[0], r1 = r[1], r2 = r[2];
+  const double r3 = r[3], r4 = r[4], r5 = r[5];
+  const double r6 = r[6], r7 = r[7], r8 = r[8];
+  const double p0 = pre[0], p1 = pre[1], p2 = pre[2];
+  uint32_t i;
+
+  for (i = 0; i < n; i++) {
+    const double sin_lat = sin(lat[i]);
+    const double cos_lat = cos(lat[i]);
+    const double sin_lon = sin(lon[i]);
+    const double cos_lon = cos(lon[i]);
+    const double a_chi = GEO_A / sqrt(1. - GEO_E2*sin_lat*sin_lat);
+    const double x = (a_chi + alt[i]) * cos_lat * cos_lon - p0;
+    const double y = (a_chi + alt[i]) * cos_lat * sin_lon - p1;
+    const double z = (a_chi*(1. - GEO_E2) + alt[i]) * sin_lat - p2;
+    o0[i] = r0*x + r1*y + r2*z;
+    o1[i] = r3*x + r4*y + r5*z;
+    o2[i] = r6*x + r7*y + r8*z;
+  }
+}
+
+/* out = r * (in - pre) + post */
+static void affine_kernel(double* restrict o0, double* restrict o1, double* restrict o2,
+                          const double* r, const double* pre, const double* post,
+                          const double* restrict i0, const double* restrict i1,
+                          const double* restrict i2, uint32_t n) {
+  const double r0 = r[0], r1 = r[1], r2 = r[2];
+  const double r3 = r[3], r4 = r[4], r5 = r[5];
+  const double r6 = r[6], r7 = r[7], r8 = r[8];
+  const double p0 = pre[0], p1 = pre[1], p2 = pre[2];
+  const double q0 = post[0], q1 = post[1], q2 = post[2];
+  uint32_t i;
+
+  for (i = 0; i < n; i++) {
+    const double x = i0[i] - p0;
+    const double y = i1[i] - p1;
+    const double z = i2[i] - p2;
+    o0[i] = r0*x + r1*y + r2*z + q0;
+    o1[i] = r3*x + r4*y + r5*z + q1;
+    o2[i] = r6*x + r7*y + r8*z + q2;
+  }
+}
+
+static const double zero[3] = { 0., 0., 0. };
+
+/* rotations from ECEF to ENU, NED and back, from ltp_of_ecef */
+#define LTP_ORIGIN(_def) const double origin[3] = { (_def)->ecef.x, (_def)->ecef.y, (_def)->ecef.z }
+#define ENU_OF_ECEF(_m) { _m[0],  _m[1],  _m[2],  _m[3],  _m[4],  _m[5],  _m[6],  _m[7],  _m[8] }
+#define NED_OF_ECEF(_m) { _m[3],  _m[4],  _m[5],  _m[0],  _m[1],  _m[2], -_m[6], -_m[7], -_m[8] }
+#define ECEF_OF_ENU(_m) { _m[0],  _m[3],  _m[6],  _m[1],  _m[4],  _m[7],  _m[2],  _m[5],  _m[8] }
+#define ECEF_OF_NED(_m) { _m[3],  _m[0], -_m[6],  _m[4],  _m[1], -_m[7],  _m[5],  _m[2], -_m[8] }
+
+void lla_of_ecef_array_d(struct LlaArray_d* lla, struct EcefArray_d* ecef, uint32_t n) {
+  lla_of_ecef_kernel(lla->lat, lla->lon, lla->alt, ecef->x, ecef->y, ecef->z, n);
+}
+
+void ecef_of_lla_array_d(struct EcefArray_d* ecef, struct LlaArray_d* lla, uint32_t n) {
+  static const double identity[9] = { 1., 0., 0., 0., 1., 0., 0., 0., 1. };
+  ltp_of_lla_kernel(ecef->x, ecef->y, ecef->z, identity, zero, lla->lat, lla->lon, lla->alt, n);
+}
+
+void enu_of_ecef_point_array_d(struct EnuArray_d* enu, struct LtpDef_d* def, struct EcefArray_d* ecef, uint32_t n) {
+  const double r[9] = ENU_OF_ECEF(def->ltp_of_ecef.m);
+  LTP_ORIGIN(def);
+  affine_kernel(enu->x, enu->y, enu->z, r, origin, zero, ecef->x, ecef->y, ecef->z, n);
+}
+
+void ned_of_ecef_point_array_d(struct NedArray_d* ned, struct LtpDef_d* def, struct EcefArray_d* ecef, uint32_t n) {
+  const double r[9] = NED_OF_ECEF(def->ltp_of_ecef.m);
+  LTP_ORIGIN(def);
+  affine_kernel(ned->x, ned->y, ned->z, r, origin, zero, ecef->x, ecef->y, ecef->z, n);
+}
+
+void ecef_of_enu_point_array_d(struct EcefArray_d* ecef, struct LtpDef_d* def, struct EnuArray_d* enu, uint32_t n) {
+  const double r[9] = ECEF_OF_ENU(def->ltp_of_ecef.m);
+  LTP_ORIGIN(def);
+  affine_kernel(ecef->x, ecef->y, ecef->z, r, zero, origin, enu->x, enu->y, enu->z, n);
+}
+
+void ecef_of_ned_point_array_d(struct EcefArray_d* ecef, struct LtpDef_d* def, struct NedArray_d* ned, uint32_t n) {
+  const double r[9] = ECEF_OF_NED(def->ltp_of_ecef.m);
+  LTP_ORIGIN(def);
+  affine_kernel(ecef->x, ecef->y, ecef->z, r, zero, origin, ned->x, ned->y, ned->z, n);
+}
+
+void enu_of_lla_point_array_d(struct EnuArray_d* enu, struct LtpDef_d* def, struct LlaArray_d* lla, uint32_t n) {
+  const double r[9] = ENU_OF_ECEF(def->ltp_of_ecef.m);
+  LTP_ORIGIN(def);
+  ltp_of_lla_kernel(enu->x, enu->y, enu->z, r, origin, lla->lat, lla->lon, lla->alt, n);
+}
+
+void ned_of_lla_point_array_d(struct NedArray_d* ned, struct LtpDef_d* def, struct LlaArray_d* lla, uint32_t n) {
+  const double r[9] = NED_OF_ECEF(def->ltp_of_ecef.m);
+  LTP_ORIGIN(def);
+  ltp_of_lla_kernel(ned->x, ned->y, ned->z, r, origin, lla->lat, lla->lon, lla->alt, n);
+}
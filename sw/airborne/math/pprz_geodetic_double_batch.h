@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * @file pprz_geodetic_double_batch.h
+ *   @brief Batch versions of the double precision geodetic conversions.
+ *
+ *   Points are given as structures of arrays (one array per coordinate)
+ *   and converted with a shared LtpDef_d, for ground tools converting
+ *   whole trajectories (log export, kml, survey planning).
+ *   The loops have no dependency between points and no aliasing between
+ *   input and output arrays, so that the compiler vectorizes them for the
+ *   target (SSE/AVX on x86, NEON on ARM) with -O3 or -ftree-vectorize.
+ *   -fno-math-errno is needed for the loops using sqrt.
+ *
+ *   Output and input arrays must not overlap.
+ */
+
+#ifndef PPRZ_GEODETIC_DOUBLE_BATCH_H
+#define PPRZ_GEODETIC_DOUBLE_BATCH_H
+
+#include "pprz_geodetic_double.h"
+
+/** arrays of ECEF coordinates, in meters */
+struct EcefArray_d {
+  double* x;
+  double* y;
+  double* z;
+};
+
+/** arrays of LLA coordinates, in radians and meters */
+struct LlaArray_d {
+  double* lon;
+  double* lat;
+  double* alt;
+};
+
+/** arrays of NED coordinates, in meters */
+struct NedArray_d {
+  double* x;
+  double* y;
+  double* z;
+};
+
+/** arrays of ENU coordinates, in meters */
+struct EnuArray_d {
+  double* x;
+  double* y;
+  double* z;
+};
+
+extern void lla_of_ecef_array_d(struct LlaArray_d* lla, struct EcefArray_d* ecef, uint32_t n);
+extern void ecef_of_lla_array_d(struct EcefArray_d* ecef, struct LlaArray_d* lla, uint32_t n);
+
+extern void enu_of_ecef_point_array_d(struct EnuArray_d* enu, struct LtpDef_d* def, struct EcefArray_d* ecef, uint32_t n);
+extern void ned_of_ecef_point_array_d(struct NedArray_d* ned, struct LtpDef_d* def, struct EcefArray_d* ecef, uint32_t n);
+
+extern void ecef_of_enu_point_array_d(struct EcefArray_d* ecef, struct LtpDef_d* def, struct EnuArray_d* enu, uint32_t n);
+extern void ecef_of_ned_point_array_d(struct EcefArray_d* ecef, struct LtpDef_d* def, struct NedArray_d* ned, uint32_t n);
+
+extern void enu_of_lla_point_array_d(struct EnuArray_d* enu, struct LtpDef_d* def, struct LlaArray_d* lla, uint32_t n);
+extern void ned_of_lla_point_array_d(struct NedArray_d* ned, struct LtpDef_d* def, struct LlaArray_d* lla, uint32_t n);
+
+#endif /* PPRZ_GEODETIC_DOUBLE_BATCH_H */
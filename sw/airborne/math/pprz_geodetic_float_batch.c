@@ -0,0 +1,110 @@
+#include "pprz_geodetic_float_batch.h"
+
+#include <math.h>
+
+#include "math/pprz_geodetic_utm.h"
+
+/*
+ * As in pprz_geodetic_double_batch.c, the kernels take restrict pointers
+ * to separate arrays so that the compiler can vectorize them. sin, cos
+ * and the other transcendental functions only vectorize with a libm
+ * providing vector versions (glibc with -ffast-math).
+ */
+
+/* ecef_of_lla_f, followed by out = r * (ecef - pre) */
+static void ltp_of_lla_kernel_f(float* restrict o0, float* restrict o1, float* restrict o2,
+                                const float* r, const float* pre,
+                                const float* restrict lat, const float* restrict lon,
+                                const float* restrict alt, uint32_t n) {
+  /* same constants as ecef_of_lla_f */
+  static const float a = 6378137.0;
+  static const float f = 1./298.257223563;
+  const float e2 = 2.*f-(f*f);
+  const float r0 = r[0], r1 = r[1], r2 = r[2];
+  const float r3 = r[3], r4 = r[4], r5 = r[5];
+  const float r6 = r[6], r7 = r[7], r8 = r[8];
+  const float p0 = pre[0], p1 = pre[1], p2 = pre[2];
+  uint32_t i;
+
+  for (i = 0; i < n; i++) {
+    const float sin_lat = sinf(lat[i]);
+    const float cos_lat = cosf(lat[i]);
+    const float sin_lon = sinf(lon[i]);
+    const float cos_lon = cosf(lon[i]);
+    const float a_chi = a / sqrtf(1. - e2*sin_lat*sin_lat);
+    const float x = (float)((a_chi + alt[i]) * cos_lat * cos_lon) - p0;
+    const float y = (float)((a_chi + alt[i]) * cos_lat * sin_lon) - p1;
+    const float z = (float)((a_chi*(1. - e2) + alt[i]) * sin_lat) - p2;
+    o0[i] = r0*x + r1*y + r2*z;
+    o1[i] = r3*x + r4*y + r5*z;
+    o2[i] = r6*x + r7*y + r8*z;
+  }
+}
+
+/* rotations from ECEF to ENU and NED, from ltp_of_ecef */
+#define LTP_ORIGIN(_def) const float origin[3] = { (_def)->ecef.x, (_def)->ecef.y, (_def)->ecef.z }
+#define ENU_OF_ECEF(_m) { _m[0],  _m[1],  _m[2],  _m[3],  _m[4],  _m[5],  _m[6],  _m[7],  _m[8] }
+#define NED_OF_ECEF(_m) { _m[3],  _m[4],  _m[5],  _m[0],  _m[1],  _m[2], -_m[6], -_m[7], -_m[8] }
+
+void enu_of_lla_point_array_f(struct EnuArray_f* enu, struct LtpDef_f* def, struct LlaArray_f* lla, uint32_t n) {
+  const float r[9] = ENU_OF_ECEF(def->ltp_of_ecef.m);
+  LTP_ORIGIN(def);
+  ltp_of_lla_kernel_f(enu->x, enu->y, enu->z, r, origin, lla->lat, lla->lon, lla->alt, n);
+}
+
+void ned_of_lla_point_array_f(struct NedArray_f* ned, struct LtpDef_f* def, struct LlaArray_f* lla, uint32_t n) {
+  const float r[9] = NED_OF_ECEF(def->ltp_of_ecef.m);
+  LTP_ORIGIN(def);
+  ltp_of_lla_kernel_f(ned->x, ned->y, ned->z, r, origin, lla->lat, lla->lon, lla->alt, n);
+}
+
+/*
+ * utm_of_lla_f on each point, with the series written out and the
+ * hyperbolic functions and multiple angles derived from one exp, sin and
+ * cos. Intermediate values are doubles as in utm_of_lla_f: in float the
+ * isometric latitudes alone lose a meter. The zone, hence the central
+ * meridian, is shared by all the points.
+ */
+static void utm_of_lla_kernel_f(float* restrict north, float* restrict east,
+                                const float* restrict lat, const float* restrict lon,
+                                double lambda_c, uint32_t n) {
+  const double c0 = serie_coeff_proj_mercator[0];
+  const double c1 = serie_coeff_proj_mercator[1];
+  const double c2 = serie_coeff_proj_mercator[2];
+  uint32_t i;
+
+  for (i = 0; i < n; i++) {
+    /* isometric latitude on the ellipsoid */
+    const double e_sin = E * sin(lat[i]);
+    const double ll = log(tan(M_PI_4 + lat[i] / 2.)) - E / 2. * log((1. + e_sin) / (1. - e_sin));
+    const double dl = lon[i] - lambda_c;
+    const double exp_ll = exp(ll);
+    const double cosh_ll = (exp_ll + 1. / exp_ll) / 2.;
+    const double sinh_ll = (exp_ll - 1. / exp_ll) / 2.;
+    /* on the sphere, ll_ = isometric latitude of asin(sin(dl) / cosh(ll)) */
+    const double sin_phi = sin(dl) / cosh_ll;
+    const double ll_ = 0.5 * log((1. + sin_phi) / (1. - sin_phi));
+    const double lambda_ = atan(sinh_ll / cos(dl));
+    /* sin(2k (lambda_ + i ll_)) = sin(2k lambda_) cosh(2k ll_) + i cos(2k lambda_) sinh(2k ll_) */
+    const double s2 = sin(2. * lambda_);
+    const double c2_ = cos(2. * lambda_);
+    const double exp2 = exp(2. * ll_);
+    const double ch2 = (exp2 + 1. / exp2) / 2.;
+    const double sh2 = (exp2 - 1. / exp2) / 2.;
+    const double s4 = 2. * s2 * c2_;
+    const double c4 = 1. - 2. * s2 * s2;
+    const double ch4 = 2. * ch2 * ch2 - 1.;
+    const double sh4 = 2. * sh2 * ch2;
+    const double re = c0 * lambda_ + c1 * s2 * ch2 + c2 * s4 * ch4;
+    const double im = c0 * ll_ + c1 * c2_ * sh2 + c2 * c4 * sh4;
+    north[i] = DELTA_NORTH + N * re;
+    east[i] = DELTA_EAST + N * im;
+  }
+}
+
+void utm_of_lla_array_f(struct UtmArray_f* utm, struct LlaArray_f* lla, uint32_t n) {
+  uint32_t i;
+  utm_of_lla_kernel_f(utm->north, utm->east, lla->lat, lla->lon, LambdaOfUtmZone(utm->zone), n);
+  for (i = 0; i < n; i++)
+    utm->alt[i] = lla->alt[i];
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * @file pprz_geodetic_float_batch.h
+ *   @brief Batch versions of the float geodetic conversions.
+ *
+ *   Same layout as pprz_geodetic_double_batch.h, for the tools working
+ *   with the float LtpDef_f of the autopilot. Results are the ones of the
+ *   point versions: ECEF coordinates are computed in float as well.
+ *
+ *   Output and input arrays must not overlap.
+ */
+
+#ifndef PPRZ_GEODETIC_FLOAT_BATCH_H
+#define PPRZ_GEODETIC_FLOAT_BATCH_H
+
+#include "pprz_geodetic_float.h"
+
+/** arrays of LLA coordinates, in radians and meters */
+struct LlaArray_f {
+  float* lon;
+  float* lat;
+  float* alt;
+};
+
+/** arrays of NED coordinates, in meters */
+struct NedArray_f {
+  float* x;
+  float* y;
+  float* z;
+};
+
+/** arrays of ENU coordinates, in meters */
+struct EnuArray_f {
+  float* x;
+  float* y;
+  float* z;
+};
+
+/** arrays of UTM coordinates, in meters, all in the same zone */
+struct UtmArray_f {
+  float* north;
+  float* east;
+  float* alt;
+  uint8_t zone;
+};
+
+extern void enu_of_lla_point_array_f(struct EnuArray_f* enu, struct LtpDef_f* def, struct LlaArray_f* lla, uint32_t n);
+extern void ned_of_lla_point_array_f(struct NedArray_f* ned, struct LtpDef_f* def, struct LlaArray_f* lla, uint32_t n);
+
+/** utm->zone must be set */
+extern void utm_of_lla_array_f(struct UtmArray_f* utm, struct LlaArray_f* lla, uint32_t n);
+
+#endif /* PPRZ_GEODETIC_FLOAT_BATCH_H */
@@ -192,42 +192,205 @@ void ned_of_lla_vect_i(struct NedCoor_i* ned, struct LtpDef_i* def, struct LlaCo
 }
 
 /*
-   For now we cheat and call the floating point version
-   Anyone up for writing it in fixed point ?
-*/
-#include "pprz_geodetic_float.h"
-#include "pprz_geodetic_double.h"
+ * ECEF <-> LLA in fixed point
+ *
+ * The angles and the trigonometric functions are computed by CORDIC on 64
+ * bit integers, angles with GEO_CORDIC_FRAC fractional bits. Distances are
+ * in centimeters with GEO_POS_FRAC fractional bits, trigonometric values
+ * and ellipsoid ratios with GEO_FRAC fractional bits.
+ *
+ * lla_of_ecef_i uses Bowring's method with one iteration, exact to well
+ * below the centimeter between -10km and 100km of altitude.
+ *
+ * Errors against the double precision versions (see test/test_geodetic.c),
+ * over the whole globe and altitudes from -1km to 50km:
+ *   lla_of_ecef_i : lat/lon < 1e-7 rad (1 LSB), alt < 10 mm
+ *   ecef_of_lla_i : < 2 cm on each axis (0.4 cm rms)
+ *
+ * pprz_trig_int is not used here, its 1/4096 rad steps are far too coarse
+ * for positions (~1.5 km on the earth surface).
+ */
+
+#define GEO_FRAC        30
+#define GEO_POS_FRAC    10
+#define GEO_CORDIC_FRAC 40
+#define GEO_CORDIC_ITER 34
+
+/* atan(2^-i) */
+static const int64_t geo_cordic_atan[GEO_CORDIC_ITER] = {
+  863554413089LL, 509785937287LL, 269356888665LL, 136729762476LL,
+  68630207382LL,  34348560106LL,  17178471287LL,  8589759836LL,
+  4294945451LL,   2147480917LL,   1073741483LL,   536870869LL,
+  268435451LL,    134217727LL,    67108864LL,     33554432LL,
+  16777216LL,     8388608LL,      4194304LL,      2097152LL,
+  1048576LL,      524288LL,       262144LL,       131072LL,
+  65536LL,        32768LL,        16384LL,        8192LL,
+  4096LL,         2048LL,         1024LL,         512LL,
+  256LL,          128LL
+};
+
+/* inverse of the CORDIC gain, with GEO_CORDIC_FRAC and GEO_FRAC */
+#define GEO_CORDIC_INV_GAIN     667681663043LL
+#define GEO_INV_GAIN            652032874LL
+#define GEO_CORDIC_PI           3454217652358LL
+#define GEO_CORDIC_PI_2         1727108826179LL
+
+/* WGS84, with GEO_FRAC */
+#define GEO_ONE                 (1LL << GEO_FRAC)
+#define GEO_ONE_MINUS_F         1070141771LL   /* b/a                 */
+#define GEO_E2                  7188036LL      /* e^2                 */
+#define GEO_ONE_MINUS_E2        1066553788LL   /* 1-e^2               */
+/* WGS84, in cm with GEO_POS_FRAC */
+#define GEO_A                   653121228800LL /* a                   */
+#define GEO_EP2_B               4386950299LL   /* e'^2 * b            */
+#define GEO_E2_A                4372241685LL   /* e^2 * a             */
+
+/* (a * b) >> GEO_FRAC without overflow, |b| < 2^33 */
+static inline int64_t geo_mul(int64_t a, int64_t b) {
+  return (a >> GEO_FRAC) * b + (((a & (GEO_ONE - 1)) * b) >> GEO_FRAC);
+}
+
+static uint64_t geo_isqrt(uint64_t n) {
+  uint64_t r = 0;
+  uint64_t bit = 1ULL << 62;
+  while (bit > n)
+    bit >>= 2;
+  while (bit) {
+    if (n >= r + bit) {
+      n -= r + bit;
+      r = (r >> 1) + bit;
+    }
+    else
+      r >>= 1;
+    bit >>= 2;
+  }
+  return r;
+}
+
+/* angle of (x, y), and optionally its norm, |x|,|y| < 2^41 */
+static int64_t geo_cordic_atan2(int64_t y, int64_t x, int64_t* norm) {
+  int64_t z = 0;
+  int i;
+  if (x == 0 && y == 0) {
+    if (norm) *norm = 0;
+    return 0;
+  }
+  if (x < 0) {
+    z = (y >= 0) ? GEO_CORDIC_PI : -GEO_CORDIC_PI;
+    x = -x;
+    y = -y;
+  }
+  for (i = 0; i < GEO_CORDIC_ITER; i++) {
+    const int64_t dx = y >> i;
+    const int64_t dy = x >> i;
+    if (y > 0) {
+      x += dx;
+      y -= dy;
+      z += geo_cordic_atan[i];
+    }
+    else {
+      x -= dx;
+      y += dy;
+      z -= geo_cordic_atan[i];
+    }
+  }
+  if (norm)
+    *norm = geo_mul(x, GEO_INV_GAIN);
+  return z;
+}
+
+/* sine and cosine with GEO_FRAC, angle within [-pi/2, pi/2] */
+static void geo_cordic_sincos(int64_t* s, int64_t* c, int64_t angle) {
+  int64_t x = GEO_CORDIC_INV_GAIN;
+  int64_t y = 0;
+  int i;
+  for (i = 0; i < GEO_CORDIC_ITER; i++) {
+    const int64_t dx = y >> i;
+    const int64_t dy = x >> i;
+    if (angle >= 0) {
+      x -= dx;
+      y += dy;
+      angle -= geo_cordic_atan[i];
+    }
+    else {
+      x += dx;
+      y -= dy;
+      angle += geo_cordic_atan[i];
+    }
+  }
+  *c = (x + (1LL << (GEO_CORDIC_FRAC - GEO_FRAC - 1))) >> (GEO_CORDIC_FRAC - GEO_FRAC);
+  *s = (y + (1LL << (GEO_CORDIC_FRAC - GEO_FRAC - 1))) >> (GEO_CORDIC_FRAC - GEO_FRAC);
+}
+
+/* 1e7 = 2^7 * 78125 */
+#define GEO_CORDIC_OF_EM7(_a) ((((int64_t)(_a)) << (GEO_CORDIC_FRAC - 7)) / 78125)
+#define GEO_EM7_OF_CORDIC(_a) ((int32_t)(((_a) * 78125 + (1LL << (GEO_CORDIC_FRAC - 8))) >> (GEO_CORDIC_FRAC - 7)))
 
 void lla_of_ecef_i(struct LlaCoor_i* out, struct EcefCoor_i* in) {
 
-  /* convert our input to floating point */
-  struct EcefCoor_d in_d;
-  in_d.x = M_OF_CM((double)in->x);
-  in_d.y = M_OF_CM((double)in->y);
-  in_d.z = M_OF_CM((double)in->z);
-  /* calls the floating point transformation */
-  struct LlaCoor_d out_d;
-  lla_of_ecef_d(&out_d, &in_d);
-  /* convert the output to fixed point       */
-  out->lon = (int32_t)rint(EM7RAD_OF_RAD(out_d.lon));
-  out->lat = (int32_t)rint(EM7RAD_OF_RAD(out_d.lat));
-  out->alt = (int32_t)MM_OF_M(out_d.alt);
+  const int64_t x = (int64_t)in->x << GEO_POS_FRAC;
+  const int64_t y = (int64_t)in->y << GEO_POS_FRAC;
+  const int64_t z = (int64_t)in->z << GEO_POS_FRAC;
+
+  /* longitude and distance to the polar axis */
+  int64_t p;
+  const int64_t lon = geo_cordic_atan2(y, x, &p);
+
+  /* parametric latitude: tan(u) = z / ((1-f) * p) */
+  int64_t su, cu;
+  geo_cordic_sincos(&su, &cu, geo_cordic_atan2(z, geo_mul(p, GEO_ONE_MINUS_F), NULL));
+
+  /* Bowring: tan(lat) = (z + e'^2 b sin^3(u)) / (p - e^2 a cos^3(u)) */
+  const int64_t su3 = geo_mul(geo_mul(su, su), su);
+  const int64_t cu3 = geo_mul(geo_mul(cu, cu), cu);
+  const int64_t lat = geo_cordic_atan2(z + geo_mul(GEO_EP2_B, su3), p - geo_mul(GEO_E2_A, cu3), NULL);
+
+  /* alt = p cos(lat) + z sin(lat) - a sqrt(1 - e^2 sin^2(lat)) */
+  int64_t sl, cl;
+  geo_cordic_sincos(&sl, &cl, lat);
+  const int64_t w = geo_isqrt((uint64_t)(GEO_ONE - geo_mul(GEO_E2, geo_mul(sl, sl))) << GEO_FRAC);
+  const int64_t alt = geo_mul(p, cl) + geo_mul(z, sl) - geo_mul(GEO_A, w);
+
+  out->lon = GEO_EM7_OF_CORDIC(lon);
+  out->lat = GEO_EM7_OF_CORDIC(lat);
+  out->alt = (int32_t)((alt * 10 + (1LL << (GEO_POS_FRAC - 1))) >> GEO_POS_FRAC);
 
 }
 
 void ecef_of_lla_i(struct EcefCoor_i* out, struct LlaCoor_i* in) {
 
-  /* convert our input to floating point */
-  struct LlaCoor_d in_d;
-  in_d.lon = RAD_OF_EM7RAD((double)in->lon);
-  in_d.lat = RAD_OF_EM7RAD((double)in->lat);
-  in_d.alt = M_OF_MM((double)in->alt);
-  /* calls the floating point transformation */
-  struct EcefCoor_d out_d;
-  ecef_of_lla_d(&out_d, &in_d);
-  /* convert the output to fixed point       */
-  out->x = (int32_t)CM_OF_M(out_d.x);
-  out->y = (int32_t)CM_OF_M(out_d.y);
-  out->z = (int32_t)CM_OF_M(out_d.z);
+  int64_t sin_lat, cos_lat, sin_lon, cos_lon;
+  geo_cordic_sincos(&sin_lat, &cos_lat, GEO_CORDIC_OF_EM7(in->lat));
+
+  /* bring the longitude back to [-pi/2, pi/2] */
+  int64_t lon = GEO_CORDIC_OF_EM7(in->lon);
+  int neg = 0;
+  if (lon > GEO_CORDIC_PI_2) {
+    lon -= GEO_CORDIC_PI;
+    neg = 1;
+  }
+  else if (lon < -GEO_CORDIC_PI_2) {
+    lon += GEO_CORDIC_PI;
+    neg = 1;
+  }
+  geo_cordic_sincos(&sin_lon, &cos_lon, lon);
+  if (neg) {
+    sin_lon = -sin_lon;
+    cos_lon = -cos_lon;
+  }
+
+  /* prime vertical radius of curvature: a / sqrt(1 - e^2 sin^2(lat)) */
+  const int64_t w = geo_isqrt((uint64_t)(GEO_ONE - geo_mul(GEO_E2, geo_mul(sin_lat, sin_lat))) << GEO_FRAC);
+  const int64_t n = geo_mul(GEO_A, (1LL << (2 * GEO_FRAC)) / w);
+  const int64_t alt = ((int64_t)in->alt << GEO_POS_FRAC) / 10;
+
+  const int64_t r = geo_mul(n + alt, cos_lat);
+  const int64_t x = geo_mul(r, cos_lon);
+  const int64_t y = geo_mul(r, sin_lon);
+  const int64_t z = geo_mul(geo_mul(n, GEO_ONE_MINUS_E2) + alt, sin_lat);
+
+  out->x = (int32_t)((x + (1LL << (GEO_POS_FRAC - 1))) >> GEO_POS_FRAC);
+  out->y = (int32_t)((y + (1LL << (GEO_POS_FRAC - 1))) >> GEO_POS_FRAC);
+  out->z = (int32_t)((z + (1LL << (GEO_POS_FRAC - 1))) >> GEO_POS_FRAC);
 
 }
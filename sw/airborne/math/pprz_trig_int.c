@@ -23,6 +23,8 @@
 
 #include "pprz_trig_int.h"
 
+#if PPRZ_TRIG_INT_ENGINE == PPRZ_TRIG_INT_TABLE
+
 PPRZ_TRIG_CONST int16_t pprz_trig_int[6434] = {    0,
     3,     7,    11,    15,    19,    23,    27,    31,    35,    39,    43,    47,    51,    55,    59,    63,
    67,    71,    75,    79,    83,    87,    91,    95,    99,   103,   107,   111,   115,   119,   123,   127,
@@ -427,3 +429,203 @@ PPRZ_TRIG_CONST int16_t pprz_trig_int[6434] = {    0,
  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,
  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,  16383,
  16383};
+
+#endif /* PPRZ_TRIG_INT_ENGINE == PPRZ_TRIG_INT_TABLE */
+
+
+/*
+ * High resolution functions
+ */
+
+#define HR_PI   843314857   /* pi with PPRZ_ITRIG_HR_ANGLE_FRAC */
+#define HR_PI_2 421657428
+#define HR_PI_4 210828714
+#define HR_2_PI 1686629713
+#define HR_ONE  (1 << PPRZ_ITRIG_HR_FRAC)
+
+#define HR_MUL(_a, _b) ((int32_t)(((int64_t)(_a) * (_b)) >> PPRZ_ITRIG_HR_FRAC))
+
+/* atan(2^-i) with PPRZ_ITRIG_HR_ANGLE_FRAC */
+#define CORDIC_ITER 28
+static const int32_t cordic_atan[CORDIC_ITER] = {
+  210828714, 124459457,  65760959,  33381290,  16755422,   8385879,
+    4193963,   2097109,   1048571,    524287,    262144,    131072,
+      65536,     32768,     16384,      8192,      4096,      2048,
+       1024,       512,       256,       128,        64,        32,
+         16,         8,         4,         2,
+};
+
+#if PPRZ_TRIG_INT_ENGINE == PPRZ_TRIG_INT_INTERP
+
+/* sin(k pi/128) with PPRZ_ITRIG_HR_FRAC, k = 0..64 */
+#define INTERP_STEPS 64
+static const int32_t interp_sin[INTERP_STEPS + 1] = {
+           0,   26350943,   52686014,   78989349,  105245103,  131437462,
+   157550647,  183568930,  209476638,  235258165,  260897982,  286380643,
+   311690799,  336813204,  361732726,  386434353,  410903207,  435124548,
+   459083786,  482766489,  506158392,  529245404,  552013618,  574449320,
+   596538995,  618269338,  639627258,  660599890,  681174602,  701339000,
+   721080937,  740388522,  759250125,  777654384,  795590213,  813046808,
+   830013654,  846480531,  862437520,  877875009,  892783698,  907154608,
+   920979082,  934248793,  946955747,  959092290,  970651112,  981625251,
+   992008094, 1001793390, 1010975242, 1019548121, 1027506862, 1034846671,
+  1041563127, 1047652185, 1053110176, 1057933813, 1062120190, 1065666786,
+  1068571464, 1070832474, 1072448455, 1073418433, 1073741824,
+};
+
+/*
+ * angle in [0, pi/2]: closest entry k and sin(k h + d) = sin(k h) cos(d) + cos(k h) sin(d),
+ * with |d| <= pi/256, sin(d) and cos(d) from their Taylor series to the 4th order
+ */
+static int32_t sin_kernel(int32_t a) {
+  /* 128/pi with 28 bits, pi/128 with 40 bits */
+  const int32_t k = (int32_t)(((int64_t)a * 10937044409LL + (1LL << 55)) >> 56);
+  const int32_t d = (a - (int32_t)(((int64_t)k * 26986075409LL + (1 << 11)) >> 12)) << 2;
+  const int32_t d2 = HR_MUL(d, d);
+  const int32_t sd = d - HR_MUL(d, d2) / 6;
+  const int32_t cd = HR_ONE - d2 / 2 + HR_MUL(d2, d2) / 24;
+  return HR_MUL(interp_sin[k], cd) + HR_MUL(interp_sin[INTERP_STEPS - k], sd);
+}
+
+#elif PPRZ_TRIG_INT_ENGINE == PPRZ_TRIG_INT_POLY
+
+/*
+ * minimax polynomials on [0, pi/4] in x^2, with PPRZ_ITRIG_HR_FRAC
+ *  sin(x) = x * P(x^2) within 3.4e-12, cos(x) = Q(x^2) within 4.8e-11
+ */
+static int32_t poly_sin(int32_t x) {
+  const int32_t x2 = HR_MUL(x, x);
+  int32_t p = 2918;
+  p = -213022 + HR_MUL(p, x2);
+  p = 8947844 + HR_MUL(p, x2);
+  p = -178956970 + HR_MUL(p, x2);
+  p = HR_ONE + HR_MUL(p, x2);
+  return HR_MUL(p, x);
+}
+
+static int32_t poly_cos(int32_t x) {
+  const int32_t x2 = HR_MUL(x, x);
+  int32_t p = 26178;
+  p = -1491064 + HR_MUL(p, x2);
+  p = 44739189 + HR_MUL(p, x2);
+  p = -536870908 + HR_MUL(p, x2);
+  return HR_ONE + HR_MUL(p, x2);
+}
+
+/* angle in [0, pi/2] */
+static int32_t sin_kernel(int32_t a) {
+  if (a <= HR_PI_4)
+    return poly_sin(a << 2);
+  else
+    return poly_cos((HR_PI_2 - a) << 2);
+}
+
+#else /* table or CORDIC */
+
+/* angle in [0, pi/2], CORDIC in rotation mode */
+static int32_t sin_kernel(int32_t a) {
+  int32_t x = 652032874;  /* 1/gain with PPRZ_ITRIG_HR_FRAC */
+  int32_t y = 0;
+  int32_t z = a;
+  int i;
+
+  for (i = 0; i < CORDIC_ITER; i++) {
+    const int32_t xi = x;
+    if (z >= 0) {
+      x -= y >> i;
+      y += xi >> i;
+      z -= cordic_atan[i];
+    }
+    else {
+      x += y >> i;
+      y -= xi >> i;
+      z += cordic_atan[i];
+    }
+  }
+  return y;
+}
+
+#endif /* PPRZ_TRIG_INT_ENGINE */
+
+int32_t pprz_itrig_sin_hr(int32_t angle) {
+  int32_t a = angle;
+  while (a > HR_PI)  a -= HR_2_PI;
+  while (a < -HR_PI) a += HR_2_PI;
+  if (a > HR_PI_2) a = HR_PI - a;
+  else if (a < -HR_PI_2) a = -HR_PI - a;
+  if (a >= 0)
+    return sin_kernel(a);
+  else
+    return -sin_kernel(-a);
+}
+
+int32_t pprz_itrig_cos_hr(int32_t angle) {
+  int32_t a = angle;
+  while (a > HR_PI)  a -= HR_2_PI;
+  return pprz_itrig_sin_hr(a + HR_PI_2);
+}
+
+/*
+ * CORDIC in vectoring mode. The vector is brought in the right half plane,
+ * then scaled to keep 29 significant bits whatever the magnitude of the inputs.
+ */
+int32_t pprz_itrig_atan2_hr(int32_t y, int32_t x) {
+  int64_t xl = x, yl = y;
+  int32_t z = 0;
+  int i;
+
+  if (x == 0 && y == 0)
+    return 0;
+  if (xl < 0) {
+    const int64_t t = xl;
+    if (yl >= 0) {
+      xl = yl; yl = -t; z = HR_PI_2;
+    }
+    else {
+      xl = -yl; yl = t; z = -HR_PI_2;
+    }
+  }
+
+  int64_t m = xl > (yl < 0 ? -yl : yl) ? xl : (yl < 0 ? -yl : yl);
+  while (m >= (1LL << 29)) { m >>= 1; xl >>= 1; yl >>= 1; }
+  while (m <  (1LL << 28)) { m <<= 1; xl <<= 1; yl <<= 1; }
+
+  int32_t xi = (int32_t)xl, yi = (int32_t)yl;
+  for (i = 0; i < CORDIC_ITER; i++) {
+    const int32_t xt = xi;
+    if (yi > 0) {
+      xi += yi >> i;
+      yi -= xt >> i;
+      z += cordic_atan[i];
+    }
+    else {
+      xi -= yi >> i;
+      yi += xt >> i;
+      z -= cordic_atan[i];
+    }
+  }
+  return z;
+}
+
+static uint32_t isqrt64(uint64_t n) {
+  uint64_t res = 0;
+  uint64_t bit = 1ULL << 62;
+  while (bit > n) bit >>= 2;
+  while (bit) {
+    if (n >= res + bit) {
+      n -= res + bit;
+      res = (res >> 1) + bit;
+    }
+    else
+      res >>= 1;
+    bit >>= 2;
+  }
+  return (uint32_t)res;
+}
+
+int32_t pprz_itrig_asin_hr(int32_t s) {
+  if (s >= HR_ONE) return HR_PI_2;
+  if (s <= -HR_ONE) return -HR_PI_2;
+  const uint32_t c = isqrt64((1ULL << (2 * PPRZ_ITRIG_HR_FRAC)) - (int64_t)s * s);
+  return pprz_itrig_atan2_hr(s, c);
+}
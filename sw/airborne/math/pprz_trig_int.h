@@ -27,6 +27,57 @@
 #include "std.h"
 #include "math/pprz_algebra_int.h"
 
+/*
+ * Integer trigonometry.
+ *
+ * The engine computing PPRZ_ITRIG_SIN/COS is selected at compile time
+ * with PPRZ_TRIG_INT_ENGINE (e.g. -DPPRZ_TRIG_INT_ENGINE=PPRZ_TRIG_INT_POLY):
+ *
+ *  PPRZ_TRIG_INT_TABLE  : 6434 entries sine table, indexed by the angle
+ *                         (12.9 KB, fastest, default)
+ *  PPRZ_TRIG_INT_INTERP : 65 entries table and second order correction
+ *                         (260 bytes)
+ *  PPRZ_TRIG_INT_POLY   : minimax polynomials, no table
+ *  PPRZ_TRIG_INT_CORDIC : CORDIC, shares the 112 bytes atan table of atan2
+ *
+ * Besides the INT32_ANGLE_FRAC / INT32_TRIG_FRAC macros, the functions
+ * below work at high resolution: angles with PPRZ_ITRIG_HR_ANGLE_FRAC
+ * (3.7e-9 rad) and values with PPRZ_ITRIG_HR_FRAC. With the table engine
+ * they use CORDIC. atan2 and asin always use CORDIC.
+ *
+ * Max errors (test/test_trig_int.c):
+ *  PPRZ_ITRIG_SIN/COS : 5 LSB with the table (INT32_ANGLE_PI rounding), 0.5 LSB otherwise
+ *  sin/cos_hr         : 6.2 LSB interp, 3.2 LSB poly, 25.6 LSB CORDIC
+ *  atan2_hr           : 3.1e-8 rad
+ *  asin_hr            : 2.2e-8 rad
+ */
+
+#define PPRZ_TRIG_INT_TABLE  0
+#define PPRZ_TRIG_INT_INTERP 1
+#define PPRZ_TRIG_INT_POLY   2
+#define PPRZ_TRIG_INT_CORDIC 3
+
+#ifndef PPRZ_TRIG_INT_ENGINE
+#define PPRZ_TRIG_INT_ENGINE PPRZ_TRIG_INT_TABLE
+#endif
+
+#define PPRZ_ITRIG_HR_ANGLE_FRAC 28
+#define PPRZ_ITRIG_HR_FRAC       30
+
+/** sine, angle in rad with PPRZ_ITRIG_HR_ANGLE_FRAC, result with PPRZ_ITRIG_HR_FRAC */
+extern int32_t pprz_itrig_sin_hr(int32_t angle);
+/** cosine, angle in rad with PPRZ_ITRIG_HR_ANGLE_FRAC, result with PPRZ_ITRIG_HR_FRAC */
+extern int32_t pprz_itrig_cos_hr(int32_t angle);
+/** atan2 of any y and x, result in ]-pi, pi] with PPRZ_ITRIG_HR_ANGLE_FRAC */
+extern int32_t pprz_itrig_atan2_hr(int32_t y, int32_t x);
+/** asin, s with PPRZ_ITRIG_HR_FRAC, result with PPRZ_ITRIG_HR_ANGLE_FRAC */
+extern int32_t pprz_itrig_asin_hr(int32_t s);
+
+#define PPRZ_ITRIG_HR_SHIFT (PPRZ_ITRIG_HR_ANGLE_FRAC - INT32_ANGLE_FRAC)
+#define PPRZ_ITRIG_HR_ROUND(_v, _shift) (((_v) + (1 << ((_shift) - 1))) >> (_shift))
+
+#if PPRZ_TRIG_INT_ENGINE == PPRZ_TRIG_INT_TABLE
+
 /* Allow makefile to define BOOZ_TRIG_CONST in case we want
  to make the trig tables const and store them in flash.
  Otherwise use the empty string and keep the table in RAM. */
@@ -53,6 +104,38 @@ extern PPRZ_TRIG_CONST int16_t pprz_trig_int[];
     PPRZ_ITRIG_SIN( _c, _a + INT32_ANGLE_PI_2);				\
   }
 
+#else /* PPRZ_TRIG_INT_ENGINE != PPRZ_TRIG_INT_TABLE */
+
+#define PPRZ_ITRIG_SIN(_s, _a) {					\
+    int32_t an = _a;							\
+    INT32_ANGLE_NORMALIZE(an);						\
+    _s = PPRZ_ITRIG_HR_ROUND(pprz_itrig_sin_hr(an << PPRZ_ITRIG_HR_SHIFT), \
+                             PPRZ_ITRIG_HR_FRAC - INT32_TRIG_FRAC);	\
+  }
+
+/* not as sin(a + pi/2): INT32_ANGLE_PI_2 is one LSB short */
+#define PPRZ_ITRIG_COS(_c, _a) {					\
+    int32_t an = _a;							\
+    INT32_ANGLE_NORMALIZE(an);						\
+    _c = PPRZ_ITRIG_HR_ROUND(pprz_itrig_cos_hr(an << PPRZ_ITRIG_HR_SHIFT), \
+                             PPRZ_ITRIG_HR_FRAC - INT32_TRIG_FRAC);	\
+  }
+
+#endif /* PPRZ_TRIG_INT_ENGINE */
+
+/** atan2, result with INT32_ANGLE_FRAC */
+#define PPRZ_ITRIG_ATAN2(_a, _y, _x) {					\
+    _a = PPRZ_ITRIG_HR_ROUND(pprz_itrig_atan2_hr(_y, _x), PPRZ_ITRIG_HR_SHIFT); \
+  }
+
+/** asin of _s with INT32_TRIG_FRAC, result with INT32_ANGLE_FRAC */
+#define PPRZ_ITRIG_ASIN(_a, _s) {					\
+    int32_t sn = _s;							\
+    Bound(sn, -TRIG_BFP_OF_REAL(1), TRIG_BFP_OF_REAL(1));		\
+    _a = PPRZ_ITRIG_HR_ROUND(pprz_itrig_asin_hr(sn << (PPRZ_ITRIG_HR_FRAC - INT32_TRIG_FRAC)), \
+                             PPRZ_ITRIG_HR_SHIFT);			\
+  }
+
 
 
 #endif /* PPRZ_TRIG_INT_H */
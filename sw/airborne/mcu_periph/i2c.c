@@ -42,3 +42,147 @@ void   i2c_init(struct i2c_periph* p) {
 }
 
 
+
+
+#ifdef USE_I2C_SCHED
+
+#include "sys_time.h"
+
+struct i2c_sched_dev i2c_sched_dev[I2C_SCHED_NB_DEV];
+uint8_t i2c_sched_nb_dev;
+uint16_t i2c_sched_tick;
+
+/* system timer at the start of the current tick */
+static uint32_t i2c_sched_tick_start;
+#define I2C_SCHED_SYS_TICS_OF_TICK SYS_TICS_OF_SEC(1. / I2C_SCHED_FREQ)
+
+/* buses with registered devices */
+#define I2C_SCHED_NB_BUS 3
+static struct i2c_periph* i2c_sched_bus[I2C_SCHED_NB_BUS];
+static uint8_t i2c_sched_nb_bus;
+
+static struct i2c_sched_dev* i2c_sched_find(struct i2c_transaction* t) {
+  uint8_t i;
+  for (i = 0; i < i2c_sched_nb_dev; i++)
+    if (i2c_sched_dev[i].trans == t)
+      return &i2c_sched_dev[i];
+  return NULL;
+}
+
+static void i2c_sched_add_bus(struct i2c_periph* p) {
+  uint8_t i;
+  for (i = 0; i < i2c_sched_nb_bus; i++)
+    if (i2c_sched_bus[i] == p)
+      return;
+  if (i2c_sched_nb_bus < I2C_SCHED_NB_BUS)
+    i2c_sched_bus[i2c_sched_nb_bus++] = p;
+}
+
+struct i2c_sched_dev* i2c_sched_register(struct i2c_periph* p, struct i2c_transaction* t,
+                                         uint8_t prio, uint16_t period, uint16_t deadline) {
+  struct i2c_sched_dev* d = i2c_sched_find(t);
+  if (d == NULL) {
+    if (i2c_sched_nb_dev >= I2C_SCHED_NB_DEV)
+      return NULL;
+    d = &i2c_sched_dev[i2c_sched_nb_dev++];
+    d->trans = t;
+    d->state = I2CSchedIdle;
+    d->t_sent = i2c_sched_tick - period;
+    d->nb_req = 0;
+    d->nb_merged = 0;
+    d->nb_late = 0;
+    d->max_latency = 0;
+  }
+  d->p = p;
+  d->prio = prio;
+  d->period = period;
+  d->deadline = deadline;
+  i2c_sched_add_bus(p);
+  return d;
+}
+
+/** Number of transactions in the queue of the peripheral, including the running one */
+static inline uint8_t i2c_sched_queued(struct i2c_periph* p) {
+  int16_t n = p->trans_insert_idx - p->trans_extract_idx;
+  if (n < 0) n += I2C_TRANSACTION_QUEUE_LEN;
+  return n;
+}
+
+/** Update the statistics of a sent transaction once it is finished */
+static void i2c_sched_check_done(struct i2c_sched_dev* d) {
+  if (d->state == I2CSchedSent &&
+      d->trans->status != I2CTransPending && d->trans->status != I2CTransRunning) {
+    uint16_t latency = i2c_sched_tick - d->t_req;
+    if (latency > d->max_latency) d->max_latency = latency;
+    if (d->deadline != 0 && latency > d->deadline) d->nb_late++;
+    d->state = I2CSchedIdle;
+  }
+}
+
+/** Give the most important ready requests to the peripheral
+ *  Ties are broken by the age of the request.
+ */
+static void i2c_sched_dispatch(struct i2c_periph* p) {
+  while (i2c_sched_queued(p) < I2C_SCHED_DEPTH) {
+    struct i2c_sched_dev* best = NULL;
+    uint8_t i;
+    for (i = 0; i < i2c_sched_nb_dev; i++) {
+      struct i2c_sched_dev* d = &i2c_sched_dev[i];
+      if (d->p != p || d->state != I2CSchedWaiting)
+        continue;
+      if (d->period != 0 && (uint16_t)(i2c_sched_tick - d->t_sent) < d->period)
+        continue;
+      if (best == NULL || d->prio < best->prio ||
+          (d->prio == best->prio &&
+           (uint16_t)(i2c_sched_tick - d->t_req) > (uint16_t)(i2c_sched_tick - best->t_req)))
+        best = d;
+    }
+    if (best == NULL || !i2c_submit(p, best->trans))
+      return;
+    best->state = I2CSchedSent;
+    best->t_sent = i2c_sched_tick;
+  }
+}
+
+bool_t i2c_sched_submit(struct i2c_periph* p, struct i2c_transaction* t) {
+  struct i2c_sched_dev* d = i2c_sched_find(t);
+  if (d == NULL) {
+    d = i2c_sched_register(p, t, I2C_SCHED_PRIO_NORMAL, 0, 0);
+    /* no room left, bypass the scheduler */
+    if (d == NULL)
+      return i2c_submit(p, t);
+  }
+  d->nb_req++;
+  i2c_sched_check_done(d);
+  if (d->state != I2CSchedIdle) {
+    /* same transaction already waiting or running */
+    d->nb_merged++;
+    return TRUE;
+  }
+  d->p = p;
+  i2c_sched_add_bus(p);
+  d->state = I2CSchedWaiting;
+  d->t_req = i2c_sched_tick;
+  t->status = I2CTransPending;
+  i2c_sched_dispatch(p);
+  return TRUE;
+}
+
+/* Ticks are counted on the system timer, whatever the call rate of the
+ * periodic function (clamped to the main frequency by the modules).
+ */
+void i2c_sched_periodic(void) {
+  uint32_t n = SysTimeTimer(i2c_sched_tick_start) / I2C_SCHED_SYS_TICS_OF_TICK;
+  i2c_sched_tick += n;
+  i2c_sched_tick_start += n * I2C_SCHED_SYS_TICS_OF_TICK;
+}
+
+void i2c_sched_event(void) {
+  uint8_t i;
+  for (i = 0; i < i2c_sched_nb_dev; i++)
+    i2c_sched_check_done(&i2c_sched_dev[i]);
+  for (i = 0; i < i2c_sched_nb_bus; i++)
+    i2c_sched_dispatch(i2c_sched_bus[i]);
+}
+
+#endif /* USE_I2C_SCHED */
@@ -134,12 +134,101 @@ extern void   i2c_init(struct i2c_periph* p);
 extern bool_t i2c_idle(struct i2c_periph* p);
 extern bool_t i2c_submit(struct i2c_periph* p, struct i2c_transaction* t);
 
+#ifdef USE_I2C_SCHED
+
+/*
+ * Transaction scheduler
+ *
+ * Sits on top of the transaction queue of each bus: requests are held by
+ * the scheduler and only I2C_SCHED_DEPTH of them are given to the
+ * peripheral at a time, by order of priority, so that a slow device can
+ * only delay a more important one by a single transaction.
+ * A device is a transaction structure, registered with a priority, a
+ * minimum period between two transactions and a deadline. Unregistered
+ * transactions are registered at their first request with the normal
+ * priority. A new request for a transaction which is still waiting or
+ * running is merged with it instead of being queued twice.
+ * Time is counted in ticks of 1/I2C_SCHED_FREQ s, measured on the system
+ * timer by i2c_sched_periodic which must run at least at that rate to keep
+ * the resolution.
+ * Only the transactions submitted with I2CSubmit (or the I2CTransmit,
+ * I2CReceive and I2CTransceive macros) are scheduled. Drivers calling
+ * i2c_submit directly bypass it (imu_aspirin, hmc5843, lisa baro_board):
+ * they chain several requests on one transaction or busy wait on its
+ * status, which the merging of requests or the holding of them until the
+ * next event would break.
+ */
+
+#ifndef I2C_SCHED_NB_DEV
+#define I2C_SCHED_NB_DEV 16
+#endif
+
+/** Number of transactions given to a peripheral at a time */
+#ifndef I2C_SCHED_DEPTH
+#define I2C_SCHED_DEPTH 1
+#endif
+
+/** Resolution of the scheduler times, ticks per second */
+#ifndef I2C_SCHED_FREQ
+#define I2C_SCHED_FREQ 100
+#endif
+
+#define I2C_SCHED_TICKS_OF_SEC(_s) ((uint16_t)((_s) * I2C_SCHED_FREQ + 0.5))
+
+/* lower is more important */
+#define I2C_SCHED_PRIO_HIGH   0
+#define I2C_SCHED_PRIO_NORMAL 4
+#define I2C_SCHED_PRIO_LOW    8
+
+enum I2CSchedState {
+  I2CSchedIdle,
+  I2CSchedWaiting,
+  I2CSchedSent
+};
+
+struct i2c_sched_dev {
+  struct i2c_periph* p;
+  struct i2c_transaction* trans;
+  uint8_t  prio;
+  uint16_t period;      ///< min ticks between two transactions, 0 for no limit
+  uint16_t deadline;    ///< max ticks from request to completion, 0 for none
+  enum I2CSchedState state;
+  uint16_t t_req;       ///< tick of the current request
+  uint16_t t_sent;      ///< tick of the last transaction given to the peripheral
+  /* statistics, reset by the telemetry report */
+  uint16_t nb_req;
+  uint16_t nb_merged;
+  uint16_t nb_late;
+  uint16_t max_latency; ///< ticks
+};
+
+extern struct i2c_sched_dev i2c_sched_dev[I2C_SCHED_NB_DEV];
+extern uint8_t i2c_sched_nb_dev;
+extern uint16_t i2c_sched_tick;
+
+extern struct i2c_sched_dev* i2c_sched_register(struct i2c_periph* p, struct i2c_transaction* t,
+                                                uint8_t prio, uint16_t period, uint16_t deadline);
+extern bool_t i2c_sched_submit(struct i2c_periph* p, struct i2c_transaction* t);
+extern void i2c_sched_periodic(void);
+extern void i2c_sched_event(void);
+
+#define I2CSubmit(_p, _t) i2c_sched_submit(&(_p),&(_t))
+#define I2CSchedRegister(_p, _t, _prio, _period, _deadline) \
+  i2c_sched_register(&(_p), &(_t), _prio, _period, _deadline)
+
+#else /* USE_I2C_SCHED */
+
+#define I2CSubmit(_p, _t) i2c_submit(&(_p),&(_t))
+#define I2CSchedRegister(_p, _t, _prio, _period, _deadline) {}
+
+#endif /* USE_I2C_SCHED */
+
 #define I2CReceive(_p, _t, _s_addr, _len) { \
   _t.type = I2CTransRx;                     \
   _t.slave_addr = _s_addr;                  \
   _t.len_r = _len;                          \
   _t.len_w = 0;                             \
-  i2c_submit(&(_p),&(_t));                  \
+  I2CSubmit(_p, _t);                        \
 }
 
 #define I2CTransmit(_p, _t, _s_addr, _len) {	\
@@ -147,7 +236,7 @@ extern bool_t i2c_submit(struct i2c_periph* p, struct i2c_transaction* t);
   _t.slave_addr = _s_addr;			              \
   _t.len_r = 0;				                        \
   _t.len_w = _len;				                    \
-  i2c_submit(&(_p),&(_t));			              \
+  I2CSubmit(_p, _t);			                    \
 }
 
 #define I2CTransceive(_p, _t, _s_addr, _len_w, _len_r) {  \
@@ -155,7 +244,7 @@ extern bool_t i2c_submit(struct i2c_periph* p, struct i2c_transaction* t);
   _t.slave_addr = _s_addr;                                \
   _t.len_r = _len_r;                                      \
   _t.len_w = _len_w;                                      \
-  i2c_submit(&(_p),&(_t));                                \
+  I2CSubmit(_p, _t);                                      \
 }
 
 
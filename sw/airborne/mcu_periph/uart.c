@@ -24,6 +24,8 @@
 
 #include "mcu_periph/uart.h"
 
+#include <string.h>
+
 #ifdef USE_UART0
 struct uart_periph uart0;
 #endif
@@ -50,12 +52,49 @@ void uart_periph_init(struct uart_periph* p) {
   p->tx_insert_idx = 0;
   p->tx_extract_idx = 0;
   p->tx_running = FALSE;
+  p->rx_dma = NULL;
+  p->tx_dma = NULL;
+  p->tx_dma_len = 0;
+}
+
+static inline uint16_t uart_tx_free_space(struct uart_periph* p) {
+  return (p->tx_extract_idx - p->tx_insert_idx - 1) & UART_TX_BUFFER_MASK;
 }
 
 bool_t uart_check_free_space(struct uart_periph* p, uint8_t len) {
-  int16_t space = p->tx_extract_idx - p->tx_insert_idx;
-  if (space <= 0)
-    space += UART_TX_BUFFER_SIZE;
-  return (uint16_t)(space - 1) >= len;
+  return uart_tx_free_space(p) >= len;
+}
+
+uint16_t uart_read_bulk(struct uart_periph* p, uint8_t* data, uint16_t len) {
+  uint16_t n = 0;
+  UartRxUpdate(p);
+  while (n < len && p->rx_extract_idx != p->rx_insert_idx) {
+    uint16_t extract = p->rx_extract_idx;
+    uint16_t insert = p->rx_insert_idx;
+    /* contiguous part, up to the end of the buffer */
+    uint16_t chunk = (insert > extract ? insert : UART_RX_BUFFER_SIZE) - extract;
+    if (chunk > len - n)
+      chunk = len - n;
+    memcpy(&data[n], &p->rx_buf[extract], chunk);
+    n += chunk;
+    p->rx_extract_idx = (extract + chunk) & UART_RX_BUFFER_MASK;
+  }
+  return n;
 }
 
+#ifndef UART_ARCH_WRITE_BULK
+/* byte per byte when the arch has no bulk transmission */
+uint16_t uart_write_bulk(struct uart_periph* p, uint8_t* data, uint16_t len) {
+  uint16_t i;
+  uint16_t space = uart_tx_free_space(p);
+  if (len > space)
+    len = space;
+  for (i = 0; i < len; i++)
+    uart_transmit(p, data[i]);
+  return len;
+}
+#endif
+
+void uart_transmit_buffer(struct uart_periph* p, uint8_t* data, uint16_t len) {
+  uart_write_bulk(p, data, len);
+}
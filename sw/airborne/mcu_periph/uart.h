@@ -33,8 +33,19 @@
 #include "mcu_periph/uart_arch.h"
 #include "std.h"
 
+/* Buffer sizes, powers of two so that indexes wrap with a mask */
+#ifndef UART_RX_BUFFER_SIZE
 #define UART_RX_BUFFER_SIZE 128
+#endif
+#ifndef UART_TX_BUFFER_SIZE
 #define UART_TX_BUFFER_SIZE 128
+#endif
+#if (UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) || (UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1))
+#error "UART_RX_BUFFER_SIZE and UART_TX_BUFFER_SIZE must be powers of two"
+#endif
+#define UART_RX_BUFFER_MASK (UART_RX_BUFFER_SIZE - 1)
+#define UART_TX_BUFFER_MASK (UART_TX_BUFFER_SIZE - 1)
+
 #define UART_DEV_NAME_SIZE 16
 
 /**
@@ -46,12 +57,16 @@ struct uart_periph {
   uint16_t rx_insert_idx;
   uint16_t rx_extract_idx;
   /* Transmit buffer */
-  uint8_t tx_buf[UART_RX_BUFFER_SIZE];
+  uint8_t tx_buf[UART_TX_BUFFER_SIZE];
   uint16_t tx_insert_idx;
   uint16_t tx_extract_idx;
   uint8_t tx_running;
   /* UART Register */
   void* reg_addr;
+  /* DMA channels (stm32), NULL when the UART is interrupt driven */
+  void* rx_dma;
+  void* tx_dma;
+  uint16_t tx_dma_len;
   /* UART Dev (linux) */
   char dev[UART_DEV_NAME_SIZE];
 };
@@ -60,13 +75,32 @@ extern void uart_periph_init(struct uart_periph* p);
 extern void uart_periph_set_baudrate(struct uart_periph* p, uint32_t baud);
 //extern void uart_periph_init_param(struct uart_periph* p, uint32_t baud, uint8_t mode, uint8_t fmode, char * dev);
 extern void uart_transmit(struct uart_periph* p, uint8_t data);
+extern void uart_transmit_buffer(struct uart_periph* p, uint8_t* data, uint16_t len);
 extern bool_t uart_check_free_space(struct uart_periph* p, uint8_t len);
 
-#define UartChAvailable(_p) (_p.rx_insert_idx != _p.rx_extract_idx)
+/** Copy up to len received bytes to data
+ *  \return number of bytes read
+ */
+extern uint16_t uart_read_bulk(struct uart_periph* p, uint8_t* data, uint16_t len);
+
+/** Queue up to len bytes for transmission
+ *  \return number of bytes queued, less than len if the buffer is full
+ */
+extern uint16_t uart_write_bulk(struct uart_periph* p, uint8_t* data, uint16_t len);
+
+/* Update of rx_insert_idx by the arch when reception is not interrupt driven */
+#ifndef UartRxUpdate
+#define UartRxUpdate(_p) {}
+#endif
+
+#define UartChAvailable(_p) ({                                      \
+   UartRxUpdate(&(_p));                                             \
+   _p.rx_insert_idx != _p.rx_extract_idx;                           \
+})
 
 #define UartGetch(_p) ({                                            \
-   uint8_t ret = _p.rx_buf[_p.rx_extract_idx];                   \
-   _p.rx_extract_idx = (_p.rx_extract_idx + 1)%UART_RX_BUFFER_SIZE; \
+   uint8_t ret = _p.rx_buf[_p.rx_extract_idx];                      \
+   _p.rx_extract_idx = (_p.rx_extract_idx + 1) & UART_RX_BUFFER_MASK; \
    ret;                                                             \
 })
 
@@ -78,9 +112,11 @@ extern void uart0_init(void);
 #define Uart0Init() uart_periph_init(&uart0)
 #define Uart0CheckFreeSpace(_x) uart_check_free_space(&uart0, _x)
 #define Uart0Transmit(_x) uart_transmit(&uart0, _x)
+#define Uart0TransmitBuffer(_b, _l) uart_transmit_buffer(&uart0, _b, _l)
 #define Uart0SendMessage() {}
 #define Uart0ChAvailable() UartChAvailable(uart0)
 #define Uart0Getch() UartGetch(uart0)
+#define Uart0ReadBulk(_b, _l) uart_read_bulk(&uart0, _b, _l)
 #define Uart0TxRunning uart0.tx_running
 #define Uart0SetBaudrate(_b) uart_periph_set_baudrate(&uart0, _b)
 //#define Uart0InitParam(_b, _m, _fm) uart_periph_init_param(&uart0, _b, _m, _fm, "")
@@ -88,9 +124,11 @@ extern void uart0_init(void);
 #define UART0Init           Uart0Init
 #define UART0CheckFreeSpace Uart0CheckFreeSpace
 #define UART0Transmit       Uart0Transmit
+#define UART0TransmitBuffer Uart0TransmitBuffer
 #define UART0SendMessage    Uart0SendMessage
 #define UART0ChAvailable    Uart0ChAvailable
 #define UART0Getch          Uart0Getch
+#define UART0ReadBulk       Uart0ReadBulk
 #define UART0TxRunning      Uart0TxRunning
 #define UART0SetBaudrate    Uart0SetBaudrate
 
@@ -103,9 +141,11 @@ extern void uart1_init(void);
 #define Uart1Init() uart_periph_init(&uart1)
 #define Uart1CheckFreeSpace(_x) uart_check_free_space(&uart1, _x)
 #define Uart1Transmit(_x) uart_transmit(&uart1, _x)
+#define Uart1TransmitBuffer(_b, _l) uart_transmit_buffer(&uart1, _b, _l)
 #define Uart1SendMessage() {}
 #define Uart1ChAvailable() UartChAvailable(uart1)
 #define Uart1Getch() UartGetch(uart1)
+#define Uart1ReadBulk(_b, _l) uart_read_bulk(&uart1, _b, _l)
 #define Uart1TxRunning uart1.tx_running
 #define Uart1SetBaudrate(_b) uart_periph_set_baudrate(&uart1, _b)
 //#define Uart1InitParam(_b, _m, _fm) uart_periph_init_param(&uart1, _b, _m, _fm, "")
@@ -113,9 +153,11 @@ extern void uart1_init(void);
 #define UART1Init           Uart1Init
 #define UART1CheckFreeSpace Uart1CheckFreeSpace
 #define UART1Transmit       Uart1Transmit
+#define UART1TransmitBuffer Uart1TransmitBuffer
 #define UART1SendMessage    Uart1SendMessage
 #define UART1ChAvailable    Uart1ChAvailable
 #define UART1Getch          Uart1Getch
+#define UART1ReadBulk       Uart1ReadBulk
 #define UART1TxRunning      Uart1TxRunning
 #define UART1SetBaudrate    Uart1SetBaudrate
 
@@ -128,9 +170,11 @@ extern void uart2_init(void);
 #define Uart2Init() uart_periph_init(&uart2)
 #define Uart2CheckFreeSpace(_x) uart_check_free_space(&uart2, _x)
 #define Uart2Transmit(_x) uart_transmit(&uart2, _x)
+#define Uart2TransmitBuffer(_b, _l) uart_transmit_buffer(&uart2, _b, _l)
 #define Uart2SendMessage() {}
 #define Uart2ChAvailable() UartChAvailable(uart2)
 #define Uart2Getch() UartGetch(uart2)
+#define Uart2ReadBulk(_b, _l) uart_read_bulk(&uart2, _b, _l)
 #define Uart2TxRunning uart2.tx_running
 #define Uart2SetBaudrate(_b) uart_periph_set_baudrate(&uart2, _b)
 //#define Uart2InitParam(_b, _m, _fm) uart_periph_init_param(&uart2, _b, _m, _fm, "")
@@ -138,9 +182,11 @@ extern void uart2_init(void);
 #define UART2Init           Uart2Init
 #define UART2CheckFreeSpace Uart2CheckFreeSpace
 #define UART2Transmit       Uart2Transmit
+#define UART2TransmitBuffer Uart2TransmitBuffer
 #define UART2SendMessage    Uart2SendMessage
 #define UART2ChAvailable    Uart2ChAvailable
 #define UART2Getch          Uart2Getch
+#define UART2ReadBulk       Uart2ReadBulk
 #define UART2TxRunning      Uart2TxRunning
 #define UART2SetBaudrate    Uart2SetBaudrate
 
@@ -153,9 +199,11 @@ extern void uart3_init(void);
 #define Uart3Init() uart_periph_init(&uart3)
 #define Uart3CheckFreeSpace(_x) uart_check_free_space(&uart3, _x)
 #define Uart3Transmit(_x) uart_transmit(&uart3, _x)
+#define Uart3TransmitBuffer(_b, _l) uart_transmit_buffer(&uart3, _b, _l)
 #define Uart3SendMessage() {}
 #define Uart3ChAvailable() UartChAvailable(uart3)
 #define Uart3Getch() UartGetch(uart3)
+#define Uart3ReadBulk(_b, _l) uart_read_bulk(&uart3, _b, _l)
 #define Uart3TxRunning uart3.tx_running
 #define Uart3SetBaudrate(_b) uart_periph_set_baudrate(&uart3, _b)
 //#define Uart3InitParam(_b, _m, _fm) uart_periph_init_param(&uart3, _b, _m, _fm, "")
@@ -163,9 +211,11 @@ extern void uart3_init(void);
 #define UART3Init           Uart3Init
 #define UART3CheckFreeSpace Uart3CheckFreeSpace
 #define UART3Transmit       Uart3Transmit
+#define UART3TransmitBuffer Uart3TransmitBuffer
 #define UART3SendMessage    Uart3SendMessage
 #define UART3ChAvailable    Uart3ChAvailable
 #define UART3Getch          Uart3Getch
+#define UART3ReadBulk       Uart3ReadBulk
 #define UART3TxRunning      Uart3TxRunning
 #define UART3SetBaudrate    Uart3SetBaudrate
 
@@ -178,9 +228,11 @@ extern void uart5_init(void);
 #define Uart5Init() uart_periph_init(&uart5)
 #define Uart5CheckFreeSpace(_x) uart_check_free_space(&uart5, _x)
 #define Uart5Transmit(_x) uart_transmit(&uart5, _x)
+#define Uart5TransmitBuffer(_b, _l) uart_transmit_buffer(&uart5, _b, _l)
 #define Uart5SendMessage() {}
 #define Uart5ChAvailable() UartChAvailable(uart5)
 #define Uart5Getch() UartGetch(uart5)
+#define Uart5ReadBulk(_b, _l) uart_read_bulk(&uart5, _b, _l)
 #define Uart5TxRunning uart5.tx_running
 #define Uart5SetBaudrate(_b) uart_periph_set_baudrate(&uart5, _b)
 //#define Uart5InitParam(_b, _m, _fm) uart_periph_init_param(&uart5, _b, _m, _fm, "")
@@ -188,9 +240,11 @@ extern void uart5_init(void);
 #define UART5Init           Uart5Init
 #define UART5CheckFreeSpace Uart5CheckFreeSpace
 #define UART5Transmit       Uart5Transmit
+#define UART5TransmitBuffer Uart5TransmitBuffer
 #define UART5SendMessage    Uart5SendMessage
 #define UART5ChAvailable    Uart5ChAvailable
 #define UART5Getch          Uart5Getch
+#define UART5ReadBulk       Uart5ReadBulk
 #define UART5TxRunning      Uart5TxRunning
 #define UART5SetBaudrate    Uart5SetBaudrate
 
@@ -45,6 +45,10 @@ void VCOM_allow_linecoding(uint8_t mode);
 #define UsbSInit() VCOM_init()
 #define UsbSCheckFreeSpace(_x) VCOM_check_free_space(_x)
 #define UsbSTransmit(_x) VCOM_putchar(_x)
+#define UsbSTransmitBuffer(_b, _l) {                    \
+    uint16_t _i;                                        \
+    for (_i = 0; _i < (_l); _i++) VCOM_putchar((_b)[_i]); \
+  }
 #define UsbSSendMessage() {}
 #define UsbSGetch() VCOM_getchar()
 #define UsbSChAvailable() VCOM_check_available()
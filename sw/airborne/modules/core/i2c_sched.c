@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2011  The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "core/i2c_sched.h"
+
+#include "mcu_periph/uart.h"
+#include "messages.h"
+#ifndef DOWNLINK_DEVICE
+#define DOWNLINK_DEVICE DOWNLINK_AP_DEVICE
+#endif
+#include "downlink.h"
+
+/* next device to report */
+static uint8_t i2c_sched_report_idx;
+
+void i2c_sched_report(void) {
+  uint8_t id = i2c_sched_report_idx;
+  struct i2c_sched_dev* d;
+  uint16_t latency_ms;
+
+  if (i2c_sched_nb_dev == 0)
+    return;
+  if (id >= i2c_sched_nb_dev) id = 0;
+  i2c_sched_report_idx = id + 1;
+
+  d = &i2c_sched_dev[id];
+  latency_ms = (uint16_t)((uint32_t)d->max_latency * 1000 / I2C_SCHED_FREQ);
+  DOWNLINK_SEND_I2C_SCHED(DefaultChannel, &id, &d->trans->slave_addr, &d->prio,
+      &d->nb_req, &d->nb_merged, &d->nb_late, &latency_ms);
+  d->nb_req = 0;
+  d->nb_merged = 0;
+  d->nb_late = 0;
+  d->max_latency = 0;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2011  The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file i2c_sched.h
+ *
+ * Telemetry of the I2C transaction scheduler (see mcu_periph/i2c.h)
+ */
+
+#ifndef I2C_SCHED_H
+#define I2C_SCHED_H
+
+#include "std.h"
+#include "mcu_periph/i2c.h"
+
+/** Report the statistics of one device with I2C_SCHED and reset them
+ *  Devices are sent in turn.
+ */
+void i2c_sched_report(void);
+
+#endif /* I2C_SCHED_H */
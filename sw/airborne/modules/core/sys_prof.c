@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2011  The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "core/sys_prof.h"
+#include "generated/modules.h"
+
+#define SYS_PROF_NB (SYS_PROF_CORE_NB + SYS_PROF_MODULES_NB)
+
+struct sys_prof_entry sys_prof[SYS_PROF_NB];
+
+/* next entry to report */
+static uint8_t sys_prof_idx;
+
+static inline void sys_prof_reset(struct sys_prof_entry* e) {
+  e->sum = 0;
+  e->min = 0;
+  e->max = 0;
+  e->nb = 0;
+}
+
+#include "mcu_periph/uart.h"
+#include "messages.h"
+#ifndef DOWNLINK_DEVICE
+#define DOWNLINK_DEVICE DOWNLINK_AP_DEVICE
+#endif
+#include "downlink.h"
+
+#define SysProfUsec(_t) ((_t) > 0xFFFF ? 0xFFFF : (uint16_t)(_t))
+
+void sys_prof_report(void) {
+  uint8_t n;
+  /** Send the next entry which has been called */
+  for (n = 0; n < SYS_PROF_NB; n++) {
+    uint8_t id = sys_prof_idx;
+    struct sys_prof_entry* e = &sys_prof[id];
+    sys_prof_idx++;
+    if (sys_prof_idx >= SYS_PROF_NB) sys_prof_idx = 0;
+    if (e->nb > 0) {
+      uint32_t min = USEC_OF_SYS_TICS(e->min);
+      uint32_t avg = USEC_OF_SYS_TICS(e->sum / e->nb);
+      uint32_t max = USEC_OF_SYS_TICS(e->max);
+      uint16_t min_us = SysProfUsec(min);
+      uint16_t avg_us = SysProfUsec(avg);
+      uint16_t max_us = SysProfUsec(max);
+      DOWNLINK_SEND_SYS_PROF(DefaultChannel, &id, &e->nb, &min_us, &avg_us, &max_us);
+      sys_prof_reset(e);
+      return;
+    }
+  }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2011  The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file sys_prof.h
+ *
+ * Execution time profiling
+ * min/avg/max time of the module init/periodic/event functions and of
+ * the AHRS/INS calls of the main loop.
+ *
+ * Calls are wrapped with SysProfStart(id)/SysProfStop(id), by the
+ * generated modules code and by the main loop. Core entries come first,
+ * followed by the SYS_PROF_MODULES_NB entries of the generated modules
+ * (see generated/modules.h for the names). Profiling is only done on
+ * the ap target (SYS_PROF defined): otherwise, or without this module,
+ * the macros are the empty ones of generated/modules.h.
+ * The table is cleared statically, so that the calls made before the init
+ * of this module (init of the other modules) are counted as well.
+ */
+
+#ifndef SYS_PROF_H
+#define SYS_PROF_H
+
+#include "std.h"
+#include "sys_time.h"
+
+/** Entries of the main loop */
+enum sys_prof_core_id {
+  SYS_PROF_AHRS_PROPAGATE,
+  SYS_PROF_AHRS_UPDATE_ACCEL,
+  SYS_PROF_AHRS_UPDATE_MAG,
+  SYS_PROF_INS_PROPAGATE,
+  SYS_PROF_INS_UPDATE_BARO,
+  SYS_PROF_INS_UPDATE_GPS,
+  SYS_PROF_CORE_NB
+};
+
+struct sys_prof_entry {
+  uint32_t start; ///< timer at the start of the current call
+  uint32_t sum;   ///< sum of the call times since the last report, in sys tics
+  uint32_t min;   ///< only valid if nb > 0
+  uint32_t max;
+  uint32_t nb;    ///< number of calls since the last report
+};
+
+#ifdef SYS_PROF
+
+extern struct sys_prof_entry sys_prof[];
+
+#define SysProfStart(_id) SysTimeTimerStart(sys_prof[_id].start)
+#define SysProfStop(_id) sys_prof_stop(&sys_prof[_id], SysTimeTimer(sys_prof[_id].start))
+
+static inline void sys_prof_stop(struct sys_prof_entry* e, uint32_t t) {
+  e->sum += t;
+  if (e->nb == 0 || t < e->min) e->min = t;
+  if (t > e->max) e->max = t;
+  e->nb++;
+}
+
+/** Report one entry with SYS_PROF and reset it
+ *  Entries are sent in turn, unused ones are skipped
+ */
+void sys_prof_report(void);
+
+#else /* SYS_PROF */
+
+#define sys_prof_report() {}
+
+#endif /* SYS_PROF */
+
+#endif /* SYS_PROF_H */
@@ -42,6 +42,12 @@ void gps_i2c_periodic(void);
 #define gps_i2cEvent() { if (gps_i2c_done) gps_i2c_event(); }
 #define gps_i2cChAvailable() (gps_i2c_rx_insert_idx != gps_i2c_rx_extract_idx)
 #define gps_i2cGetch() (gps_i2c_rx_buf[gps_i2c_rx_extract_idx++])
+#define gps_i2cReadBulk(_b, _l) ({                                      \
+  uint16_t _n = 0;                                                      \
+  while (_n < (_l) && gps_i2cChAvailable())                             \
+    (_b)[_n++] = gps_i2cGetch();                                        \
+  _n;                                                                   \
+})
 #define gps_i2cTransmit(_char) {             \
   if (! gps_i2c_data_ready_to_transmit)  /* Else transmitting, overrun*/     \
     gps_i2c_tx_buf[gps_i2c_tx_insert_idx++] = _char; \
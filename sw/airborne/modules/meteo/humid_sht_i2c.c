@@ -45,6 +45,14 @@
 
 #define SHT_SLAVE_ADDR 0x80
 
+/* priority and max transaction rate on a shared bus, see mcu_periph/i2c.h */
+#ifndef SHT_I2C_PRIO
+#define SHT_I2C_PRIO I2C_SCHED_PRIO_LOW
+#endif
+#ifndef SHT_I2C_PERIOD
+#define SHT_I2C_PERIOD 0.05
+#endif
+
 struct i2c_transaction sht_trans;
 uint8_t sht_status;
 uint8_t sht_serial[8] = {0};
@@ -72,6 +80,7 @@ int8_t humid_sht_crc(volatile uint8_t* data) {
 
 void humid_sht_init_i2c(void) {
   sht_status = SHT2_UNINIT;
+  I2CSchedRegister(SHT_I2C_DEV, sht_trans, SHT_I2C_PRIO, I2C_SCHED_TICKS_OF_SEC(SHT_I2C_PERIOD), I2C_SCHED_TICKS_OF_SEC(0.25));
 }
 
 void humid_sht_periodic_i2c( void ) {
@@ -47,6 +47,11 @@
 /* address can be 0xEC or 0xEE (CSB\ high = 0xEC) */
 #define MS5611_SLAVE_ADDR 0xEC
 
+/* priority on a shared bus, see mcu_periph/i2c.h */
+#ifndef MS5611_I2C_PRIO
+#define MS5611_I2C_PRIO I2C_SCHED_PRIO_NORMAL
+#endif
+
 #if PERIODIC_FREQUENCY > 60
 #error baro_ms5611_i2c assumes a PERIODIC_FREQUENCY of 60Hz
 #endif
@@ -80,6 +85,7 @@ static int8_t baro_ms5611_crc(uint16_t* prom) {
 void baro_ms5611_init(void) {
   ms5611_status = MS5611_UNINIT;
   prom_cnt = 0;
+  I2CSchedRegister(MS5611_I2C_DEV, ms5611_trans, MS5611_I2C_PRIO, 0, I2C_SCHED_TICKS_OF_SEC(0.02));
 }
 
 void baro_ms5611_periodic( void ) {
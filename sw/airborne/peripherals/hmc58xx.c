@@ -26,6 +26,11 @@
 #include "peripherals/hmc58xx.h"
 #include "std.h"
 
+/* priority of the mag on a shared bus, see mcu_periph/i2c.h */
+#ifndef HMC58XX_I2C_PRIO
+#define HMC58XX_I2C_PRIO I2C_SCHED_PRIO_HIGH
+#endif
+
 #define HMC_CONF_UNINIT 0
 #define HMC_CONF_CRA    1
 #define HMC_CONF_CRB    2
@@ -51,6 +56,7 @@ void hmc58xx_init(void)
   hmc58xx_i2c_trans.slave_addr = HMC58XX_ADDR;
   hmc58xx_initialized = FALSE;
   hmc58xx_init_status = HMC_CONF_UNINIT;
+  I2CSchedRegister(HMC58XX_I2C_DEVICE, hmc58xx_i2c_trans, HMC58XX_I2C_PRIO, 0, I2C_SCHED_TICKS_OF_SEC(0.02));
 }
 
 // Configuration function called once before normal use
@@ -31,3 +31,9 @@ volatile bool_t pprz_msg_received = FALSE;
 uint8_t pprz_ovrn, pprz_error;
 volatile uint8_t pprz_payload_len;
 uint8_t pprz_payload[PPRZ_PAYLOAD_LEN];
+
+#ifdef PPRZ_TRANSPORT_BUFFERED
+uint8_t pprz_tx_frame[PPRZ_TX_FRAME_LEN];
+uint8_t pprz_tx_idx;
+bool_t pprz_tx_overflow;
+#endif
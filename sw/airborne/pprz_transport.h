@@ -58,6 +58,8 @@ extern uint8_t ck_a, ck_b;
 #define PprzTransportPut1Byte(_x) Link(Transmit(_x))
 #define PprzTransportSendMessage() Link(SendMessage())
 
+#ifndef PPRZ_TRANSPORT_BUFFERED
+
 #define PprzTransportHeader(payload_len) { \
   PprzTransportPut1Byte(STX);				\
   uint8_t msg_len = PprzTransportSizeOf(payload_len);	\
@@ -134,6 +136,124 @@ extern uint8_t ck_a, ck_b;
 
 #define PprzTransportPutUint8Array(_n, _x) PprzTransportPutArray(PprzTransportPutUint8ByAddr, _n, _x)
 
+#else /* PPRZ_TRANSPORT_BUFFERED */
+
+/** Buffered mode
+ *
+ *  The whole frame is built in pprz_tx_frame (fields are copied with
+ *  memcpy), the checksum is computed in a single pass by the trailer
+ *  and the frame is handed to the device with one TransmitBuffer call.
+ *  As with ck_a/ck_b, only one message can be built at a time.
+ *  A payload which does not fit in the frame is not copied, the whole
+ *  frame is dropped by the trailer and counted in downlink_nb_ovrn.
+ */
+
+#include <string.h>
+
+/** max frame length, length field is 8 bits */
+#define PPRZ_TX_FRAME_LEN 256
+
+extern uint8_t pprz_tx_frame[PPRZ_TX_FRAME_LEN];
+extern uint8_t pprz_tx_idx;
+extern bool_t pprz_tx_overflow;
+extern uint8_t downlink_nb_ovrn;
+
+/** room left for _n bytes and the checksum, the whole frame length must fit in 8 bits */
+#define PprzTransportTxFits(_n) (pprz_tx_idx + (_n) + 2 <= 255)
+
+#define PprzTransportHeader(payload_len) { \
+  pprz_tx_frame[0] = STX;				\
+  pprz_tx_frame[1] = PprzTransportSizeOf(payload_len);	\
+  pprz_tx_idx = 2;					\
+  pprz_tx_overflow = FALSE;				\
+}
+
+#define PprzTransportTrailer() { \
+  uint8_t _i; \
+  if (pprz_tx_overflow) { \
+    downlink_nb_ovrn++; \
+  } \
+  else { \
+    ck_a = 0; ck_b = 0; \
+    for (_i = 1; _i < pprz_tx_idx; _i++) { \
+      ck_a += pprz_tx_frame[_i]; \
+      ck_b += ck_a; \
+    } \
+    pprz_tx_frame[pprz_tx_idx++] = ck_a; \
+    pprz_tx_frame[pprz_tx_idx++] = ck_b; \
+    Link(TransmitBuffer(pprz_tx_frame, pprz_tx_idx)); \
+    PprzTransportSendMessage() \
+  } \
+}
+
+#define PprzTransportPutBytes(_src, _n) { \
+  if (PprzTransportTxFits(_n)) { \
+    memcpy(&pprz_tx_frame[pprz_tx_idx], (const void*)(_src), _n); \
+    pprz_tx_idx += _n; \
+  } \
+  else \
+    pprz_tx_overflow = TRUE; \
+}
+
+#define PprzTransportPutUint8(_byte) { \
+  if (PprzTransportTxFits(1)) \
+    pprz_tx_frame[pprz_tx_idx++] = _byte; \
+  else \
+    pprz_tx_overflow = TRUE; \
+}
+
+#define PprzTransportPutNamedUint8(_name, _byte) PprzTransportPutUint8(_byte)
+
+#define PprzTransportPut1ByteByAddr(_byte) PprzTransportPutUint8(*(const uint8_t*)(_byte))
+#define PprzTransportPut2ByteByAddr(_byte) PprzTransportPutBytes(_byte, 2)
+#define PprzTransportPut4ByteByAddr(_byte) PprzTransportPutBytes(_byte, 4)
+
+#ifdef __IEEE_BIG_ENDIAN /* From machine/ieeefp.h */
+#define PprzTransportPutDoubleByAddr(_byte) { \
+    PprzTransportPutBytes((const uint8_t*)_byte+4, 4);	\
+    PprzTransportPutBytes((const uint8_t*)_byte, 4);	\
+  }
+#else
+#define PprzTransportPutDoubleByAddr(_byte) PprzTransportPutBytes(_byte, 8)
+#endif
+
+#define PprzTransportPutInt8ByAddr(_x) PprzTransportPut1ByteByAddr(_x)
+#define PprzTransportPutUint8ByAddr(_x) PprzTransportPut1ByteByAddr(_x)
+#define PprzTransportPutInt16ByAddr(_x) PprzTransportPut2ByteByAddr(_x)
+#define PprzTransportPutUint16ByAddr(_x) PprzTransportPut2ByteByAddr(_x)
+#define PprzTransportPutInt32ByAddr(_x) PprzTransportPut4ByteByAddr(_x)
+#define PprzTransportPutUint32ByAddr(_x) PprzTransportPut4ByteByAddr(_x)
+#define PprzTransportPutFloatByAddr(_x) PprzTransportPut4ByteByAddr(_x)
+
+/** arrays are copied in one block, elements are in memory order */
+#define PprzTransportPutArray(_n, _x) { \
+  PprzTransportPutUint8(_n); \
+  PprzTransportPutBytes(_x, (_n) * sizeof(_x[0])); \
+}
+
+#define PprzTransportPutFloatArray(_n, _x) PprzTransportPutArray(_n, _x)
+#ifdef __IEEE_BIG_ENDIAN
+#define PprzTransportPutDoubleArray(_n, _x) { \
+  uint8_t _i; \
+  PprzTransportPutUint8(_n); \
+  for(_i = 0; _i < _n; _i++) { \
+    PprzTransportPutDoubleByAddr(&_x[_i]); \
+  } \
+}
+#else
+#define PprzTransportPutDoubleArray(_n, _x) PprzTransportPutArray(_n, _x)
+#endif
+
+#define PprzTransportPutInt16Array(_n, _x) PprzTransportPutArray(_n, _x)
+#define PprzTransportPutUint16Array(_n, _x) PprzTransportPutArray(_n, _x)
+
+#define PprzTransportPutInt32Array(_n, _x) PprzTransportPutArray(_n, _x)
+#define PprzTransportPutUint32Array(_n, _x) PprzTransportPutArray(_n, _x)
+
+#define PprzTransportPutUint8Array(_n, _x) PprzTransportPutArray(_n, _x)
+
+#endif /* PPRZ_TRANSPORT_BUFFERED */
+
 
 /** Receiving pprz messages */
 
@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Fixed point port of ahrs_float_lkf.c, see the comments there for the model.
+ *
+ * The float filter works on full 6x6 matrices and inverts the 3x3
+ * innovation covariance. Here the structure is used instead:
+ *
+ *  - propagation: T = [ I -C' ; 0 I ], so with P = [ A B ; B' D ]
+ *      D is unchanged, B = B - C' D, A = A - C' B' - B_new C
+ *    and only the lower triangle of A is computed.
+ *
+ *  - accel update: H = [ Ha 0 ] with Ha = g * [ -c1 c0 ] (c = columns of C),
+ *    so Ha' Ha = g^2 I and
+ *      K y     = P(:,0:1) inv(Paa + R/g^2 I) v,   v = Ha' y / g^2
+ *      K H P   = P(:,0:1) inv(Paa + R/g^2 I) P(0:1,:)
+ *    where Paa is the 2x2 roll/pitch block: a 2x2 solve instead of the 3x3
+ *    inverse, and v reduces to ( c1.a / g, -c0.a / g ).
+ *
+ *  - mag update: H = [ 0 0 -c1 0 0 0 ], |c1| = 1, so the 3x3 inverse is a
+ *    scalar division by P22 + R, and H' y reduces to c1.mag - hy.
+ *
+ * These only hold for an orthonormal C, which is the case as it is computed
+ * from the normalized quaternion.
+ *
+ * As in the float filter, T does not contain dt.
+ */
+
+#include "ahrs_int_lkf.h"
+
+#include "subsystems/imu.h"
+#include "subsystems/ahrs/ahrs_aligner.h"
+
+#include "generated/airframe.h"
+
+static void ahrs_do_update_accel(void);
+static void ahrs_do_update_mag(void);
+static inline void bail_compute_dcm(void);
+static inline void bail_normalize_quat(void);
+static inline void bail_correct(int64_t g[][2], int32_t pc[][BAIL_SSIZE], int64_t* v, int nc);
+
+/* our estimated attitude  (ltp <-> imu)      */
+struct Int32Quat bail_quat;
+/* our estimated gyro biases                  */
+struct Int32Rates bail_bias;
+/* we get unbiased body rates as byproduct    */
+struct Int32Rates bail_rates;
+/* C n->b rotation matrix representation */
+struct Int32RMat bail_dcm;
+
+/* error covariance matrix */
+int32_t bail_P[BAIL_SSIZE][BAIL_SSIZE];
+/* filter state */
+int32_t bail_X[BAIL_SSIZE];
+
+/* low pass of accel measurements, with BAIL_ACCEL_FRAC */
+#define BAIL_ACCEL_FRAC (INT32_ACCEL_FRAC + 4)
+struct Int32Vect3 bail_accel_measure;
+
+int32_t bail_R_accel;
+int32_t bail_R_mag;
+int32_t bail_Q_att;
+int32_t bail_Q_gyro;
+
+/* tuning of ahrs_float_lkf */
+#define BAIL_hy 0.0
+#define BAIL_Q_GYRO 1e-04
+#define BAIL_Q_ATT  0
+#define BAIL_SIGMA_ACCEL 1000.0
+#define BAIL_SIGMA_MAG   20.
+
+#ifndef AHRS_PROPAGATE_FREQUENCY
+#define AHRS_PROPAGATE_FREQUENCY 512
+#endif
+
+#define BAIL_QUAT_ONE (1 << BAIL_QUAT_FRAC)
+
+/* rounded right shift of an int64 */
+#define BAIL_RSHIFT(_v, _s) (((_v) + ((int64_t)1 << ((_s) - 1))) >> (_s))
+
+/* from C (BAIL_QUAT_FRAC) times a bias error to an attitude error */
+#define BAIL_PROP_SHIFT (BAIL_QUAT_FRAC + BAIL_BIAS_SCALE - BAIL_ATT_SCALE)
+
+/* gains for a state of scale _i have BAIL_GAIN_FRAC(_i) */
+#define BAIL_GAIN_FRAC(_i) (BAIL_QUAT_FRAC + BAIL_SCALE(_i) - BAIL_ATT_SCALE)
+/* and times a normalized innovation (BAIL_QUAT_FRAC), shift to the X fraction */
+#define BAIL_X_SHIFT(_i) ((_i) < 3 ? BAIL_GAIN_FRAC(_i) :		\
+                          BAIL_GAIN_FRAC(_i) + BAIL_QUAT_FRAC - BAIL_RATE_FRAC)
+
+static inline int32_t bail_sat(int64_t v) {
+  if (v > INT32_MAX) return INT32_MAX;
+  if (v < -INT32_MAX) return -INT32_MAX;
+  return v;
+}
+
+#define AHRS_TO_BFP() {							\
+    /* IMU rate */							\
+    INT_RATES_RSHIFT(ahrs.imu_rate, bail_rates, BAIL_RATE_FRAC - INT32_RATE_FRAC); \
+    /* LTP to IMU quaternion */						\
+    QUAT_ASSIGN(ahrs.ltp_to_imu_quat,					\
+                BAIL_RSHIFT((int64_t)bail_quat.qi, BAIL_QUAT_FRAC - INT32_QUAT_FRAC), \
+                BAIL_RSHIFT((int64_t)bail_quat.qx, BAIL_QUAT_FRAC - INT32_QUAT_FRAC), \
+                BAIL_RSHIFT((int64_t)bail_quat.qy, BAIL_QUAT_FRAC - INT32_QUAT_FRAC), \
+                BAIL_RSHIFT((int64_t)bail_quat.qz, BAIL_QUAT_FRAC - INT32_QUAT_FRAC)); \
+    /* LTP to IMU rotation matrix */					\
+    for (int _i = 0; _i < 9; _i++)					\
+      ahrs.ltp_to_imu_rmat.m[_i] = BAIL_RSHIFT((int64_t)bail_dcm.m[_i], BAIL_QUAT_FRAC - INT32_TRIG_FRAC); \
+    /* LTP to IMU eulers      */					\
+    INT32_EULERS_OF_RMAT(ahrs.ltp_to_imu_euler, ahrs.ltp_to_imu_rmat);	\
+  }
+
+#define AHRS_LTP_TO_BODY() {						\
+    /* Compute LTP to BODY quaternion */				\
+    INT32_QUAT_COMP_INV(ahrs.ltp_to_body_quat, ahrs.ltp_to_imu_quat, imu.body_to_imu_quat); \
+    /* Compute LTP to BODY rotation matrix */				\
+    INT32_RMAT_COMP_INV(ahrs.ltp_to_body_rmat, ahrs.ltp_to_imu_rmat, imu.body_to_imu_rmat); \
+    /* compute LTP to BODY eulers */					\
+    INT32_EULERS_OF_RMAT(ahrs.ltp_to_body_euler, ahrs.ltp_to_body_rmat); \
+    /* compute body rates */						\
+    INT32_RMAT_TRANSP_RATEMULT(ahrs.body_rate, imu.body_to_imu_rmat, ahrs.imu_rate); \
+  }
+
+/* _a2c = _a2b comp _b2c, with BAIL_QUAT_FRAC */
+#define BAIL_QUAT_COMP(_a2c, _a2b, _b2c) {				\
+    const int64_t _i = (int64_t)(_a2b).qi*(_b2c).qi - (int64_t)(_a2b).qx*(_b2c).qx - (int64_t)(_a2b).qy*(_b2c).qy - (int64_t)(_a2b).qz*(_b2c).qz; \
+    const int64_t _x = (int64_t)(_a2b).qi*(_b2c).qx + (int64_t)(_a2b).qx*(_b2c).qi + (int64_t)(_a2b).qy*(_b2c).qz - (int64_t)(_a2b).qz*(_b2c).qy; \
+    const int64_t _y = (int64_t)(_a2b).qi*(_b2c).qy - (int64_t)(_a2b).qx*(_b2c).qz + (int64_t)(_a2b).qy*(_b2c).qi + (int64_t)(_a2b).qz*(_b2c).qx; \
+    const int64_t _z = (int64_t)(_a2b).qi*(_b2c).qz + (int64_t)(_a2b).qx*(_b2c).qy - (int64_t)(_a2b).qy*(_b2c).qx + (int64_t)(_a2b).qz*(_b2c).qi; \
+    QUAT_ASSIGN(_a2c, BAIL_RSHIFT(_i, BAIL_QUAT_FRAC), BAIL_RSHIFT(_x, BAIL_QUAT_FRAC), \
+                BAIL_RSHIFT(_y, BAIL_QUAT_FRAC), BAIL_RSHIFT(_z, BAIL_QUAT_FRAC)); \
+  }
+
+
+void ahrs_init(void) {
+  int i, j;
+
+  for (i = 0; i < BAIL_SSIZE; i++) {
+    for (j = 0; j < BAIL_SSIZE; j++)
+      bail_P[i][j] = 0;
+    bail_X[i] = 0;
+  }
+  /* initial covariance values */
+  for (i = 0; i < 3; i++) {
+    bail_P[i][i] = BAIL_P_BFP_OF_REAL(1.0, i, i);
+    bail_P[i+3][i+3] = BAIL_P_BFP_OF_REAL(0.1, i+3, i+3);
+  }
+
+  QUAT_ASSIGN(bail_quat, BAIL_QUAT_ONE, 0, 0, 0);
+  INT_RATES_ZERO(bail_bias);
+  INT_RATES_ZERO(bail_rates);
+  bail_compute_dcm();
+
+  ahrs.status = AHRS_UNINIT;
+  INT_EULERS_ZERO(ahrs.ltp_to_body_euler);
+  INT_EULERS_ZERO(ahrs.ltp_to_imu_euler);
+  INT32_QUAT_ZERO(ahrs.ltp_to_body_quat);
+  INT32_QUAT_ZERO(ahrs.ltp_to_imu_quat);
+  INT_RATES_ZERO(ahrs.body_rate);
+  INT_RATES_ZERO(ahrs.imu_rate);
+
+  ahrs_int_lkf_SetRaccel(BAIL_SIGMA_ACCEL);
+  ahrs_int_lkf_SetRmag(BAIL_SIGMA_MAG);
+
+  bail_Q_att = BAIL_P_BFP_OF_REAL(BAIL_Q_ATT, 0, 0);
+  bail_Q_gyro = BAIL_P_BFP_OF_REAL(BAIL_Q_GYRO, 3, 3);
+}
+
+void ahrs_align(void) {
+  INT_RATES_LSHIFT(bail_bias, ahrs_aligner.lp_gyro, BAIL_RATE_FRAC - INT32_RATE_FRAC);
+  INT32_VECT3_LSHIFT(bail_accel_measure, ahrs_aligner.lp_accel, BAIL_ACCEL_FRAC - INT32_ACCEL_FRAC);
+  ahrs.status = AHRS_RUNNING;
+}
+
+static inline void ahrs_lowpass_accel(void) {
+  struct Int32Vect3 accel;
+  INT32_VECT3_LSHIFT(accel, imu.accel, BAIL_ACCEL_FRAC - INT32_ACCEL_FRAC);
+  VECT3_ADD(bail_accel_measure, accel);
+  INT32_VECT3_RSHIFT(bail_accel_measure, bail_accel_measure, 1);
+}
+
+void ahrs_propagate(void) {
+  int i, j, k;
+
+  ahrs_lowpass_accel();
+
+  /* compute unbiased rates */
+  INT_RATES_LSHIFT(bail_rates, imu.gyro, BAIL_RATE_FRAC - INT32_RATE_FRAC);
+  RATES_SUB(bail_rates, bail_bias);
+
+  /*
+   * multiplicative quaternion update with the correction quaternion
+   * qr = [ sqrt(1 - q_sq), rates * dt / 2 ], q_sq as in the float filter.
+   * The angles are below 1e-2, the first order of the square root is
+   * exact at BAIL_QUAT_FRAC.
+   */
+  struct Int32Quat qr;
+  const int64_t dt_2 = 2 * AHRS_PROPAGATE_FREQUENCY;
+  qr.qx = ((int64_t)bail_rates.p << (BAIL_QUAT_FRAC - BAIL_RATE_FRAC)) / dt_2;
+  qr.qy = ((int64_t)bail_rates.q << (BAIL_QUAT_FRAC - BAIL_RATE_FRAC)) / dt_2;
+  qr.qz = ((int64_t)bail_rates.r << (BAIL_QUAT_FRAC - BAIL_RATE_FRAC)) / dt_2;
+  const int64_t q_sq = ((int64_t)qr.qx*qr.qx + (int64_t)qr.qy*qr.qy + (int64_t)qr.qz*qr.qz) >> 2;
+  qr.qi = BAIL_QUAT_ONE - (int32_t)BAIL_RSHIFT(q_sq, BAIL_QUAT_FRAC + 1);
+
+  struct Int32Quat qtemp;
+  BAIL_QUAT_COMP(qtemp, bail_quat, qr);
+  QUAT_COPY(bail_quat, qtemp);
+  bail_normalize_quat();
+
+  /*
+   *  compute all representations
+   */
+  bail_compute_dcm();
+  AHRS_TO_BFP();
+  AHRS_LTP_TO_BODY();
+
+  /*
+   * P_prio = T * P * T_T + Q
+   *
+   *  B = B - C' D           cross attitude/bias, BAIL_P_FRAC(0, 3)
+   *  A = A - C' B' - B C    attitude, BAIL_P_FRAC(0, 0)
+   *  D = D                  bias
+   */
+  int32_t b[3][3];
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      int64_t t = 0;
+      for (k = 0; k < 3; k++)
+        t += (int64_t)RMAT_ELMT(bail_dcm, k, i) * bail_P[3+k][3+j];
+      b[i][j] = bail_sat(bail_P[i][3+j] - BAIL_RSHIFT(t, BAIL_PROP_SHIFT));
+    }
+  }
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j <= i; j++) {
+      int64_t t = 0;
+      for (k = 0; k < 3; k++) {
+        t += (int64_t)RMAT_ELMT(bail_dcm, k, i) * bail_P[j][3+k];
+        t += (int64_t)b[i][k] * RMAT_ELMT(bail_dcm, k, j);
+      }
+      bail_P[i][j] = bail_sat(bail_P[i][j] - BAIL_RSHIFT(t, BAIL_PROP_SHIFT));
+      bail_P[j][i] = bail_P[i][j];
+    }
+  }
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 3; j++) {
+      bail_P[i][3+j] = b[i][j];
+      bail_P[3+j][i] = b[i][j];
+    }
+    bail_P[i][i] += bail_Q_att;
+    bail_P[3+i][3+i] += bail_Q_gyro;
+  }
+}
+
+void ahrs_update_accel(void) {
+  RunOnceEvery(50, ahrs_do_update_accel());
+}
+
+static void ahrs_do_update_accel(void) {
+  int i;
+
+  /*
+   * normalized innovation v = Ha' y / g^2, y = -c2 g - accel
+   *   v0 = c1.accel / g
+   *   v1 = -c0.accel / g
+   */
+  const int64_t c0a = (int64_t)RMAT_ELMT(bail_dcm, 0, 0) * bail_accel_measure.x +
+    (int64_t)RMAT_ELMT(bail_dcm, 1, 0) * bail_accel_measure.y +
+    (int64_t)RMAT_ELMT(bail_dcm, 2, 0) * bail_accel_measure.z;
+  const int64_t c1a = (int64_t)RMAT_ELMT(bail_dcm, 0, 1) * bail_accel_measure.x +
+    (int64_t)RMAT_ELMT(bail_dcm, 1, 1) * bail_accel_measure.y +
+    (int64_t)RMAT_ELMT(bail_dcm, 2, 1) * bail_accel_measure.z;
+  const int64_t g_bfp = BFP_OF_REAL(BAIL_g, BAIL_ACCEL_FRAC);
+  int64_t v[2] = { c1a / g_bfp, -c0a / g_bfp };
+
+  /*
+   * gain G = P(:,0:1) inv(N), N = Paa + R/g^2 I, one row at a time
+   * by elimination on the symmetric 2x2 N
+   */
+  const int64_t r = (int64_t)bail_R_accel << (BAIL_P_FRAC(0, 0) - BAIL_R_FRAC);
+  const int64_t n00 = bail_P[0][0] + r;
+  const int64_t n01 = bail_P[0][1];
+  const int64_t n11 = bail_P[1][1] + r;
+  if (n00 <= 0)
+    return;
+  const int64_t d1 = n11 - n01 * n01 / n00;
+  if (d1 <= 0)
+    return;
+  const int64_t l = (n01 << BAIL_QUAT_FRAC) / n00;
+
+  int32_t pc[2][BAIL_SSIZE];
+  int64_t g[BAIL_SSIZE][2];
+  for (i = 0; i < BAIL_SSIZE; i++) {
+    pc[0][i] = bail_P[i][0];
+    pc[1][i] = bail_P[i][1];
+    const int64_t t = bail_P[i][1] - BAIL_RSHIFT(bail_P[i][0] * l, BAIL_QUAT_FRAC);
+    g[i][1] = (t << BAIL_QUAT_FRAC) / d1;
+    const int64_t u = bail_P[i][0] - BAIL_RSHIFT(g[i][1] * n01, BAIL_QUAT_FRAC);
+    g[i][0] = (u << BAIL_QUAT_FRAC) / n00;
+  }
+
+  bail_correct(g, pc, v, 2);
+}
+
+void ahrs_update_mag(void) {
+  RunOnceEvery(10, ahrs_do_update_mag());
+}
+
+static void ahrs_do_update_mag(void) {
+  int i;
+
+  /* normalized innovation v = H' y = c1.mag - hy */
+  const int64_t c1m = (int64_t)RMAT_ELMT(bail_dcm, 0, 1) * imu.mag.x +
+    (int64_t)RMAT_ELMT(bail_dcm, 1, 1) * imu.mag.y +
+    (int64_t)RMAT_ELMT(bail_dcm, 2, 1) * imu.mag.z;
+  int64_t v[1] = { BAIL_RSHIFT(c1m, INT32_MAG_FRAC) - BFP_OF_REAL(BAIL_hy, BAIL_QUAT_FRAC) };
+
+  /* gain G = P(:,2) / (P22 + R) */
+  const int64_t s = bail_P[2][2] + ((int64_t)bail_R_mag << (BAIL_P_FRAC(0, 0) - BAIL_R_FRAC));
+  if (s <= 0)
+    return;
+
+  int32_t pc[1][BAIL_SSIZE];
+  int64_t g[BAIL_SSIZE][2];
+  for (i = 0; i < BAIL_SSIZE; i++) {
+    pc[0][i] = bail_P[i][2];
+    g[i][0] = ((int64_t)bail_P[i][2] << BAIL_QUAT_FRAC) / s;
+  }
+
+  bail_correct(g, pc, v, 1);
+}
+
+void ahrs_update(void) {
+  ahrs_update_accel();
+  ahrs_update_mag();
+}
+
+/*
+ * Common end of both updates, with the gain g on the nc columns pc of P_prio:
+ *   X = g * v
+ *   P = P_prio - g * pc'
+ * then correct the attitude and the gyro bias with X.
+ */
+static inline void bail_correct(int64_t g[][2], int32_t pc[][BAIL_SSIZE], int64_t* v, int nc) {
+  int i, j, k;
+
+  for (i = 0; i < BAIL_SSIZE; i++) {
+    int64_t x = 0;
+    for (k = 0; k < nc; k++)
+      x += g[i][k] * v[k];
+    bail_X[i] = BAIL_RSHIFT(x, BAIL_X_SHIFT(i));
+    for (j = 0; j <= i; j++) {
+      int64_t t = 0;
+      for (k = 0; k < nc; k++)
+        t += g[i][k] * pc[k][j];
+      bail_P[i][j] -= BAIL_RSHIFT(t, BAIL_QUAT_FRAC);
+      bail_P[j][i] = bail_P[i][j];
+    }
+  }
+
+  /*
+   *  error quaternion, inverted: [ sqrt(1 - q_sq), -X/2 ]
+   *  the errors are below 0.1 rad, the second order of the square root
+   *  is enough.
+   */
+  struct Int32Quat q_err;
+  q_err.qx = -(bail_X[0] >> 1);
+  q_err.qy = -(bail_X[1] >> 1);
+  q_err.qz = -(bail_X[2] >> 1);
+  const int64_t q_sq = ((int64_t)q_err.qx*q_err.qx + (int64_t)q_err.qy*q_err.qy + (int64_t)q_err.qz*q_err.qz) >> BAIL_QUAT_FRAC;
+  q_err.qi = BAIL_QUAT_ONE - (q_sq >> 1) - ((q_sq * q_sq) >> (BAIL_QUAT_FRAC + 3));
+
+  /*  correct attitude
+   */
+  struct Int32Quat qtemp;
+  BAIL_QUAT_COMP(qtemp, q_err, bail_quat);
+  QUAT_COPY(bail_quat, qtemp);
+  bail_normalize_quat();
+
+  /*  correct gyro bias
+   */
+  bail_bias.p -= bail_X[3];
+  bail_bias.q -= bail_X[4];
+  bail_bias.r -= bail_X[5];
+
+  /*
+   *  compute all representations
+   */
+  bail_compute_dcm();
+  AHRS_TO_BFP();
+  AHRS_LTP_TO_BODY();
+}
+
+/*
+ * The quaternion stays close to unit, one Newton iteration of 1/sqrt
+ * around 1 is enough: q = q * (3 - |q|^2) / 2
+ */
+static inline void bail_normalize_quat(void) {
+  const int64_t n2 = (int64_t)bail_quat.qi*bail_quat.qi + (int64_t)bail_quat.qx*bail_quat.qx +
+    (int64_t)bail_quat.qy*bail_quat.qy + (int64_t)bail_quat.qz*bail_quat.qz;
+  const int64_t f = ((((int64_t)3) << (2*BAIL_QUAT_FRAC)) - n2) >> (BAIL_QUAT_FRAC + 1);
+  bail_quat.qi = BAIL_RSHIFT(bail_quat.qi * f, BAIL_QUAT_FRAC);
+  bail_quat.qx = BAIL_RSHIFT(bail_quat.qx * f, BAIL_QUAT_FRAC);
+  bail_quat.qy = BAIL_RSHIFT(bail_quat.qy * f, BAIL_QUAT_FRAC);
+  bail_quat.qz = BAIL_RSHIFT(bail_quat.qz * f, BAIL_QUAT_FRAC);
+}
+
+/* rotation matrix of the quaternion, as FLOAT_RMAT_OF_QUAT, with BAIL_QUAT_FRAC */
+static inline void bail_compute_dcm(void) {
+  const int64_t qx2  = (int64_t)bail_quat.qx*bail_quat.qx;
+  const int64_t qy2  = (int64_t)bail_quat.qy*bail_quat.qy;
+  const int64_t qz2  = (int64_t)bail_quat.qz*bail_quat.qz;
+  const int64_t qiqx = (int64_t)bail_quat.qi*bail_quat.qx;
+  const int64_t qiqy = (int64_t)bail_quat.qi*bail_quat.qy;
+  const int64_t qiqz = (int64_t)bail_quat.qi*bail_quat.qz;
+  const int64_t qxqy = (int64_t)bail_quat.qx*bail_quat.qy;
+  const int64_t qxqz = (int64_t)bail_quat.qx*bail_quat.qz;
+  const int64_t qyqz = (int64_t)bail_quat.qy*bail_quat.qz;
+  const int s = BAIL_QUAT_FRAC - 1;
+  RMAT_ELMT(bail_dcm, 0, 0) = BAIL_QUAT_ONE - BAIL_RSHIFT(qy2 + qz2, s);
+  RMAT_ELMT(bail_dcm, 0, 1) = BAIL_RSHIFT(qxqy + qiqz, s);
+  RMAT_ELMT(bail_dcm, 0, 2) = BAIL_RSHIFT(qxqz - qiqy, s);
+  RMAT_ELMT(bail_dcm, 1, 0) = BAIL_RSHIFT(qxqy - qiqz, s);
+  RMAT_ELMT(bail_dcm, 1, 1) = BAIL_QUAT_ONE - BAIL_RSHIFT(qx2 + qz2, s);
+  RMAT_ELMT(bail_dcm, 1, 2) = BAIL_RSHIFT(qyqz + qiqx, s);
+  RMAT_ELMT(bail_dcm, 2, 0) = BAIL_RSHIFT(qxqz + qiqy, s);
+  RMAT_ELMT(bail_dcm, 2, 1) = BAIL_RSHIFT(qyqz - qiqx, s);
+  RMAT_ELMT(bail_dcm, 2, 2) = BAIL_QUAT_ONE - BAIL_RSHIFT(qx2 + qy2, s);
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Fixed point version of the error state Kalman filter of ahrs_float_lkf.
+ *
+ * Same model, same tuning, same update schedule. The state is
+ * attitude error (rad) and gyro bias error (rad/s).
+ *
+ * Representations:
+ *  bail_quat, bail_dcm : BAIL_QUAT_FRAC (30), so that the 512Hz
+ *                        integration does not lose the small increments
+ *  bail_bias, bail_rates : BAIL_RATE_FRAC (24)
+ *  bail_X  : attitude errors with BAIL_QUAT_FRAC, bias errors with BAIL_RATE_FRAC
+ *  bail_P  : the state is scaled by 2^BAIL_ATT_SCALE for attitude errors and
+ *            2^BAIL_BIAS_SCALE for bias errors, P[i][j] is stored with
+ *            BAIL_P_FRAC(i, j) = scale(i) + scale(j):
+ *              attitude block : 16, range +-32768 rad^2
+ *              cross block    : 22, range +-512 rad^2/s
+ *              bias block     : 28, range +-8 (rad/s)^2, LSB 3.7e-9
+ *            which covers the float filter (attitude variances up to a few
+ *            thousands with the default tuning, bias variances down to 1e-4).
+ */
+
+#ifndef AHRS_INT_LKF_H
+#define AHRS_INT_LKF_H
+
+#include "subsystems/ahrs.h"
+#include "std.h"
+#include "math/pprz_algebra_int.h"
+
+#define BAIL_QUAT_FRAC  30
+#define BAIL_RATE_FRAC  24
+
+#define BAIL_ATT_SCALE   8
+#define BAIL_BIAS_SCALE 14
+#define BAIL_SCALE(_i) ((_i) < 3 ? BAIL_ATT_SCALE : BAIL_BIAS_SCALE)
+#define BAIL_P_FRAC(_i, _j) (BAIL_SCALE(_i) + BAIL_SCALE(_j))
+
+#define BAIL_P_BFP_OF_REAL(_v, _i, _j) BFP_OF_REAL((_v), BAIL_P_FRAC(_i, _j))
+#define BAIL_P_FLOAT_OF_BFP(_v, _i, _j) FLOAT_OF_BFP((_v), BAIL_P_FRAC(_i, _j))
+
+extern struct Int32Quat   bail_quat;
+extern struct Int32Rates  bail_bias;
+extern struct Int32Rates  bail_rates;
+extern struct Int32RMat   bail_dcm;
+
+extern struct Int32Vect3  bail_accel_measure;
+
+#define BAIL_SSIZE 6
+extern int32_t bail_P[BAIL_SSIZE][BAIL_SSIZE];
+extern int32_t bail_X[BAIL_SSIZE];
+
+/*
+ * measurement noise variances with BAIL_R_FRAC.
+ * The accel one is divided by g^2: the accel update works on tilt angles.
+ */
+#define BAIL_R_FRAC 8
+#define BAIL_g 9.81
+extern int32_t bail_R_accel;
+extern int32_t bail_R_mag;
+
+extern int32_t bail_Q_att;
+extern int32_t bail_Q_gyro;
+
+/* standard deviations as real numbers, as ahrs_float_lkf_SetRaccel/SetRmag */
+#define ahrs_int_lkf_SetRaccel(_v) {					\
+    bail_R_accel = BFP_OF_REAL((_v) * (_v) / (BAIL_g * BAIL_g), BAIL_R_FRAC); \
+  }
+#define ahrs_int_lkf_SetRmag(_v) {					\
+    bail_R_mag = BFP_OF_REAL((_v) * (_v), BAIL_R_FRAC);		\
+  }
+
+#endif /* AHRS_INT_LKF_H */
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "subsystems/gps/gps_frame.h"
+
+#include <string.h>
+
+void gps_frame_init(struct gps_frame* f, const struct gps_frame_proto* proto) {
+  f->proto = proto;
+  /* raw is aligned, shift buf so that the payload is */
+  f->buf = f->raw + ((4 - (proto->payload_offset & 3)) & 3);
+  f->idx = 0;
+  f->len = 0;
+  f->available = FALSE;
+  f->error_cnt = 0;
+  f->error_last = GPS_FRAME_ERR_NONE;
+  f->in_idx = 0;
+  f->in_len = 0;
+}
+
+static inline const uint8_t* gps_frame_sync(const struct gps_frame_proto* p,
+                                            const uint8_t* data, uint16_t len) {
+  if (p->sync1 == p->sync1_alt)
+    return memchr(data, p->sync1, len);
+  for (; len > 0; data++, len--) {
+    if (*data == p->sync1 || *data == p->sync1_alt)
+      return data;
+  }
+  return NULL;
+}
+
+/* drop the current frame, a new one may start in the header already copied */
+static void gps_frame_error(struct gps_frame* f, uint8_t error) {
+  f->error_last = error;
+  f->error_cnt++;
+  f->len = 0;
+  if (f->proto->frame_len != NULL && f->idx > 1 && f->idx <= f->proto->header_len) {
+    const uint8_t* s = gps_frame_sync(f->proto, f->buf + 1, f->idx - 1);
+    if (s != NULL) {
+      f->idx = f->buf + f->idx - s;
+      memmove(f->buf, s, f->idx);
+      return;
+    }
+  }
+  f->idx = 0;
+}
+
+uint16_t gps_frame_parse(struct gps_frame* f, const uint8_t* data, uint16_t len) {
+  const struct gps_frame_proto* p = f->proto;
+  uint16_t n = 0;
+  uint16_t chunk;
+
+  while (!f->available && n < len) {
+    if (f->idx == 0) {
+      const uint8_t* s = gps_frame_sync(p, &data[n], len - n);
+      if (s == NULL)
+        return len;
+      n = s - data;
+      f->buf[0] = data[n++];
+      f->idx = 1;
+      f->len = 0;
+      continue;
+    }
+
+    if (f->len == 0) {
+      if (p->frame_len != NULL) {
+        if (f->idx < p->header_len) {
+          chunk = Min(p->header_len - f->idx, len - n);
+          memcpy(&f->buf[f->idx], &data[n], chunk);
+          f->idx += chunk;
+          n += chunk;
+          if (f->idx < p->header_len)
+            return n;
+        }
+        f->len = p->frame_len(f->buf);
+        if (f->len == 0) {
+          gps_frame_error(f, GPS_FRAME_ERR_OUT_OF_SYNC);
+          continue;
+        }
+        if (f->len > GPS_FRAME_MAX_LEN) {
+          gps_frame_error(f, GPS_FRAME_ERR_MSG_TOO_LONG);
+          continue;
+        }
+      }
+      else {
+        const uint8_t* e = memchr(&data[n], p->end, len - n);
+        chunk = (e != NULL ? e + 1 - data : len) - n;
+        if (f->idx + chunk > GPS_FRAME_MAX_LEN) {
+          /* skip up to the next sync char */
+          gps_frame_error(f, GPS_FRAME_ERR_MSG_TOO_LONG);
+          continue;
+        }
+        memcpy(&f->buf[f->idx], &data[n], chunk);
+        f->idx += chunk;
+        n += chunk;
+        if (e == NULL)
+          return n;
+        f->len = f->idx;
+      }
+    }
+
+    if (f->idx < f->len) {
+      chunk = Min(f->len - f->idx, len - n);
+      memcpy(&f->buf[f->idx], &data[n], chunk);
+      f->idx += chunk;
+      n += chunk;
+      if (f->idx < f->len)
+        return n;
+    }
+
+    if (p->check(f->buf, f->len)) {
+      f->available = TRUE;
+      f->idx = 0;
+    }
+    else
+      gps_frame_error(f, GPS_FRAME_ERR_CHECKSUM);
+  }
+  return n;
+}
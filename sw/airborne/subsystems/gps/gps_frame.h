@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/** @file gps_frame.h
+ * @brief Framing of the GPS protocols
+ *
+ * Bytes are read from the GPS link by blocks. The start of a frame is
+ * found with a scan for the sync char of the protocol, then the header and
+ * the body are copied by chunks and the whole frame is checked at once.
+ * A protocol is described by a gps_frame_proto: either the length of
+ * its frames is known from a fixed size header (UBX, MTK, Skytraq), or
+ * frames are ended by a given char (NMEA).
+ */
+
+#ifndef GPS_FRAME_H
+#define GPS_FRAME_H
+
+#include "std.h"
+
+/** UBX frame with a 255 bytes payload (6 header, 2 checksum), rounded up */
+#define GPS_FRAME_MAX_LEN 264
+
+/** Size of the block read at once from the link */
+#ifndef GPS_FRAME_IN_LEN
+#define GPS_FRAME_IN_LEN 64
+#endif
+
+/* last error type */
+#define GPS_FRAME_ERR_NONE         0
+#define GPS_FRAME_ERR_OUT_OF_SYNC  1
+#define GPS_FRAME_ERR_MSG_TOO_LONG 2
+#define GPS_FRAME_ERR_CHECKSUM     3
+
+struct gps_frame_proto {
+  uint8_t sync1;          ///< first byte of a frame
+  uint8_t sync1_alt;      ///< alternate first byte, same as sync1 if none
+  uint8_t header_len;     ///< number of bytes needed by frame_len
+  /** Total length of the frame from its header, 0 if the header is not valid,
+   *  more than GPS_FRAME_MAX_LEN if the frame is too long.
+   *  NULL if frames are ended by the end char */
+  uint16_t (*frame_len)(const uint8_t* header);
+  uint8_t end;            ///< last char of a frame if frame_len is NULL
+  /** Check of a complete frame (checksum, trailer) */
+  bool_t (*check)(const uint8_t* frame, uint16_t len);
+  uint8_t payload_offset; ///< payload is 4 bytes aligned at this offset of buf
+};
+
+struct gps_frame {
+  const struct gps_frame_proto* proto;
+  uint8_t raw[GPS_FRAME_MAX_LEN + 3] __attribute__ ((aligned));
+  uint8_t* buf;           ///< current frame, in raw
+  uint16_t idx;           ///< number of bytes of the frame in buf
+  uint16_t len;           ///< length of the frame, 0 while unknown
+  bool_t available;       ///< buf holds a complete and checked frame
+  uint8_t error_cnt;
+  uint8_t error_last;
+  uint8_t in[GPS_FRAME_IN_LEN]; ///< block read from the link
+  uint8_t in_idx;         ///< bytes of the block already parsed
+  uint8_t in_len;
+};
+
+extern void gps_frame_init(struct gps_frame* f, const struct gps_frame_proto* proto);
+
+/** Parse up to len bytes, stops at the end of a frame
+ *  \return number of bytes consumed
+ */
+extern uint16_t gps_frame_parse(struct gps_frame* f, const uint8_t* data, uint16_t len);
+
+/** Bytes of the last block read from the link are not parsed yet */
+#define GpsFramePending(_f) ((_f).in_idx != (_f).in_len)
+
+/** Read the GPS link until a frame is available or no more bytes are received.
+ *  GpsLink is the one of the protocol header.
+ */
+#define GpsFrameRead(_f) {                                              \
+    while (!(_f).available) {                                           \
+      if ((_f).in_idx == (_f).in_len) {                                 \
+        (_f).in_idx = 0;                                                \
+        (_f).in_len = GpsLink(ReadBulk((_f).in, GPS_FRAME_IN_LEN));     \
+        if ((_f).in_len == 0)                                           \
+          break;                                                        \
+      }                                                                 \
+      (_f).in_idx += gps_frame_parse(&(_f), &(_f).in[(_f).in_idx],      \
+                                     (_f).in_len - (_f).in_idx);        \
+    }                                                                   \
+  }
+
+#endif /* GPS_FRAME_H */
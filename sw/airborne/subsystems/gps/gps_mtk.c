@@ -42,25 +42,6 @@
 #define MTK_DIY_OUTPUT_RATE	MTK_DIY_OUTPUT_4HZ
 #define OUTPUT_RATE			4
 
-/* parser status */
-#define UNINIT        0
-#define GOT_SYNC1_14  1
-#define GOT_SYNC2_14  2
-#define GOT_CLASS_14  3
-#define GOT_SYNC1_16  4
-#define GOT_SYNC2_16  5
-#define GOT_ID        6
-#define GOT_PAYLOAD   7
-#define GOT_CHECKSUM1 8
-
-/* last error type */
-#define GPS_MTK_ERR_NONE         0
-#define GPS_MTK_ERR_OVERRUN      1
-#define GPS_MTK_ERR_MSG_TOO_LONG 2
-#define GPS_MTK_ERR_CHECKSUM     3
-#define GPS_MTK_ERR_UNEXPECTED   4
-#define GPS_MTK_ERR_OUT_OF_SYNC  5
-
 /* defines for UTC-GPS time conversion */
 #define SECS_MINUTE (60)
 #define SECS_HOUR   (60*60)
@@ -78,11 +59,44 @@ bool_t gps_configuring;
 static uint8_t gps_status_config;
 #endif
 
+/* frames:
+ *  DIY 1.4: sync1 sync2 class id payload(26) ck_a ck_b
+ *  DIY 1.6: class id len payload ck_a ck_b
+ */
+static uint16_t gps_mtk_frame_len(const uint8_t* header) {
+  if (header[0] == MTK_DIY14_SYNC1) {
+    if (header[1] != MTK_DIY14_SYNC2 || header[2] != MTK_DIY14_ID ||
+        header[3] != MTK_DIY14_NAV_ID)
+      return 0;
+    return 4 + MTK_DIY14_NAV_LENGTH + 2;
+  }
+  if (header[1] != MTK_DIY16_NAV_ID)
+    return 0;
+  return 3 + header[2] + 2;
+}
+
+/* Fletcher checksum from the third byte to the payload */
+static bool_t gps_mtk_check(const uint8_t* frame, uint16_t len) {
+  uint8_t ck_a = 0, ck_b = 0;
+  const uint8_t* c;
+  for (c = &frame[2]; c < &frame[len - 2]; c++) {
+    ck_a += *c;
+    ck_b += ck_a;
+  }
+  return (ck_a == frame[len - 2] && ck_b == frame[len - 1]);
+}
+
+static const struct gps_frame_proto gps_mtk_proto = {
+  .sync1 = MTK_DIY14_SYNC1,
+  .sync1_alt = MTK_DIY16_ID,
+  .header_len = 4,
+  .frame_len = gps_mtk_frame_len,
+  .check = gps_mtk_check,
+  .payload_offset = 0
+};
+
 void gps_impl_init(void) {
-   gps_mtk.status = UNINIT;
-   gps_mtk.msg_available = FALSE;
-   gps_mtk.error_cnt = 0;
-   gps_mtk.error_last = GPS_MTK_ERR_NONE;
+   gps_frame_init(&gps_mtk.frame, &gps_mtk_proto);
 #ifdef GPS_CONFIGURE
    gps_status_config = 0;
    gps_configuring = TRUE;
@@ -133,6 +147,17 @@ static void gps_mtk_time2itow(uint32_t  gps_date, uint32_t  gps_time,
 }
 
 void gps_mtk_read_message(void) {
+  if (gps_mtk.frame.buf[0] == MTK_DIY14_SYNC1) {
+    gps_mtk.msg_class = gps_mtk.frame.buf[2];
+    gps_mtk.msg_id = gps_mtk.frame.buf[3];
+    gps_mtk.msg_buf = &gps_mtk.frame.buf[4];
+  }
+  else {
+    gps_mtk.msg_class = gps_mtk.frame.buf[0];
+    gps_mtk.msg_id = gps_mtk.frame.buf[1];
+    gps_mtk.msg_buf = &gps_mtk.frame.buf[3];
+  }
+
   if (gps_mtk.msg_class == MTK_DIY14_ID) {
     if (gps_mtk.msg_id == MTK_DIY14_NAV_ID) {
 #ifdef GPS_TIMESTAMP
@@ -256,109 +281,6 @@ void gps_mtk_read_message(void) {
   }
 }
 
-/* byte parsing */
-void gps_mtk_parse( uint8_t c ) {
-  if (gps_mtk.status < GOT_PAYLOAD) {
-    gps_mtk.ck_a += c;
-    gps_mtk.ck_b += gps_mtk.ck_a;
-  }
-  switch (gps_mtk.status) {
-  case UNINIT:
-    if (c == MTK_DIY14_SYNC1)
-      gps_mtk.status = GOT_SYNC1_14;
-    if (c == MTK_DIY16_ID)
-      gps_mtk.msg_class = c;
-      gps_mtk.status = GOT_SYNC1_16;
-    break;
-  /* MTK_DIY_VER_14 */
-  case GOT_SYNC1_14:
-    if (c != MTK_DIY14_SYNC2) {
-      gps_mtk.error_last = GPS_MTK_ERR_OUT_OF_SYNC;
-      goto error;
-    }
-    if (gps_mtk.msg_available) {
-      /* Previous message has not yet been parsed: discard this one */
-      gps_mtk.error_last = GPS_MTK_ERR_OVERRUN;
-      goto error;
-    }
-    gps_mtk.ck_a = 0;
-    gps_mtk.ck_b = 0;
-    gps_mtk.status++;
-    gps_mtk.len = MTK_DIY14_NAV_LENGTH;
-    break;
-  case GOT_SYNC2_14:
-    if (c != MTK_DIY14_ID) {
-      gps_mtk.error_last = GPS_MTK_ERR_OUT_OF_SYNC;
-      goto error;
-    }
-    gps_mtk.msg_class = c;
-    gps_mtk.msg_idx = 0;
-    gps_mtk.status++;
-    break;
-  case GOT_CLASS_14:
-    if (c != MTK_DIY14_NAV_ID) {
-      gps_mtk.error_last = GPS_MTK_ERR_OUT_OF_SYNC;
-      goto error;
-    }
-    gps_mtk.msg_id = c;
-    gps_mtk.status = GOT_ID;
-    break;
-  /* MTK_DIY_VER_16 */
-  case GOT_SYNC1_16:
-    if (c != MTK_DIY16_NAV_ID) {
-      gps_mtk.error_last = GPS_MTK_ERR_OUT_OF_SYNC;
-      goto error;
-    }
-    if (gps_mtk.msg_available) {
-      /* Previous message has not yet been parsed: discard this one */
-      gps_mtk.error_last = GPS_MTK_ERR_OVERRUN;
-      goto error;
-    }
-    gps_mtk.msg_id = c;
-    gps_mtk.ck_a = 0;
-    gps_mtk.ck_b = 0;
-    gps_mtk.status++;
-    break;
-  case GOT_SYNC2_16:
-    gps_mtk.len = c;
-    gps_mtk.msg_idx = 0;
-    gps_mtk.status = GOT_ID;
-    break;
-  case GOT_ID:
-    gps_mtk.msg_buf[gps_mtk.msg_idx] = c;
-    gps_mtk.msg_idx++;
-    if (gps_mtk.msg_idx >= gps_mtk.len) {
-      gps_mtk.status++;
-    }
-    break;
-  case GOT_PAYLOAD:
-    if (c != gps_mtk.ck_a) {
-      gps_mtk.error_last = GPS_MTK_ERR_CHECKSUM;
-      goto error;
-    }
-    gps_mtk.status++;
-    break;
-  case GOT_CHECKSUM1:
-    if (c != gps_mtk.ck_b) {
-      gps_mtk.error_last = GPS_MTK_ERR_CHECKSUM;
-      goto error;
-    }
-    gps_mtk.msg_available = TRUE;
-    goto restart;
-    break;
-  default:
-    gps_mtk.error_last = GPS_MTK_ERR_UNEXPECTED;
-    goto error;
-  }
-  return;
- error:
-  gps_mtk.error_cnt++;
- restart:
-  gps_mtk.status = UNINIT;
-  return;
-}
-
-
 /*
  *
  *
@@ -24,25 +24,18 @@
 #define MTK_H
 
 #include "mcu_periph/uart.h"
+#include "subsystems/gps/gps_frame.h"
 
 /** Includes macros generated from mtk.xml */
 #include "mtk_protocol.h"
 
-#define GPS_MTK_MAX_PAYLOAD 255
-
 struct GpsMtk {
-  bool_t msg_available;
-  uint8_t msg_buf[GPS_MTK_MAX_PAYLOAD] __attribute__ ((aligned));
+  struct gps_frame frame;
+  uint8_t* msg_buf;       ///< payload of the last frame
   uint8_t msg_id;
   uint8_t msg_class;
 
-  uint8_t status;
-  uint16_t len;
-  uint8_t msg_idx;
-  uint8_t ck_a, ck_b;
   uint8_t send_ck_a, send_ck_b;
-  uint8_t error_cnt;
-  uint8_t error_last;
 
   uint8_t status_flags;
   uint8_t sol_flags;
@@ -71,11 +64,11 @@ extern bool_t gps_configuring;
 #endif
 
 #define GpsEvent(_sol_available_callback) {         \
-    if (GpsBuffer()) {                              \
+    if (GpsBuffer() || GpsFramePending(gps_mtk.frame)) { \
       ReadGpsBuffer();                              \
       GpsConfigure();                               \
     }                                               \
-    if (gps_mtk.msg_available) {                    \
+    if (gps_mtk.frame.available) {                  \
       gps_mtk_read_message();                       \
       if (gps_mtk.msg_class == MTK_DIY14_ID &&      \
           gps_mtk.msg_id == MTK_DIY14_NAV_ID) {     \
@@ -92,18 +85,14 @@ extern bool_t gps_configuring;
         }                                           \
         _sol_available_callback();                  \
       }                                             \
-      gps_mtk.msg_available = FALSE;                \
+      gps_mtk.frame.available = FALSE;              \
     }                                               \
   }
 
-#define ReadGpsBuffer() {					\
-    while (GpsLink(ChAvailable())&&!gps_mtk.msg_available)	\
-      gps_mtk_parse(GpsLink(Getch()));			\
-  }
+#define ReadGpsBuffer() GpsFrameRead(gps_mtk.frame)
 
 
 extern void gps_mtk_read_message(void);
-extern void gps_mtk_parse(uint8_t c);
 
 #define MTK_DIY_FIX_3D      3
 #define MTK_DIY_FIX_2D      2
@@ -59,213 +59,134 @@ void parse_nmea_GPRMC(void);
 void parse_nmea_GPGGA(void);
 
 
+static inline uint8_t nmea_hex(uint8_t c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return 0xFF;
+}
+
+/* the checksum is optional: xor of the chars between '$' and '*' */
+static bool_t gps_nmea_check(const uint8_t* frame, uint16_t len) {
+  const uint8_t* star = memchr(frame, '*', len);
+  const uint8_t* c;
+  uint8_t checksum = 0;
+  if (star == NULL)
+    return TRUE;
+  if (star + 2 >= frame + len)
+    return FALSE;
+  for (c = &frame[1]; c < star; c++)
+    checksum ^= *c;
+  return (checksum == ((nmea_hex(star[1]) << 4) | nmea_hex(star[2])));
+}
+
+static const struct gps_frame_proto gps_nmea_proto = {
+  .sync1 = '$',
+  .sync1_alt = '$',
+  .frame_len = NULL,
+  .end = '\n',
+  .check = gps_nmea_check
+};
+
 void gps_impl_init( void ) {
-  gps_nmea.msg_available = FALSE;
+  gps_frame_init(&gps_nmea.frame, &gps_nmea_proto);
   gps_nmea.pos_available = FALSE;
-  gps_nmea.gps_nb_ovrn = 0;
-  gps_nmea.msg_len = 0;
+  gps_nmea.nb_fields = 0;
 }
 
 
-
 /**
- * parse GPGSA-nmea-messages stored in
- * nmea_msg_buf .
+ * parse GPGSA-nmea-messages
+ * fields: mode, fix, satellites...
  */
 void parse_nmea_GPGSA(void) {
-  int i = 8;     // current position in the message
-  //      char* endptr;  // end of parsed substrings
-
   // attempt to reject empty packets right away
-  if(gps_nmea.msg_buf[i]==',' && gps_nmea.msg_buf[i+1]==',') {
+  if (gps_nmea.nb_fields < 3 || gps_nmea.fields[2][0] == 0) {
     NMEA_PRINT("p_GPGSA() - skipping empty message\n\r");
     return;
   }
 
-  // get auto2D/3D
-  // ignored
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: fix
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPGSA() - skipping incomplete message\n\r");
-      return;
-    }
-  }
-
   // get 2D/3D-fix
   // set gps_mode=3=3d, 2=2d, 1=no fix or 0
-  gps.fix = atoi(&gps_nmea.msg_buf[i]);
+  gps.fix = atoi(gps_nmea.fields[2]);
   if (gps.fix == 1)
     gps.fix = 0;
   NMEA_PRINT("p_GPGSA() - gps.fix=%i (3=3D)\n\r", gps.fix);
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field:satellite-number-0
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPGSA() - skipping incomplete message\n\r");
-      return;
-    }
-  }
-
-  //int satcount = 0;
 
   // TODO: get sateline-numbers for gps_svinfos
 }
 
 /**
- * parse GPRMC-nmea-messages stored in
- * gps_nmea.msg_buf .
+ * parse GPRMC-nmea-messages
+ * fields: time, warning, lat, N/S, lon, E/W, speed, course...
  */
 void parse_nmea_GPRMC(void) {
-  int i = 8;     // current position in the message
-  char* endptr;  // end of parsed substrings
-
   // attempt to reject empty packets right away
-  if(gps_nmea.msg_buf[i]==',' && gps_nmea.msg_buf[i+1]==',') {
-    NMEA_PRINT("p_GPRMC() - skipping empty message\n\r");
+  if (gps_nmea.nb_fields < 9) {
+    NMEA_PRINT("p_GPRMC() - skipping incomplete message\n\r");
     return;
   }
-
-  // get time
-  // ignored
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: warning
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPRMC() - skipping incomplete message\n\r");
-      return;
-    }
+  if (gps_nmea.fields[1][0] == 0 && gps_nmea.fields[2][0] == 0) {
+    NMEA_PRINT("p_GPRMC() - skipping empty message\n\r");
+    return;
   }
 
-  // get warning
-  // ignored
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: lat
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPRMC() - skipping incomplete message\n\r");
-      return;
-    }
-  }
-  // get lat
-  // ignored
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: N/S
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPRMC() - skipping incomplete message\n\r");
-      return;
-    }
-  }
-  // get North/South
-  // ignored
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: lon
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPRMC() - skipping incomplete message\n\r");
-      return;
-    }
-  }
-  // get lon
-  // ignored
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: E/W
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPRMC() - skipping incomplete message\n\r");
-      return;
-    }
-  }
-  // get eath/west
-  // ignored
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: speed
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPRMC() - skipping incomplete message\n\r");
-      return;
-    }
-  }
   // get speed
-  double speed = strtod(&gps_nmea.msg_buf[i], &endptr);
+  double speed = strtod(gps_nmea.fields[7], NULL);
   gps.gspeed = speed * 1.852 * 100 / (60*60);
   NMEA_PRINT("p_GPRMC() - ground-speed=%d knot = %d cm/s\n\r", (speed*1000), (gps.gspeed*1000));
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: course
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPRMC() - skipping incomplete message\n\r");
-      return;
-    }
-  }
-  double course = strtod(&gps_nmea.msg_buf[i], &endptr);
+
+  double course = strtod(gps_nmea.fields[8], NULL);
   gps.course=course*10; //FIXME should be GPS heading in rad*1e7
   NMEA_PRINT("COURSE: %d \n\r",gps_course);
 }
 
 
 /**
- * parse GPGGA-nmea-messages stored in
- * gps_nmea.msg_buf .
+ * parse GPGGA-nmea-messages
+ * fields: time, lat, N/S, lon, E/W, fix status, satellites used, HDOP,
+ *         altitude, ...
  */
 void parse_nmea_GPGGA(void) {
-  int i = 8;     // current position in the message
-  char* endptr;  // end of parsed substrings
   double degrees, minutesfrac;
   struct LlaCoor_f lla_f;
 
   // attempt to reject empty packets right away
-  if(gps_nmea.msg_buf[i]==',' && gps_nmea.msg_buf[i+1]==',') {
+  if (gps_nmea.nb_fields < 10) {
+    NMEA_PRINT("p_GPGGA() - skipping incomplete message\n\r");
+    return;
+  }
+  if (gps_nmea.fields[1][0] == 0 && gps_nmea.fields[2][0] == 0) {
     NMEA_PRINT("p_GPGGA() - skipping empty message\n\r");
     return;
   }
 
   // get UTC time [hhmmss.sss]
-  // ignored GpsInfo.PosLLA.TimeOfFix.f = strtod(&packet[i], &endptr);
-  double time = strtod(&gps_nmea.msg_buf[i],&endptr);
+  double time = strtod(gps_nmea.fields[1], NULL);
   gps.tow = (uint32_t)((time+1)*1000);
 
-  //AD TODO: strtod itow
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: latitude
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPGGA() - skipping incomplete message\n\r");
-      return;
-    }
-  }
-
   // get latitude [ddmm.mmmmm]
-  double lat = strtod(&gps_nmea.msg_buf[i], &endptr);
+  double lat = strtod(gps_nmea.fields[2], NULL);
   // convert to pure degrees [dd.dddd] format
   minutesfrac = modf(lat/100, &degrees);
   lat = degrees + (minutesfrac*100)/60;
-  // convert to radians
-  //GpsInfo.PosLLA.lat.f *= (M_PI/180);
-  lla_f.lat = RadOfDeg(lat);
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: N/S indicator
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPGGA() - skipping incomplete message\n\r");
-      return;
-    }
-  }
-
   // correct latitute for N/S
-  if(gps_nmea.msg_buf[i] == 'S')
+  if (gps_nmea.fields[3][0] == 'S')
     lat = -lat;
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: longitude
-    if (i >= gps_nmea.msg_len)
-      return;
-  }
-
   // convert to radians
   lla_f.lat = RadOfDeg(lat);
-
-  gps.lla_pos.lat =lla_f.lat * 1e7; // convert to fixed-point
+  gps.lla_pos.lat = lla_f.lat * 1e7; // convert to fixed-point
   NMEA_PRINT("p_GPGGA() - lat=%d gps_lat=%i\n\r", (lat*1000), lla_f.lat);
 
   // get longitude [ddmm.mmmmm]
-  double lon = strtod(&gps_nmea.msg_buf[i], &endptr);
+  double lon = strtod(gps_nmea.fields[4], NULL);
   // convert to pure degrees [dd.dddd] format
   minutesfrac = modf(lon/100, &degrees);
   lon = degrees + (minutesfrac*100)/60;
-  // convert to radians
-  //GpsInfo.PosLLA.lon.f *= (M_PI/180);
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: E/W indicator
-    if (i >= gps_nmea.msg_len)
-      return;
-  }
-
-  // correct latitute for E/W
-  if(gps_nmea.msg_buf[i] == 'W')
+  // correct longitude for E/W
+  if (gps_nmea.fields[5][0] == 'W')
     lon = -lon;
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: position fix status
-    if (i >= gps_nmea.msg_len)
-      return;
-  }
-
+  // convert to radians
+  lla_f.lon = RadOfDeg(lon);
   gps.lla_pos.lon = lla_f.lon * 1e7; // convert to fixed-point
   NMEA_PRINT("p_GPGGA() - lon=%d gps_lon=%i time=%u\n\r", (lon*1000), lla_f.lon, gps.tow);
 
@@ -280,130 +201,78 @@ void parse_nmea_GPGGA(void) {
   gps.utm_pos.alt = utm_f.alt*1000;
   gps.utm_pos.zone = nav_utm_zone0;
 
-
-
   // position fix status
   // 0 = Invalid, 1 = Valid SPS, 2 = Valid DGPS, 3 = Valid PPS
   // check for good position fix
-  if( (gps_nmea.msg_buf[i] != '0') && (gps_nmea.msg_buf[i] != ',') )  {
+  if (gps_nmea.fields[6][0] != '0' && gps_nmea.fields[6][0] != 0) {
     gps_nmea.pos_available = TRUE;
     NMEA_PRINT("p_GPGGA() - POS_AVAILABLE == TRUE\n\r");
   } else {
     gps_nmea.pos_available = FALSE;
     NMEA_PRINT("p_GPGGA() - gps_pos_available == false\n\r");
   }
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: satellites used
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPGGA() - skipping incomplete message\n\r\r");
-      return;
-    }
-  }
 
   // get number of satellites used in GPS solution
-  gps.num_sv = atoi(&gps_nmea.msg_buf[i]);
+  gps.num_sv = atoi(gps_nmea.fields[7]);
   NMEA_PRINT("p_GPGGA() - gps_numSatlitesUsed=%i\n\r", gps.num_sv);
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: HDOP (horizontal dilution of precision)
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPGGA() - skipping incomplete message\n\r");
-      return;
-    }
-  }
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: altitude
-    if (i >= gps_nmea.msg_len) {
-      NMEA_PRINT("p_GPGGA() - skipping incomplete message\n\r");
-      return;
-    }
-  }
 
   // get altitude (in meters)
   // FIXME alt above ellipsoid or geoid (MSL) ???
-  double alt = strtod(&gps_nmea.msg_buf[i], &endptr);
+  double alt = strtod(gps_nmea.fields[9], NULL);
   gps.hmsl = alt * 100;
   NMEA_PRINT("p_GPGGA() - gps_alt=%i\n\r", gps.hmsl);
-
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: altitude units, always 'M'
-    if (i >= gps_nmea.msg_len)
-      return;
-  }
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: geoid seperation
-    if (i >= gps_nmea.msg_len)
-      return;
-  }
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: seperation units
-    if (i >= gps_nmea.msg_len)
-      return;
-  }
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: DGPS age
-    if (i >= gps_nmea.msg_len)
-      return;
-  }
-  while(gps_nmea.msg_buf[i++] != ',') {              // next field: DGPS station ID
-    if (i >= gps_nmea.msg_len)
-      return;
-  }
-  //while(gps_nmea.msg_buf[i++] != '*');              // next field: checksum
 }
 
 /**
- * parse_nmea_char() has a complete line.
- * Find out what type of message it is and
- * hand it to the parser for that type.
+ * Split the available line in fields.
+ * The separators are replaced by the end of string.
  */
-void nmea_parse_msg( void ) {
-
-  if(gps_nmea.msg_len > 5 && !strncmp(gps_nmea.msg_buf , "GPRMC", 5)) {
-    gps_nmea.msg_buf[gps_nmea.msg_len] = 0;
-    NMEA_PRINT("parsing RMC: \"%s\" \n\r",gps_nmea.msg_buf);
-    NMEA_PRINT("RMC");
-    parse_nmea_GPRMC();
-  } else
-    if(gps_nmea.msg_len > 5 && !strncmp(gps_nmea.msg_buf , "GPGGA", 5)) {
-      gps_nmea.msg_buf[gps_nmea.msg_len] = 0;
-      NMEA_PRINT("parse_gps_msg() - parsing GGA gps-message \"%s\" \n\r",gps_nmea.msg_buf);
-      NMEA_PRINT("GGA");
-      parse_nmea_GPGGA();
-    } else
-      if(gps_nmea.msg_len > 5 && !strncmp(gps_nmea.msg_buf , "GPGSA", 5)) {
-	gps_nmea.msg_buf[gps_nmea.msg_len] = 0;
-	NMEA_PRINT("GSA: \"%s\" \n\r",gps_nmea.msg_buf);
-	NMEA_PRINT("GSA");
-	parse_nmea_GPGSA();
-      } else {
-	gps_nmea.msg_buf[gps_nmea.msg_len] = 0;
-	NMEA_PRINT("ignoring: len=%i \n\r \"%s\" \n\r", gps_nmea.msg_len, gps_nmea.msg_buf);
-      }
-
-  // reset message-buffer
-  gps_nmea.msg_len = 0;
+static void nmea_split_fields(char* line, uint16_t len) {
+  char* end = memchr(line, '*', len);
+  char* c;
+  if (end == NULL)
+    end = memchr(line, '\r', len);
+  if (end == NULL)
+    end = &line[len - 1];
+  *end = 0;
+
+  gps_nmea.fields[0] = line;
+  gps_nmea.nb_fields = 1;
+  for (c = line; c < end; c++) {
+    if (*c == ',') {
+      *c = 0;
+      if (gps_nmea.nb_fields < NMEA_MAX_FIELDS)
+        gps_nmea.fields[gps_nmea.nb_fields++] = c + 1;
+    }
+  }
 }
 
-
 /**
- * This is the actual parser.
- * It reads one character at a time
- * setting gps_nmea.msg_available to TRUE
- * after a full line.
+ * A complete line is available.
+ * Find out what type of message it is, whatever the talker,
+ * and hand it to the parser for that type.
  */
-void nmea_parse_char( uint8_t c ) {
-  //reject empty lines
-  if (gps_nmea.msg_len == 0) {
-    if (c == '\r' || c == '\n' || c == '$')
-      return;
-  }
-
-  // fill the buffer, unless it's full
-  if (gps_nmea.msg_len < NMEA_MAXLEN - 1) {
+void nmea_parse_msg( void ) {
+  /* skip the '$' */
+  nmea_split_fields((char*)&gps_nmea.frame.buf[1], gps_nmea.frame.len - 1);
 
-    // messages end with a linefeed
-    //AD: TRUNK:       if (c == '\r' || c == '\n')
-    if (c == '\r' || c == '\n') {
-      gps_nmea.msg_available = TRUE;
-    } else {
-      gps_nmea.msg_buf[gps_nmea.msg_len] = c;
-      gps_nmea.msg_len ++;
-    }
+  const char* type = gps_nmea.fields[0];
+  if (strlen(type) != 5) {
+    NMEA_PRINT("ignoring: \"%s\" \n\r", type);
+    return;
   }
+  type += 2;
 
-  if (gps_nmea.msg_len >= NMEA_MAXLEN - 1)
-    gps_nmea.msg_available = TRUE;
+  if (!strcmp(type, "RMC")) {
+    NMEA_PRINT("RMC");
+    parse_nmea_GPRMC();
+  } else if (!strcmp(type, "GGA")) {
+    NMEA_PRINT("GGA");
+    parse_nmea_GPGGA();
+  } else if (!strcmp(type, "GSA")) {
+    NMEA_PRINT("GSA");
+    parse_nmea_GPGSA();
+  } else {
+    NMEA_PRINT("ignoring: \"%s\" \n\r", gps_nmea.fields[0]);
+  }
 }
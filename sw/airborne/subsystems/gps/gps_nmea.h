@@ -30,6 +30,7 @@
 #define GPS_NMEA_H
 
 #include "mcu_periph/uart.h"
+#include "subsystems/gps/gps_frame.h"
 
 #define GPS_NB_CHANNELS 16
 
@@ -39,14 +40,13 @@
 #define NMEA_PRINT(...) {};
 #endif
 
-#define NMEA_MAXLEN 255
+#define NMEA_MAX_FIELDS 24
 
 struct GpsNmea {
-  bool_t msg_available;
+  struct gps_frame frame;     ///< one nmea-line, from '$' to '\n'
   bool_t pos_available;
-  uint8_t gps_nb_ovrn;        // number if incomplete nmea-messages
-  char msg_buf[NMEA_MAXLEN];  ///< buffer for storing one nmea-line
-  int msg_len;
+  uint8_t nb_fields;
+  char* fields[NMEA_MAX_FIELDS]; ///< fields of the line, talker and type first
 };
 
 extern struct GpsNmea gps_nmea;
@@ -62,10 +62,10 @@ extern struct GpsNmea gps_nmea;
 #define GpsBuffer() GpsLink(ChAvailable())
 
 #define GpsEvent(_sol_available_callback) {        \
-    if (GpsBuffer()) {                             \
+    if (GpsBuffer() || GpsFramePending(gps_nmea.frame)) { \
       ReadGpsBuffer();                             \
     }                                              \
-    if (gps_nmea.msg_available) {                  \
+    if (gps_nmea.frame.available) {                \
       nmea_parse_msg();				   \
       if (gps_nmea.pos_available) {		   \
         if (gps.fix == GPS_FIX_3D) {               \
@@ -74,20 +74,14 @@ extern struct GpsNmea gps_nmea;
         }                                          \
         _sol_available_callback();                 \
       }                                            \
-      gps_nmea.msg_available = FALSE;               \
+      gps_nmea.frame.available = FALSE;            \
     }                                              \
   }
 
-#define ReadGpsBuffer() {					\
-    while (GpsLink(ChAvailable())&&!gps_nmea.msg_available)	\
-      nmea_parse_char(GpsLink(Getch()));			\
-  }
-
-
+#define ReadGpsBuffer() GpsFrameRead(gps_nmea.frame)
 
-/** The function to be called when a characted friom the device is available */
-extern void nmea_parse_char(uint8_t c);
 
+/** Split the available line in fields and parse it */
 extern void nmea_parse_msg(void);
 
 
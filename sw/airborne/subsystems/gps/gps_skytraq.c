@@ -23,23 +23,44 @@
 
 struct GpsSkytraq gps_skytraq;
 
-/* parser status */
-#define UNINIT        0
-#define GOT_SYNC1     1
-#define GOT_SYNC2     2
-#define GOT_LEN1      3
-#define GOT_LEN2      4
-#define GOT_ID        5
-#define GOT_PAYLOAD   6
-#define GOT_CHECKSUM  7
-#define GOT_SYNC3     8
-
 //#include "my_debug_servo.h"
 #include "led.h"
 
+/* frame: sync1 sync2 len(2, big endian) id payload checksum sync3 sync4
+ * len counts the id and the payload
+ */
+static uint16_t gps_skytraq_frame_len(const uint8_t* header) {
+  uint16_t payload_len = (header[2] << 8) | header[3];
+  if (header[1] != SKYTRAQ_SYNC2)
+    return 0;
+  /* too long for the buffer, before the sum can wrap */
+  if (payload_len > GPS_FRAME_MAX_LEN - 4 - 3)
+    return GPS_FRAME_MAX_LEN + 1;
+  return 4 + payload_len + 3;
+}
+
+/* xor of the id and the payload */
+static bool_t gps_skytraq_check(const uint8_t* frame, uint16_t len) {
+  uint8_t checksum = 0;
+  const uint8_t* c;
+  for (c = &frame[4]; c < &frame[len - 3]; c++)
+    checksum ^= *c;
+  return (checksum == frame[len - 3] &&
+          frame[len - 2] == SKYTRAQ_SYNC3 && frame[len - 1] == SKYTRAQ_SYNC4);
+}
+
+static const struct gps_frame_proto gps_skytraq_proto = {
+  .sync1 = SKYTRAQ_SYNC1,
+  .sync1_alt = SKYTRAQ_SYNC1,
+  .header_len = 4,
+  .frame_len = gps_skytraq_frame_len,
+  .check = gps_skytraq_check,
+  .payload_offset = 5
+};
+
 void gps_impl_init(void) {
 
-  gps_skytraq.status = UNINIT;
+  gps_frame_init(&gps_skytraq.frame, &gps_skytraq_proto);
 
 
   //DEBUG_SERVO1_INIT();
@@ -51,6 +72,9 @@ void gps_skytraq_read_message(void) {
 
   //DEBUG_S1_ON();
 
+  gps_skytraq.msg_id = gps_skytraq.frame.buf[4];
+  gps_skytraq.msg_buf = &gps_skytraq.frame.buf[5];
+
   if (gps_skytraq.msg_id == SKYTRAQ_ID_NAVIGATION_DATA) {
     gps.ecef_pos.x  = SKYTRAQ_NAVIGATION_DATA_ECEFX(gps_skytraq.msg_buf);
     gps.ecef_pos.y  = SKYTRAQ_NAVIGATION_DATA_ECEFY(gps_skytraq.msg_buf);
@@ -82,72 +106,3 @@ void gps_skytraq_read_message(void) {
 
   //DEBUG_S1_OFF();
 }
-
-void gps_skytraq_parse(uint8_t c) {
-  if (gps_skytraq.status < GOT_PAYLOAD)
-    gps_skytraq.checksum ^= c;
-  switch (gps_skytraq.status) {
-  case UNINIT:
-    if (c == SKYTRAQ_SYNC1)
-      gps_skytraq.status = GOT_SYNC1;
-    break;
-  case GOT_SYNC1:
-    if (c != SKYTRAQ_SYNC2) {
-      gps_skytraq.error_last = GPS_SKYTRAQ_ERR_OUT_OF_SYNC;
-      goto error;
-    }
-    gps_skytraq.status = GOT_SYNC2;
-    break;
-  case GOT_SYNC2:
-    gps_skytraq.len = c<<8;
-    gps_skytraq.status = GOT_LEN1;
-    break;
-  case GOT_LEN1:
-    gps_skytraq.len += c;
-    gps_skytraq.status = GOT_LEN2;
-    if (gps_skytraq.len > GPS_SKYTRAQ_MAX_PAYLOAD) {
-      gps_skytraq.error_last = GPS_SKYTRAQ_ERR_MSG_TOO_LONG;
-      goto error;
-    }
-    break;
-  case GOT_LEN2:
-    gps_skytraq.msg_id = c;
-    gps_skytraq.msg_idx = 0;
-    gps_skytraq.checksum = c;
-    gps_skytraq.status = GOT_ID;
-    break;
-  case GOT_ID:
-    gps_skytraq.msg_buf[gps_skytraq.msg_idx] = c;
-    gps_skytraq.msg_idx++;
-    if (gps_skytraq.msg_idx >= gps_skytraq.len-1) {
-      gps_skytraq.status = GOT_PAYLOAD;
-    }
-    break;
-  case GOT_PAYLOAD:
-    if (c != gps_skytraq.checksum) {
-      gps_skytraq.error_last = GPS_SKYTRAQ_ERR_CHECKSUM;
-      goto error;
-    }
-    gps_skytraq.status = GOT_CHECKSUM;
-    break;
-  case GOT_CHECKSUM:
-    if (c != SKYTRAQ_SYNC3) {
-      gps_skytraq.error_last = GPS_SKYTRAQ_ERR_OUT_OF_SYNC;
-      goto error;
-    }
-    gps_skytraq.status = GOT_SYNC3;
-    break;
-  case GOT_SYNC3:
-    gps_skytraq.msg_available = TRUE;
-    goto restart;
-  default:
-    gps_skytraq.error_last = GPS_SKYTRAQ_ERR_UNEXPECTED;
-    goto error;
-  }
-  return;
- error:
-  gps_skytraq.error_cnt++;
- restart:
-  gps_skytraq.status = UNINIT;
-  return;
-}
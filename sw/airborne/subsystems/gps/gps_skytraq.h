@@ -23,6 +23,7 @@
 #define GPS_SKYTRAQ_H
 
 #include "mcu_periph/uart.h"
+#include "subsystems/gps/gps_frame.h"
 
 #define SKYTRAQ_SYNC1 0xA0
 #define SKYTRAQ_SYNC2 0xA1
@@ -54,26 +55,10 @@
 
 
 
-/* last error type */
-#define GPS_SKYTRAQ_ERR_NONE         0
-#define GPS_SKYTRAQ_ERR_OVERRUN      1
-#define GPS_SKYTRAQ_ERR_MSG_TOO_LONG 2
-#define GPS_SKYTRAQ_ERR_CHECKSUM     3
-#define GPS_SKYTRAQ_ERR_OUT_OF_SYNC  4
-#define GPS_SKYTRAQ_ERR_UNEXPECTED   5
-
-#define GPS_SKYTRAQ_MAX_PAYLOAD 255
 struct GpsSkytraq {
-  uint8_t msg_buf[GPS_SKYTRAQ_MAX_PAYLOAD] __attribute__ ((aligned));
-  bool_t  msg_available;
-  uint8_t msg_id;
-
-  uint8_t  status;
-  uint16_t len;
-  uint8_t  msg_idx;
-  uint8_t  checksum;
-  uint8_t  error_cnt;
-  uint8_t  error_last;
+  struct gps_frame frame;
+  uint8_t* msg_buf;       ///< payload of the last frame, 4 bytes aligned
+  uint8_t  msg_id;
 };
 
 extern struct GpsSkytraq gps_skytraq;
@@ -89,10 +74,10 @@ extern struct GpsSkytraq gps_skytraq;
 #define GpsBuffer() GpsLink(ChAvailable())
 
 #define GpsEvent(_sol_available_callback) {                     \
-    if (GpsBuffer()) {                                          \
+    if (GpsBuffer() || GpsFramePending(gps_skytraq.frame)) {    \
       ReadGpsBuffer();                                          \
     }                                                           \
-    if (gps_skytraq.msg_available) {                            \
+    if (gps_skytraq.frame.available) {                          \
       gps_skytraq_read_message();                               \
       if (gps_skytraq.msg_id == SKYTRAQ_ID_NAVIGATION_DATA) {	\
         if (gps.fix == GPS_FIX_3D)                              \
@@ -100,17 +85,13 @@ extern struct GpsSkytraq gps_skytraq;
           gps.last_fix_time = cpu_time_sec;                     \
         _sol_available_callback();                              \
       }                                                         \
-      gps_skytraq.msg_available = FALSE;                        \
+      gps_skytraq.frame.available = FALSE;                      \
     }                                                           \
   }
 
-#define ReadGpsBuffer() {						\
-    while (GpsLink(ChAvailable())&&!gps_skytraq.msg_available)	\
-      gps_skytraq_parse(GpsLink(Getch()));				\
-  }
+#define ReadGpsBuffer() GpsFrameRead(gps_skytraq.frame)
 
 
 extern void gps_skytraq_read_message(void);
-extern void gps_skytraq_parse(uint8_t c);
 
 #endif /* GPS_SKYTRAQ_H */
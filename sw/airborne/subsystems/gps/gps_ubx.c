@@ -29,25 +29,6 @@
 #include "math/pprz_geodetic_float.h"
 #endif
 
-/* parser status */
-#define UNINIT        0
-#define GOT_SYNC1     1
-#define GOT_SYNC2     2
-#define GOT_CLASS     3
-#define GOT_ID        4
-#define GOT_LEN1      5
-#define GOT_LEN2      6
-#define GOT_PAYLOAD   7
-#define GOT_CHECKSUM1 8
-
-/* last error type */
-#define GPS_UBX_ERR_NONE         0
-#define GPS_UBX_ERR_OVERRUN      1
-#define GPS_UBX_ERR_MSG_TOO_LONG 2
-#define GPS_UBX_ERR_CHECKSUM     3
-#define GPS_UBX_ERR_UNEXPECTED   4
-#define GPS_UBX_ERR_OUT_OF_SYNC  5
-
 #define UTM_HEM_NORTH 0
 #define UTM_HEM_SOUTH 1
 
@@ -79,17 +60,49 @@
 
 struct GpsUbx gps_ubx;
 
+/* frame: sync1 sync2 class id len(2) payload ck_a ck_b */
+static uint16_t gps_ubx_frame_len(const uint8_t* header) {
+  uint16_t payload_len = header[4] | (header[5] << 8);
+  if (header[1] != UBX_SYNC2)
+    return 0;
+  /* too long for the buffer, before the sum can wrap */
+  if (payload_len > GPS_FRAME_MAX_LEN - 6 - 2)
+    return GPS_FRAME_MAX_LEN + 1;
+  return 6 + payload_len + 2;
+}
+
+/* Fletcher checksum over class, id, len and payload */
+static bool_t gps_ubx_check(const uint8_t* frame, uint16_t len) {
+  uint8_t ck_a = 0, ck_b = 0;
+  const uint8_t* c;
+  for (c = &frame[2]; c < &frame[len - 2]; c++) {
+    ck_a += *c;
+    ck_b += ck_a;
+  }
+  return (ck_a == frame[len - 2] && ck_b == frame[len - 1]);
+}
+
+static const struct gps_frame_proto gps_ubx_proto = {
+  .sync1 = UBX_SYNC1,
+  .sync1_alt = UBX_SYNC1,
+  .header_len = 6,
+  .frame_len = gps_ubx_frame_len,
+  .check = gps_ubx_check,
+  .payload_offset = 6
+};
+
 void gps_impl_init(void) {
-   gps_ubx.status = UNINIT;
-   gps_ubx.msg_available = FALSE;
-   gps_ubx.error_cnt = 0;
-   gps_ubx.error_last = GPS_UBX_ERR_NONE;
+   gps_frame_init(&gps_ubx.frame, &gps_ubx_proto);
    gps_ubx.have_velned = 0;
 }
 
 
 void gps_ubx_read_message(void) {
 
+  gps_ubx.msg_class = gps_ubx.frame.buf[2];
+  gps_ubx.msg_id = gps_ubx.frame.buf[3];
+  gps_ubx.msg_buf = &gps_ubx.frame.buf[6];
+
   if (gps_ubx.msg_class == UBX_NAV_ID) {
     if (gps_ubx.msg_id == UBX_NAV_SOL_ID) {
 #ifdef GPS_TIMESTAMP
@@ -187,86 +200,6 @@ void gps_ubx_read_message(void) {
 }
 
 
-/* UBX parsing */
-void gps_ubx_parse( uint8_t c ) {
-  if (gps_ubx.status < GOT_PAYLOAD) {
-    gps_ubx.ck_a += c;
-    gps_ubx.ck_b += gps_ubx.ck_a;
-  }
-  switch (gps_ubx.status) {
-  case UNINIT:
-    if (c == UBX_SYNC1)
-      gps_ubx.status++;
-    break;
-  case GOT_SYNC1:
-    if (c != UBX_SYNC2) {
-      gps_ubx.error_last = GPS_UBX_ERR_OUT_OF_SYNC;
-      goto error;
-    }
-    gps_ubx.ck_a = 0;
-    gps_ubx.ck_b = 0;
-    gps_ubx.status++;
-    break;
-  case GOT_SYNC2:
-    if (gps_ubx.msg_available) {
-      /* Previous message has not yet been parsed: discard this one */
-      gps_ubx.error_last = GPS_UBX_ERR_OVERRUN;
-      goto error;
-    }
-    gps_ubx.msg_class = c;
-    gps_ubx.status++;
-    break;
-  case GOT_CLASS:
-    gps_ubx.msg_id = c;
-    gps_ubx.status++;
-    break;
-  case GOT_ID:
-    gps_ubx.len = c;
-    gps_ubx.status++;
-    break;
-  case GOT_LEN1:
-    gps_ubx.len |= (c<<8);
-    if (gps_ubx.len > GPS_UBX_MAX_PAYLOAD) {
-      gps_ubx.error_last = GPS_UBX_ERR_MSG_TOO_LONG;
-      goto error;
-    }
-    gps_ubx.msg_idx = 0;
-    gps_ubx.status++;
-    break;
-  case GOT_LEN2:
-    gps_ubx.msg_buf[gps_ubx.msg_idx] = c;
-    gps_ubx.msg_idx++;
-    if (gps_ubx.msg_idx >= gps_ubx.len) {
-      gps_ubx.status++;
-    }
-    break;
-  case GOT_PAYLOAD:
-    if (c != gps_ubx.ck_a) {
-      gps_ubx.error_last = GPS_UBX_ERR_CHECKSUM;
-      goto error;
-    }
-    gps_ubx.status++;
-    break;
-  case GOT_CHECKSUM1:
-    if (c != gps_ubx.ck_b) {
-      gps_ubx.error_last = GPS_UBX_ERR_CHECKSUM;
-      goto error;
-    }
-    gps_ubx.msg_available = TRUE;
-    goto restart;
-    break;
-  default:
-    gps_ubx.error_last = GPS_UBX_ERR_UNEXPECTED;
-    goto error;
-  }
-  return;
- error:
-  gps_ubx.error_cnt++;
- restart:
-  gps_ubx.status = UNINIT;
-  return;
-}
-
 #ifdef GPS_UBX_UCENTER
 #include GPS_UBX_UCENTER
 #endif
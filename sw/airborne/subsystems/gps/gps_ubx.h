@@ -32,26 +32,20 @@
 #endif
 
 #include "mcu_periph/uart.h"
+#include "subsystems/gps/gps_frame.h"
 
 /** Includes macros generated from ubx.xml */
 #include "ubx_protocol.h"
 
 #define GPS_NB_CHANNELS 16
 
-#define GPS_UBX_MAX_PAYLOAD 255
 struct GpsUbx {
-  bool_t msg_available;
-  uint8_t msg_buf[GPS_UBX_MAX_PAYLOAD] __attribute__ ((aligned));
+  struct gps_frame frame;
+  uint8_t* msg_buf;       ///< payload of the last frame
   uint8_t msg_id;
   uint8_t msg_class;
 
-  uint8_t status;
-  uint16_t len;
-  uint8_t msg_idx;
-  uint8_t ck_a, ck_b;
   uint8_t send_ck_a, send_ck_b;
-  uint8_t error_cnt;
-  uint8_t error_last;
 
   uint8_t status_flags;
   uint8_t sol_flags;
@@ -80,10 +74,10 @@ extern struct GpsUbx gps_ubx;
  * For rotorcraft, only SOL message is needed for pos/speed data
  */
 #define GpsEvent(_sol_available_callback) {        \
-    if (GpsBuffer()) {                             \
+    if (GpsBuffer() || GpsFramePending(gps_ubx.frame)) { \
       ReadGpsBuffer();                             \
     }                                              \
-    if (gps_ubx.msg_available) {                   \
+    if (gps_ubx.frame.available) {                 \
       gps_ubx_read_message();                      \
       gps_ubx_ucenter_event();                     \
       if (gps_ubx.msg_class == UBX_NAV_ID &&       \
@@ -96,18 +90,14 @@ extern struct GpsUbx gps_ubx;
         }                                          \
         _sol_available_callback();                 \
       }                                            \
-      gps_ubx.msg_available = FALSE;               \
+      gps_ubx.frame.available = FALSE;             \
     }                                              \
   }
 
-#define ReadGpsBuffer() {					\
-    while (GpsLink(ChAvailable())&&!gps_ubx.msg_available)	\
-      gps_ubx_parse(GpsLink(Getch()));			\
-  }
+#define ReadGpsBuffer() GpsFrameRead(gps_ubx.frame)
 
 
 extern void gps_ubx_read_message(void);
-extern void gps_ubx_parse(uint8_t c);
 
 
 
@@ -147,77 +147,56 @@ static inline void b2_hff_compute_accel_body_mean(uint8_t n) {
 /*
  * For GPS lag compensation
  *
+ * The GPS measurements are valid GPS_LAG seconds (defined in the airframe
+ * file) before they are received. The filter keeps the states and
+ * covariances of the last GPS_LAG_N propagation steps, and a GPS update
+ * is done on the state of its validity time, then forwarded to the
+ * present.
  *
- *
+ * As propagation is linear and does not depend on the measurement, no
+ * re-propagation of the past accelerations is needed: a correction dX, dP
+ * made m steps ago is, in the present state,
+ *   dX_m = F^m dX
+ *   dP_m = F^m dP F^m'
+ * with F^m = [ 1 m*dt ; 0 1 ]. It is added to the current state and to
+ * the more recent states of the history, so that the next update finds
+ * them corrected.
  */
 #ifdef GPS_LAG
-/*
- * GPS_LAG is defined in seconds in airframe file
- */
 
-/* number of propagaton steps to redo according to GPS_LAG */
+/* number of propagation steps between the GPS validity time and its reception */
 #define GPS_LAG_N ((int) (GPS_LAG * HFF_FREQ + 0.5))
-/* number of propagation steps between two GPS updates */
-#define GPS_DT_N ((int) (HFF_FREQ / 4))
-/* tolerance of the GPS lag accuracy is +- GPS_LAG_TOLERANCE seconds */
-#define GPS_LAG_TOLERANCE 0.08
-#define GPS_LAG_TOL_N ((int) (GPS_LAG_TOLERANCE * HFF_FREQ + 0.5))
-
-/* maximum number of past propagation steps to rerun per ap cycle
- * make sure GPS_LAG_N/MAX_PP_STEPS < 128
- * GPS_LAG_N/MAX_PP_STEPS/512 = seconds until re-propagation catches up with the present
- */
-#define MAX_PP_STEPS 6
 
-/* variables for mean accel buffer */
-#define ACC_BUF_MAXN (GPS_LAG_N+10)
-#define INC_ACC_IDX(idx) {	idx = (idx + 1) < ACC_BUF_MAXN ? (idx + 1) : 0;	}
-
-struct FloatVect2 past_accel[ACC_BUF_MAXN]; /* buffer with past mean accel values for redoing the propagation */
-unsigned int acc_buf_r; /* pos to read from, oldest measurement */
-unsigned int acc_buf_w; /* pos to write to */
-unsigned int acc_buf_n; /* number of elements in buffer */
-
-
-/*
- * stuff for ringbuffer to store past filter states
- */
-#define HFF_RB_MAXN ((int) (GPS_LAG * 4))
-#define INC_RB_POINTER(ptr) {					\
-	if (ptr == &b2_hff_rb[HFF_RB_MAXN-1])		\
-	  ptr = b2_hff_rb;							\
-	else										\
-	  ptr++;									\
-  }
+/* past filter state, covariances are symmetric */
+struct HfilterHist {
+  float x;
+  float xdot;
+  float y;
+  float ydot;
+  float xP00, xP01, xP11;
+  float yP00, yP01, yP11;
+};
 
-struct HfilterFloat b2_hff_rb[HFF_RB_MAXN]; /* ringbuffer with state and covariance when GPS was valid */
-struct HfilterFloat *b2_hff_rb_put; /* write pointer */
+/* history of the last GPS_LAG_N states, plus the current one */
+#define HFF_HIST_N (GPS_LAG_N + 1)
+struct HfilterHist b2_hff_hist[HFF_HIST_N];
+/* pos to write to, the newest state is just before */
+int b2_hff_hist_w;
+/* number of states in the history */
+int16_t b2_hff_hist_n;
+
+/* number of steps back of the last GPS update */
+uint16_t b2_hff_gps_lag_n;
+/* steps of GPS_LAG_N that were not in the history yet for the last GPS update */
+int16_t b2_hff_gps_lag_err;
+
+static inline void b2_hff_hist_put_state(struct HfilterFloat* source);
+static inline void b2_hff_update_gps_past(void);
 #endif /* GPS_LAG */
 
-struct HfilterFloat *b2_hff_rb_last; /* read pointer */
-int b2_hff_rb_n; /* fill count */
-
-
-/* by how many steps the estimated GPS validity point in time differed from GPS_LAG_N */
-int lag_counter_err;
-
-/* counts down the propagation steps until the filter state is saved again */
-int save_counter;
-int past_save_counter;
-#define SAVE_NOW 0
-#define SAVING -1
-#define SAVE_DONE -2
-
 uint16_t b2_hff_lost_limit;
 uint16_t b2_hff_lost_counter;
 
-#ifdef GPS_LAG
-static inline void b2_hff_get_past_accel(unsigned int back_n);
-static inline void b2_hff_rb_put_state(struct HfilterFloat* source);
-static inline void b2_hff_rb_drop_last(void);
-static inline void b2_hff_set_state(struct HfilterFloat* dest, struct HfilterFloat* source);
-#endif
-
 
 
 static inline void b2_hff_init_x(float init_x, float init_xdot);
@@ -245,31 +224,16 @@ void b2_hff_init(float init_x, float init_xdot, float init_y, float init_ydot) {
   acc_body.n = 0;
   acc_body.size = ACC_RB_MAXN;
 #ifdef GPS_LAG
-  /* init buffer for past mean accel values */
-  acc_buf_r = 0;
-  acc_buf_w = 0;
-  acc_buf_n = 0;
-  b2_hff_rb_put = b2_hff_rb;
-  b2_hff_rb_last = b2_hff_rb;
-  b2_hff_rb_last->rollback = FALSE;
-  b2_hff_rb_last->lag_counter = 0;
-  b2_hff_state.lag_counter = GPS_LAG_N;
+  b2_hff_hist_w = 0;
+  b2_hff_hist_n = 0;
+  b2_hff_gps_lag_n = 0;
+  b2_hff_gps_lag_err = 0;
 #ifdef SITL
   printf("GPS_LAG: %f\n", GPS_LAG);
   printf("GPS_LAG_N: %d\n", GPS_LAG_N);
-  printf("GPS_DT_N: %d\n", GPS_DT_N);
   printf("DT_HFILTER: %f\n", DT_HFILTER);
-  printf("GPS_LAG_TOL_N: %i\n", GPS_LAG_TOL_N);
 #endif
-#else
-  b2_hff_rb_last = &b2_hff_state;
-  b2_hff_state.lag_counter = 0;
 #endif
-  b2_hff_rb_n = 0;
-  b2_hff_state.rollback = FALSE;
-  lag_counter_err = 0;
-  save_counter = -1;
-  past_save_counter = SAVE_DONE;
   b2_hff_ps_counter = 1;
   b2_hff_lost_counter = 0;
   b2_hff_lost_limit = HFF_LOST_LIMIT;
@@ -299,120 +263,24 @@ static inline void b2_hff_init_y(float init_y, float init_ydot) {
 }
 
 #ifdef GPS_LAG
-static inline void b2_hff_store_accel_ltp(float x, float y) {
-  past_accel[acc_buf_w].x = x;
-  past_accel[acc_buf_w].y = y;
-  INC_ACC_IDX(acc_buf_w);
-
-  if (acc_buf_n < ACC_BUF_MAXN) {
-	acc_buf_n++;
-  } else {
-	INC_ACC_IDX(acc_buf_r);
-  }
-}
-
-/* get the accel values from back_n steps ago */
-static inline void b2_hff_get_past_accel(unsigned int back_n) {
-  int i;
-  if (back_n > acc_buf_n) {
-	PRINT_DBG(1, ("Cannot go back %d steps, going back only %d instead!\n", back_n, acc_buf_n));
-	back_n = acc_buf_n;
-  } else if (back_n == 0) {
-	PRINT_DBG(1, ("Cannot go back zero steps!\n"));
-	return;
-  }
-  if ((int)(acc_buf_w - back_n) < 0)
-	i = acc_buf_w - back_n  + ACC_BUF_MAXN;
-  else
-	i = acc_buf_w - back_n;
-  b2_hff_xdd_meas = past_accel[i].x;
-  b2_hff_ydd_meas = past_accel[i].y;
-  PRINT_DBG(3, ("get past accel. buf_n: %2d \tbuf_w: %2d \tback_n: %2d \ti: %2d \txdd: %f \tydd: %f\n", acc_buf_n, acc_buf_w, back_n, i, b2_hff_xdd_meas, b2_hff_ydd_meas));
+static inline void b2_hff_hist_set(struct HfilterHist* h, struct HfilterFloat* source) {
+  h->x    = source->x;
+  h->xdot = source->xdot;
+  h->y    = source->y;
+  h->ydot = source->ydot;
+  h->xP00 = source->xP[0][0];
+  h->xP01 = source->xP[0][1];
+  h->xP11 = source->xP[1][1];
+  h->yP00 = source->yP[0][0];
+  h->yP01 = source->yP[0][1];
+  h->yP11 = source->yP[1][1];
 }
 
-static inline void b2_hff_rb_put_state(struct HfilterFloat* source) {
-  /* copy state from source into buffer */
-  b2_hff_set_state(b2_hff_rb_put, source);
-  b2_hff_rb_put->lag_counter = 0;
-  b2_hff_rb_put->rollback = FALSE;
-
-  /* forward write pointer */
-  INC_RB_POINTER(b2_hff_rb_put);
-
-  /* increase fill count and forward last pointer if neccessary */
-  if (b2_hff_rb_n < HFF_RB_MAXN) {
-	b2_hff_rb_n++;
-  } else {
-	INC_RB_POINTER(b2_hff_rb_last);
-  }
-  PRINT_DBG(2, ("put state. fill count now: %d\n", b2_hff_rb_n));
-}
-
-static inline void b2_hff_rb_drop_last(void) {
-  if (b2_hff_rb_n > 0) {
-	INC_RB_POINTER(b2_hff_rb_last);
-	b2_hff_rb_n--;
-  } else {
-	PRINT_DBG(2, ("hff ringbuffer empty!\n"));
-	b2_hff_rb_last->lag_counter = 0;
-	b2_hff_rb_last->rollback = FALSE;
-  }
-  PRINT_DBG(2, ("drop last state. fill count now: %d\n", b2_hff_rb_n));
-}
-
-
-/* copy source state to dest state */
-static inline void b2_hff_set_state(struct HfilterFloat* dest, struct HfilterFloat* source) {
-  dest->x       = source->x;
-  dest->xdot    = source->xdot;
-  dest->xdotdot = source->xdotdot;
-  dest->y       = source->y;
-  dest->ydot    = source->ydot;
-  dest->ydotdot = source->ydotdot;
-  for (int i=0; i < HFF_STATE_SIZE; i++) {
-	for (int j=0; j < HFF_STATE_SIZE; j++) {
-	  dest->xP[i][j] = source->xP[i][j];
-	  dest->yP[i][j] = source->yP[i][j];
-	}
-  }
-}
-
-static inline void b2_hff_propagate_past(struct HfilterFloat* hff_past) {
-  PRINT_DBG(1, ("enter propagate past: %d\n", hff_past->lag_counter));
-  /* run max MAX_PP_STEPS propagation steps */
-  for (int i=0; i < MAX_PP_STEPS; i++) {
-	if (hff_past->lag_counter > 0) {
-	  b2_hff_get_past_accel(hff_past->lag_counter);
-	  PRINT_DBG(2, ("propagate past: %d\n", hff_past->lag_counter));
-	  b2_hff_propagate_x(hff_past);
-	  b2_hff_propagate_y(hff_past);
-	  hff_past->lag_counter--;
-
-	  if (past_save_counter > 0) {
-		past_save_counter--;
-		PRINT_DBG(2, ("dec past_save_counter: %d\n", past_save_counter));
-	  } else if (past_save_counter == SAVE_NOW) {
-		/* next GPS measurement valid at this state -> save */
-		PRINT_DBG(2, ("save past state\n"));
-		b2_hff_rb_put_state(hff_past);
-		past_save_counter = SAVING;
-	  } else if (past_save_counter == SAVING) {
-		/* increase lag counter on if next state is already saved */
-		if (hff_past == &b2_hff_rb[HFF_RB_MAXN-1])
-		  b2_hff_rb[0].lag_counter++;
-		else
-		  (hff_past+1)->lag_counter++;
-	  }
-	}
-
-	/* finished re-propagating the past values */
-	if (hff_past->lag_counter == 0) {
-	  b2_hff_set_state(&b2_hff_state, hff_past);
-	  b2_hff_rb_drop_last();
-      past_save_counter = SAVE_DONE;
-	  break;
-	}
-  }
+static inline void b2_hff_hist_put_state(struct HfilterFloat* source) {
+  b2_hff_hist_set(&b2_hff_hist[b2_hff_hist_w], source);
+  b2_hff_hist_w = (b2_hff_hist_w + 1) < HFF_HIST_N ? (b2_hff_hist_w + 1) : 0;
+  if (b2_hff_hist_n < HFF_HIST_N)
+    b2_hff_hist_n++;
 }
 #endif /* GPS_LAG */
 
@@ -422,13 +290,6 @@ void b2_hff_propagate(void) {
   if (b2_hff_lost_counter < b2_hff_lost_limit)
     b2_hff_lost_counter++;
 
-#ifdef GPS_LAG
-  /* continue re-propagating to catch up with the present */
-  if (b2_hff_rb_last->rollback) {
-	b2_hff_propagate_past(b2_hff_rb_last);
-  }
-#endif
-
   /* store body accelerations for mean computation */
   b2_hff_store_accel_body();
 
@@ -443,9 +304,6 @@ void b2_hff_propagate(void) {
       INT32_RMAT_TRANSP_VMULT(mean_accel_ltp, ahrs.ltp_to_body_rmat, acc_body_mean);
       b2_hff_xdd_meas = ACCEL_FLOAT_OF_BFP(mean_accel_ltp.x);
       b2_hff_ydd_meas = ACCEL_FLOAT_OF_BFP(mean_accel_ltp.y);
-#ifdef GPS_LAG
-      b2_hff_store_accel_ltp(b2_hff_xdd_meas, b2_hff_ydd_meas);
-#endif
 
       /*
        * propagate current state
@@ -462,18 +320,8 @@ void b2_hff_propagate(void) {
       ins_ltp_pos.y   = POS_BFP_OF_REAL(b2_hff_state.y);
 
 #ifdef GPS_LAG
-      /* increase lag counter on last saved state */
-      if (b2_hff_rb_n > 0)
-        b2_hff_rb_last->lag_counter++;
-
-      /* save filter state if needed */
-      if (save_counter == 0) {
-        PRINT_DBG(1, ("save current state\n"));
-        b2_hff_rb_put_state(&b2_hff_state);
-        save_counter = -1;
-      } else if (save_counter > 0) {
-        save_counter--;
-      }
+      /* keep the state for the delayed GPS updates */
+      b2_hff_hist_put_state(&b2_hff_state);
 #endif
     }
   } else {
@@ -498,55 +346,128 @@ void b2_hff_update_gps(void) {
 #endif
 
 #ifdef GPS_LAG
-  if (GPS_LAG_N == 0) {
+  if (GPS_LAG_N > 0) {
+    b2_hff_update_gps_past();
+    return;
+  }
 #endif
 
-    /* update filter state with measurement */
-    b2_hff_update_x(&b2_hff_state, ins_gps_pos_m_ned.x, Rgps_pos);
-    b2_hff_update_y(&b2_hff_state, ins_gps_pos_m_ned.y, Rgps_pos);
+  /* update filter state with measurement */
+  b2_hff_update_x(&b2_hff_state, ins_gps_pos_m_ned.x, Rgps_pos);
+  b2_hff_update_y(&b2_hff_state, ins_gps_pos_m_ned.y, Rgps_pos);
 #ifdef HFF_UPDATE_SPEED
-    b2_hff_update_xdot(&b2_hff_state, ins_gps_speed_m_s_ned.x, Rgps_vel);
-    b2_hff_update_ydot(&b2_hff_state, ins_gps_speed_m_s_ned.y, Rgps_vel);
+  b2_hff_update_xdot(&b2_hff_state, ins_gps_speed_m_s_ned.x, Rgps_vel);
+  b2_hff_update_ydot(&b2_hff_state, ins_gps_speed_m_s_ned.y, Rgps_vel);
 #endif
 
-    /* update ins state */
-    ins_ltp_accel.x = ACCEL_BFP_OF_REAL(b2_hff_state.xdotdot);
-    ins_ltp_accel.y = ACCEL_BFP_OF_REAL(b2_hff_state.ydotdot);
-    ins_ltp_speed.x = SPEED_BFP_OF_REAL(b2_hff_state.xdot);
-    ins_ltp_speed.y = SPEED_BFP_OF_REAL(b2_hff_state.ydot);
-    ins_ltp_pos.x   = POS_BFP_OF_REAL(b2_hff_state.x);
-    ins_ltp_pos.y   = POS_BFP_OF_REAL(b2_hff_state.y);
+  /* update ins state */
+  ins_ltp_accel.x = ACCEL_BFP_OF_REAL(b2_hff_state.xdotdot);
+  ins_ltp_accel.y = ACCEL_BFP_OF_REAL(b2_hff_state.ydotdot);
+  ins_ltp_speed.x = SPEED_BFP_OF_REAL(b2_hff_state.xdot);
+  ins_ltp_speed.y = SPEED_BFP_OF_REAL(b2_hff_state.ydot);
+  ins_ltp_pos.x   = POS_BFP_OF_REAL(b2_hff_state.x);
+  ins_ltp_pos.y   = POS_BFP_OF_REAL(b2_hff_state.y);
+}
 
 #ifdef GPS_LAG
-  } else if (b2_hff_rb_n > 0) {
-    /* roll back if state was saved approx when GPS was valid */
-    lag_counter_err = b2_hff_rb_last->lag_counter - GPS_LAG_N;
-    PRINT_DBG(2, ("update. rb_n: %d  lag_counter: %d  lag_cnt_err: %d\n", b2_hff_rb_n, b2_hff_rb_last->lag_counter, lag_counter_err));
-    if (abs(lag_counter_err) <= GPS_LAG_TOL_N) {
-      b2_hff_rb_last->rollback = TRUE;
-      b2_hff_update_x(b2_hff_rb_last, ins_gps_pos_m_ned.x, Rgps_pos);
-      b2_hff_update_y(b2_hff_rb_last, ins_gps_pos_m_ned.y, Rgps_pos);
+/* add F^m dX and F^m dP F^m' to a state, tau = m * dt */
+#define HFF_FORWARD_CORRECTION(_x, _xdot, _P00, _P01, _P11, _d, _tau) {	\
+    _x    += _d.x + (_tau) * _d.xdot;					\
+    _xdot += _d.xdot;							\
+    _P00  += _d.xP00 + (_tau) * (2 * _d.xP01 + (_tau) * _d.xP11);	\
+    _P01  += _d.xP01 + (_tau) * _d.xP11;				\
+    _P11  += _d.xP11;							\
+  }
+
+/*
+ * GPS update on the state of GPS_LAG_N steps ago, or the oldest one of the
+ * history if it is not full yet, forwarded to the newer states.
+ */
+static inline void b2_hff_update_gps_past(void) {
+  if (b2_hff_hist_n == 0) {
+    /* nothing to go back to */
+    b2_hff_gps_lag_n = 0;
+    b2_hff_gps_lag_err = GPS_LAG_N;
+  }
+  else {
+    int back_n = GPS_LAG_N < b2_hff_hist_n - 1 ? GPS_LAG_N : b2_hff_hist_n - 1;
+    b2_hff_gps_lag_n = back_n;
+    b2_hff_gps_lag_err = GPS_LAG_N - back_n;
+  }
+  const int back_n = b2_hff_gps_lag_n;
+
+  /* the past state, the newest one of the history is the current state */
+  struct HfilterFloat past;
+  int i = b2_hff_hist_w - 1 - back_n;
+  if (i < 0)
+    i += HFF_HIST_N;
+  if (back_n == 0) {
+    past = b2_hff_state;
+  }
+  else {
+    struct HfilterHist* h = &b2_hff_hist[i];
+    past.x = h->x;
+    past.xdot = h->xdot;
+    past.y = h->y;
+    past.ydot = h->ydot;
+    past.xP[0][0] = h->xP00;
+    past.xP[0][1] = past.xP[1][0] = h->xP01;
+    past.xP[1][1] = h->xP11;
+    past.yP[0][0] = h->yP00;
+    past.yP[0][1] = past.yP[1][0] = h->yP01;
+    past.yP[1][1] = h->yP11;
+  }
+  const struct HfilterFloat prior = past;
+
+  /* update it with the measurement */
+  b2_hff_update_x(&past, ins_gps_pos_m_ned.x, Rgps_pos);
+  b2_hff_update_y(&past, ins_gps_pos_m_ned.y, Rgps_pos);
 #ifdef HFF_UPDATE_SPEED
-      b2_hff_update_xdot(b2_hff_rb_last, ins_gps_speed_m_s_ned.x, Rgps_vel);
-      b2_hff_update_ydot(b2_hff_rb_last, ins_gps_speed_m_s_ned.y, Rgps_vel);
+  b2_hff_update_xdot(&past, ins_gps_speed_m_s_ned.x, Rgps_vel);
+  b2_hff_update_ydot(&past, ins_gps_speed_m_s_ned.y, Rgps_vel);
 #endif
-      past_save_counter = GPS_DT_N-1;// + lag_counter_err;
-      PRINT_DBG(2, ("gps updated. past_save_counter: %d\n", past_save_counter));
-      b2_hff_propagate_past(b2_hff_rb_last);
-    } else if (lag_counter_err >= GPS_DT_N - (GPS_LAG_TOL_N+1)) {
-      /* apparently missed a GPS update, try next saved state */
-      PRINT_DBG(2, ("try next saved state\n"));
-      b2_hff_rb_drop_last();
-      b2_hff_update_gps();
-    }
-  } else if (save_counter < 0) {
-    /* ringbuffer empty -> save output filter state at next GPS validity point in time */
-    save_counter = GPS_DT_N-1 - (GPS_LAG_N % GPS_DT_N);
-    PRINT_DBG(2, ("rb empty, save counter set: %d\n", save_counter));
-  }
 
-#endif /* GPS_LAG */
+  /* corrections, y ones in the x fields */
+  struct HfilterHist dx, dy;
+  dx.x    = past.x - prior.x;
+  dx.xdot = past.xdot - prior.xdot;
+  dx.xP00 = past.xP[0][0] - prior.xP[0][0];
+  dx.xP01 = past.xP[0][1] - prior.xP[0][1];
+  dx.xP11 = past.xP[1][1] - prior.xP[1][1];
+  dy.x    = past.y - prior.y;
+  dy.xdot = past.ydot - prior.ydot;
+  dy.xP00 = past.yP[0][0] - prior.yP[0][0];
+  dy.xP01 = past.yP[0][1] - prior.yP[0][1];
+  dy.xP11 = past.yP[1][1] - prior.yP[1][1];
+
+  /* forward them to the states of the history after it */
+  for (int m = 0; m < back_n; m++) {
+    struct HfilterHist* h = &b2_hff_hist[i];
+    const float tau = m * DT_HFILTER;
+    HFF_FORWARD_CORRECTION(h->x, h->xdot, h->xP00, h->xP01, h->xP11, dx, tau);
+    HFF_FORWARD_CORRECTION(h->y, h->ydot, h->yP00, h->yP01, h->yP11, dy, tau);
+    i = (i + 1) < HFF_HIST_N ? (i + 1) : 0;
+  }
+  /* and to the current state, which is the newest one of the history */
+  const float tau = back_n * DT_HFILTER;
+  HFF_FORWARD_CORRECTION(b2_hff_state.x, b2_hff_state.xdot,
+                         b2_hff_state.xP[0][0], b2_hff_state.xP[0][1], b2_hff_state.xP[1][1], dx, tau);
+  HFF_FORWARD_CORRECTION(b2_hff_state.y, b2_hff_state.ydot,
+                         b2_hff_state.yP[0][0], b2_hff_state.yP[0][1], b2_hff_state.yP[1][1], dy, tau);
+  b2_hff_state.xP[1][0] = b2_hff_state.xP[0][1];
+  b2_hff_state.yP[1][0] = b2_hff_state.yP[0][1];
+  if (b2_hff_hist_n > 0)
+    b2_hff_hist_set(&b2_hff_hist[i], &b2_hff_state);
+
+  /* update ins state */
+  ins_ltp_accel.x = ACCEL_BFP_OF_REAL(b2_hff_state.xdotdot);
+  ins_ltp_accel.y = ACCEL_BFP_OF_REAL(b2_hff_state.ydotdot);
+  ins_ltp_speed.x = SPEED_BFP_OF_REAL(b2_hff_state.xdot);
+  ins_ltp_speed.y = SPEED_BFP_OF_REAL(b2_hff_state.ydot);
+  ins_ltp_pos.x   = POS_BFP_OF_REAL(b2_hff_state.x);
+  ins_ltp_pos.y   = POS_BFP_OF_REAL(b2_hff_state.y);
 }
+#endif /* GPS_LAG */
 
 
 void b2_hff_realign(struct FloatVect2 pos, struct FloatVect2 vel) {
@@ -555,11 +476,8 @@ void b2_hff_realign(struct FloatVect2 pos, struct FloatVect2 vel) {
   b2_hff_state.xdot = vel.x;
   b2_hff_state.ydot = vel.y;
 #ifdef GPS_LAG
-  while (b2_hff_rb_n > 0) {
-	b2_hff_rb_drop_last();
-  }
-  save_counter = -1;
-  past_save_counter = SAVE_DONE;
+  /* past states are not consistent with the new one anymore */
+  b2_hff_hist_n = 0;
 #endif
 }
 
@@ -50,8 +50,6 @@ struct HfilterFloat {
   float ydotdot;
   float xP[HFF_STATE_SIZE][HFF_STATE_SIZE];
   float yP[HFF_STATE_SIZE][HFF_STATE_SIZE];
-  uint8_t lag_counter;
-  bool_t rollback;
 };
 
 extern struct HfilterFloat b2_hff_state;
@@ -76,8 +74,10 @@ extern uint16_t b2_hff_lost_counter;
 
 extern void b2_hff_store_accel_body(void);
 
-extern struct HfilterFloat *b2_hff_rb_last;
-extern int lag_counter_err;
-extern int save_counter;
+#ifdef GPS_LAG
+extern uint16_t b2_hff_gps_lag_n;
+extern int16_t b2_hff_gps_lag_err;
+extern int16_t b2_hff_hist_n;
+#endif
 
 #endif /* HF_FLOAT_H */
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Replays a sensor log through one AHRS implementation and reports the
+ * cost of ahrs_propagate / ahrs_update_accel / ahrs_update_mag and the
+ * attitude error against the true attitude.
+ *
+ * The log is the one written by nps with --imu_log <file>
+ * (sw/simulator/nps/nps_imu_log.c): the run_ahrs_on_flight_log format
+ * followed by the true ltp_to_imu quaternion. Logs without the quaternion
+ * are accepted, only timings are reported then.
+ *
+ * Built once per filter, see the Makefile:
+ *   make bench LOG=<file>
+ *
+ * usage: bench_ahrs_<filter> <file> [settle time (s), default 10]
+ *   the attitude error is computed after the alignment and the settle time.
+ *
+ * Costs are the ones of the host, which has an FPU: they do not give the
+ * cost on the targets, to be measured on the board (see sys_prof).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "std.h"
+
+#include "math/pprz_algebra_float.h"
+#include "math/pprz_algebra_double.h"
+#include "math/pprz_algebra_int.h"
+
+#include "subsystems/ahrs.h"
+#include "subsystems/ahrs/ahrs_aligner.h"
+#include "subsystems/imu.h"
+
+#ifndef AHRS_BENCH_NAME
+#define AHRS_BENCH_NAME "ahrs"
+#endif
+
+/* host clock, used to turn ns into host cycles, set it to the one of your host */
+#ifndef BENCH_HOST_MHZ
+#define BENCH_HOST_MHZ 3000.
+#endif
+
+/*
+ * set by the Makefile:
+ *  AHRS_BENCH_FLOAT_STATE : the estimate is in ahrs_float rather than ahrs
+ */
+
+/* from fms_autopilot_msg.h */
+#define VI_IMU_DATA_VALID      0
+#define VI_MAG_DATA_VALID      1
+#define IMU_AVAILABLE(_flag) (_flag & (1<<VI_IMU_DATA_VALID))
+#define MAG_AVAILABLE(_flag) (_flag & (1<<VI_MAG_DATA_VALID))
+
+#define MAX_SAMPLE 2000000
+
+struct test_sample {
+  double time;
+  uint8_t flag;
+  struct DoubleRates gyro;
+  struct DoubleVect3 accel;
+  struct DoubleVect3 mag;
+  struct DoubleVect3 gps_pecef;
+  struct DoubleVect3 gps_vecef;
+  double baro;
+  struct DoubleQuat  quat_true;
+};
+static struct test_sample* samples;
+static int nb_samples;
+static bool_t has_truth;
+
+/* time spent and number of calls for each entry point */
+struct bench_stat {
+  const char* name;
+  double ns;
+  unsigned long nb;
+};
+static struct bench_stat stat_propagate = { "propagate", 0., 0 };
+static struct bench_stat stat_accel     = { "update_accel", 0., 0 };
+static struct bench_stat stat_mag       = { "update_mag", 0., 0 };
+
+/* cost of an empty measurement, removed from each call */
+static double timer_overhead;
+
+static inline double now_ns(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return 1e9 * t.tv_sec + t.tv_nsec;
+}
+
+#define BENCH_CALL(_stat, _call) {					\
+    double t0 = now_ns();						\
+    _call;								\
+    (_stat).ns += now_ns() - t0 - timer_overhead;			\
+    (_stat).nb++;							\
+  }
+
+static void read_log(const char* filename);
+static void calibrate_timer(void);
+static void feed_imu(int i);
+static double attitude_error(int i);
+static void report_stat(struct bench_stat* s);
+
+int main(int argc, char** argv) {
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <log file> [settle time (s)]\n", argv[0]);
+    return 1;
+  }
+  double settle_time = argc > 2 ? atof(argv[2]) : 10.;
+
+  read_log(argv[1]);
+  calibrate_timer();
+
+  imu_init();
+  ahrs_aligner_init();
+  ahrs_init();
+
+  double t_running = -1.;
+  double err_sum2 = 0., err_max = 0.;
+  unsigned long err_nb = 0;
+
+  for (int i = 0; i < nb_samples; i++) {
+    feed_imu(i);
+    if (ahrs.status == AHRS_UNINIT) {
+      ahrs_aligner_run();
+      if (ahrs_aligner.status == AHRS_ALIGNER_LOCKED) {
+        ahrs_align();
+        t_running = samples[i].time;
+      }
+      continue;
+    }
+    BENCH_CALL(stat_propagate, ahrs_propagate());
+    if (IMU_AVAILABLE(samples[i].flag))
+      BENCH_CALL(stat_accel, ahrs_update_accel());
+    if (MAG_AVAILABLE(samples[i].flag))
+      BENCH_CALL(stat_mag, ahrs_update_mag());
+
+    if (has_truth && samples[i].time - t_running >= settle_time) {
+      double err = attitude_error(i);
+      err_sum2 += err * err;
+      if (err > err_max)
+        err_max = err;
+      err_nb++;
+    }
+  }
+
+  printf("--- %s : %d samples, aligned at %.2fs, timer overhead %.1f ns ---\n",
+         AHRS_BENCH_NAME, nb_samples, t_running, timer_overhead);
+  printf("%-13s %8s %9s %12s\n", "", "calls", "host ns", "host cycles");
+  report_stat(&stat_propagate);
+  report_stat(&stat_accel);
+  report_stat(&stat_mag);
+  if (err_nb > 0)
+    printf("attitude error after %.0fs: rms %.3f deg, max %.3f deg (%lu samples)\n",
+           settle_time, DegOfRad(sqrt(err_sum2 / err_nb)), DegOfRad(err_max), err_nb);
+  else if (!has_truth)
+    printf("no true attitude in the log\n");
+
+  return 0;
+}
+
+/*
+ * Read a log, with or without the true quaternion
+ */
+static void read_log(const char* filename) {
+  FILE* fd = fopen(filename, "r");
+  if (fd == NULL) {
+    perror(filename);
+    exit(EXIT_FAILURE);
+  }
+  samples = malloc(MAX_SAMPLE * sizeof(struct test_sample));
+  if (samples == NULL) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  char line[512];
+  nb_samples = 0;
+  has_truth = TRUE;
+  while (nb_samples < MAX_SAMPLE && fgets(line, sizeof(line), fd)) {
+    struct test_sample* s = &samples[nb_samples];
+    int ret = sscanf(line, "%lf %hhu %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf",
+                     &s->time, &s->flag,
+                     &s->gyro.p, &s->gyro.q, &s->gyro.r,
+                     &s->accel.x, &s->accel.y, &s->accel.z,
+                     &s->mag.x, &s->mag.y, &s->mag.z,
+                     &s->gps_pecef.x, &s->gps_pecef.y, &s->gps_pecef.z,
+                     &s->gps_vecef.x, &s->gps_vecef.y, &s->gps_vecef.z,
+                     &s->baro,
+                     &s->quat_true.qi, &s->quat_true.qx, &s->quat_true.qy, &s->quat_true.qz);
+    if (ret < 18)
+      break;
+    if (ret < 22)
+      has_truth = FALSE;
+    nb_samples++;
+  }
+  fclose(fd);
+  printf("read %d points in file %s\n", nb_samples, filename);
+}
+
+static void calibrate_timer(void) {
+  const int n = 100000;
+  double t0 = now_ns();
+  for (int i = 0; i < n; i++) {
+    volatile double t = now_ns();
+    (void)t;
+  }
+  timer_overhead = (now_ns() - t0) / n;
+}
+
+static void feed_imu(int i) {
+  if (i > 0) {
+    RATES_COPY(imu.gyro_prev, imu.gyro);
+  }
+  else {
+    RATES_BFP_OF_REAL(imu.gyro_prev, samples[0].gyro);
+  }
+  RATES_BFP_OF_REAL(imu.gyro, samples[i].gyro);
+  ACCELS_BFP_OF_REAL(imu.accel, samples[i].accel);
+  MAGS_BFP_OF_REAL(imu.mag, samples[i].mag);
+}
+
+/*
+ * angle of the rotation between estimated and true ltp_to_imu
+ */
+static double attitude_error(int i) {
+  struct DoubleQuat q_est, q_err;
+#ifdef AHRS_BENCH_FLOAT_STATE
+  QUAT_COPY(q_est, ahrs_float.ltp_to_imu_quat);
+#else
+  QUAT_FLOAT_OF_BFP(q_est, ahrs.ltp_to_imu_quat);
+#endif
+  FLOAT_QUAT_INV_COMP(q_err, samples[i].quat_true, q_est);
+  double n = sqrt(q_err.qx*q_err.qx + q_err.qy*q_err.qy + q_err.qz*q_err.qz);
+  return 2. * atan2(n, fabs(q_err.qi));
+}
+
+static void report_stat(struct bench_stat* s) {
+  if (s->nb == 0) {
+    printf("%-13s %8d\n", s->name, 0);
+    return;
+  }
+  double ns = s->ns / s->nb;
+  printf("%-13s %8lu %9.1f %12.0f\n", s->name, s->nb, ns, ns * BENCH_HOST_MHZ / 1000.);
+}
+
+/* imu.h wants that */
+void imu_impl_init(void) {}
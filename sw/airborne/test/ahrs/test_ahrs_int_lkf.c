@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Runs ahrs_int_lkf and ahrs_float_lkf side by side on the same synthetic
+ * sensor data and checks that they do not diverge.
+ *
+ * The float filter is built with its entry points renamed to flkf_*
+ * (see the Makefile), ahrs_* are the ones of the fixed point filter.
+ *
+ * The trajectory is a slow tumbling in all three axes, sensors have bias
+ * and noise, the mag reference is the (1, 0, 1) of both filters.
+ *
+ * usage: test_ahrs_int_lkf [duration (s), default 120]
+ * returns 1 if the divergence is above the bounds below.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "std.h"
+#include "math/pprz_algebra_float.h"
+#include "math/pprz_algebra_double.h"
+#include "math/pprz_algebra_int.h"
+
+#include "subsystems/ahrs.h"
+#include "subsystems/ahrs/ahrs_aligner.h"
+#include "subsystems/ahrs/ahrs_float_lkf.h"
+#include "subsystems/ahrs/ahrs_int_lkf.h"
+#include "subsystems/imu.h"
+
+extern void flkf_init(void);
+extern void flkf_align(void);
+extern void flkf_propagate(void);
+extern void flkf_update_accel(void);
+extern void flkf_update_mag(void);
+
+/* bounds on the divergence between the two filters */
+#define MAX_ATT_DIFF  RadOfDeg(0.01)
+#define MAX_BIAS_DIFF RadOfDeg(0.001)
+/* relative, on the diagonal of P */
+#define MAX_P_DIFF    1e-3
+
+#define FREQ 512.
+
+static double noise(double sigma);
+static void true_rates(struct DoubleRates* w, double t);
+static double quat_angle(struct DoubleQuat* a, struct DoubleQuat* b);
+
+int main(int argc, char** argv) {
+
+  double duration = argc > 1 ? atof(argv[1]) : 120.;
+
+  const struct DoubleRates gyro_bias = { RadOfDeg(1.), RadOfDeg(-2.), RadOfDeg(0.5) };
+  const struct DoubleVect3 ltp_g = { 0., 0., -9.81 };
+  const struct DoubleVect3 ltp_h = { 1., 0., 1. };
+
+  imu_init();
+  ahrs_aligner_init();
+  flkf_init();
+  ahrs_init();
+
+  /* start level and aligned, both filters from the same initial estimate */
+  struct DoubleQuat q_true = { 1., 0., 0., 0. };
+  RATES_BFP_OF_REAL(ahrs_aligner.lp_gyro, gyro_bias);
+  struct DoubleVect3 accel0 = { 0., 0., -9.81 };
+  ACCELS_BFP_OF_REAL(ahrs_aligner.lp_accel, accel0);
+  flkf_align();
+  ahrs_align();
+
+  double att_diff_max = 0., bias_diff_max = 0.;
+  double att_err_f2 = 0., att_err_i2 = 0.;
+  int nb_err = 0;
+
+  const int nb_steps = duration * FREQ;
+  for (int i = 0; i < nb_steps; i++) {
+    const double t = i / FREQ;
+
+    /* true attitude */
+    struct DoubleRates w;
+    true_rates(&w, t);
+    struct DoubleQuat qr, qtmp;
+    const double n = sqrt(w.p*w.p + w.q*w.q + w.r*w.r);
+    const double a = n / FREQ / 2.;
+    if (n > 1e-12) {
+      QUAT_ASSIGN(qr, cos(a), sin(a)*w.p/n, sin(a)*w.q/n, sin(a)*w.r/n);
+    }
+    else {
+      QUAT_ASSIGN(qr, 1., 0., 0., 0.);
+    }
+    FLOAT_QUAT_COMP(qtmp, q_true, qr);
+    QUAT_COPY(q_true, qtmp);
+
+    /* sensors */
+    struct DoubleRMat dcm;
+    FLOAT_RMAT_OF_QUAT(dcm, q_true);
+    struct DoubleRates gyro;
+    RATES_ASSIGN(gyro, w.p + gyro_bias.p + noise(RadOfDeg(0.5)),
+                       w.q + gyro_bias.q + noise(RadOfDeg(0.5)),
+                       w.r + gyro_bias.r + noise(RadOfDeg(0.5)));
+    struct DoubleVect3 accel, mag;
+    FLOAT_RMAT_VECT3_MUL(accel, dcm, ltp_g);
+    FLOAT_RMAT_VECT3_MUL(mag, dcm, ltp_h);
+    VECT3_ASSIGN(accel, accel.x + noise(0.3), accel.y + noise(0.3), accel.z + noise(0.3));
+    VECT3_ASSIGN(mag, mag.x + noise(0.01), mag.y + noise(0.01), mag.z + noise(0.01));
+    RATES_COPY(imu.gyro_prev, imu.gyro);
+    RATES_BFP_OF_REAL(imu.gyro, gyro);
+    ACCELS_BFP_OF_REAL(imu.accel, accel);
+    MAGS_BFP_OF_REAL(imu.mag, mag);
+
+    /* both filters */
+    flkf_propagate();
+    flkf_update_accel();
+    flkf_update_mag();
+    ahrs_propagate();
+    ahrs_update_accel();
+    ahrs_update_mag();
+
+    /* compare */
+    struct DoubleQuat qf, qint;
+    QUAT_COPY(qf, bafl_quat);
+    QUAT_ASSIGN(qint, FLOAT_OF_BFP(bail_quat.qi, BAIL_QUAT_FRAC), FLOAT_OF_BFP(bail_quat.qx, BAIL_QUAT_FRAC),
+                FLOAT_OF_BFP(bail_quat.qy, BAIL_QUAT_FRAC), FLOAT_OF_BFP(bail_quat.qz, BAIL_QUAT_FRAC));
+    const double att_diff = quat_angle(&qf, &qint);
+    if (att_diff > att_diff_max)
+      att_diff_max = att_diff;
+    const double bias_diff[3] = {
+      bafl_bias.p - FLOAT_OF_BFP(bail_bias.p, BAIL_RATE_FRAC),
+      bafl_bias.q - FLOAT_OF_BFP(bail_bias.q, BAIL_RATE_FRAC),
+      bafl_bias.r - FLOAT_OF_BFP(bail_bias.r, BAIL_RATE_FRAC) };
+    for (int j = 0; j < 3; j++)
+      if (fabs(bias_diff[j]) > bias_diff_max)
+        bias_diff_max = fabs(bias_diff[j]);
+
+    if (t > 20.) {
+      const double ef = quat_angle(&q_true, &qf);
+      const double ei = quat_angle(&q_true, &qint);
+      att_err_f2 += ef * ef;
+      att_err_i2 += ei * ei;
+      nb_err++;
+    }
+  }
+
+  double p_diff_max = 0.;
+  printf("P diagonal, float / fixed point:\n");
+  for (int i = 0; i < BAIL_SSIZE; i++) {
+    const double p_int = BAIL_P_FLOAT_OF_BFP(bail_P[i][i], i, i);
+    const double d = fabs(p_int - bafl_P[i][i]) / bafl_P[i][i];
+    if (d > p_diff_max)
+      p_diff_max = d;
+    printf("  %12.6g %12.6g\n", bafl_P[i][i], p_int);
+  }
+
+  printf("%.0f s at %.0f Hz\n", duration, FREQ);
+  printf("attitude error after 20 s (rms): float %.4f deg, fixed point %.4f deg\n",
+         DegOfRad(sqrt(att_err_f2 / nb_err)), DegOfRad(sqrt(att_err_i2 / nb_err)));
+  printf("max divergence: attitude %.5f deg, bias %.6f deg/s, P diagonal %.2e\n",
+         DegOfRad(att_diff_max), DegOfRad(bias_diff_max), p_diff_max);
+
+  if (att_diff_max > MAX_ATT_DIFF || bias_diff_max > MAX_BIAS_DIFF || p_diff_max > MAX_P_DIFF) {
+    printf("FAILED: bounds are %.5f deg, %.6f deg/s, %.2e\n",
+           DegOfRad(MAX_ATT_DIFF), DegOfRad(MAX_BIAS_DIFF), MAX_P_DIFF);
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
+
+/* gaussian noise, Box-Muller on a fixed seed so that runs are repeatable */
+static double noise(double sigma) {
+  static unsigned long long s = 42;
+  s = s * 6364136223846793005ULL + 1442695040888963407ULL;
+  const double u1 = ((s >> 11) + 1.) / 9007199254740993.;
+  s = s * 6364136223846793005ULL + 1442695040888963407ULL;
+  const double u2 = (s >> 11) / 9007199254740992.;
+  return sigma * sqrt(-2. * log(u1)) * cos(2. * M_PI * u2);
+}
+
+static void true_rates(struct DoubleRates* w, double t) {
+  w->p = 0.6 * sin(2. * M_PI * 0.11 * t);
+  w->q = 0.4 * sin(2. * M_PI * 0.07 * t + 1.);
+  w->r = 0.3 * sin(2. * M_PI * 0.05 * t + 2.);
+}
+
+/* angle of the rotation between two attitudes */
+static double quat_angle(struct DoubleQuat* a, struct DoubleQuat* b) {
+  struct DoubleQuat e;
+  FLOAT_QUAT_INV_COMP(e, *a, *b);
+  const double n = sqrt(e.qx*e.qx + e.qy*e.qy + e.qz*e.qz);
+  return 2. * atan2(n, fabs(e.qi));
+}
+
+/* imu.h wants that */
+void imu_impl_init(void) {}
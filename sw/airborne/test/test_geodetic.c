@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <time.h>
 
 #include "std.h"
 
@@ -22,6 +23,8 @@ static void test_doubles(void);
 static void test_enu_of_ecef_int(void);
 static void test_ned_to_ecef_to_ned(void);
 static void test_enu_to_ecef_to_enu( void );
+static void test_lla_ecef_int(void);
+static void bench_lla_ecef_int(void);
 
 /*
  * toulouse lat 43.6052765, lon 1.4427764, alt 180.123019274324 -> x 4624497.0 y 116475.0 z 4376563.0
@@ -34,6 +37,9 @@ int main(int argc, char** argv) {
 
   test_lla_of_utm();
 
+  test_lla_ecef_int();
+  bench_lla_ecef_int();
+
   //test_enu_of_ecef_int();
   //  test_ned_to_ecef_to_ned();
 
@@ -259,3 +265,138 @@ void test_enu_to_ecef_to_enu( void ) {
 
 }
 
+
+
+/*
+ * fixed point ECEF <-> LLA against the double versions, over a global grid
+ */
+static void test_lla_ecef_int(void) {
+
+  printf("\n--- lla_of_ecef_i / ecef_of_lla_i vs double ---\n");
+
+  static const double alts[] = { -1000., 0., 180., 1000., 10000., 50000. };
+  double max_lat = 0, max_lon = 0, max_alt = 0, max_ecef = 0;
+  double sum_pos = 0, sum_alt = 0;
+  int nb_samples = 0;
+  unsigned int i;
+  double lat, lon;
+
+  for (lat = -89.75; lat <= 89.75; lat += 0.5) {
+    for (lon = -179.75; lon <= 180.; lon += 0.5) {
+      for (i = 0; i < sizeof(alts) / sizeof(alts[0]); i++) {
+        /* ecef_of_lla */
+        struct LlaCoor_i lla_i = { .lon = rint(EM7RAD_OF_RAD(RadOfDeg(lon))),
+                                   .lat = rint(EM7RAD_OF_RAD(RadOfDeg(lat))),
+                                   .alt = rint(MM_OF_M(alts[i])) };
+        struct LlaCoor_d lla_d = { .lon = RAD_OF_EM7RAD((double)lla_i.lon),
+                                   .lat = RAD_OF_EM7RAD((double)lla_i.lat),
+                                   .alt = M_OF_MM((double)lla_i.alt) };
+        struct EcefCoor_d ecef_d;
+        struct EcefCoor_i ecef_i;
+        ecef_of_lla_d(&ecef_d, &lla_d);
+        ecef_of_lla_i(&ecef_i, &lla_i);
+        double ex = fabs(CM_OF_M(ecef_d.x) - ecef_i.x);
+        double ey = fabs(CM_OF_M(ecef_d.y) - ecef_i.y);
+        double ez = fabs(CM_OF_M(ecef_d.z) - ecef_i.z);
+        if (ex > max_ecef) max_ecef = ex;
+        if (ey > max_ecef) max_ecef = ey;
+        if (ez > max_ecef) max_ecef = ez;
+        sum_pos += ex*ex + ey*ey + ez*ez;
+
+        /* lla_of_ecef, on the same centimeter point for both */
+        struct EcefCoor_i in_i = { rint(CM_OF_M(ecef_d.x)), rint(CM_OF_M(ecef_d.y)), rint(CM_OF_M(ecef_d.z)) };
+        struct EcefCoor_d in_d = { M_OF_CM((double)in_i.x), M_OF_CM((double)in_i.y), M_OF_CM((double)in_i.z) };
+        struct LlaCoor_d out_d;
+        struct LlaCoor_i out_i;
+        lla_of_ecef_d(&out_d, &in_d);
+        lla_of_ecef_i(&out_i, &in_i);
+        double elat = fabs(EM7RAD_OF_RAD(out_d.lat) - out_i.lat);
+        double elon = fabs(EM7RAD_OF_RAD(out_d.lon) - out_i.lon);
+        /* same meridian on both sides of the antimeridian */
+        if (elon > 3e7) elon = fabs(elon - EM7RAD_OF_RAD(2 * M_PI));
+        double ealt = fabs(MM_OF_M(out_d.alt) - out_i.alt);
+        if (elat > max_lat) max_lat = elat;
+        if (elon > max_lon) max_lon = elon;
+        if (ealt > max_alt) max_alt = ealt;
+        sum_alt += ealt*ealt;
+        nb_samples++;
+      }
+    }
+  }
+
+  printf("%d samples\n", nb_samples);
+  printf("ecef_of_lla_i: error max %.2f cm, rms %.2f cm\n", max_ecef, sqrt(sum_pos / (3 * nb_samples)));
+  printf("lla_of_ecef_i: error max lat %.2f lon %.2f (1e-7 rad), alt %.2f mm (rms %.2f mm)\n",
+         max_lat, max_lon, max_alt, sqrt(sum_alt / nb_samples));
+}
+
+
+/* former implementation, through the double version */
+static void lla_of_ecef_i_by_double(struct LlaCoor_i* out, struct EcefCoor_i* in) {
+  struct EcefCoor_d in_d = { M_OF_CM((double)in->x), M_OF_CM((double)in->y), M_OF_CM((double)in->z) };
+  struct LlaCoor_d out_d;
+  lla_of_ecef_d(&out_d, &in_d);
+  out->lon = (int32_t)rint(EM7RAD_OF_RAD(out_d.lon));
+  out->lat = (int32_t)rint(EM7RAD_OF_RAD(out_d.lat));
+  out->alt = (int32_t)MM_OF_M(out_d.alt);
+}
+
+static void ecef_of_lla_i_by_double(struct EcefCoor_i* out, struct LlaCoor_i* in) {
+  struct LlaCoor_d in_d = { .lon = RAD_OF_EM7RAD((double)in->lon),
+                            .lat = RAD_OF_EM7RAD((double)in->lat),
+                            .alt = M_OF_MM((double)in->alt) };
+  struct EcefCoor_d out_d;
+  ecef_of_lla_d(&out_d, &in_d);
+  out->x = (int32_t)CM_OF_M(out_d.x);
+  out->y = (int32_t)CM_OF_M(out_d.y);
+  out->z = (int32_t)CM_OF_M(out_d.z);
+}
+
+#define BENCH_LOOPS 1000000
+
+static void bench_lla_ecef_int(void) {
+
+  printf("\n--- lla_of_ecef_i / ecef_of_lla_i timing ---\n");
+
+  /* inputs vary around these points, without drifting */
+  struct EcefCoor_i ecef0 = { 462449700, 11647500, 437656300 };
+  struct EcefCoor_i ecef = ecef0;
+  struct LlaCoor_i lla, lla0;
+  int32_t check = 0;
+  clock_t t0;
+  int i;
+
+  t0 = clock();
+  for (i = 0; i < BENCH_LOOPS; i++) {
+    ecef.x = ecef0.x + (i & 0xff);
+    lla_of_ecef_i(&lla, &ecef);
+    check += lla.alt;
+  }
+  double t_int = (double)(clock() - t0) / CLOCKS_PER_SEC;
+  t0 = clock();
+  for (i = 0; i < BENCH_LOOPS; i++) {
+    ecef.x = ecef0.x + (i & 0xff);
+    lla_of_ecef_i_by_double(&lla, &ecef);
+    check += lla.alt;
+  }
+  double t_dbl = (double)(clock() - t0) / CLOCKS_PER_SEC;
+  printf("lla_of_ecef_i %.3f us, through double %.3f us\n", 1e6 * t_int / BENCH_LOOPS, 1e6 * t_dbl / BENCH_LOOPS);
+
+  lla_of_ecef_i(&lla0, &ecef0);
+  lla = lla0;
+  t0 = clock();
+  for (i = 0; i < BENCH_LOOPS; i++) {
+    lla.lat = lla0.lat + (i & 0xff);
+    ecef_of_lla_i(&ecef, &lla);
+    check += ecef.z;
+  }
+  t_int = (double)(clock() - t0) / CLOCKS_PER_SEC;
+  t0 = clock();
+  for (i = 0; i < BENCH_LOOPS; i++) {
+    lla.lat = lla0.lat + (i & 0xff);
+    ecef_of_lla_i_by_double(&ecef, &lla);
+    check += ecef.z;
+  }
+  t_dbl = (double)(clock() - t0) / CLOCKS_PER_SEC;
+  printf("ecef_of_lla_i %.3f us, through double %.3f us (%d)\n", 1e6 * t_int / BENCH_LOOPS, 1e6 * t_dbl / BENCH_LOOPS, check & 1);
+}
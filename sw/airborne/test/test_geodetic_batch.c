@@ -0,0 +1,207 @@
+/*
+ * batch geodetic conversions: checked against the point by point
+ * versions and timed on a long trajectory
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "std.h"
+
+#include "math/pprz_geodetic_double.h"
+#include "math/pprz_geodetic_double_batch.h"
+#include "math/pprz_geodetic_float_batch.h"
+
+#define NB_POINTS 1000000
+
+static double now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+static float* new_array_f(void) {
+  float* a = malloc(NB_POINTS * sizeof(float));
+  if (a == NULL) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  memset(a, 0, NB_POINTS * sizeof(float));
+  return a;
+}
+
+static double* new_array(void) {
+  double* a = malloc(NB_POINTS * sizeof(double));
+  if (a == NULL) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  memset(a, 0, NB_POINTS * sizeof(double));
+  return a;
+}
+
+int main(int argc, char** argv) {
+
+  struct LlaArray_d lla = { new_array(), new_array(), new_array() };
+  struct LlaArray_d lla2 = { new_array(), new_array(), new_array() };
+  struct EcefArray_d ecef = { new_array(), new_array(), new_array() };
+  struct EcefArray_d ecef2 = { new_array(), new_array(), new_array() };
+  struct EnuArray_d enu = { new_array(), new_array(), new_array() };
+  struct EnuArray_d enu2 = { new_array(), new_array(), new_array() };
+  double t0, t_scalar, t_batch;
+  double err, max_err;
+  uint32_t i;
+
+  /* toulouse */
+  struct EcefCoor_d ref = { 4624497.0, 116475.0, 4376563.0 };
+  struct LtpDef_d def;
+  ltp_def_from_ecef_d(&def, &ref);
+
+  /* a 3 hour flight at 100Hz, circles of 1km around the reference */
+  for (i = 0; i < NB_POINTS; i++) {
+    double t = i * 0.01;
+    lla.lat[i] = def.lla.lat + 1.5e-4 * sin(0.01 * t) + 1e-7 * t;
+    lla.lon[i] = def.lla.lon + 2e-4 * cos(0.01 * t);
+    lla.alt[i] = def.lla.alt + 100. + 50. * sin(0.003 * t);
+  }
+
+  printf("--- %d points ---\n", NB_POINTS);
+
+  /* ecef_of_lla */
+  t0 = now();
+  for (i = 0; i < NB_POINTS; i++) {
+    struct LlaCoor_d l = { lla.lon[i], lla.lat[i], lla.alt[i] };
+    struct EcefCoor_d e;
+    ecef_of_lla_d(&e, &l);
+    ecef.x[i] = e.x; ecef.y[i] = e.y; ecef.z[i] = e.z;
+  }
+  t_scalar = now() - t0;
+  t0 = now();
+  ecef_of_lla_array_d(&ecef, &lla, NB_POINTS);
+  t_batch = now() - t0;
+  printf("ecef_of_lla     : point %7.2f ms, array %7.2f ms\n", 1e3 * t_scalar, 1e3 * t_batch);
+
+  /* lla_of_ecef */
+  max_err = 0;
+  t0 = now();
+  for (i = 0; i < NB_POINTS; i++) {
+    struct EcefCoor_d e = { ecef.x[i], ecef.y[i], ecef.z[i] };
+    struct LlaCoor_d l;
+    lla_of_ecef_d(&l, &e);
+    lla2.lat[i] = l.lat; lla2.lon[i] = l.lon; lla2.alt[i] = l.alt;
+  }
+  t_scalar = now() - t0;
+  t0 = now();
+  lla_of_ecef_array_d(&lla, &ecef, NB_POINTS);
+  t_batch = now() - t0;
+  for (i = 0; i < NB_POINTS; i++) {
+    err = fabs(lla.lat[i] - lla2.lat[i]) * 6378137.0;
+    if (err > max_err) max_err = err;
+    err = fabs(lla.alt[i] - lla2.alt[i]);
+    if (err > max_err) max_err = err;
+  }
+  printf("lla_of_ecef     : point %7.2f ms, array %7.2f ms, max diff %.2e m\n",
+         1e3 * t_scalar, 1e3 * t_batch, max_err);
+
+  /* enu_of_ecef */
+  max_err = 0;
+  t0 = now();
+  for (i = 0; i < NB_POINTS; i++) {
+    struct EcefCoor_d e = { ecef.x[i], ecef.y[i], ecef.z[i] };
+    struct EnuCoor_d l;
+    enu_of_ecef_point_d(&l, &def, &e);
+    enu2.x[i] = l.x; enu2.y[i] = l.y; enu2.z[i] = l.z;
+  }
+  t_scalar = now() - t0;
+  t0 = now();
+  enu_of_ecef_point_array_d(&enu, &def, &ecef, NB_POINTS);
+  t_batch = now() - t0;
+  for (i = 0; i < NB_POINTS; i++) {
+    err = fabs(enu.x[i] - enu2.x[i]) + fabs(enu.y[i] - enu2.y[i]) + fabs(enu.z[i] - enu2.z[i]);
+    if (err > max_err) max_err = err;
+  }
+  printf("enu_of_ecef     : point %7.2f ms, array %7.2f ms, max diff %.2e m\n",
+         1e3 * t_scalar, 1e3 * t_batch, max_err);
+
+  /* back to ecef */
+  t0 = now();
+  ecef_of_enu_point_array_d(&ecef2, &def, &enu, NB_POINTS);
+  t_batch = now() - t0;
+  max_err = 0;
+  for (i = 0; i < NB_POINTS; i++) {
+    err = fabs(ecef2.x[i] - ecef.x[i]) + fabs(ecef2.y[i] - ecef.y[i]) + fabs(ecef2.z[i] - ecef.z[i]);
+    if (err > max_err) max_err = err;
+  }
+  printf("ecef_of_enu     : array %7.2f ms, round trip %.2e m\n", 1e3 * t_batch, max_err);
+
+  /* lla to enu in one go */
+  lla_of_ecef_array_d(&lla, &ecef, NB_POINTS);
+  t0 = now();
+  enu_of_lla_point_array_d(&enu2, &def, &lla, NB_POINTS);
+  t_batch = now() - t0;
+  max_err = 0;
+  for (i = 0; i < NB_POINTS; i++) {
+    err = fabs(enu2.x[i] - enu.x[i]) + fabs(enu2.y[i] - enu.y[i]) + fabs(enu2.z[i] - enu.z[i]);
+    if (err > max_err) max_err = err;
+  }
+  printf("enu_of_lla      : array %7.2f ms, max diff %.2e m\n", 1e3 * t_batch, max_err);
+
+  /* float versions */
+  struct LlaArray_f lla_f = { new_array_f(), new_array_f(), new_array_f() };
+  struct NedArray_f ned_f = { new_array_f(), new_array_f(), new_array_f() };
+  struct UtmArray_f utm_f = { new_array_f(), new_array_f(), new_array_f(), 31 };
+  struct LtpDef_f def_f;
+  struct EcefCoor_f ref_f = { ref.x, ref.y, ref.z };
+  ltp_def_from_ecef_f(&def_f, &ref_f);
+  for (i = 0; i < NB_POINTS; i++) {
+    lla_f.lat[i] = lla.lat[i];
+    lla_f.lon[i] = lla.lon[i];
+    lla_f.alt[i] = lla.alt[i];
+  }
+
+  max_err = 0;
+  t0 = now();
+  for (i = 0; i < NB_POINTS; i++) {
+    struct LlaCoor_f l = { lla_f.lon[i], lla_f.lat[i], lla_f.alt[i] };
+    struct NedCoor_f p;
+    ned_of_lla_point_f(&p, &def_f, &l);
+    err = fabs(p.x - ned_f.x[i]); /* keeps the loop */
+    ned_f.x[i] = p.x; ned_f.y[i] = p.y; ned_f.z[i] = p.z;
+  }
+  t_scalar = now() - t0;
+  struct NedArray_f ned2_f = { new_array_f(), new_array_f(), new_array_f() };
+  t0 = now();
+  ned_of_lla_point_array_f(&ned2_f, &def_f, &lla_f, NB_POINTS);
+  t_batch = now() - t0;
+  for (i = 0; i < NB_POINTS; i++) {
+    err = fabs(ned2_f.x[i] - ned_f.x[i]) + fabs(ned2_f.y[i] - ned_f.y[i]) + fabs(ned2_f.z[i] - ned_f.z[i]);
+    if (err > max_err) max_err = err;
+  }
+  printf("ned_of_lla_f    : point %7.2f ms, array %7.2f ms, max diff %.2e m\n",
+         1e3 * t_scalar, 1e3 * t_batch, max_err);
+
+  max_err = 0;
+  t0 = now();
+  for (i = 0; i < NB_POINTS; i++) {
+    struct LlaCoor_f l = { lla_f.lon[i], lla_f.lat[i], lla_f.alt[i] };
+    struct UtmCoor_f u;
+    u.zone = utm_f.zone;
+    utm_of_lla_f(&u, &l);
+    ned_f.x[i] = u.north; ned_f.y[i] = u.east;
+  }
+  t_scalar = now() - t0;
+  t0 = now();
+  utm_of_lla_array_f(&utm_f, &lla_f, NB_POINTS);
+  t_batch = now() - t0;
+  for (i = 0; i < NB_POINTS; i++) {
+    err = fabs(utm_f.north[i] - ned_f.x[i]) + fabs(utm_f.east[i] - ned_f.y[i]);
+    if (err > max_err) max_err = err;
+  }
+  printf("utm_of_lla_f    : point %7.2f ms, array %7.2f ms, max diff %.2e m\n",
+         1e3 * t_scalar, 1e3 * t_batch, max_err);
+
+  return 0;
+}
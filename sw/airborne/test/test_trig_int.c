@@ -0,0 +1,149 @@
+/*
+ * accuracy and timing of the integer trigonometry engine against libm
+ *
+ * build it for each engine, see the Makefile:
+ *  make test_trig_int_table test_trig_int_interp test_trig_int_poly test_trig_int_cordic
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "std.h"
+#include "math/pprz_algebra_int.h"
+#include "math/pprz_trig_int.h"
+
+#define NB_LOOPS 1000000
+
+static const char* engine_name[] = { "table", "interp", "poly", "cordic" };
+
+static double now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/* sin/cos macros on every INT32_ANGLE_FRAC angle in [-pi, pi] */
+static void test_sin_cos(void) {
+  double max_err = 0;
+  int32_t a;
+
+  for (a = -INT32_ANGLE_PI; a <= INT32_ANGLE_PI; a++) {
+    int32_t s, c;
+    PPRZ_ITRIG_SIN(s, a);
+    PPRZ_ITRIG_COS(c, a);
+    double err_s = fabs(s - sin(ANGLE_FLOAT_OF_BFP((double)a)) * (1 << INT32_TRIG_FRAC));
+    double err_c = fabs(c - cos(ANGLE_FLOAT_OF_BFP((double)a)) * (1 << INT32_TRIG_FRAC));
+    if (err_s > max_err) max_err = err_s;
+    if (err_c > max_err) max_err = err_c;
+  }
+  printf("PPRZ_ITRIG_SIN/COS   : max error %.2f LSB (2^-%d)\n", max_err, INT32_TRIG_FRAC);
+}
+
+static void test_hr(void) {
+  double max_sin = 0, max_atan = 0, max_asin = 0;
+  int i;
+
+  srand(1);
+  for (i = 0; i < NB_LOOPS; i++) {
+    int32_t a = (int32_t)(((int64_t)rand() << 1 | (rand() & 1)) - RAND_MAX);
+    double ad = (double)a / (1 << PPRZ_ITRIG_HR_ANGLE_FRAC);
+    double err = fabs(pprz_itrig_sin_hr(a) - sin(ad) * (1 << PPRZ_ITRIG_HR_FRAC));
+    if (err > max_sin) max_sin = err;
+    err = fabs(pprz_itrig_cos_hr(a) - cos(ad) * (1 << PPRZ_ITRIG_HR_FRAC));
+    if (err > max_sin) max_sin = err;
+
+    /* atan2 from 1 to 2^30 in magnitude */
+    int shift = rand() % 30;
+    int32_t x = (rand() - RAND_MAX / 2) >> shift;
+    int32_t y = (rand() - RAND_MAX / 2) >> shift;
+    double ref = atan2(y, x);
+    double res = (double)pprz_itrig_atan2_hr(y, x) / (1 << PPRZ_ITRIG_HR_ANGLE_FRAC);
+    if (x != 0 || y != 0) {
+      err = fabs(res - ref);
+      if (err > M_PI) err = fabs(err - 2 * M_PI);
+      if (err > max_atan) max_atan = err;
+    }
+
+    int32_t s = (rand() % (2 * (1 << 15) + 1) - (1 << 15)) << (PPRZ_ITRIG_HR_FRAC - 15);
+    ref = asin((double)s / (1 << PPRZ_ITRIG_HR_FRAC));
+    res = (double)pprz_itrig_asin_hr(s) / (1 << PPRZ_ITRIG_HR_ANGLE_FRAC);
+    err = fabs(res - ref);
+    if (err > max_asin) max_asin = err;
+  }
+  printf("pprz_itrig_sin/cos_hr: max error %.2f LSB (2^-%d)\n", max_sin, PPRZ_ITRIG_HR_FRAC);
+  printf("pprz_itrig_atan2_hr  : max error %.2e rad\n", max_atan);
+  printf("pprz_itrig_asin_hr   : max error %.2e rad\n", max_asin);
+}
+
+/* former atan2 approximation, for comparison */
+static void test_int32_atan2(void) {
+  double max_err = 0, max_err_2 = 0;
+  int32_t x, y;
+
+  for (x = -2000; x <= 2000; x += 7) {
+    for (y = -2000; y <= 2000; y += 7) {
+      int32_t a, b;
+      INT32_ATAN2(a, y, x);
+      PPRZ_ITRIG_ATAN2(b, y, x);
+      double ref = atan2(y, x);
+      double err = fabs(ANGLE_FLOAT_OF_BFP((double)a) - ref);
+      if (err > M_PI) err = fabs(err - 2 * M_PI);
+      if (err > max_err) max_err = err;
+      err = fabs(ANGLE_FLOAT_OF_BFP((double)b) - ref);
+      if (err > M_PI) err = fabs(err - 2 * M_PI);
+      if (err > max_err_2) max_err_2 = err;
+    }
+  }
+  printf("INT32_ATAN2          : max error %.2e rad\n", max_err);
+  printf("PPRZ_ITRIG_ATAN2     : max error %.2e rad\n", max_err_2);
+}
+
+static void bench(void) {
+  volatile int32_t sink;
+  int32_t acc = 0;
+  double t0, t;
+  int i;
+
+  t0 = now();
+  for (i = 0; i < NB_LOOPS; i++) {
+    int32_t s;
+    PPRZ_ITRIG_SIN(s, (i * 37) & 0x3fff);
+    acc += s;
+  }
+  t = now() - t0;
+  printf("PPRZ_ITRIG_SIN       : %6.1f ns\n", 1e9 * t / NB_LOOPS);
+
+  t0 = now();
+  for (i = 0; i < NB_LOOPS; i++)
+    acc += pprz_itrig_sin_hr(i * 1117);
+  t = now() - t0;
+  printf("pprz_itrig_sin_hr    : %6.1f ns\n", 1e9 * t / NB_LOOPS);
+
+  t0 = now();
+  for (i = 0; i < NB_LOOPS; i++)
+    acc += pprz_itrig_atan2_hr(i - NB_LOOPS / 2, 1000);
+  t = now() - t0;
+  printf("pprz_itrig_atan2_hr  : %6.1f ns\n", 1e9 * t / NB_LOOPS);
+
+  t0 = now();
+  for (i = 0; i < NB_LOOPS; i++) {
+    int32_t a;
+    INT32_ATAN2(a, i - NB_LOOPS / 2, 1000);
+    acc += a;
+  }
+  t = now() - t0;
+  printf("INT32_ATAN2          : %6.1f ns\n", 1e9 * t / NB_LOOPS);
+  sink = acc;
+  (void)sink;
+}
+
+int main(int argc, char** argv) {
+  printf("--- engine %s ---\n", engine_name[PPRZ_TRIG_INT_ENGINE]);
+  test_sin_cos();
+  test_hr();
+  test_int32_atan2();
+  bench();
+  return 0;
+}
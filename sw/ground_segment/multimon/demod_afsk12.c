@@ -89,10 +89,8 @@ static void afsk12_demod(struct demod_state *s, float *buffer, int length)
 		s->l1.afsk12.subsamp = 0;
 	}
 	for (; length >= SUBSAMP; length -= SUBSAMP, buffer += SUBSAMP) {
-		f = fsqr(mac(buffer, corr_mark_i, CORRLEN)) +
-			fsqr(mac(buffer, corr_mark_q, CORRLEN)) -
-			fsqr(mac(buffer, corr_space_i, CORRLEN)) -
-			fsqr(mac(buffer, corr_space_q, CORRLEN));
+		f = afsk_corr(buffer, corr_mark_i, corr_mark_q,
+			      corr_space_i, corr_space_q, CORRLEN);
 		s->l1.afsk12.dcd_shreg <<= 1;
 		s->l1.afsk12.dcd_shreg |= (f > 0);
 		verbprintf(10, "%c", '0'+(s->l1.afsk12.dcd_shreg & 1));
@@ -96,10 +96,8 @@ static void afsk48p_demod(struct demod_state *s, float *buffer, int length)
 	}
 
 	for (; length > 0; length--, buffer++) {
-		f = fsqr(mac(buffer, corr_mark_i, CORRLEN)) +
-			fsqr(mac(buffer, corr_mark_q, CORRLEN)) -
-			fsqr(mac(buffer, corr_space_i, CORRLEN)) -
-			fsqr(mac(buffer, corr_space_q, CORRLEN));
+		f = afsk_corr(buffer, corr_mark_i, corr_mark_q,
+			      corr_space_i, corr_space_q, CORRLEN);
 		s->l1.afsk48p.dcd_shreg <<= 1;
 		s->l1.afsk48p.dcd_shreg |= (f > 0);
 		verbprintf(10, "%c", '0'+(s->l1.afsk48p.dcd_shreg & 1));
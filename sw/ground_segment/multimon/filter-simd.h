@@ -0,0 +1,229 @@
+/*
+ *      filter-simd.h -- SSE/AVX and NEON filter routines
+ *
+ *      Copyright (C) 2011  The Paparazzi Team
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/* ---------------------------------------------------------------------- */
+
+#ifndef _FILTER_SIMD_H
+#define _FILTER_SIMD_H
+
+/*
+ * Vector versions of mac() and of the four correlations of the AFSK
+ * demodulators, selected by the target flags of the compiler:
+ *   __AVX__            8 floats per step (-mavx, -march=native)
+ *   __SSE__            4 floats per step (always there on x86_64)
+ *   __ARM_NEON         4 floats per step (aarch64, -mfpu=neon on arm)
+ *
+ * afsk_corr() loads each chunk of samples once for the four tables,
+ * which is most of the gain over four calls to mac(). Loads of the
+ * samples are unaligned, the demodulators slide over the buffer one
+ * (sub)sample at a time.
+ *
+ * Sums are done in a different order than the scalar loop, results
+ * differ by a few float LSB.
+ */
+
+/* ---------------------------------------------------------------------- */
+
+#if defined(__AVX__)
+
+#include <immintrin.h>
+
+#define __HAVE_ARCH_MAC
+#define __HAVE_ARCH_AFSK_CORR
+
+static inline float __hsum_avx(__m256 v)
+{
+	__m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55));
+	return _mm_cvtss_f32(s);
+}
+
+#ifdef __FMA__
+#define __MADD_AVX(acc, a, b) _mm256_fmadd_ps((a), (b), (acc))
+#else
+#define __MADD_AVX(acc, a, b) _mm256_add_ps((acc), _mm256_mul_ps((a), (b)))
+#endif
+
+static inline float mac(const float *a, const float *b, unsigned int size)
+{
+	__m256 acc = _mm256_setzero_ps();
+	float sum;
+	unsigned int i;
+
+	for (i = 0; i + 8 <= size; i += 8)
+		acc = __MADD_AVX(acc, _mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+	sum = __hsum_avx(acc);
+	for (; i < size; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+static inline float afsk_corr(const float *buf, const float *mark_i, const float *mark_q,
+			      const float *space_i, const float *space_q, unsigned int size)
+{
+	__m256 mi = _mm256_setzero_ps(), mq = _mm256_setzero_ps();
+	__m256 si = _mm256_setzero_ps(), sq = _mm256_setzero_ps();
+	float fmi, fmq, fsi, fsq;
+	unsigned int i;
+
+	for (i = 0; i + 8 <= size; i += 8) {
+		const __m256 x = _mm256_loadu_ps(buf + i);
+		mi = __MADD_AVX(mi, x, _mm256_loadu_ps(mark_i + i));
+		mq = __MADD_AVX(mq, x, _mm256_loadu_ps(mark_q + i));
+		si = __MADD_AVX(si, x, _mm256_loadu_ps(space_i + i));
+		sq = __MADD_AVX(sq, x, _mm256_loadu_ps(space_q + i));
+	}
+	fmi = __hsum_avx(mi);
+	fmq = __hsum_avx(mq);
+	fsi = __hsum_avx(si);
+	fsq = __hsum_avx(sq);
+	for (; i < size; i++) {
+		fmi += buf[i] * mark_i[i];
+		fmq += buf[i] * mark_q[i];
+		fsi += buf[i] * space_i[i];
+		fsq += buf[i] * space_q[i];
+	}
+	return fmi*fmi + fmq*fmq - fsi*fsi - fsq*fsq;
+}
+
+/* ---------------------------------------------------------------------- */
+
+#elif defined(__SSE__)
+
+#include <xmmintrin.h>
+
+#define __HAVE_ARCH_MAC
+#define __HAVE_ARCH_AFSK_CORR
+
+static inline float __hsum_sse(__m128 v)
+{
+	v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+	v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 0x55));
+	return _mm_cvtss_f32(v);
+}
+
+static inline float mac(const float *a, const float *b, unsigned int size)
+{
+	__m128 acc = _mm_setzero_ps();
+	float sum;
+	unsigned int i;
+
+	for (i = 0; i + 4 <= size; i += 4)
+		acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+	sum = __hsum_sse(acc);
+	for (; i < size; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+static inline float afsk_corr(const float *buf, const float *mark_i, const float *mark_q,
+			      const float *space_i, const float *space_q, unsigned int size)
+{
+	__m128 mi = _mm_setzero_ps(), mq = _mm_setzero_ps();
+	__m128 si = _mm_setzero_ps(), sq = _mm_setzero_ps();
+	float fmi, fmq, fsi, fsq;
+	unsigned int i;
+
+	for (i = 0; i + 4 <= size; i += 4) {
+		const __m128 x = _mm_loadu_ps(buf + i);
+		mi = _mm_add_ps(mi, _mm_mul_ps(x, _mm_loadu_ps(mark_i + i)));
+		mq = _mm_add_ps(mq, _mm_mul_ps(x, _mm_loadu_ps(mark_q + i)));
+		si = _mm_add_ps(si, _mm_mul_ps(x, _mm_loadu_ps(space_i + i)));
+		sq = _mm_add_ps(sq, _mm_mul_ps(x, _mm_loadu_ps(space_q + i)));
+	}
+	fmi = __hsum_sse(mi);
+	fmq = __hsum_sse(mq);
+	fsi = __hsum_sse(si);
+	fsq = __hsum_sse(sq);
+	for (; i < size; i++) {
+		fmi += buf[i] * mark_i[i];
+		fmq += buf[i] * mark_q[i];
+		fsi += buf[i] * space_i[i];
+		fsq += buf[i] * space_q[i];
+	}
+	return fmi*fmi + fmq*fmq - fsi*fsi - fsq*fsq;
+}
+
+/* ---------------------------------------------------------------------- */
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#include <arm_neon.h>
+
+#define __HAVE_ARCH_MAC
+#define __HAVE_ARCH_AFSK_CORR
+
+static inline float __hsum_neon(float32x4_t v)
+{
+#ifdef __aarch64__
+	return vaddvq_f32(v);
+#else
+	float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+	return vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+}
+
+static inline float mac(const float *a, const float *b, unsigned int size)
+{
+	float32x4_t acc = vdupq_n_f32(0);
+	float sum;
+	unsigned int i;
+
+	for (i = 0; i + 4 <= size; i += 4)
+		acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+	sum = __hsum_neon(acc);
+	for (; i < size; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+static inline float afsk_corr(const float *buf, const float *mark_i, const float *mark_q,
+			      const float *space_i, const float *space_q, unsigned int size)
+{
+	float32x4_t mi = vdupq_n_f32(0), mq = vdupq_n_f32(0);
+	float32x4_t si = vdupq_n_f32(0), sq = vdupq_n_f32(0);
+	float fmi, fmq, fsi, fsq;
+	unsigned int i;
+
+	for (i = 0; i + 4 <= size; i += 4) {
+		const float32x4_t x = vld1q_f32(buf + i);
+		mi = vmlaq_f32(mi, x, vld1q_f32(mark_i + i));
+		mq = vmlaq_f32(mq, x, vld1q_f32(mark_q + i));
+		si = vmlaq_f32(si, x, vld1q_f32(space_i + i));
+		sq = vmlaq_f32(sq, x, vld1q_f32(space_q + i));
+	}
+	fmi = __hsum_neon(mi);
+	fmq = __hsum_neon(mq);
+	fsi = __hsum_neon(si);
+	fsq = __hsum_neon(sq);
+	for (; i < size; i++) {
+		fmi += buf[i] * mark_i[i];
+		fmq += buf[i] * mark_q[i];
+		fsi += buf[i] * space_i[i];
+		fsq += buf[i] * space_q[i];
+	}
+	return fmi*fmi + fmq*fmq - fsi*fsi - fsq*fsq;
+}
+
+#endif
+
+/* ---------------------------------------------------------------------- */
+#endif /* _FILTER_SIMD_H */
@@ -26,9 +26,12 @@
 
 /* ---------------------------------------------------------------------- */
 
-#ifdef ARCH_I386
+/* the vector unit is preferred, the x87 version is for i386 without SSE */
+#if !defined(NO_SIMD_FILTER) && (defined(__SSE__) || defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include "filter-simd.h"
+#elif defined(ARCH_I386)
 #include "filter-i386.h"
-#endif /* ARCH_I386 */
+#endif
 
 /* ---------------------------------------------------------------------- */
 
@@ -106,5 +109,20 @@ extern inline float fsqr(float f)
 	return f*f;
 }
 
+/*
+ * energy difference between mark and space tones: the four correlations
+ * of the AFSK demodulators
+ */
+#ifndef __HAVE_ARCH_AFSK_CORR
+static inline float afsk_corr(const float *buf, const float *mark_i, const float *mark_q,
+			      const float *space_i, const float *space_q, unsigned int size)
+{
+	return fsqr(mac(buf, mark_i, size)) +
+		fsqr(mac(buf, mark_q, size)) -
+		fsqr(mac(buf, space_i, size)) -
+		fsqr(mac(buf, space_q, size));
+}
+#endif /* __HAVE_ARCH_AFSK_CORR */
+
 /* ---------------------------------------------------------------------- */
 #endif /* _FILTER_H */
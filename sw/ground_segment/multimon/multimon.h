@@ -32,6 +32,9 @@ extern const float costabf[0x400];
 
 /* ---------------------------------------------------------------------- */
 
+/* number of audio inputs demodulated in parallel (unixinput -m) */
+#define MULTIMON_MAX_CHANNELS 16
+
 struct demod_state {
   const struct demod_param *dem_par;
   union {
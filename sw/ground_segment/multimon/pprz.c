@@ -31,6 +31,10 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include "pprz.h"
 
 #define STX         0x02
 #define ETX         0x03
@@ -48,6 +52,46 @@
 
 /* ---------------------------------------------------------------------- */
 
+char multimon_pipe_name[1024] = MULTIMON_PIPE_NAME;
+
+/*
+ * output pipe, shared by the demodulators of all the channels, which
+ * write whole frames under pprz_pipe_mutex. It is opened once a reader
+ * is there, frames decoded before are dropped.
+ */
+static int pprz_pipe_fd = -1;
+static pthread_mutex_t pprz_pipe_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int pprz_open_pipe(void)
+{
+	int fd;
+
+	pthread_mutex_lock(&pprz_pipe_mutex);
+	fd = pprz_pipe_fd;
+	pthread_mutex_unlock(&pprz_pipe_mutex);
+	if (fd >= 0)
+		return fd;
+
+	/* fails with ENXIO as long as nobody reads the fifo */
+	if ((fd = open(multimon_pipe_name, O_WRONLY | O_NONBLOCK)) < 0) {
+		if (errno != ENXIO)
+			perror("open pipe");
+		return -1;
+	}
+	/* frames are then written whole, as before */
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+	pthread_mutex_lock(&pprz_pipe_mutex);
+	if (pprz_pipe_fd < 0)
+		pprz_pipe_fd = fd;
+	else {
+		close(fd);
+		fd = pprz_pipe_fd;
+	}
+	pthread_mutex_unlock(&pprz_pipe_mutex);
+	return fd;
+}
+
 static void pprz_tmtc_send(struct demod_state *s, unsigned char *data, unsigned int len, unsigned char type)
 {
 	unsigned char msg[INPUT_BUF_LEN+6];
@@ -70,7 +114,18 @@ static void pprz_tmtc_send(struct demod_state *s, unsigned char *data, unsigned
 	msg[count++] = checksum;
 	msg[count++] = ETX;
 
-	ret = write(s->l2.pprz.pipe_fd, msg, count);
+	if (pprz_open_pipe() < 0)
+		return;
+
+	/* whole frames, the channels share the fifo (dropped if it was closed meanwhile) */
+	pthread_mutex_lock(&pprz_pipe_mutex);
+	ret = pprz_pipe_fd < 0 ? (int)count : write(pprz_pipe_fd, msg, count);
+	if (ret < 0 && errno == EPIPE) {
+		/* the reader is gone, reopened at the next frame */
+		close(pprz_pipe_fd);
+		pprz_pipe_fd = -1;
+	}
+	pthread_mutex_unlock(&pprz_pipe_mutex);
 
 	if (count != ret)
 		perror("write pipe");
@@ -78,24 +133,21 @@ static void pprz_tmtc_send(struct demod_state *s, unsigned char *data, unsigned
 
 /* ---------------------------------------------------------------------- */
 
-char multimon_pipe_name[1024] = MULTIMON_PIPE_NAME;
-
 void pprz_init(struct demod_state *s)
 {
+	struct stat st;
+
 	memset(&s->l2.hdlc, 0, sizeof(s->l2.hdlc));
 	
-	/* open named pipe */
-	struct stat st;
+	/* create named pipe, opened at the first frame */
 	if (stat(multimon_pipe_name, &st)) {
-	  if (mkfifo(multimon_pipe_name, 0644) == -1) {
+	  if (mkfifo(multimon_pipe_name, 0644) == -1 && errno != EEXIST) {
 	    perror("make pipe");
 	    exit (10);
 	  }
 	}
-	if ((s->l2.pprz.pipe_fd = open(multimon_pipe_name, O_WRONLY /*| O_NONBLOCK*/)) < 0) {
-		perror("open pipe");
-		exit (10);
-	}
+	/* a reader leaving is seen as EPIPE */
+	signal(SIGPIPE, SIG_IGN);
 
 	/* reset buffer pointer */	
 	s->l2.pprz.rxptr = s->l2.hdlc.rxbuf;
@@ -33,6 +33,7 @@
 #include <string.h>
 #include <sys/wait.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 #include <sys/soundcard.h>
 #include <sys/ioctl.h>
@@ -50,7 +51,6 @@ static const struct demod_param *dem[] = { ALL_DEMOD };
 
 #define NUMDEMOD (sizeof(dem)/sizeof(dem[0]))
 
-static struct demod_state dem_st[NUMDEMOD];
 static unsigned int dem_mask[(NUMDEMOD+31)/32];
 
 #define MASK_SET(n) dem_mask[(n)>>5] |= 1<<((n)&0x1f)
@@ -59,6 +59,25 @@ static unsigned int dem_mask[(NUMDEMOD+31)/32];
 
 /* ---------------------------------------------------------------------- */
 
+/*
+ * one audio input and its demodulators, in multi channel mode each
+ * channel runs in its own thread
+ */
+struct channel {
+  const char *name;
+  struct demod_state dem_st[NUMDEMOD];
+  pthread_t thread;
+};
+
+static struct channel channels[MULTIMON_MAX_CHANNELS];
+static unsigned int nb_channels = 1;
+
+static const char *input_type = "hw";
+static int sample_rate = -1;
+static unsigned int overlap = 0;
+
+/* ---------------------------------------------------------------------- */
+
 static int verbose_level = 0;
 
 /* ---------------------------------------------------------------------- */
@@ -75,7 +94,7 @@ void verbprintf(int verb_level, const char *fmt, ...)
 
 /* ---------------------------------------------------------------------- */
 
-static void process_buffer(float *buf, unsigned int len)
+static void process_buffer(struct demod_state *dem_st, float *buf, unsigned int len)
 {
   int i;
 
@@ -86,8 +105,8 @@ static void process_buffer(float *buf, unsigned int len)
 
 /* ---------------------------------------------------------------------- */
 
-static void input_sound(unsigned int sample_rate, unsigned int overlap,
-			const char *ifname)
+static void input_sound(struct demod_state *dem_st, unsigned int sample_rate,
+			unsigned int overlap, const char *ifname)
 {
   int sndparam;
   int fd;
@@ -177,7 +196,7 @@ static void input_sound(unsigned int sample_rate, unsigned int overlap,
 	if (i)
 	  fprintf(stderr, "warning: noninteger number of samples read\n");
 	if (fbuf_cnt > overlap) {
-	  process_buffer(fbuf, fbuf_cnt-overlap);
+	  process_buffer(dem_st, fbuf, fbuf_cnt-overlap);
 	  memmove(fbuf, fbuf+fbuf_cnt-overlap, overlap*sizeof(fbuf[0]));
 	  fbuf_cnt = overlap;
 	}
@@ -201,7 +220,7 @@ static void input_sound(unsigned int sample_rate, unsigned int overlap,
 	if (i)
 	  fprintf(stderr, "warning: noninteger number of samples read\n");
 	if (fbuf_cnt > overlap) {
-	  process_buffer(fbuf, fbuf_cnt-overlap);
+	  process_buffer(dem_st, fbuf, fbuf_cnt-overlap);
 	  memmove(fbuf, fbuf+fbuf_cnt-overlap, overlap*sizeof(fbuf[0]));
 	  fbuf_cnt = overlap;
 	}
@@ -213,8 +232,8 @@ static void input_sound(unsigned int sample_rate, unsigned int overlap,
 
 /* ---------------------------------------------------------------------- */
 
-static void input_file(unsigned int sample_rate, unsigned int overlap,
-		       const char *fname, const char *type)
+static void input_file(struct demod_state *dem_st, unsigned int sample_rate,
+		       unsigned int overlap, const char *fname, const char *type)
 {
   struct stat statbuf;
   int pipedes[2];
@@ -287,7 +306,7 @@ static void input_file(unsigned int sample_rate, unsigned int overlap,
       if (i)
 	fprintf(stderr, "warning: noninteger number of samples read\n");
       if (fbuf_cnt > overlap) {
-	process_buffer(fbuf, fbuf_cnt-overlap);
+	process_buffer(dem_st, fbuf, fbuf_cnt-overlap);
 	memmove(fbuf, fbuf+fbuf_cnt-overlap, overlap*sizeof(fbuf[0]));
 	fbuf_cnt = overlap;
       }
@@ -299,31 +318,45 @@ static void input_file(unsigned int sample_rate, unsigned int overlap,
 
 /* ---------------------------------------------------------------------- */
 
+static void *channel_thread(void *arg)
+{
+  struct channel *ch = arg;
+
+  if (!strcmp(input_type, "hw"))
+    input_sound(ch->dem_st, sample_rate, overlap, ch->name);
+  else
+    input_file(ch->dem_st, sample_rate, overlap, ch->name, input_type);
+  return NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
 static const char usage_str[] = "multimod\n"
   "Demodulates many different radio transmission formats\n"
   "(C) 1996 by Thomas Sailer HB9JNX/AE4WA\n"
   "  -t <type>  : input file type (any other type than raw requires sox)\n"
   "  -a <demod> : add demodulator\n"
   "  -p <fifo> : output\n"
-  "  -s <demod> : subtract demodulator\n";
+  "  -s <demod> : subtract demodulator\n"
+  "  -m         : multi channel, each source is demodulated in its own thread,\n"
+  "               the frames of all the sources are output to the -p fifo\n";
 
 int main(int argc, char *argv[])
 {
   int c;
   int errflg = 0;
   int i;
+  unsigned int j;
   char **itype;
   int mask_first = 1;
-  int sample_rate = -1;
-  unsigned int overlap = 0;
-  char *input_type = "hw";
+  int multi_channel = 0;
 
   fprintf(stdout, "multimod  (C) 1996/1997 by Tom Sailer HB9JNX/AE4WA\n"
 	  "available demodulators:");
   for (i = 0; i < NUMDEMOD; i++) 
     fprintf(stdout, " %s", dem[i]->name);
   fprintf(stdout, "\n");
-  while ((c = getopt(argc, argv, "t:a:p:s:v:")) != EOF) {
+  while ((c = getopt(argc, argv, "t:a:p:s:v:m")) != EOF) {
     switch (c) {
     case '?':
       errflg++;
@@ -333,6 +366,10 @@ int main(int argc, char *argv[])
       verbose_level = strtoul(optarg, 0, 0);
       break;
 
+    case 'm':
+      multi_channel = 1;
+      break;
+
     case 't':
       for (itype = (char **)allowed_types; *itype; itype++) 
 	if (!strcmp(*itype, optarg)) {
@@ -392,14 +429,31 @@ int main(int argc, char *argv[])
   if (mask_first)
     memset(dem_mask, 0xff, sizeof(dem_mask));
 
+  if (multi_channel) {
+    if ((argc - optind) < 1 && strcmp(input_type, "hw")) {
+      (void)fprintf(stderr, "no source files specified\n");
+      exit(4);
+    }
+    if ((argc - optind) > MULTIMON_MAX_CHANNELS) {
+      (void)fprintf(stderr, "at most %d channels\n", MULTIMON_MAX_CHANNELS);
+      exit(4);
+    }
+    nb_channels = (argc - optind) < 1 ? 1 : (argc - optind);
+    for (j = 0; j < nb_channels; j++)
+      channels[j].name = (argc - optind) < 1 ? NULL : argv[optind + j];
+  }
+
   fprintf(stdout, "Enabled demodulators:");
   for (i = 0; i < NUMDEMOD; i++) 
     if (MASK_ISSET(i)) {
       fprintf(stdout, " %s", dem[i]->name);
-      memset(dem_st+i, 0, sizeof(dem_st[i]));
-      dem_st[i].dem_par = dem[i];
-      if (dem[i]->init)
-	dem[i]->init(dem_st+i);
+      for (j = 0; j < nb_channels; j++) {
+	struct demod_state *dem_st = channels[j].dem_st;
+	memset(dem_st+i, 0, sizeof(dem_st[i]));
+	dem_st[i].dem_par = dem[i];
+	if (dem[i]->init)
+	  dem[i]->init(dem_st+i);
+      }
       if (sample_rate == -1)
 	sample_rate = dem[i]->samplerate;
       else if (sample_rate != dem[i]->samplerate) {
@@ -414,11 +468,22 @@ int main(int argc, char *argv[])
     }
   fprintf(stdout, "\n");
 
+  if (multi_channel) {
+    for (j = 0; j < nb_channels; j++)
+      if (pthread_create(&channels[j].thread, NULL, channel_thread, &channels[j])) {
+	perror("pthread_create");
+	exit(10);
+      }
+    for (j = 0; j < nb_channels; j++)
+      pthread_join(channels[j].thread, NULL);
+    exit(0);
+  }
+
   if (!strcmp(input_type, "hw")) {
     if ((argc - optind) >= 1)
-      input_sound(sample_rate, overlap, argv[optind]);
+      input_sound(channels[0].dem_st, sample_rate, overlap, argv[optind]);
     else 
-      input_sound(sample_rate, overlap, NULL);
+      input_sound(channels[0].dem_st, sample_rate, overlap, NULL);
     exit(0);
   }
   if ((argc - optind) < 1) {
@@ -426,7 +491,7 @@ int main(int argc, char *argv[])
     exit(4);
   }
   for (i = optind; i < argc; i++)
-    input_file(sample_rate, overlap, argv[i], input_type);
+    input_file(channels[0].dem_st, sample_rate, overlap, argv[i], input_type);
   exit(0);
 }
 
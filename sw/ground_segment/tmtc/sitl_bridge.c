@@ -0,0 +1,401 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * SITL bridge
+ *
+ * Receives binary pprz frames sent by simulated aircraft built with
+ * SITL_TRANSPORT=unix (sw/airborne/arch/sim/unix_transport.c) on a
+ * unix datagram socket, and forwards them as text messages on the
+ * Ivy bus.
+ * A message is only formatted if some Ivy client has a binding that
+ * matches it, so unused telemetry costs nothing but the frame check.
+ */
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <Ivy/ivy.h>
+#include <Ivy/ivyglibloop.h>
+
+#define STX 0x99
+#define FRAME_MAX_LEN 260
+#define TEXT_MAX_LEN 2048
+#define NB_MSG 256
+#define NB_AC 256
+
+enum FieldType {
+  FT_UINT8, FT_INT8, FT_UINT16, FT_INT16, FT_UINT32, FT_INT32, FT_FLOAT, FT_DOUBLE,
+  FT_STRING  ///< length (uint8) followed by the chars, as a uint8 array
+};
+
+struct Field {
+  enum FieldType type;
+  gboolean is_array;
+};
+
+struct Message {
+  char* name;
+  GArray* fields;
+};
+
+/* binding status of a (ac_id, msg_id), recomputed lazily */
+enum BindStatus { BIND_UNKNOWN = 0, BIND_NONE, BIND_MATCH };
+
+static struct Message messages[NB_MSG];
+static guint8 bind_status[NB_AC][NB_MSG];
+/* regexps bound by ivy clients, key is "app:id" */
+static GHashTable* bindings;
+
+static char* socket_path = "/tmp/paparazzi_sitl";
+static char* ivy_bus = "127.255.255.255";
+static char* class_name = "telemetry";
+
+static unsigned long nb_frames, nb_sent, nb_err;
+
+
+/*
+ * messages.xml parsing
+ */
+
+static gboolean in_class = FALSE;
+static int cur_msg = -1;
+
+static int field_type_of_string(const char* s, struct Field* f) {
+  static const struct { const char* name; enum FieldType type; } types[] = {
+    { "uint8", FT_UINT8 }, { "int8", FT_INT8 }, { "uint16", FT_UINT16 },
+    { "int16", FT_INT16 }, { "uint32", FT_UINT32 }, { "int32", FT_INT32 },
+    { "float", FT_FLOAT }, { "double", FT_DOUBLE }, { "string", FT_STRING }
+  };
+  size_t len = strlen(s);
+  f->is_array = (len > 2 && strcmp(s + len - 2, "[]") == 0);
+  if (f->is_array)
+    len -= 2;
+  for (unsigned int i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    if (strlen(types[i].name) == len && strncmp(s, types[i].name, len) == 0) {
+      f->type = types[i].type;
+      return (f->is_array && f->type == FT_STRING) ? -1 : 0;
+    }
+  }
+  return -1;
+}
+
+static const char* get_attribute(const gchar** names, const gchar** values, const char* name) {
+  for (int i = 0; names[i]; i++)
+    if (strcmp(names[i], name) == 0)
+      return values[i];
+  return NULL;
+}
+
+static void xml_start(GMarkupParseContext* ctx __attribute__ ((unused)), const gchar* element,
+                      const gchar** names, const gchar** values,
+                      gpointer data __attribute__ ((unused)), GError** error __attribute__ ((unused))) {
+  if (strcmp(element, "class") == 0) {
+    const char* name = get_attribute(names, values, "name");
+    in_class = (name && strcmp(name, class_name) == 0);
+  }
+  else if (in_class && strcmp(element, "message") == 0) {
+    const char* name = get_attribute(names, values, "name");
+    const char* id = get_attribute(names, values, "id");
+    cur_msg = -1;
+    if (name && id && atoi(id) >= 0 && atoi(id) < NB_MSG) {
+      cur_msg = atoi(id);
+      messages[cur_msg].name = g_strdup(name);
+      messages[cur_msg].fields = g_array_new(FALSE, FALSE, sizeof(struct Field));
+    }
+  }
+  else if (in_class && cur_msg >= 0 && strcmp(element, "field") == 0) {
+    const char* type = get_attribute(names, values, "type");
+    struct Field f;
+    if (type && field_type_of_string(type, &f) == 0)
+      g_array_append_val(messages[cur_msg].fields, f);
+    else
+      g_warning("%s: unsupported field type %s", messages[cur_msg].name, type);
+  }
+}
+
+static void xml_end(GMarkupParseContext* ctx __attribute__ ((unused)), const gchar* element,
+                    gpointer data __attribute__ ((unused)), GError** error __attribute__ ((unused))) {
+  if (strcmp(element, "class") == 0)
+    in_class = FALSE;
+  else if (strcmp(element, "message") == 0)
+    cur_msg = -1;
+}
+
+static int load_messages(const char* file) {
+  gchar* content;
+  gsize len;
+  GError* error = NULL;
+  if (!g_file_get_contents(file, &content, &len, &error)) {
+    fprintf(stderr, "%s\n", error->message);
+    return -1;
+  }
+  GMarkupParser parser = { xml_start, xml_end, NULL, NULL, NULL };
+  GMarkupParseContext* ctx = g_markup_parse_context_new(&parser, 0, NULL, NULL);
+  if (!g_markup_parse_context_parse(ctx, content, len, &error)) {
+    fprintf(stderr, "%s: %s\n", file, error->message);
+    return -1;
+  }
+  g_markup_parse_context_free(ctx);
+  g_free(content);
+  return 0;
+}
+
+
+/*
+ * Ivy bindings tracking
+ */
+
+static void reset_bind_status(void) {
+  memset(bind_status, BIND_UNKNOWN, sizeof(bind_status));
+}
+
+static void on_bind(IvyClientPtr app, void* user_data __attribute__ ((unused)), int id,
+                    const char* regexp, IvyBindEvent event) {
+  gchar* key = g_strdup_printf("%p:%d", (void*)app, id);
+  if (event == IvyRemoveBind) {
+    g_hash_table_remove(bindings, key);
+    g_free(key);
+  }
+  else {
+    GRegex* re = g_regex_new(regexp, G_REGEX_OPTIMIZE, 0, NULL);
+    if (re)
+      g_hash_table_replace(bindings, key, re);
+    else
+      g_free(key);
+  }
+  reset_bind_status();
+}
+
+static void on_app(IvyClientPtr app, void* user_data __attribute__ ((unused)), IvyApplicationEvent event) {
+  if (event == IvyApplicationDisconnected) {
+    gchar* prefix = g_strdup_printf("%p:", (void*)app);
+    GHashTableIter iter;
+    gpointer key, value;
+    g_hash_table_iter_init(&iter, bindings);
+    while (g_hash_table_iter_next(&iter, &key, &value))
+      if (g_str_has_prefix((gchar*)key, prefix))
+        g_hash_table_iter_remove(&iter);
+    g_free(prefix);
+    reset_bind_status();
+  }
+}
+
+/* match the bindings against a message with all fields set to 0 */
+static gboolean is_bound(guint8 ac_id, guint8 msg_id) {
+  if (bind_status[ac_id][msg_id] == BIND_UNKNOWN) {
+    GString* probe = g_string_new(NULL);
+    g_string_printf(probe, "%d %s", ac_id, messages[msg_id].name);
+    for (guint i = 0; i < messages[msg_id].fields->len; i++) {
+      struct Field* f = &g_array_index(messages[msg_id].fields, struct Field, i);
+      g_string_append(probe, f->is_array ? " 0," : " 0");
+    }
+    bind_status[ac_id][msg_id] = BIND_NONE;
+    GHashTableIter iter;
+    gpointer key, value;
+    g_hash_table_iter_init(&iter, bindings);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+      if (g_regex_match((GRegex*)value, probe->str, 0, NULL)) {
+        bind_status[ac_id][msg_id] = BIND_MATCH;
+        break;
+      }
+    }
+    g_string_free(probe, TRUE);
+  }
+  return bind_status[ac_id][msg_id] == BIND_MATCH;
+}
+
+
+/*
+ * Frame decoding, same text format as arch/sim/ivy_transport.h
+ */
+
+static int field_size[] = { 1, 1, 2, 2, 4, 4, 4, 8, 1 };
+
+/* snprintf of one value, returns its length as snprintf does */
+static int format_value(char* out, size_t size, enum FieldType type, const guint8* p) {
+  switch (type) {
+  case FT_UINT8:  return snprintf(out, size, "%u", *p);
+  case FT_INT8:   return snprintf(out, size, "%d", *(const gint8*)p);
+  case FT_UINT16: { guint16 v; memcpy(&v, p, 2); return snprintf(out, size, "%u", v); }
+  case FT_INT16:  { gint16 v;  memcpy(&v, p, 2); return snprintf(out, size, "%d", v); }
+  case FT_UINT32: { guint32 v; memcpy(&v, p, 4); return snprintf(out, size, "%u", v); }
+  case FT_INT32:  { gint32 v;  memcpy(&v, p, 4); return snprintf(out, size, "%d", v); }
+  case FT_FLOAT:  { float v;   memcpy(&v, p, 4); return snprintf(out, size, "%f", v); }
+  case FT_DOUBLE: { double v;  memcpy(&v, p, 8); return snprintf(out, size, "%f", v); }
+  case FT_STRING: break;
+  }
+  return 0;
+}
+
+static void forward_frame(const guint8* buf, ssize_t len) {
+  nb_frames++;
+  if (len < 6 || buf[0] != STX || buf[1] != len) {
+    nb_err++;
+    return;
+  }
+  guint8 ck_a = buf[1], ck_b = buf[1];
+  for (int i = 2; i < len - 2; i++) {
+    ck_a += buf[i];
+    ck_b += ck_a;
+  }
+  if (ck_a != buf[len - 2] || ck_b != buf[len - 1]) {
+    nb_err++;
+    return;
+  }
+
+  guint8 ac_id = buf[2];
+  guint8 msg_id = buf[3];
+  if (!messages[msg_id].name || !is_bound(ac_id, msg_id))
+    return;
+
+  char text[TEXT_MAX_LEN];
+  char* t = text;
+  const guint8* p = buf + 4;
+  const guint8* end = buf + len - 2;
+  for (guint i = 0; i < messages[msg_id].fields->len; i++) {
+    struct Field* f = &g_array_index(messages[msg_id].fields, struct Field, i);
+    int size = field_size[f->type];
+    int n = 1;
+    if (f->is_array || f->type == FT_STRING) {
+      if (p >= end) goto error;
+      n = *p++;
+    }
+    if (p + n * size > end) goto error;
+    /* room for the value and its separator, t always leaves room for the final '\0' */
+    if (f->type == FT_STRING) {
+      if (n + 1 >= text + TEXT_MAX_LEN - t) goto error;
+      memcpy(t, p, n);
+      t += n;
+      p += n;
+      *t++ = ' ';
+      continue;
+    }
+    for (int j = 0; j < n; j++, p += size) {
+      size_t room = text + TEXT_MAX_LEN - t;
+      int r = format_value(t, room, f->type, p);
+      if (r < 0 || (size_t)r + 1 >= room) goto error;
+      t += r;
+      if (f->is_array) *t++ = ',';
+    }
+    if (t + 1 >= text + TEXT_MAX_LEN) goto error;
+    *t++ = ' ';
+  }
+  *t = '\0';
+  IvySendMsg("%d %s %s", ac_id, messages[msg_id].name, text);
+  nb_sent++;
+  return;
+ error:
+  nb_err++;
+}
+
+static gboolean on_socket(GIOChannel* chan, GIOCondition cond __attribute__ ((unused)),
+                          gpointer data __attribute__ ((unused))) {
+  guint8 buf[FRAME_MAX_LEN];
+  int fd = g_io_channel_unix_get_fd(chan);
+  ssize_t len;
+  while ((len = recv(fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+    forward_frame(buf, len);
+  return TRUE;
+}
+
+static gboolean on_timeout(gpointer data __attribute__ ((unused))) {
+  if (nb_err > 0)
+    g_message("frames %lu, forwarded %lu, errors %lu", nb_frames, nb_sent, nb_err);
+  return TRUE;
+}
+
+
+static int open_socket(const char* path) {
+  int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    perror("socket");
+    return -1;
+  }
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  unlink(path);
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    perror(path);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+
+int main(int argc, char** argv) {
+
+  const char* paparazzi_home = getenv("PAPARAZZI_HOME");
+  gchar* messages_file = g_strdup_printf("%s/conf/messages.xml", paparazzi_home ? paparazzi_home : ".");
+
+  static const char* usage =
+"Usage: %s [options]\n"
+" Options :\n"
+"   -b ivy bus (default %s)\n"
+"   -s unix socket (default %s)\n"
+"   -m messages file (default %s)\n";
+
+  int c;
+  while ((c = getopt(argc, argv, "b:s:m:h")) != -1) {
+    switch (c) {
+    case 'b': ivy_bus = optarg; break;
+    case 's': socket_path = optarg; break;
+    case 'm': messages_file = optarg; break;
+    default:
+      fprintf(stderr, usage, argv[0], ivy_bus, socket_path, messages_file);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (load_messages(messages_file) < 0)
+    return 1;
+
+  int fd = open_socket(socket_path);
+  if (fd < 0)
+    return 1;
+
+  bindings = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_regex_unref);
+  reset_bind_status();
+
+  GMainLoop* ml = g_main_loop_new(NULL, FALSE);
+
+  IvyInit("SitlBridge", "SitlBridge READY", on_app, NULL, NULL, NULL);
+  IvySetBindCallback(on_bind, NULL);
+  IvyStart(ivy_bus);
+
+  GIOChannel* chan = g_io_channel_unix_new(fd);
+  g_io_add_watch(chan, G_IO_IN, on_socket, NULL);
+  g_timeout_add(10000, on_timeout, NULL);
+
+  g_main_loop_run(ml);
+
+  return 0;
+}
@@ -1,7 +1,6 @@
 #include "ahrs_data.h"
 #include "ahrs_display.h"
 #include "ahrs_utils.h"
-#include "ekf.h"
 
 #include <string.h>
 #include <math.h>
@@ -106,6 +105,13 @@ void linear_measure(double *y, double* err, double*X, double *H) {
   H[5] = 0.;
 }
 
+#define EKF_NAME        ahrs_ekf
+#define EKF_STATE_DIM   6
+#define EKF_MEASURE_DIM 1
+#define EKF_FFUN        linear_filter
+#define EKF_MFUN        linear_measure
+#include "ekf_fixed.h"
+
 
 #define P0E 1.0
 #define P0B 1.0
@@ -137,17 +143,17 @@ void run_ekf (void) {
   /* command */
   double U[3] = {0.0, 0.0, 0.0};
   
-  struct ekf_filter* ekf;
-  ekf = ekf_filter_new(6, 1, Q, R, linear_filter, linear_measure);
+  static struct ahrs_ekf ekf;
+  ahrs_ekf_init(&ekf, Q, R);
   ahrs_euler_init(ad, 150, X);
-  ekf_filter_reset(ekf, X, P);
+  ahrs_ekf_reset(&ekf, X, P);
   int iter;
 
   for (iter=0; iter < ad->nb_samples; iter++) {
     U[0] = ad->gyro_p[iter];
     U[1] = ad->gyro_q[iter];
     U[2] = ad->gyro_r[iter];
-    ekf_filter_predict(ekf, U);
+    ahrs_ekf_predict(&ekf, U);
 
     ahrs_state = iter%3;
     switch (ahrs_state) {
@@ -164,9 +170,9 @@ void run_ekf (void) {
       break;
     }
     }
-    ekf_filter_update(ekf, Y);
+    ahrs_ekf_update(&ekf, Y);
 
-    ekf_filter_get_state(ekf, X, P);
+    ahrs_ekf_get_state(&ekf, X, P);
     ahrs_data_save_state_euler(ad, iter, X, P);
     ahrs_data_save_measure(ad, iter);
 
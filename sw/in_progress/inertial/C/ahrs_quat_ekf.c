@@ -1,7 +1,6 @@
 #include "ahrs_data.h"
 #include "ahrs_display.h"
 #include "ahrs_utils.h"
-#include "ekf.h"
 
 #include <string.h>
 #include <math.h>
@@ -113,6 +112,13 @@ void linear_measure(double *y, double* err, double*X, double *H) {
   H[6] = 0.;
 }
 
+#define EKF_NAME        ahrs_ekf
+#define EKF_STATE_DIM   7
+#define EKF_MEASURE_DIM 1
+#define EKF_FFUN        linear_filter
+#define EKF_MFUN        linear_measure
+#include "ekf_fixed.h"
+
 #define P0Q 1.0
 #define P0B 1.0
 
@@ -145,10 +151,10 @@ void run_ekf (void) {
   /* command */
   double U[3] = {0.0, 0.0, 0.0};
   
-  struct ekf_filter* ekf;
-  ekf = ekf_filter_new(7, 1, Q, R, linear_filter, linear_measure);
+  static struct ahrs_ekf ekf;
+  ahrs_ekf_init(&ekf, Q, R);
   ahrs_quat_init(ad, 150, X);
-  ekf_filter_reset(ekf, X, P);
+  ahrs_ekf_reset(&ekf, X, P);
 
   /* filter run */
   int iter;
@@ -156,7 +162,7 @@ void run_ekf (void) {
     U[0] = ad->gyro_p[iter];// - X[4];
     U[1] = ad->gyro_q[iter];// - X[5];
     U[2] = ad->gyro_r[iter];// - X[6];
-    ekf_filter_predict(ekf, U);
+    ahrs_ekf_predict(&ekf, U);
     norm_quat(X);
     ahrs_state = iter%3;
     switch (ahrs_state) {
@@ -173,10 +179,10 @@ void run_ekf (void) {
       break;
     }
     }
-    ekf_filter_update(ekf, Y);
+    ahrs_ekf_update(&ekf, Y);
     norm_quat(X);
     //    printf("P66 %f\n", P[6*7 + 6]);
-    ekf_filter_get_state(ekf, X, P);
+    ahrs_ekf_get_state(&ekf, X, P);
     ahrs_data_save_state_quat(ad, iter, X, P);
     ahrs_data_save_measure(ad, iter);
   }
@@ -1,7 +1,6 @@
 #include "ahrs_data.h"
 #include "ahrs_display.h"
 #include "ahrs_utils.h"
-#include "ukf.h"
 
 #define UPDATE_PHI   0
 #define UPDATE_THETA 1
@@ -48,6 +47,13 @@ void linear_measure(double *y, double *x) {
   y[0] = eulers[ahrs_state];
 }
 
+#define UKF_NAME        ahrs_ukf
+#define UKF_STATE_DIM   7
+#define UKF_MEASURE_DIM 1
+#define UKF_FFUN        linear_filter
+#define UKF_MFUN        linear_measure
+#include "ukf_fixed.h"
+
 
 
 void run_ukf(void) {
@@ -56,9 +62,9 @@ void run_ukf(void) {
 		   0.0,   1.0,   0.0,   0.0,   0.0,   0.0,   0.0,
 		   0.0,   0.0,   1.0,   0.0,   0.0,   0.0,   0.0,
 		   0.0,   0.0,   0.0,   1.0,   0.0,   0.0,   0.0,
-		   0.0,   0.0,   0.0,   0.0,   0.0,   0.0,   0.0,
-		   0.0,   0.0,   0.0,   0.0,   0.0,   0.0,   0.0,
-		   0.0,   0.0,   0.0,   0.0,   0.0,   0.0,   0.0 };
+		   0.0,   0.0,   0.0,   0.0,   1.0,   0.0,   0.0,
+		   0.0,   0.0,   0.0,   0.0,   0.0,   1.0,   0.0,
+		   0.0,   0.0,   0.0,   0.0,   0.0,   0.0,   1.0 };
   /* model noise covariance matrix */
   double Q[7*7] = {0.0,   0.0,   0.0,   0.0,   0.0,   0.0,   0.0, 
 		   0.0,   0.0,   0.0,   0.0,   0.0,   0.0,   0.0,
@@ -76,11 +82,11 @@ void run_ukf(void) {
   /* command */
   double U[3] = {0.0, 0.0, 0.0};
 
-  ukf_filter filter;
-  filter = ukf_filter_new(7, 1, Q, R, linear_filter, linear_measure);
-  ahrs_init(ad, 150, X);
-  ukf_filter_reset(filter, X, P);
-  ukf_filter_compute_weights(filter, 1.1, 0.0, 2.0);
+  static struct ahrs_ukf filter;
+  ahrs_ukf_init(&filter, Q, R);
+  ahrs_quat_init(ad, 150, X);
+  ahrs_ukf_reset(&filter, X, P);
+  ahrs_ukf_compute_weights(&filter, 1.1, 0.0, 2.0);
 
   int iter;
   for (iter=0; iter < ad->nb_samples; iter++) {
@@ -102,12 +108,10 @@ void run_ukf(void) {
       break;
     }
     }
-    ukf_filter_update(filter, Y, U);
-    ukf_filter_get_state(filter, X, P);
+    ahrs_ukf_update(&filter, Y, U);
+    ahrs_ukf_get_state(&filter, X, P);
     ahrs_data_save_state(ad, iter, X, P);
   }
-
-  ukf_filter_delete(filter);
 }
 
 int main(int argc, char** argv) {
@@ -0,0 +1,160 @@
+/*
+ * Extended Kalman filter with compile time dimensions and static storage.
+ *
+ * This header is a template: it generates a filter struct and its functions
+ * for the parameters defined before including it:
+ *
+ *   EKF_NAME         prefix of the generated struct and functions
+ *   EKF_STATE_DIM    size of the state
+ *   EKF_MEASURE_DIM  size of the measure
+ *   EKF_FFUN         void ffun(double* u, double* X, double* dt, double* Xdot, double* F)
+ *                    returns the time step, the state derivative and its jacobian
+ *   EKF_MFUN         void mfun(double* y, double* err, double* X, double* H)
+ *                    returns the error (measure - estimate) and the jacobian of the measure
+ *
+ * e.g. with EKF_NAME defined as tilt_ekf:
+ *
+ *   static struct tilt_ekf filter;
+ *   tilt_ekf_init(&filter, Q, R);
+ *   tilt_ekf_reset(&filter, X0, P0);
+ *   tilt_ekf_predict(&filter, u);
+ *   tilt_ekf_update(&filter, y);
+ *   ... filter.X, filter.P
+ *
+ * The covariance is propagated in continuous form unless EKF_UPDATE_DISCRETE
+ * is defined:
+ *   continuous  Pdot = F * P + P * F' + Q
+ *   discrete    Pdot = F * P * F' + Q
+ *   P += Pdot * dt
+ *
+ * The functions are static, so the header can be included several times
+ * with different parameters, and ffun / mfun are called directly so that
+ * the compiler can inline them. Nothing is allocated, the temporaries are
+ * on the stack.
+ */
+
+#include <string.h>
+#include "fixed_matrix.h"
+
+#if !defined EKF_NAME || !defined EKF_STATE_DIM || !defined EKF_MEASURE_DIM || \
+    !defined EKF_FFUN || !defined EKF_MFUN
+#error "define EKF_NAME, EKF_STATE_DIM, EKF_MEASURE_DIM, EKF_FFUN and EKF_MFUN before including ekf_fixed.h"
+#endif
+
+#define EKF_CAT_(_a, _b) _a##_b
+#define EKF_CAT(_a, _b) EKF_CAT_(_a, _b)
+#define EKF_FN(_f) EKF_CAT(EKF_NAME, _f)
+
+#define EKF_N EKF_STATE_DIM
+#define EKF_M EKF_MEASURE_DIM
+
+struct EKF_NAME {
+  /* state and its covariance */
+  double X[EKF_N];
+  double P[EKF_N * EKF_N];
+  /* process and measurement noise covariances */
+  double Q[EKF_N * EKF_N];
+  double R[EKF_M * EKF_M];
+};
+
+static inline void EKF_FN(_init)(struct EKF_NAME* f, const double* Q, const double* R) {
+  memset(f, 0, sizeof(struct EKF_NAME));
+  memcpy(f->Q, Q, sizeof(f->Q));
+  memcpy(f->R, R, sizeof(f->R));
+}
+
+static inline void EKF_FN(_reset)(struct EKF_NAME* f, const double* X0, const double* P0) {
+  memcpy(f->X, X0, sizeof(f->X));
+  memcpy(f->P, P0, sizeof(f->P));
+}
+
+static inline void EKF_FN(_get_state)(struct EKF_NAME* f, double* X, double* P) {
+  memcpy(X, f->X, sizeof(f->X));
+  memcpy(P, f->P, sizeof(f->P));
+}
+
+static inline void EKF_FN(_predict)(struct EKF_NAME* f, double* u) {
+  double dt;
+  double Xdot[EKF_N];
+  double F[EKF_N * EKF_N];
+  double FP[EKF_N * EKF_N];
+  unsigned i, j;
+
+  EKF_FFUN(u, f->X, &dt, Xdot, F);
+  for (i = 0; i < EKF_N; i++)
+    f->X[i] += dt * Xdot[i];
+
+  fmat_mult(EKF_N, EKF_N, EKF_N, FP, F, f->P);
+#ifdef EKF_UPDATE_DISCRETE
+  /* F * P * F' */
+  for (i = 0; i < EKF_N; i++)
+    for (j = 0; j <= i; j++) {
+      double t = f->Q[i * EKF_N + j];
+      for (unsigned k = 0; k < EKF_N; k++)
+        t += FP[i * EKF_N + k] * F[j * EKF_N + k];
+      f->P[i * EKF_N + j] += dt * t;
+    }
+#else
+  /* F * P + P * F' is F * P + (F * P)', as P is symmetric */
+  for (i = 0; i < EKF_N; i++)
+    for (j = 0; j <= i; j++)
+      f->P[i * EKF_N + j] += dt * (FP[i * EKF_N + j] + FP[j * EKF_N + i] + f->Q[i * EKF_N + j]);
+#endif
+  fmat_symmetrize(EKF_N, f->P);
+}
+
+/*
+ *  E = H * P * H' + R
+ *  K = P * H' * inv(E)
+ *  P = P - K * H * P
+ *  X = X + K * err
+ *
+ * Returns 0, or -1 if E is not positive definite, in which case the
+ * filter is left unchanged.
+ */
+static inline int EKF_FN(_update)(struct EKF_NAME* f, double* y) {
+  double err[EKF_M];
+  double H[EKF_M * EKF_N];
+  double PHt[EKF_N * EKF_M];
+  double E[EKF_M * EKF_M];
+  double K[EKF_N * EKF_M];
+  unsigned i, j;
+
+  EKF_MFUN(y, err, f->X, H);
+
+  /* P * H', H * P is its transpose */
+  fmat_mult_transp(EKF_N, EKF_N, EKF_M, PHt, f->P, H);
+  fmat_mult(EKF_M, EKF_N, EKF_M, E, H, PHt);
+  for (i = 0; i < EKF_M * EKF_M; i++)
+    E[i] += f->R[i];
+
+  if (fmat_cholesky(EKF_M, E, E))
+    return -1;
+  fmat_cholesky_solve_rows(EKF_M, EKF_N, K, E, PHt);
+
+  for (i = 0; i < EKF_N; i++)
+    for (j = 0; j <= i; j++) {
+      double t = 0.;
+      for (unsigned k = 0; k < EKF_M; k++)
+        t += K[i * EKF_M + k] * PHt[j * EKF_M + k];
+      f->P[i * EKF_N + j] -= t;
+    }
+  fmat_symmetrize(EKF_N, f->P);
+
+  for (i = 0; i < EKF_N; i++)
+    for (j = 0; j < EKF_M; j++)
+      f->X[i] += K[i * EKF_M + j] * err[j];
+
+  return 0;
+}
+
+#undef EKF_N
+#undef EKF_M
+#undef EKF_FN
+#undef EKF_CAT
+#undef EKF_CAT_
+#undef EKF_NAME
+#undef EKF_STATE_DIM
+#undef EKF_MEASURE_DIM
+#undef EKF_FFUN
+#undef EKF_MFUN
@@ -0,0 +1,112 @@
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+/*
+ * Small matrix kernels for the fixed size filters (ekf_fixed.h, ukf_fixed.h).
+ *
+ * Matrices are row major arrays of doubles. The kernels are always inlined:
+ * called with compile time dimensions, the loops are unrolled and the
+ * inner loops, which run along rows, are vectorized.
+ * Symmetric matrices are computed on their lower triangle and mirrored.
+ */
+
+#include <math.h>
+
+#define FMAT_INLINE static inline __attribute__((always_inline))
+
+/* r = a * b, a is n x m, b is m x p */
+FMAT_INLINE void fmat_mult(const unsigned n, const unsigned m, const unsigned p,
+                           double* r, const double* a, const double* b) {
+  for (unsigned i = 0; i < n; i++) {
+    for (unsigned j = 0; j < p; j++)
+      r[i*p + j] = 0.;
+    for (unsigned k = 0; k < m; k++) {
+      const double aik = a[i*m + k];
+      for (unsigned j = 0; j < p; j++)
+        r[i*p + j] += aik * b[k*p + j];
+    }
+  }
+}
+
+/* r = a * b', a is n x m, b is p x m */
+FMAT_INLINE void fmat_mult_transp(const unsigned n, const unsigned m, const unsigned p,
+                                  double* r, const double* a, const double* b) {
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned j = 0; j < p; j++) {
+      double t = 0.;
+      for (unsigned k = 0; k < m; k++)
+        t += a[i*m + k] * b[j*m + k];
+      r[i*p + j] = t;
+    }
+}
+
+/* lower triangle of a += w * v * v', v of size n */
+FMAT_INLINE void fmat_add_outer_lower(const unsigned n, double* a, const double w, const double* v) {
+  for (unsigned i = 0; i < n; i++) {
+    const double wvi = w * v[i];
+    for (unsigned j = 0; j <= i; j++)
+      a[i*n + j] += wvi * v[j];
+  }
+}
+
+/* copy the lower triangle of a to its upper triangle */
+FMAT_INLINE void fmat_symmetrize(const unsigned n, double* a) {
+  for (unsigned i = 0; i < n; i++)
+    for (unsigned j = 0; j < i; j++)
+      a[j*n + i] = a[i*n + j];
+}
+
+/*
+ * Cholesky decomposition a = l * l'.
+ * l is lower triangular, its upper triangle is set to zero.
+ * Only the lower triangle of a is read, l can be a.
+ * Returns 0, or -1 if a is not positive definite.
+ */
+FMAT_INLINE int fmat_cholesky(const unsigned n, double* l, const double* a) {
+  for (unsigned j = 0; j < n; j++) {
+    double d = a[j*n + j];
+    for (unsigned k = 0; k < j; k++)
+      d -= l[j*n + k] * l[j*n + k];
+    if (d <= 0.)
+      return -1;
+    const double ljj = sqrt(d);
+    const double inv = 1. / ljj;
+    l[j*n + j] = ljj;
+    for (unsigned i = j + 1; i < n; i++) {
+      double t = a[i*n + j];
+      for (unsigned k = 0; k < j; k++)
+        t -= l[i*n + k] * l[j*n + k];
+      l[i*n + j] = t * inv;
+    }
+    for (unsigned k = j + 1; k < n; k++)
+      l[j*n + k] = 0.;
+  }
+  return 0;
+}
+
+/*
+ * x = b * inv(l * l'), with l from fmat_cholesky,
+ * b and x are p x n, x can be b.
+ */
+FMAT_INLINE void fmat_cholesky_solve_rows(const unsigned n, const unsigned p,
+                                          double* x, const double* l, const double* b) {
+  for (unsigned r = 0; r < p; r++) {
+    double* xr = &x[r*n];
+    /* l * y = b_r */
+    for (unsigned j = 0; j < n; j++) {
+      double t = b[r*n + j];
+      for (unsigned k = 0; k < j; k++)
+        t -= l[j*n + k] * xr[k];
+      xr[j] = t / l[j*n + j];
+    }
+    /* l' * x_r = y */
+    for (unsigned j = n; j-- > 0; ) {
+      double t = xr[j];
+      for (unsigned k = j + 1; k < n; k++)
+        t -= l[k*n + j] * xr[k];
+      xr[j] = t / l[j*n + j];
+    }
+  }
+}
+
+#endif /* FIXED_MATRIX_H */
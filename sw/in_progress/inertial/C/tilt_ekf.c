@@ -3,7 +3,6 @@
 #include "tilt_data.h"
 #include "tilt_display.h"
 #include "tilt_utils.h"
-#include "ekf.h"
 
 /*
   Simple 2 state filter for hybridizing gyrometer and accelerometer 
@@ -43,6 +42,13 @@ void linear_measure(double *y, double* err, double*x, double *H) {
   H[1] = 0.;
 }
 
+#define EKF_NAME        tilt_ekf
+#define EKF_STATE_DIM   2
+#define EKF_MEASURE_DIM 1
+#define EKF_FFUN        linear_filter
+#define EKF_MFUN        linear_measure
+#include "ekf_fixed.h"
+
 
 void run_ekf(struct tilt_data* td) {
   /* model noise covariance matrix       */
@@ -60,18 +66,18 @@ void run_ekf(struct tilt_data* td) {
   /* command */
   double u[1];
 
-  struct ekf_filter* filter;
-  filter = ekf_filter_new(2, 1, Q, R, linear_filter, linear_measure);
+  static struct tilt_ekf filter;
+  tilt_ekf_init(&filter, Q, R);
   tilt_init(td, 150, X0);
-  ekf_filter_reset(filter, X0, P0);
+  tilt_ekf_reset(&filter, X0, P0);
 
   /* filter run */
   for (iter=0; iter<td->nb_samples; iter++) {
     u[0] = td->gyro[iter];
     y[0] = td->m_angle[iter];
-    ekf_filter_predict(filter, u);
-    ekf_filter_update(filter, y);
-    ekf_filter_get_state(filter, X0, P0);
+    tilt_ekf_predict(&filter, u);
+    tilt_ekf_update(&filter, y);
+    tilt_ekf_get_state(&filter, X0, P0);
     tilt_data_save_state(td, iter, X0, P0);
   }
 }
@@ -3,7 +3,6 @@
 #include "tilt_data.h"
 #include "tilt_display.h"
 #include "tilt_utils.h"
-#include "ukf.h"
 
 /*
   Simple 2 state filter for hybridizing gyrometer and accelerometer 
@@ -29,6 +28,13 @@ void linear_measure(double *y, double *x) {
   y[0] = x[0];
 }
 
+#define UKF_NAME        tilt_ukf
+#define UKF_STATE_DIM   2
+#define UKF_MEASURE_DIM 1
+#define UKF_FFUN        linear_filter
+#define UKF_MFUN        linear_measure
+#include "ukf_fixed.h"
+
 
 void run_ukf(struct tilt_data* td) {
   /* model noise covariance matrix */
@@ -46,22 +52,21 @@ void run_ukf(struct tilt_data* td) {
   /* command */
   double u[2] = {0.0, 0.0};
 
-  ukf_filter filter;
-  filter = ukf_filter_new(2, 1, Q, R, linear_filter, linear_measure);
+  static struct tilt_ukf filter;
+  tilt_ukf_init(&filter, Q, R);
   tilt_init(td, 150, x);
-  ukf_filter_reset(filter, x, P);
-  ukf_filter_compute_weights(filter, 1.1, 0.0, 2.0);
+  tilt_ukf_reset(&filter, x, P);
+  tilt_ukf_compute_weights(&filter, 1.1, 0.0, 2.0);
 
   /* filter run */
   int iter;
   for (iter=0; iter<td->nb_samples; iter++) {
     u[0] = td->gyro[iter];
     y[0] = td->m_angle[iter];
-    ukf_filter_update(filter, y, u);
-    ukf_filter_get_state(filter, x, P);
+    tilt_ukf_update(&filter, y, u);
+    tilt_ukf_get_state(&filter, x, P);
     tilt_data_save_state(td, iter, x, P);
   }
-  ukf_filter_delete(filter);
 }
 
 int
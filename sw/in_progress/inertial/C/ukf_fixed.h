@@ -0,0 +1,221 @@
+/*
+ * Unscented Kalman filter with compile time dimensions and static storage.
+ *
+ * This header is a template: it generates a filter struct and its functions
+ * for the parameters defined before including it:
+ *
+ *   UKF_NAME         prefix of the generated struct and functions
+ *   UKF_STATE_DIM    size of the state
+ *   UKF_MEASURE_DIM  size of the measure
+ *   UKF_FFUN         evolution function, void ffun(double* x1, double* x0, double* u)
+ *   UKF_MFUN         measure function, void mfun(double* y, double* x)
+ *
+ * e.g. with UKF_NAME defined as tilt_ukf:
+ *
+ *   static struct tilt_ukf filter;
+ *   tilt_ukf_init(&filter, Q, R);
+ *   tilt_ukf_compute_weights(&filter, 1.1, 0.0, 2.0);
+ *   tilt_ukf_reset(&filter, x0, P0);
+ *   tilt_ukf_update(&filter, y, u);
+ *   ... filter.x, filter.P
+ *
+ * The functions are static, so the header can be included several times
+ * with different parameters, and ffun / mfun are called directly so that
+ * the compiler can inline them. Nothing is allocated: the sigma points are
+ * kept in the struct, the other temporaries are on the stack.
+ */
+
+#include <string.h>
+#include "fixed_matrix.h"
+
+#if !defined UKF_NAME || !defined UKF_STATE_DIM || !defined UKF_MEASURE_DIM || \
+    !defined UKF_FFUN || !defined UKF_MFUN
+#error "define UKF_NAME, UKF_STATE_DIM, UKF_MEASURE_DIM, UKF_FFUN and UKF_MFUN before including ukf_fixed.h"
+#endif
+
+#define UKF_CAT_(_a, _b) _a##_b
+#define UKF_CAT(_a, _b) UKF_CAT_(_a, _b)
+#define UKF_FN(_f) UKF_CAT(UKF_NAME, _f)
+
+#define UKF_L UKF_STATE_DIM
+#define UKF_M UKF_MEASURE_DIM
+#define UKF_S (2 * UKF_STATE_DIM + 1)
+
+struct UKF_NAME {
+  /* state and its covariance */
+  double x[UKF_L];
+  double P[UKF_L * UKF_L];
+  /* additive model and measure noise covariances */
+  double Q[UKF_L * UKF_L];
+  double R[UKF_M * UKF_M];
+  /* weights of the mean and of the covariance, scaling parameter */
+  double wm[UKF_S];
+  double wc[UKF_S];
+  double gamma;
+  /* sigma points and their images, first one is the mean */
+  double sigma_point[UKF_S * UKF_L];
+  double khi[UKF_S * UKF_L];
+  double khi_y[UKF_S * UKF_M];
+};
+
+/*
+ * @param Q: additive model noise covariance matrix
+ * @param R: additive measurement noise covariance matrix
+ */
+static inline void UKF_FN(_init)(struct UKF_NAME* f, const double* Q, const double* R) {
+  memset(f, 0, sizeof(struct UKF_NAME));
+  memcpy(f->Q, Q, sizeof(f->Q));
+  memcpy(f->R, R, sizeof(f->R));
+}
+
+/*
+ * set filter weights using default procedure
+ * @param alpha: spread parameter
+ * @param k: scaling parameter
+ * @param beta: distribution fitting parameter (2 for Gaussian)
+ */
+static inline void UKF_FN(_compute_weights)(struct UKF_NAME* f, double alpha, double k, double beta) {
+  const double l = UKF_L;
+  const double lam = alpha * alpha * (l + k) - l;
+  f->wm[0] = lam / (lam + l);
+  f->wc[0] = f->wm[0] + (1.0 - alpha * alpha + beta);
+  for (unsigned i = 1; i < UKF_S; i++) {
+    f->wm[i] = 0.5 / (lam + l);
+    f->wc[i] = 0.5 / (lam + l);
+  }
+  f->gamma = alpha * sqrt(l + k);
+}
+
+static inline void UKF_FN(_reset)(struct UKF_NAME* f, const double* x0, const double* P0) {
+  memcpy(f->x, x0, sizeof(f->x));
+  memcpy(f->P, P0, sizeof(f->P));
+}
+
+static inline void UKF_FN(_get_state)(struct UKF_NAME* f, double* x, double* P) {
+  memcpy(x, f->x, sizeof(f->x));
+  memcpy(P, f->P, sizeof(f->P));
+}
+
+/* sigma points around x, spread along the columns of chol */
+static inline void UKF_FN(_draw_sigma_points)(struct UKF_NAME* f, const double* x, const double* chol) {
+  for (unsigned j = 0; j < UKF_L; j++)
+    f->sigma_point[j] = x[j];
+  for (unsigned i = 0; i < UKF_L; i++)
+    for (unsigned j = 0; j < UKF_L; j++) {
+      const double d = f->gamma * chol[j * UKF_L + i];
+      f->sigma_point[(i + 1) * UKF_L + j] = x[j] + d;
+      f->sigma_point[(i + 1 + UKF_L) * UKF_L + j] = x[j] - d;
+    }
+}
+
+/*
+ * Update filter using a measure
+ * @param y: the measure vector
+ * @param u: the command
+ * Returns 0, or -1 if a covariance is not positive definite, in which
+ * case the filter is left unchanged.
+ */
+static inline int UKF_FN(_update)(struct UKF_NAME* f, double* y, double* u) {
+  double chol[UKF_L * UKF_L];
+  double xm[UKF_L], dx[UKF_L];
+  double PM[UKF_L * UKF_L];
+  double ym[UKF_M], dy[UKF_M];
+  double Pyy[UKF_M * UKF_M];
+  double Pxy[UKF_L * UKF_M];
+  double gain[UKF_L * UKF_M];
+  double KL[UKF_L * UKF_M];
+  unsigned i, j;
+
+  /* sigma points from the state covariance */
+  if (fmat_cholesky(UKF_L, chol, f->P))
+    return -1;
+  UKF_FN(_draw_sigma_points)(f, f->x, chol);
+
+  /* propagate them, state prediction */
+  for (i = 0; i < UKF_S; i++)
+    UKF_FFUN(&f->khi[i * UKF_L], &f->sigma_point[i * UKF_L], u);
+  for (j = 0; j < UKF_L; j++)
+    xm[j] = 0.;
+  for (i = 0; i < UKF_S; i++)
+    for (j = 0; j < UKF_L; j++)
+      xm[j] += f->wm[i] * f->khi[i * UKF_L + j];
+
+  /* time update */
+  memcpy(PM, f->Q, sizeof(PM));
+  for (i = 0; i < UKF_S; i++) {
+    for (j = 0; j < UKF_L; j++)
+      dx[j] = f->khi[i * UKF_L + j] - xm[j];
+    fmat_add_outer_lower(UKF_L, PM, f->wc[i], dx);
+  }
+  fmat_symmetrize(UKF_L, PM);
+
+  /* redraw sigma points */
+  if (fmat_cholesky(UKF_L, chol, PM))
+    return -1;
+  UKF_FN(_draw_sigma_points)(f, xm, chol);
+
+  /* propagate measure, measure prediction */
+  for (i = 0; i < UKF_S; i++)
+    UKF_MFUN(&f->khi_y[i * UKF_M], &f->sigma_point[i * UKF_L]);
+  for (j = 0; j < UKF_M; j++)
+    ym[j] = 0.;
+  for (i = 0; i < UKF_S; i++)
+    for (j = 0; j < UKF_M; j++)
+      ym[j] += f->wm[i] * f->khi_y[i * UKF_M + j];
+
+  /* measure and cross covariances */
+  memcpy(Pyy, f->R, sizeof(Pyy));
+  memset(Pxy, 0, sizeof(Pxy));
+  for (i = 0; i < UKF_S; i++) {
+    for (j = 0; j < UKF_M; j++)
+      dy[j] = f->khi_y[i * UKF_M + j] - ym[j];
+    for (j = 0; j < UKF_L; j++)
+      dx[j] = f->sigma_point[i * UKF_L + j] - xm[j];
+    fmat_add_outer_lower(UKF_M, Pyy, f->wc[i], dy);
+    for (j = 0; j < UKF_L; j++) {
+      const double wdx = f->wc[i] * dx[j];
+      for (unsigned k = 0; k < UKF_M; k++)
+        Pxy[j * UKF_M + k] += wdx * dy[k];
+    }
+  }
+
+  /* kalman gain, Pxy * inv(Pyy) */
+  if (fmat_cholesky(UKF_M, Pyy, Pyy))
+    return -1;
+  fmat_cholesky_solve_rows(UKF_M, UKF_L, gain, Pyy, Pxy);
+
+  /* update state */
+  for (j = 0; j < UKF_M; j++)
+    dy[j] = y[j] - ym[j];
+  for (i = 0; i < UKF_L; i++) {
+    double t = 0.;
+    for (j = 0; j < UKF_M; j++)
+      t += gain[i * UKF_M + j] * dy[j];
+    f->x[i] = xm[i] + t;
+  }
+
+  /* update covariance, P = PM - K Pyy K' = PM - (K L) (K L)' */
+  fmat_mult(UKF_L, UKF_M, UKF_M, KL, gain, Pyy);
+  for (i = 0; i < UKF_L; i++)
+    for (j = 0; j <= i; j++) {
+      double t = 0.;
+      for (unsigned k = 0; k < UKF_M; k++)
+        t += KL[i * UKF_M + k] * KL[j * UKF_M + k];
+      f->P[i * UKF_L + j] = PM[i * UKF_L + j] - t;
+    }
+  fmat_symmetrize(UKF_L, f->P);
+
+  return 0;
+}
+
+#undef UKF_L
+#undef UKF_M
+#undef UKF_S
+#undef UKF_FN
+#undef UKF_CAT
+#undef UKF_CAT_
+#undef UKF_NAME
+#undef UKF_STATE_DIM
+#undef UKF_MEASURE_DIM
+#undef UKF_FFUN
+#undef UKF_MFUN
@@ -0,0 +1,440 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/** Converts a .log/.data pair to the columnar format of log_columns.h
+ *
+ *  usage: data2columns <file.log> [<file.col>]
+ *  The data file is taken from the data_file attribute of the log, or
+ *  has the same basename. Compressed (.gz) data files are accepted.
+ */
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_columns.h"
+
+struct field_def {
+  char* name;
+  enum lc_type type;
+  gboolean is_array;
+  gboolean is_string;
+};
+
+struct msg_def {
+  char* name;
+  GArray* fields;
+};
+
+struct column_buf {
+  char name[LC_NAME_LEN];
+  enum lc_type type;
+  GArray* values;
+};
+
+struct series_buf {
+  char* ac;
+  struct msg_def* msg;
+  guint64 nb_rows;
+  struct column_buf* time;
+  GPtrArray** elems;    ///< per field, the columns of its elements
+};
+
+static GHashTable* msgs_telemetry;
+static GHashTable* msgs_telemetry_ap;
+static GHashTable* series;
+static GPtrArray* series_list;
+static gchar* data_file;
+
+
+/*
+ * .log parsing
+ */
+
+static GHashTable* cur_class;
+static struct msg_def* cur_msg;
+
+static int type_of_string(const char* s, struct field_def* f) {
+  static const char* names[] = { "uint8", "int8", "uint16", "int16", "uint32", "int32", "float", "double" };
+  size_t len = strlen(s);
+  unsigned int i;
+  f->is_array = (len > 2 && strcmp(s + len - 2, "[]") == 0);
+  f->is_string = (strncmp(s, "string", 6) == 0 || strncmp(s, "char", 4) == 0);
+  if (f->is_array)
+    len -= 2;
+  for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    if (strlen(names[i]) == len && strncmp(s, names[i], len) == 0) {
+      f->type = (enum lc_type)i;
+      return 0;
+    }
+  return f->is_string ? 0 : -1;
+}
+
+static const char* get_attribute(const gchar** names, const gchar** values, const char* name) {
+  int i;
+  for (i = 0; names[i]; i++)
+    if (strcmp(names[i], name) == 0)
+      return values[i];
+  return NULL;
+}
+
+static void xml_start(GMarkupParseContext* ctx __attribute__ ((unused)), const gchar* element,
+                      const gchar** names, const gchar** values,
+                      gpointer data __attribute__ ((unused)), GError** error __attribute__ ((unused))) {
+  if (strcmp(element, "configuration") == 0) {
+    const char* f = get_attribute(names, values, "data_file");
+    if (f)
+      data_file = g_strdup(f);
+  }
+  else if (strcmp(element, "class") == 0) {
+    const char* name = get_attribute(names, values, "name");
+    if (name && strcmp(name, "telemetry") == 0)
+      cur_class = msgs_telemetry;
+    else if (name && strcmp(name, "telemetry_ap") == 0)
+      cur_class = msgs_telemetry_ap;
+    else
+      cur_class = NULL;
+  }
+  else if (cur_class && strcmp(element, "message") == 0) {
+    const char* name = get_attribute(names, values, "name");
+    cur_msg = NULL;
+    if (name) {
+      cur_msg = g_new0(struct msg_def, 1);
+      cur_msg->name = g_strdup(name);
+      cur_msg->fields = g_array_new(FALSE, FALSE, sizeof(struct field_def));
+      g_hash_table_insert(cur_class, cur_msg->name, cur_msg);
+    }
+  }
+  else if (cur_msg && strcmp(element, "field") == 0) {
+    const char* name = get_attribute(names, values, "name");
+    const char* type = get_attribute(names, values, "type");
+    struct field_def f = { NULL, LC_UINT8, FALSE, FALSE };
+    if (!name || !type || type_of_string(type, &f) < 0) {
+      g_warning("%s: unsupported field %s", cur_msg->name, name);
+      f.is_string = TRUE;
+    }
+    f.name = g_ascii_strdown(name ? name : "", -1);
+    g_array_append_val(cur_msg->fields, f);
+  }
+}
+
+static void xml_end(GMarkupParseContext* ctx __attribute__ ((unused)), const gchar* element,
+                    gpointer data __attribute__ ((unused)), GError** error __attribute__ ((unused))) {
+  if (strcmp(element, "class") == 0)
+    cur_class = NULL;
+  else if (strcmp(element, "message") == 0)
+    cur_msg = NULL;
+}
+
+static int load_log(const char* file) {
+  gchar* content;
+  gsize len;
+  GError* error = NULL;
+  if (!g_file_get_contents(file, &content, &len, &error)) {
+    fprintf(stderr, "%s\n", error->message);
+    return -1;
+  }
+  GMarkupParser parser = { xml_start, xml_end, NULL, NULL, NULL };
+  GMarkupParseContext* ctx = g_markup_parse_context_new(&parser, 0, NULL, NULL);
+  gboolean ok = g_markup_parse_context_parse(ctx, content, len, &error);
+  g_markup_parse_context_free(ctx);
+  g_free(content);
+  if (!ok) {
+    fprintf(stderr, "%s: %s\n", file, error->message);
+    return -1;
+  }
+  return 0;
+}
+
+
+/*
+ * .data reading
+ */
+
+static struct column_buf* column_new(const char* name, enum lc_type type, guint64 nb_rows) {
+  struct column_buf* c = g_new0(struct column_buf, 1);
+  g_strlcpy(c->name, name, LC_NAME_LEN);
+  c->type = type;
+  c->values = g_array_sized_new(FALSE, TRUE, lc_type_size[type], nb_rows + 1024);
+  /* rows before the column was known (longer array) are 0 */
+  g_array_set_size(c->values, nb_rows);
+  return c;
+}
+
+static void column_append(struct column_buf* c, double v) {
+  switch (c->type) {
+  case LC_UINT8:  { guint8 x = v;  g_array_append_val(c->values, x); break; }
+  case LC_INT8:   { gint8 x = v;   g_array_append_val(c->values, x); break; }
+  case LC_UINT16: { guint16 x = v; g_array_append_val(c->values, x); break; }
+  case LC_INT16:  { gint16 x = v;  g_array_append_val(c->values, x); break; }
+  case LC_UINT32: { guint32 x = v; g_array_append_val(c->values, x); break; }
+  case LC_INT32:  { gint32 x = v;  g_array_append_val(c->values, x); break; }
+  case LC_FLOAT:  { float x = v;   g_array_append_val(c->values, x); break; }
+  case LC_DOUBLE: { double x = v;  g_array_append_val(c->values, x); break; }
+  }
+}
+
+static struct series_buf* get_series(const char* ac, struct msg_def* msg) {
+  gchar* key = g_strdup_printf("%s %s", ac, msg->name);
+  struct series_buf* s = (struct series_buf*)g_hash_table_lookup(series, key);
+  if (s) {
+    g_free(key);
+    return s;
+  }
+  s = g_new0(struct series_buf, 1);
+  s->ac = g_strdup(ac);
+  s->msg = msg;
+  s->time = column_new("time", LC_DOUBLE, 0);
+  s->elems = g_new0(GPtrArray*, msg->fields->len);
+  guint i;
+  for (i = 0; i < msg->fields->len; i++) {
+    struct field_def* f = &g_array_index(msg->fields, struct field_def, i);
+    s->elems[i] = g_ptr_array_new();
+    if (!f->is_string && !f->is_array)
+      g_ptr_array_add(s->elems[i], column_new(f->name, f->type, 0));
+  }
+  g_hash_table_insert(series, key, s);
+  g_ptr_array_add(series_list, s);
+  return s;
+}
+
+static void add_line(char* line, GHashTable* msgs) {
+  gchar** tok = g_strsplit_set(g_strstrip(line), " ", -1);
+  guint n = g_strv_length(tok);
+  if (n < 3)
+    goto end;
+  struct msg_def* msg = (struct msg_def*)g_hash_table_lookup(msgs, tok[2]);
+  if (!msg || n != 3 + msg->fields->len)
+    goto end;
+  struct series_buf* s = get_series(tok[1], msg);
+  column_append(s->time, g_ascii_strtod(tok[0], NULL));
+  guint i, j;
+  for (i = 0; i < msg->fields->len; i++) {
+    struct field_def* f = &g_array_index(msg->fields, struct field_def, i);
+    if (f->is_string)
+      continue;
+    if (!f->is_array) {
+      column_append((struct column_buf*)g_ptr_array_index(s->elems[i], 0), g_ascii_strtod(tok[3 + i], NULL));
+      continue;
+    }
+    gchar** elems = g_strsplit(tok[3 + i], ",", -1);
+    guint nb = 0;
+    while (elems[nb] && elems[nb][0]) nb++;
+    while (s->elems[i]->len < nb) {
+      gchar* name = g_strdup_printf("%s[%d]", f->name, s->elems[i]->len);
+      g_ptr_array_add(s->elems[i], column_new(name, f->type, s->nb_rows));
+      g_free(name);
+    }
+    for (j = 0; j < s->elems[i]->len; j++)
+      column_append((struct column_buf*)g_ptr_array_index(s->elems[i], j),
+                    j < nb ? g_ascii_strtod(elems[j], NULL) : 0.);
+    g_strfreev(elems);
+  }
+  s->nb_rows++;
+ end:
+  g_strfreev(tok);
+}
+
+static int load_data(const char* file, GHashTable* msgs) {
+  FILE* f;
+  gboolean compressed = g_str_has_suffix(file, ".gz");
+  if (compressed) {
+    gchar* cmd = g_strdup_printf("gzip -dc '%s'", file);
+    f = popen(cmd, "r");
+    g_free(cmd);
+  }
+  else
+    f = fopen(file, "r");
+  if (!f) {
+    perror(file);
+    return -1;
+  }
+  char line[4096];
+  while (fgets(line, sizeof(line), f))
+    add_line(line, msgs);
+  if (compressed)
+    pclose(f);
+  else
+    fclose(f);
+  return 0;
+}
+
+
+/*
+ * .col writing
+ */
+
+static void blocks_of_column(const struct column_buf* c, guint64 nb_rows, struct lc_block* b) {
+  guint64 i, k;
+  for (k = 0; k * LC_BLOCK_ROWS < nb_rows; k++) {
+    guint64 last = MIN((k + 1) * LC_BLOCK_ROWS, nb_rows);
+    b[k].min = G_MAXDOUBLE;
+    b[k].max = -G_MAXDOUBLE;
+    for (i = k * LC_BLOCK_ROWS; i < last; i++) {
+      double v;
+      const void* p = c->values->data + i * lc_type_size[c->type];
+      switch (c->type) {
+      case LC_UINT8:  v = *(const guint8*)p; break;
+      case LC_INT8:   v = *(const gint8*)p; break;
+      case LC_UINT16: v = *(const guint16*)p; break;
+      case LC_INT16:  v = *(const gint16*)p; break;
+      case LC_UINT32: v = *(const guint32*)p; break;
+      case LC_INT32:  v = *(const gint32*)p; break;
+      case LC_FLOAT:  v = *(const float*)p; break;
+      default:        v = *(const double*)p; break;
+      }
+      if (v < b[k].min) b[k].min = v;
+      if (v > b[k].max) b[k].max = v;
+    }
+  }
+}
+
+static void pad_to(FILE* out, guint64 offset) {
+  while ((guint64)ftell(out) < offset)
+    fputc(0, out);
+}
+
+static int write_columns(const char* file) {
+  GPtrArray* cols = g_ptr_array_new();
+  GArray* col_series = g_array_new(FALSE, FALSE, sizeof(guint32));
+  struct lc_series* st = g_new0(struct lc_series, series_list->len);
+  guint i, j, k;
+
+  /* flatten the columns, time first then fields in message order */
+  for (i = 0; i < series_list->len; i++) {
+    struct series_buf* s = (struct series_buf*)g_ptr_array_index(series_list, i);
+    g_strlcpy(st[i].ac, s->ac, LC_NAME_LEN);
+    g_strlcpy(st[i].msg, s->msg->name, LC_NAME_LEN);
+    st[i].nb_rows = s->nb_rows;
+    st[i].first_column = cols->len;
+    g_ptr_array_add(cols, s->time);
+    g_array_append_val(col_series, i);
+    for (j = 0; j < s->msg->fields->len; j++)
+      for (k = 0; k < s->elems[j]->len; k++) {
+        g_ptr_array_add(cols, g_ptr_array_index(s->elems[j], k));
+        g_array_append_val(col_series, i);
+      }
+    st[i].nb_columns = cols->len - st[i].first_column;
+  }
+
+  struct lc_header h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, LC_MAGIC, 8);
+  h.version = LC_VERSION;
+  h.block_rows = LC_BLOCK_ROWS;
+  h.nb_series = series_list->len;
+  h.nb_columns = cols->len;
+  h.series_offset = sizeof(h);
+  h.columns_offset = h.series_offset + h.nb_series * sizeof(struct lc_series);
+
+  /* layout: blocks of all columns after the tables, then the data */
+  struct lc_column* ct = g_new0(struct lc_column, cols->len);
+  guint64 offset = h.columns_offset + h.nb_columns * sizeof(struct lc_column);
+  for (i = 0; i < cols->len; i++) {
+    struct column_buf* c = (struct column_buf*)g_ptr_array_index(cols, i);
+    guint32 s = g_array_index(col_series, guint32, i);
+    g_strlcpy(ct[i].name, c->name, LC_NAME_LEN);
+    ct[i].type = c->type;
+    ct[i].series = s;
+    ct[i].nb_blocks = (st[s].nb_rows + LC_BLOCK_ROWS - 1) / LC_BLOCK_ROWS;
+    ct[i].blocks_offset = offset;
+    offset += ct[i].nb_blocks * sizeof(struct lc_block);
+  }
+  for (i = 0; i < cols->len; i++) {
+    offset = (offset + LC_PAGE_SIZE - 1) / LC_PAGE_SIZE * LC_PAGE_SIZE;
+    ct[i].data_offset = offset;
+    offset += st[ct[i].series].nb_rows * lc_type_size[ct[i].type];
+  }
+
+  FILE* out = fopen(file, "wb");
+  if (!out) {
+    perror(file);
+    return -1;
+  }
+  fwrite(&h, sizeof(h), 1, out);
+  fwrite(st, sizeof(struct lc_series), h.nb_series, out);
+  fwrite(ct, sizeof(struct lc_column), h.nb_columns, out);
+  for (i = 0; i < cols->len; i++) {
+    struct column_buf* c = (struct column_buf*)g_ptr_array_index(cols, i);
+    struct lc_block* b = g_new(struct lc_block, ct[i].nb_blocks + 1);
+    blocks_of_column(c, st[ct[i].series].nb_rows, b);
+    fwrite(b, sizeof(struct lc_block), ct[i].nb_blocks, out);
+    g_free(b);
+  }
+  for (i = 0; i < cols->len; i++) {
+    struct column_buf* c = (struct column_buf*)g_ptr_array_index(cols, i);
+    pad_to(out, ct[i].data_offset);
+    fwrite(c->values->data, lc_type_size[c->type], st[ct[i].series].nb_rows, out);
+  }
+  int err = ferror(out);
+  fclose(out);
+
+  printf("%s: %u series, %u columns, %lu bytes\n", file, h.nb_series, h.nb_columns, (unsigned long)offset);
+  g_free(ct);
+  g_free(st);
+  g_array_free(col_series, TRUE);
+  g_ptr_array_free(cols, TRUE);
+  return err ? -1 : 0;
+}
+
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    puts("usage is data2columns <file.log> [<file.col>]");
+    return EXIT_FAILURE;
+  }
+
+  msgs_telemetry = g_hash_table_new(g_str_hash, g_str_equal);
+  msgs_telemetry_ap = g_hash_table_new(g_str_hash, g_str_equal);
+  series = g_hash_table_new(g_str_hash, g_str_equal);
+  series_list = g_ptr_array_new();
+
+  if (load_log(argv[1]) < 0)
+    return EXIT_FAILURE;
+
+  /* In the old days, telemetry class was named telemetry_ap ... */
+  GHashTable* msgs = g_hash_table_size(msgs_telemetry_ap) > 0 ? msgs_telemetry_ap : msgs_telemetry;
+
+  gchar* dir = g_path_get_dirname(argv[1]);
+  gchar* base = g_strndup(argv[1], strlen(argv[1]) - (g_str_has_suffix(argv[1], ".log") ? 4 : 0));
+  gchar* data = NULL;
+  if (data_file) {
+    data = g_build_filename(dir, data_file, NULL);
+    if (!g_file_test(data, G_FILE_TEST_EXISTS)) {
+      gchar* gz = g_strconcat(data, ".gz", NULL);
+      g_free(data);
+      data = gz;
+    }
+  }
+  if (!data || !g_file_test(data, G_FILE_TEST_EXISTS)) {
+    g_free(data);
+    data = g_strconcat(base, ".data", NULL);
+  }
+  if (load_data(data, msgs) < 0)
+    return EXIT_FAILURE;
+
+  gchar* col = argc == 3 ? g_strdup(argv[2]) : g_strconcat(base, ".col", NULL);
+  if (write_columns(col) < 0)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "log_columns.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const size_t lc_type_size[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+int log_columns_open(struct log_columns* lc, const char* path) {
+  struct stat st;
+
+  memset(lc, 0, sizeof(*lc));
+  lc->fd = open(path, O_RDONLY);
+  if (lc->fd < 0)
+    return -1;
+  if (fstat(lc->fd, &st) < 0 || (size_t)st.st_size < sizeof(struct lc_header))
+    goto error;
+  lc->size = st.st_size;
+  void* m = mmap(NULL, lc->size, PROT_READ, MAP_SHARED, lc->fd, 0);
+  if (m == MAP_FAILED)
+    goto error;
+  lc->data = (const uint8_t*)m;
+  lc->header = (const struct lc_header*)lc->data;
+  if (memcmp(lc->header->magic, LC_MAGIC, 8) != 0 || lc->header->version != LC_VERSION ||
+      lc->header->columns_offset + lc->header->nb_columns * sizeof(struct lc_column) > lc->size) {
+    munmap(m, lc->size);
+    goto error;
+  }
+  lc->series = (const struct lc_series*)(lc->data + lc->header->series_offset);
+  lc->columns = (const struct lc_column*)(lc->data + lc->header->columns_offset);
+  /* the tables are read first, then only the pages of the requested columns */
+  madvise(m, lc->size, MADV_RANDOM);
+  return 0;
+
+ error:
+  close(lc->fd);
+  lc->fd = -1;
+  return -1;
+}
+
+void log_columns_close(struct log_columns* lc) {
+  if (lc->data)
+    munmap((void*)lc->data, lc->size);
+  if (lc->fd >= 0)
+    close(lc->fd);
+  memset(lc, 0, sizeof(*lc));
+  lc->fd = -1;
+}
+
+int log_columns_find_series(const struct log_columns* lc, const char* ac, const char* msg) {
+  uint32_t i;
+  for (i = 0; i < lc->header->nb_series; i++)
+    if (strcmp(lc->series[i].ac, ac) == 0 && strcmp(lc->series[i].msg, msg) == 0)
+      return i;
+  return -1;
+}
+
+int log_columns_find_column(const struct log_columns* lc, int series, const char* field) {
+  const struct lc_series* s = &lc->series[series];
+  uint32_t i;
+  for (i = 0; i < s->nb_columns; i++)
+    if (strcmp(lc->columns[s->first_column + i].name, field) == 0)
+      return s->first_column + i;
+  return -1;
+}
+
+uint64_t log_columns_row_of_time(const struct log_columns* lc, int series, double t) {
+  const struct lc_series* s = &lc->series[series];
+  const struct lc_column* c = &lc->columns[s->first_column];
+  const struct lc_block* blocks = log_columns_blocks(lc, s->first_column);
+  const double* time = log_columns_time(lc, series);
+  uint64_t lo = 0, hi = c->nb_blocks;
+
+  /* first block ending after t, from the index only */
+  while (lo < hi) {
+    uint64_t mid = (lo + hi) / 2;
+    if (blocks[mid].max < t)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == c->nb_blocks)
+    return s->nb_rows;
+
+  /* then inside the block */
+  uint64_t first = lo * lc->header->block_rows;
+  uint64_t last = first + lc->header->block_rows;
+  if (last > s->nb_rows)
+    last = s->nb_rows;
+  while (first < last) {
+    uint64_t mid = (first + last) / 2;
+    if (time[mid] < t)
+      first = mid + 1;
+    else
+      last = mid;
+  }
+  return first;
+}
+
+double log_columns_value(const struct log_columns* lc, int column, uint64_t row) {
+  const void* d = log_columns_data(lc, column);
+  switch (lc->columns[column].type) {
+  case LC_UINT8:  return ((const uint8_t*)d)[row];
+  case LC_INT8:   return ((const int8_t*)d)[row];
+  case LC_UINT16: return ((const uint16_t*)d)[row];
+  case LC_INT16:  return ((const int16_t*)d)[row];
+  case LC_UINT32: return ((const uint32_t*)d)[row];
+  case LC_INT32:  return ((const int32_t*)d)[row];
+  case LC_FLOAT:  return ((const float*)d)[row];
+  case LC_DOUBLE: return ((const double*)d)[row];
+  }
+  return 0.;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/** \file log_columns.h
+ *  \brief Columnar flight log container
+ *
+ *  A .col file holds the content of a .log/.data pair (see data2columns).
+ *  Each (aircraft, message) pair is a series. A series has a time column
+ *  (double, seconds) and one column per message field, stored with the
+ *  type given in messages.xml. Array fields are split in one column per
+ *  element, named "field[i]" as in the plotter. String fields are not
+ *  stored.
+ *
+ *  Every column is page aligned and contiguous. Its rows are grouped in
+ *  blocks of LC_BLOCK_ROWS with the min and max of each block; for the
+ *  time column this is the time index. Reading one field over a time
+ *  range only touches the time index, a few time pages and that field.
+ *
+ *  Layout (host byte order):
+ *   | lc_header | lc_series[nb_series] | lc_column[nb_columns] |
+ *   | lc_block[] of each column | column data, page aligned |
+ */
+
+#ifndef LOG_COLUMNS_H
+#define LOG_COLUMNS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LC_MAGIC "PPRZCOL1"
+#define LC_VERSION 1
+#define LC_BLOCK_ROWS 4096
+#define LC_PAGE_SIZE 4096
+
+#define LC_NAME_LEN 64
+
+enum lc_type {
+  LC_UINT8, LC_INT8, LC_UINT16, LC_INT16, LC_UINT32, LC_INT32, LC_FLOAT, LC_DOUBLE
+};
+
+struct lc_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t block_rows;
+  uint32_t nb_series;
+  uint32_t nb_columns;
+  uint64_t series_offset;
+  uint64_t columns_offset;
+};
+
+struct lc_series {
+  char ac[LC_NAME_LEN];
+  char msg[LC_NAME_LEN];
+  uint64_t nb_rows;
+  uint32_t first_column;   ///< time column, fields follow
+  uint32_t nb_columns;     ///< time column included
+};
+
+struct lc_column {
+  char name[LC_NAME_LEN];
+  uint32_t type;           ///< enum lc_type
+  uint32_t series;
+  uint64_t data_offset;
+  uint64_t blocks_offset;  ///< lc_block[nb_blocks]
+  uint64_t nb_blocks;
+};
+
+struct lc_block {
+  double min;
+  double max;
+};
+
+struct log_columns {
+  int fd;
+  const uint8_t* data;
+  size_t size;
+  const struct lc_header* header;
+  const struct lc_series* series;
+  const struct lc_column* columns;
+};
+
+extern const size_t lc_type_size[];
+
+/** map a .col file, returns 0 on success */
+extern int log_columns_open(struct log_columns* lc, const char* path);
+extern void log_columns_close(struct log_columns* lc);
+
+/** returns the series (resp. column) index or -1 */
+extern int log_columns_find_series(const struct log_columns* lc, const char* ac, const char* msg);
+extern int log_columns_find_column(const struct log_columns* lc, int series, const char* field);
+
+static inline const void* log_columns_data(const struct log_columns* lc, int column) {
+  return lc->data + lc->columns[column].data_offset;
+}
+
+static inline const struct lc_block* log_columns_blocks(const struct log_columns* lc, int column) {
+  return (const struct lc_block*)(lc->data + lc->columns[column].blocks_offset);
+}
+
+static inline const double* log_columns_time(const struct log_columns* lc, int series) {
+  return (const double*)log_columns_data(lc, lc->series[series].first_column);
+}
+
+/** first row of the series with a time >= t */
+extern uint64_t log_columns_row_of_time(const struct log_columns* lc, int series, double t);
+
+/** value of a row as a double */
+extern double log_columns_value(const struct log_columns* lc, int column, uint64_t row);
+
+#endif /* LOG_COLUMNS_H */
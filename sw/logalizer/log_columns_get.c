@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/** Prints one field of a .col file (see data2columns) as "time value"
+ *  lines, or lists the series and columns if no field is given.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "log_columns.h"
+
+int main(int argc, char *argv[]) {
+  struct log_columns lc;
+  uint32_t i, j;
+
+  if (argc != 2 && argc != 5 && argc != 7) {
+    puts("usage is log_columns_get <file.col> [<ac> <msg> <field> [<t_start> <t_end>]]");
+    return EXIT_FAILURE;
+  }
+  if (log_columns_open(&lc, argv[1]) < 0) {
+    fprintf(stderr, "%s: not a column file\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  if (argc == 2) {
+    for (i = 0; i < lc.header->nb_series; i++) {
+      const struct lc_series* s = &lc.series[i];
+      printf("%s %s (%lu rows):", s->ac, s->msg, (unsigned long)s->nb_rows);
+      for (j = 1; j < s->nb_columns; j++)
+        printf(" %s", lc.columns[s->first_column + j].name);
+      printf("\n");
+    }
+    log_columns_close(&lc);
+    return EXIT_SUCCESS;
+  }
+
+  int s = log_columns_find_series(&lc, argv[2], argv[3]);
+  int c = s < 0 ? -1 : log_columns_find_column(&lc, s, argv[4]);
+  if (c < 0) {
+    fprintf(stderr, "%s %s %s not found\n", argv[2], argv[3], argv[4]);
+    return EXIT_FAILURE;
+  }
+
+  uint64_t first = 0, last = lc.series[s].nb_rows, row;
+  if (argc == 7) {
+    first = log_columns_row_of_time(&lc, s, atof(argv[5]));
+    last = log_columns_row_of_time(&lc, s, atof(argv[6]));
+  }
+  const double* time = log_columns_time(&lc, s);
+  for (row = first; row < last; row++)
+    printf("%.3f %g\n", time[row], log_columns_value(&lc, c, row));
+
+  log_columns_close(&lc);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "pprz_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define PPRZ_STX      0x99
+#define PPRZ_TS_STX   0x98
+#define XBEE_START    0x7e
+#define XBEE_TX16_ID  0x01
+#define XBEE_RX16_ID  0x81
+#define XBEE_RFDATA_OFFSET 5
+#define XBEE_MAX_LEN  1024
+
+/** minimum size of a chunk decoded by one worker */
+#define PPRZ_LOG_CHUNK_MIN (1 << 20)
+
+static const uint8_t start_byte[] = { PPRZ_STX, PPRZ_TS_STX, PPRZ_STX, XBEE_START };
+
+/** find the next start byte in [p, end) */
+static inline const uint8_t* find_start(const uint8_t* p, const uint8_t* end, uint8_t stx) {
+#ifdef __SSE2__
+  const __m128i s = _mm_set1_epi8((char)stx);
+  while (p + 16 <= end) {
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), s));
+    if (mask)
+      return p + __builtin_ctz(mask);
+    p += 16;
+  }
+#endif
+  const uint8_t* r = (const uint8_t*)memchr(p, stx, end - p);
+  return r ? r : end;
+}
+
+static inline uint32_t read_uint32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/** check the frame starting at offset.
+ *  returns the frame length (0 if invalid), emit is set if the frame
+ *  carries a pprz payload */
+static size_t decode_at(const struct pprz_log* log, size_t offset, struct pprz_log_frame* f, int* emit) {
+  const uint8_t* p = log->data + offset;
+  size_t avail = log->size - offset;
+  size_t len, i;
+  uint8_t ck_a = 0, ck_b = 0;
+
+  *emit = 0;
+  if (avail < 4)
+    return 0;
+  f->offset = offset;
+  f->timestamp = 0;
+  f->source = 0;
+
+  switch (log->format) {
+  case PPRZ_LOG_PPRZ:
+  case PPRZ_LOG_PPRZ_TS: {
+    size_t overhead = (log->format == PPRZ_LOG_PPRZ ? 4 : 8);
+    len = p[1];
+    if (len < overhead + 2 || len > avail)
+      return 0;
+    for (i = 1; i < len - 2; i++) {
+      ck_a += p[i];
+      ck_b += ck_a;
+    }
+    if (ck_a != p[len - 2] || ck_b != p[len - 1])
+      return 0;
+    if (log->format == PPRZ_LOG_PPRZ_TS)
+      f->timestamp = read_uint32(p + 2);
+    f->payload_ofs = overhead - 2;
+    f->len = len - overhead;
+    break;
+  }
+  case PPRZ_LOG_TLM:
+    len = p[1] + 8;
+    if (p[1] < 2 || len > avail)
+      return 0;
+    for (i = 1; i < len - 1; i++)
+      ck_a += p[i];
+    if (ck_a != p[len - 1])
+      return 0;
+    f->source = p[2];
+    f->timestamp = read_uint32(p + 3);
+    f->payload_ofs = 7;
+    f->len = p[1];
+    break;
+  case PPRZ_LOG_XBEE: {
+    size_t n = (p[1] << 8) | p[2];
+    len = n + 4;
+    if (n == 0 || n > XBEE_MAX_LEN || len > avail)
+      return 0;
+    for (i = 3; i < len - 1; i++)
+      ck_a += p[i];
+    if ((uint8_t)(ck_a + p[len - 1]) != 0xff)
+      return 0;
+    f->frame_len = len;
+    /* valid frame, but only RX16 and TX16 carry telemetry */
+    if ((p[3] != XBEE_RX16_ID && p[3] != XBEE_TX16_ID) ||
+        n < XBEE_RFDATA_OFFSET + 2 || n - XBEE_RFDATA_OFFSET > 255)
+      return len;
+    f->payload_ofs = 3 + XBEE_RFDATA_OFFSET;
+    f->len = n - XBEE_RFDATA_OFFSET;
+    break;
+  }
+  default:
+    return 0;
+  }
+  f->frame_len = len;
+  *emit = 1;
+  return len;
+}
+
+int pprz_log_frame_at(const struct pprz_log* log, size_t offset, struct pprz_log_frame* f) {
+  int emit;
+  if (offset >= log->size || log->data[offset] != start_byte[log->format])
+    return 0;
+  return decode_at(log, offset, f, &emit) && emit;
+}
+
+
+/*
+ * Chunk decoding
+ */
+
+struct chunk_entry {
+  struct pprz_log_frame f;
+  size_t err_before;  ///< errors found in the chunk before this frame
+  int emit;
+};
+
+struct chunk {
+  size_t start, stop;       ///< frames starting in [start, stop)
+  size_t end;               ///< where the scan stopped, may be after stop
+  struct chunk_entry* e;
+  size_t n, cap;
+  size_t nb_err;
+  int failed;               ///< out of memory, the chunk is not complete
+};
+
+static int chunk_push(struct chunk* c, const struct pprz_log_frame* f, int emit) {
+  if (c->n == c->cap) {
+    size_t cap = c->cap ? 2 * c->cap : 1024;
+    struct chunk_entry* e = (struct chunk_entry*)realloc(c->e, cap * sizeof(struct chunk_entry));
+    if (!e)
+      return -1;
+    c->e = e;
+    c->cap = cap;
+  }
+  c->e[c->n].f = *f;
+  c->e[c->n].err_before = c->nb_err;
+  c->e[c->n].emit = emit;
+  c->n++;
+  return 0;
+}
+
+static void decode_chunk(const struct pprz_log* log, struct chunk* c) {
+  const uint8_t stx = start_byte[log->format];
+  struct pprz_log_frame f;
+  size_t p = c->start;
+  int emit;
+
+  while (p < c->stop) {
+    p = find_start(log->data + p, log->data + c->stop, stx) - log->data;
+    if (p >= c->stop)
+      break;
+    size_t len = decode_at(log, p, &f, &emit);
+    if (len) {
+      if (chunk_push(c, &f, emit) < 0) {
+        c->failed = 1;
+        return;
+      }
+      p += len;
+    }
+    else {
+      c->nb_err++;
+      p++;
+    }
+  }
+  c->end = p;
+}
+
+struct decode_job {
+  const struct pprz_log* log;
+  struct chunk* chunks;
+  size_t nb_chunks;
+  volatile size_t next;
+};
+
+static void* decode_worker(void* arg) {
+  struct decode_job* job = (struct decode_job*)arg;
+  size_t i;
+  while ((i = __sync_fetch_and_add(&job->next, 1)) < job->nb_chunks)
+    decode_chunk(job->log, &job->chunks[i]);
+  return NULL;
+}
+
+static int append_frame(struct pprz_log* log, size_t* cap, const struct pprz_log_frame* f) {
+  if (log->nb_frames == *cap) {
+    size_t new_cap = *cap ? 2 * *cap : 4096;
+    struct pprz_log_frame* frames = (struct pprz_log_frame*)realloc(log->frames, new_cap * sizeof(struct pprz_log_frame));
+    if (!frames)
+      return -1;
+    log->frames = frames;
+    *cap = new_cap;
+  }
+  log->frames[log->nb_frames++] = *f;
+  return 0;
+}
+
+/** A chunk is decoded from its first byte, which may be in the middle
+ *  of a frame of the previous chunk. Scan sequentially from where the
+ *  previous chunk ended until reaching a frame also found by the chunk,
+ *  from there both decodings are identical.
+ *  pos is where the previous chunk ended, updated to where this one ends.
+ *  \return 0, -1 if out of memory */
+static int stitch_chunk(struct pprz_log* log, size_t* cap, const struct chunk* c, size_t* pos_p) {
+  size_t pos = *pos_p;
+  const uint8_t stx = start_byte[log->format];
+  struct pprz_log_frame f;
+  size_t k = 0;
+  int emit;
+
+  while (pos < c->stop) {
+    while (k < c->n && c->e[k].f.offset < pos)
+      k++;
+    if (k < c->n && c->e[k].f.offset == pos) {
+      log->nb_err += c->nb_err - c->e[k].err_before;
+      for (; k < c->n; k++)
+        if (c->e[k].emit && append_frame(log, cap, &c->e[k].f) < 0)
+          return -1;
+      *pos_p = c->end;
+      return 0;
+    }
+    size_t next = find_start(log->data + pos, log->data + c->stop, stx) - log->data;
+    if (next != pos) {
+      pos = next;
+      continue;
+    }
+    size_t len = decode_at(log, pos, &f, &emit);
+    if (len) {
+      if (emit && append_frame(log, cap, &f) < 0)
+        return -1;
+      pos += len;
+    }
+    else {
+      log->nb_err++;
+      pos++;
+    }
+  }
+  *pos_p = pos;
+  return 0;
+}
+
+int pprz_log_decode(struct pprz_log* log, int nb_threads) {
+  size_t cap = 0;
+  size_t chunk_size, nb_chunks, i;
+
+  free(log->frames);
+  log->frames = NULL;
+  log->nb_frames = 0;
+  log->nb_err = 0;
+  if (nb_threads < 1)
+    nb_threads = 1;
+
+  chunk_size = log->size / (4 * nb_threads) + 1;
+  if (chunk_size < PPRZ_LOG_CHUNK_MIN)
+    chunk_size = PPRZ_LOG_CHUNK_MIN;
+  nb_chunks = (log->size + chunk_size - 1) / chunk_size;
+
+  struct chunk* chunks = (struct chunk*)calloc(nb_chunks, sizeof(struct chunk));
+  if (!chunks)
+    return -1;
+  for (i = 0; i < nb_chunks; i++) {
+    chunks[i].start = i * chunk_size;
+    chunks[i].stop = (i + 1 == nb_chunks) ? log->size : (i + 1) * chunk_size;
+  }
+
+  struct decode_job job = { log, chunks, nb_chunks, 0 };
+  if (nb_threads == 1 || nb_chunks == 1)
+    decode_worker(&job);
+  else {
+    pthread_t th[nb_threads];
+    int started = 0;
+    for (i = 0; i < (size_t)nb_threads; i++)
+      if (pthread_create(&th[started], NULL, decode_worker, &job) == 0)
+        started++;
+    decode_worker(&job);
+    for (i = 0; i < (size_t)started; i++)
+      pthread_join(th[i], NULL);
+  }
+
+  size_t pos = 0;
+  int ret = 0;
+  for (i = 0; i < nb_chunks; i++) {
+    if (ret == 0 && (chunks[i].failed || stitch_chunk(log, &cap, &chunks[i], &pos) < 0))
+      ret = -1;
+    free(chunks[i].e);
+  }
+  free(chunks);
+  if (ret < 0) {
+    free(log->frames);
+    log->frames = NULL;
+    log->nb_frames = 0;
+  }
+  return ret;
+}
+
+
+/*
+ * Files
+ */
+
+int pprz_log_open(struct pprz_log* log, const char* path, enum pprz_log_format format) {
+  struct stat st;
+
+  memset(log, 0, sizeof(*log));
+  log->format = format;
+  log->fd = open(path, O_RDONLY);
+  if (log->fd < 0)
+    return -1;
+  if (fstat(log->fd, &st) < 0) {
+    close(log->fd);
+    return -1;
+  }
+  log->size = st.st_size;
+  if (log->size == 0) {
+    log->data = NULL;
+    return 0;
+  }
+  void* m = mmap(NULL, log->size, PROT_READ, MAP_PRIVATE, log->fd, 0);
+  if (m == MAP_FAILED) {
+    close(log->fd);
+    return -1;
+  }
+  madvise(m, log->size, MADV_SEQUENTIAL);
+  log->data = (const uint8_t*)m;
+  return 0;
+}
+
+void pprz_log_close(struct pprz_log* log) {
+  if (log->data)
+    munmap((void*)log->data, log->size);
+  if (log->fd >= 0)
+    close(log->fd);
+  free(log->frames);
+  memset(log, 0, sizeof(*log));
+  log->fd = -1;
+}
+
+int pprz_log_write_index(const struct pprz_log* log, FILE* out) {
+  uint64_t count[256], start[256];
+  uint32_t format = log->format;
+  uint64_t nb = log->nb_frames;
+  size_t i;
+  int id;
+
+  memset(count, 0, sizeof(count));
+  for (i = 0; i < log->nb_frames; i++)
+    count[PprzLogFrameMsgId(log, &log->frames[i])]++;
+
+  /* order the frames by message id, keeping the log order */
+  uint32_t* perm = (uint32_t*)malloc(nb * sizeof(uint32_t) + 1);
+  if (!perm)
+    return -1;
+  start[0] = 0;
+  for (id = 1; id < 256; id++)
+    start[id] = start[id - 1] + count[id - 1];
+  for (i = 0; i < log->nb_frames; i++)
+    perm[start[PprzLogFrameMsgId(log, &log->frames[i])]++] = i;
+
+  fwrite(PPRZ_LOG_INDEX_MAGIC, 1, 8, out);
+  fwrite(&format, sizeof(format), 1, out);
+  fwrite(&nb, sizeof(nb), 1, out);
+  fwrite(count, sizeof(count), 1, out);
+
+  size_t first = 0;
+  for (id = 0; id < 256; id++) {
+    size_t last = first + count[id];
+    for (i = first; i < last; i++)
+      fwrite(&log->frames[perm[i]].offset, sizeof(uint64_t), 1, out);
+    for (i = first; i < last; i++)
+      fwrite(&log->frames[perm[i]].timestamp, sizeof(uint32_t), 1, out);
+    for (i = first; i < last; i++)
+      fputc(PprzLogFrameAcId(log, &log->frames[perm[i]]), out);
+    first = last;
+  }
+  free(perm);
+  return ferror(out) ? -1 : 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/** \file pprz_log.h
+ *  \brief Decoding of raw binary logs
+ *
+ *  Frames handled (see sw/lib/ocaml/pprz.ml, logpprz.ml and xbee.ml):
+ *   - PPRZ_LOG_PPRZ    |0x99|len|payload|ck_a|ck_b|, len is the frame length
+ *   - PPRZ_LOG_PPRZ_TS |0x98|len|timestamp(4)|payload|ck_a|ck_b|
+ *   - PPRZ_LOG_TLM     |0x99|len|source|timestamp(4)|payload|ck|, len is the
+ *                      payload length (sd card logger, openlog2tlm)
+ *   - PPRZ_LOG_XBEE    |0x7E|len_msb|len_lsb|api frame|ck|, only RX16/TX16
+ *                      frames carry a payload
+ *  The payload always starts with ac_id and msg_id.
+ *
+ *  A log is mapped in memory. Start bytes are searched 16 bytes at a
+ *  time and checksums are only computed on candidates. Large logs are
+ *  split in chunks decoded in parallel; the chunk results are stitched
+ *  so that the frame list is the same as a sequential decoding.
+ */
+
+#ifndef PPRZ_LOG_H
+#define PPRZ_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+enum pprz_log_format {
+  PPRZ_LOG_PPRZ,
+  PPRZ_LOG_PPRZ_TS,
+  PPRZ_LOG_TLM,
+  PPRZ_LOG_XBEE
+};
+
+struct pprz_log_frame {
+  uint64_t offset;     ///< offset of the start byte in the log
+  uint32_t timestamp;  ///< 1e-4 s, 0 if the format has no timestamp
+  uint8_t source;      ///< TLM source, 0 otherwise
+  uint8_t len;         ///< payload length
+  uint8_t payload_ofs; ///< payload offset from the start byte
+  uint16_t frame_len;  ///< total length, start byte and checksum included
+};
+
+#define PprzLogFrameAcId(_log, _f) ((_log)->data[(_f)->offset + (_f)->payload_ofs])
+#define PprzLogFrameMsgId(_log, _f) ((_log)->data[(_f)->offset + (_f)->payload_ofs + 1])
+#define PprzLogFramePayload(_log, _f) (&(_log)->data[(_f)->offset + (_f)->payload_ofs])
+
+struct pprz_log {
+  enum pprz_log_format format;
+  const uint8_t* data;
+  size_t size;
+  int fd;
+  /* decoding results */
+  struct pprz_log_frame* frames;
+  size_t nb_frames;
+  size_t nb_err;       ///< start byte candidates with a bad length or checksum
+};
+
+/** map a log file, returns 0 on success */
+extern int pprz_log_open(struct pprz_log* log, const char* path, enum pprz_log_format format);
+extern void pprz_log_close(struct pprz_log* log);
+
+/** decode the whole log with nb_threads workers (sequential if <= 1)
+ *  returns 0 on success, -1 if out of memory (no frames are kept then) */
+extern int pprz_log_decode(struct pprz_log* log, int nb_threads);
+
+/** decode one frame at the given offset.
+ *  returns 1 and fills f if a valid frame starts there, 0 otherwise */
+extern int pprz_log_frame_at(const struct pprz_log* log, size_t offset, struct pprz_log_frame* f);
+
+/** write a per message index: for each msg_id, the offsets, timestamps and
+ *  ac_ids of its frames, stored column by column */
+extern int pprz_log_write_index(const struct pprz_log* log, FILE* out);
+
+#define PPRZ_LOG_INDEX_MAGIC "PPRZIDX1"
+
+#endif /* PPRZ_LOG_H */
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/** Decodes a raw binary log and writes its per message index
+ *  (see pprz_log.h)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "pprz_log.h"
+
+static const char* format_names[] = { "pprz", "pprz_ts", "tlm", "xbee" };
+
+int main(int argc, char *argv[]) {
+  enum pprz_log_format format = PPRZ_LOG_TLM;
+  int nb_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  int c, i;
+
+  while ((c = getopt(argc, argv, "f:j:")) != -1) {
+    switch (c) {
+    case 'f':
+      for (i = 0; i < 4; i++)
+        if (strcmp(optarg, format_names[i]) == 0)
+          format = (enum pprz_log_format)i;
+      break;
+    case 'j':
+      nb_threads = atoi(optarg);
+      break;
+    default:
+      optind = argc;
+    }
+  }
+  if (argc - optind < 1 || argc - optind > 2) {
+    puts("usage is pprz_log_index [-f pprz|pprz_ts|tlm|xbee] [-j threads] <logfile> [<indexfile>]");
+    return EXIT_FAILURE;
+  }
+
+  struct pprz_log log;
+  if (pprz_log_open(&log, argv[optind], format) < 0) {
+    perror(argv[optind]);
+    return EXIT_FAILURE;
+  }
+
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  if (pprz_log_decode(&log, nb_threads) < 0) {
+    perror(argv[optind]);
+    return EXIT_FAILURE;
+  }
+  gettimeofday(&t1, NULL);
+  double dt = (t1.tv_sec - t0.tv_sec) + (t1.tv_usec - t0.tv_usec) * 1e-6;
+
+  printf("%s: %lu bytes, %lu frames, %lu errors, %.3fs (%.0f MB/s, %d threads)\n",
+         argv[optind], (unsigned long)log.size, (unsigned long)log.nb_frames,
+         (unsigned long)log.nb_err, dt, dt > 0 ? log.size / dt / 1e6 : 0., nb_threads);
+
+  if (argc - optind == 2) {
+    FILE* out = fopen(argv[optind + 1], "wb");
+    if (!out || pprz_log_write_index(&log, out) < 0) {
+      perror(argv[optind + 1]);
+      return EXIT_FAILURE;
+    }
+    fclose(out);
+  }
+
+  pprz_log_close(&log);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2011 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/** Summary of the SYS_PROF messages of a .data log (see the sys_prof
+ *  module): number of calls, min/avg/max execution time of each entry,
+ *  sorted by decreasing max time.
+ *  Names of the module entries are read from the generated modules.h of
+ *  the aircraft if given.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ENTRIES 256
+#define MAX_NAME 64
+
+static const char* core_names[] = {
+  "ahrs_propagate", "ahrs_update_accel", "ahrs_update_mag",
+  "ins_propagate", "ins_update_baro", "ins_update_gps"
+};
+#define NB_CORE (sizeof(core_names) / sizeof(core_names[0]))
+
+struct entry {
+  int id;
+  unsigned long nb;
+  double sum;   ///< sum of avg*nb, usec
+  unsigned min;
+  unsigned max;
+};
+
+static struct entry entries[MAX_ENTRIES];
+static char names[MAX_ENTRIES][MAX_NAME];
+
+/* Reads the SYS_PROF_MODULES_NAMES line of a generated modules.h */
+static void read_names(const char* file) {
+  char line[8192];
+  FILE* f = fopen(file, "r");
+  if (f == NULL) {
+    perror(file);
+    exit(EXIT_FAILURE);
+  }
+  while (fgets(line, sizeof(line), f)) {
+    char *p = strstr(line, "SYS_PROF_MODULES_NAMES");
+    int i = NB_CORE;
+    if (p == NULL || strncmp(line, "#define", 7) != 0)
+      continue;
+    while (i < MAX_ENTRIES && (p = strchr(p, '"')) != NULL) {
+      char *q = strchr(++p, '"');
+      if (q == NULL) break;
+      snprintf(names[i++], MAX_NAME, "%.*s", (int)(q - p), p);
+      p = q + 1;
+    }
+  }
+  fclose(f);
+}
+
+static int by_max(const void* a, const void* b) {
+  const struct entry* ea = a;
+  const struct entry* eb = b;
+  return (int)eb->max - (int)ea->max;
+}
+
+int main(int argc, char *argv[]) {
+  char line[1024];
+  FILE* f;
+  unsigned i, n = 0;
+  double total = 0.;
+
+  if (argc != 2 && argc != 3) {
+    puts("usage is sys_prof_summary <file.data> [<generated/modules.h>]");
+    return EXIT_FAILURE;
+  }
+  for (i = 0; i < NB_CORE; i++)
+    snprintf(names[i], MAX_NAME, "%s", core_names[i]);
+  if (argc == 3)
+    read_names(argv[2]);
+
+  if ((f = fopen(argv[1], "r")) == NULL) {
+    perror(argv[1]);
+    return EXIT_FAILURE;
+  }
+  for (i = 0; i < MAX_ENTRIES; i++) {
+    entries[i].id = i;
+    entries[i].min = ~0u;
+  }
+  /* "<time> <ac_id> SYS_PROF <id> <nb> <min> <avg> <max>" */
+  while (fgets(line, sizeof(line), f)) {
+    double t;
+    unsigned ac, id, nb, min, avg, max;
+    if (sscanf(line, "%lf %u SYS_PROF %u %u %u %u %u", &t, &ac, &id, &nb, &min, &avg, &max) != 7
+        || id >= MAX_ENTRIES || nb == 0)
+      continue;
+    entries[id].nb += nb;
+    entries[id].sum += (double)avg * nb;
+    if (min < entries[id].min) entries[id].min = min;
+    if (max > entries[id].max) entries[id].max = max;
+  }
+  fclose(f);
+
+  /* keep the used entries only */
+  for (i = 0; i < MAX_ENTRIES; i++)
+    if (entries[i].nb > 0)
+      entries[n++] = entries[i];
+  qsort(entries, n, sizeof(struct entry), by_max);
+
+  printf("%-32s %10s %8s %8s %8s %12s\n", "entry", "calls", "min_us", "avg_us", "max_us", "total_ms");
+  for (i = 0; i < n; i++) {
+    struct entry* e = &entries[i];
+    char id[16];
+    snprintf(id, sizeof(id), "#%d", e->id);
+    printf("%-32s %10lu %8u %8.1f %8u %12.1f\n", names[e->id][0] ? names[e->id] : id,
+           e->nb, e->min, e->sum / e->nb, e->max, e->sum / 1000.);
+    total += e->sum;
+  }
+  printf("total %.1f ms\n", total / 1000.);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,257 @@
+/*
+ * Monte-Carlo flight campaign driver for NPS
+ *
+ * Runs N independent simulator processes in batch mode, at most one per
+ * core at a time. Each run gets its own noise seed, wind and initial
+ * heading offset, and its own Ivy bus (one port per run) so that the
+ * datalink of a run does not reach the others. Per-run metrics are read back from each process through a
+ * pipe and gathered, with aggregates, into one summary file.
+ *
+ * Usage: nps_campaign [options] -- <simsitl> [simsitl options]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <getopt.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define METRICS_LINE_LEN 4096
+
+struct NpsRun {
+  unsigned long seed;
+  double wind_n, wind_e;
+  double dpsi0;
+  pid_t pid;
+  int fd;
+  int status;
+  char metrics[METRICS_LINE_LEN];
+};
+
+static struct {
+  int nb_runs;
+  int nb_jobs;
+  unsigned long seed;
+  double sim_end;
+  int stop_block;
+  double wind_max;
+  double psi0_dev;
+  int ivy_port;
+  const char* out_file;
+  char** sim_argv;
+  int sim_argc;
+} campaign;
+
+static struct NpsRun* runs;
+
+static void usage(const char* name) {
+  fprintf(stderr,
+"Usage: %s [options] -- <simsitl> [simsitl options]\n"
+" Options :\n"
+"   -n number of runs (default 10)\n"
+"   -j number of parallel runs (default number of cores)\n"
+"   -s base seed (default 0)\n"
+"   -t simulated time of each run (s, default 300)\n"
+"   -b stop each run when entering this flight plan block\n"
+"   -w max horizontal wind speed (m/s, default 0)\n"
+"   -p max initial heading deviation (deg, default 0)\n"
+"   -i ivy port of the first run, incremented for each run (default 2011)\n"
+"   -o summary file (default nps_campaign.txt)\n", name);
+}
+
+static int parse_options(int argc, char** argv) {
+  campaign.nb_runs = 10;
+  campaign.nb_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  campaign.seed = 0;
+  campaign.sim_end = 300.;
+  campaign.stop_block = -1;
+  campaign.wind_max = 0.;
+  campaign.psi0_dev = 0.;
+  campaign.ivy_port = 2011;
+  campaign.out_file = "nps_campaign.txt";
+
+  int c;
+  while ((c = getopt(argc, argv, "n:j:s:t:b:w:p:i:o:")) != -1) {
+    switch (c) {
+    case 'n': campaign.nb_runs = atoi(optarg); break;
+    case 'j': campaign.nb_jobs = atoi(optarg); break;
+    case 's': campaign.seed = strtoul(optarg, NULL, 0); break;
+    case 't': campaign.sim_end = atof(optarg); break;
+    case 'b': campaign.stop_block = atoi(optarg); break;
+    case 'w': campaign.wind_max = atof(optarg); break;
+    case 'p': campaign.psi0_dev = atof(optarg); break;
+    case 'i': campaign.ivy_port = atoi(optarg); break;
+    case 'o': campaign.out_file = optarg; break;
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
+  if (optind >= argc || campaign.nb_runs <= 0) {
+    usage(argv[0]);
+    return -1;
+  }
+  if (campaign.nb_jobs <= 0)
+    campaign.nb_jobs = 1;
+  campaign.sim_argv = argv + optind;
+  campaign.sim_argc = argc - optind;
+  return 0;
+}
+
+/* draw all perturbations up front, so results do not depend on scheduling */
+static void init_runs(void) {
+  runs = calloc(campaign.nb_runs, sizeof(struct NpsRun));
+  srand48(campaign.seed);
+  for (int i = 0; i < campaign.nb_runs; i++) {
+    runs[i].seed = campaign.seed + i + 1;
+    double speed = campaign.wind_max * drand48();
+    double dir = 2. * M_PI * drand48();
+    runs[i].wind_n = speed * cos(dir);
+    runs[i].wind_e = speed * sin(dir);
+    runs[i].dpsi0 = campaign.psi0_dev * (2. * drand48() - 1.);
+    runs[i].pid = -1;
+    runs[i].fd = -1;
+    runs[i].status = -1;
+  }
+}
+
+static int start_run(int idx) {
+  struct NpsRun* run = &runs[idx];
+  int fds[2];
+  if (pipe2(fds, O_CLOEXEC) < 0) {
+    perror("pipe");
+    return -1;
+  }
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    close(fds[0]);
+    close(fds[1]);
+    return -1;
+  }
+
+  if (pid == 0) {
+    /* the write end is handed to the simulator as its metrics file */
+    int wfd = dup(fds[1]);
+    char args[8][32];
+    snprintf(args[0], 32, "%lu", run->seed);
+    snprintf(args[1], 32, "%f", campaign.sim_end);
+    snprintf(args[2], 32, "%d", campaign.stop_block);
+    snprintf(args[3], 32, "%f", run->wind_n);
+    snprintf(args[4], 32, "%f", run->wind_e);
+    snprintf(args[5], 32, "%f", run->dpsi0);
+    snprintf(args[6], 32, "/dev/fd/%d", wfd);
+    snprintf(args[7], 32, "127.255.255.255:%d", campaign.ivy_port + idx);
+
+    char** argv = calloc(campaign.sim_argc + 20, sizeof(char*));
+    int n = 0;
+    for (int i = 0; i < campaign.sim_argc; i++)
+      argv[n++] = campaign.sim_argv[i];
+    argv[n++] = (char*)"--batch";
+    argv[n++] = (char*)"--seed";       argv[n++] = args[0];
+    argv[n++] = (char*)"--sim_end";    argv[n++] = args[1];
+    argv[n++] = (char*)"--stop_block"; argv[n++] = args[2];
+    argv[n++] = (char*)"--wind_n";     argv[n++] = args[3];
+    argv[n++] = (char*)"--wind_e";     argv[n++] = args[4];
+    if (campaign.psi0_dev > 0.) {
+      argv[n++] = (char*)"--dpsi0";    argv[n++] = args[5];
+    }
+    argv[n++] = (char*)"--metrics";    argv[n++] = args[6];
+    argv[n++] = (char*)"--ivy_bus";    argv[n++] = args[7];
+    argv[n] = NULL;
+
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0)
+      dup2(null_fd, STDOUT_FILENO);
+    execvp(argv[0], argv);
+    perror(argv[0]);
+    _exit(127);
+  }
+
+  close(fds[1]);
+  run->pid = pid;
+  run->fd = fds[0];
+  return 0;
+}
+
+static void collect_run(struct NpsRun* run, int status) {
+  ssize_t len = 0, r;
+  while (len < METRICS_LINE_LEN - 1 &&
+         (r = read(run->fd, run->metrics + len, METRICS_LINE_LEN - 1 - len)) > 0)
+    len += r;
+  run->metrics[len] = '\0';
+  char* nl = strchr(run->metrics, '\n');
+  if (nl) *nl = '\0';
+  close(run->fd);
+  run->fd = -1;
+  run->status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static void run_campaign(void) {
+  int next = 0, running = 0, done = 0;
+  while (done < campaign.nb_runs) {
+    while (running < campaign.nb_jobs && next < campaign.nb_runs) {
+      if (start_run(next) == 0)
+        running++;
+      else
+        done++;
+      next++;
+    }
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0)
+      break;
+    for (int i = 0; i < next; i++) {
+      if (runs[i].pid == pid) {
+        collect_run(&runs[i], status);
+        fprintf(stderr, "run %d/%d done (status %d)\n", i + 1, campaign.nb_runs, runs[i].status);
+        running--;
+        done++;
+        break;
+      }
+    }
+  }
+}
+
+static int write_summary(void) {
+  FILE* f = fopen(campaign.out_file, "w");
+  if (!f) {
+    perror(campaign.out_file);
+    return -1;
+  }
+
+  int nb_ok = 0;
+  double rms_sum = 0., rms_max = 0., track_max = 0., att_max = 0.;
+  for (int i = 0; i < campaign.nb_runs; i++) {
+    struct NpsRun* run = &runs[i];
+    fprintf(f, "run=%d seed=%lu wind_n=%.2f wind_e=%.2f dpsi0=%.1f status=%d %s\n",
+            i, run->seed, run->wind_n, run->wind_e, run->dpsi0, run->status, run->metrics);
+    double duration, rms, track, att;
+    if (run->status == 0 &&
+        sscanf(run->metrics, "duration=%lf tracking_rms=%lf tracking_max=%lf max_attitude=%lf",
+               &duration, &rms, &track, &att) == 4) {
+      nb_ok++;
+      rms_sum += rms;
+      if (rms > rms_max) rms_max = rms;
+      if (track > track_max) track_max = track;
+      if (att > att_max) att_max = att;
+    }
+  }
+  fprintf(f, "# runs=%d ok=%d tracking_rms_mean=%.3f tracking_rms_max=%.3f tracking_max=%.3f max_attitude=%.4f\n",
+          campaign.nb_runs, nb_ok, nb_ok > 0 ? rms_sum / nb_ok : 0., rms_max, track_max, att_max);
+  fclose(f);
+  return nb_ok == campaign.nb_runs ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+  if (parse_options(argc, argv) < 0)
+    return EXIT_FAILURE;
+  init_runs();
+  run_campaign();
+  return write_summary() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -68,5 +68,8 @@ extern struct NpsFdm fdm;
 
 extern void nps_fdm_init(double dt);
 extern void nps_fdm_run_step(double* commands);
+/* perturbations, to be called after nps_fdm_init */
+extern void nps_fdm_set_wind(double speed_north, double speed_east, double speed_down);
+extern void nps_fdm_set_initial_heading(double psi);
 
 #endif /* NPS_FDM */
@@ -2,6 +2,7 @@
 #include <FGJSBBase.h>
 #include <models/FGPropulsion.h>
 #include <models/FGGroundReactions.h>
+#include <models/FGAtmosphere.h>
 #include <stdlib.h>
 #include "nps_fdm.h"
 #include "generated/airframe.h"
@@ -12,6 +13,7 @@
 #include "math/pprz_algebra_float.h"
 
 #define MetersOfFeet(_f) ((_f)/3.2808399)
+#define FeetOfMeters(_m) ((_m)*3.2808399)
 
 using namespace JSBSim;
 
@@ -56,6 +58,20 @@ void nps_fdm_run_step(double* commands) {
 
 }
 
+/* wind speed in m/s, NED frame */
+void nps_fdm_set_wind(double speed_north, double speed_east, double speed_down) {
+  FDMExec->GetAtmosphere()->SetWindNED(FeetOfMeters(speed_north),
+                                       FeetOfMeters(speed_east),
+                                       FeetOfMeters(speed_down));
+}
+
+/* re-run the initial conditions with a new heading (rad) */
+void nps_fdm_set_initial_heading(double psi) {
+  FDMExec->GetIC()->SetPsiRadIC(psi);
+  FDMExec->RunIC();
+  fetch_state();
+}
+
 static void feed_jsbsim(double* commands) {
 
   char buf[64];
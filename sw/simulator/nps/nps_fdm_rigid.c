@@ -0,0 +1,378 @@
+/*
+ * Lightweight rigid body flight dynamic model for NPS
+ *
+ * Multirotor 6 DOF model integrated with a fixed step RK4 in a flat
+ * earth LTP (NED) frame centered on the flight plan reference point.
+ * Motors are first order lags on their normalized command, each
+ * producing a thrust along -z body and a reaction torque around z.
+ * Derived from old_booz/booz_flight_model.c, but using plain arrays
+ * and static storage so that nothing is allocated during a step.
+ *
+ * Airframe parameters (SIMULATOR section, NPS_ prefix) and defaults
+ * are those of the booz2 quadrotor.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "nps_fdm.h"
+#include "generated/airframe.h"
+#include "generated/flight_plan.h"
+#include "math/pprz_geodetic_double.h"
+#include "math/pprz_algebra_double.h"
+
+#ifndef NPS_RIGID_MASS
+#define NPS_RIGID_MASS 0.724
+#endif
+#ifndef NPS_RIGID_IXX
+#define NPS_RIGID_IXX 0.007
+#endif
+#ifndef NPS_RIGID_IYY
+#define NPS_RIGID_IYY 0.0073
+#endif
+#ifndef NPS_RIGID_IZZ
+#define NPS_RIGID_IZZ 0.0137
+#endif
+/* body drag coefficient (N/(m/s)^2) */
+#ifndef NPS_RIGID_DRAG
+#define NPS_RIGID_DRAG 0.0075
+#endif
+
+#ifndef NPS_RIGID_NB_MOTORS
+#define NPS_RIGID_NB_MOTORS COMMANDS_NB
+#endif
+/* thrust of one motor at full command (N) */
+#ifndef NPS_RIGID_MOTOR_THRUST_MAX
+#define NPS_RIGID_MOTOR_THRUST_MAX 6.5
+#endif
+/* ratio of reaction torque to thrust (m) */
+#ifndef NPS_RIGID_MOTOR_TORQUE_COEF
+#define NPS_RIGID_MOTOR_TORQUE_COEF 0.015
+#endif
+/* motor time constant (s) */
+#ifndef NPS_RIGID_MOTOR_TAU
+#define NPS_RIGID_MOTOR_TAU 0.05
+#endif
+/* distance between center of vehicle and props (m) */
+#ifndef NPS_RIGID_ARM_LENGTH
+#define NPS_RIGID_ARM_LENGTH 0.25
+#endif
+/* motor layout, in command order: front, back, right, left */
+#ifndef NPS_RIGID_MOTOR_ROLL
+#define NPS_RIGID_MOTOR_ROLL  {  0.,  0., -1.,  1. }
+#endif
+#ifndef NPS_RIGID_MOTOR_PITCH
+#define NPS_RIGID_MOTOR_PITCH {  1., -1.,  0.,  0. }
+#endif
+#ifndef NPS_RIGID_MOTOR_YAW
+#define NPS_RIGID_MOTOR_YAW   { -1., -1.,  1.,  1. }
+#endif
+
+#define NPS_RIGID_G 9.81
+
+/* state vector */
+#define NRS_X      0
+#define NRS_Y      1
+#define NRS_Z      2
+#define NRS_XD     3
+#define NRS_YD     4
+#define NRS_ZD     5
+#define NRS_QI     6
+#define NRS_QX     7
+#define NRS_QY     8
+#define NRS_QZ     9
+#define NRS_P     10
+#define NRS_Q     11
+#define NRS_R     12
+#define NRS_MOT   13
+#define NRS_SIZE  (NRS_MOT + NPS_RIGID_NB_MOTORS)
+
+struct NpsFdm fdm;
+
+static struct {
+  double dt;
+  double state[NRS_SIZE];
+  double state_dot[NRS_SIZE];
+  double commands[NPS_RIGID_NB_MOTORS];
+  struct DoubleVect3 wind;
+  struct LtpDef_d ltpdef;
+  double hmsl0;
+} rigid;
+
+static const double motor_roll[NPS_RIGID_NB_MOTORS]  = NPS_RIGID_MOTOR_ROLL;
+static const double motor_pitch[NPS_RIGID_NB_MOTORS] = NPS_RIGID_MOTOR_PITCH;
+static const double motor_yaw[NPS_RIGID_NB_MOTORS]   = NPS_RIGID_MOTOR_YAW;
+
+static void get_derivatives(const double* X, const double* u, double* Xdot);
+static void rk4_step(double dt);
+static void ground_contact(void);
+static void fetch_state(void);
+
+/* body to ltp rotation of the vector v_in, _q being ltp_to_body */
+static inline void quat_transp_vmult(struct DoubleVect3* v_out, const double* q, const struct DoubleVect3* v_in);
+static inline void quat_vmult(struct DoubleVect3* v_out, const double* q, const struct DoubleVect3* v_in);
+
+
+void nps_fdm_init(double dt) {
+
+  memset(&rigid, 0, sizeof(rigid));
+  rigid.dt = dt;
+  rigid.state[NRS_QI] = 1.;
+
+  /* flight plan reference point */
+  struct LlaCoor_d lla0;
+  lla0.lat = RadOfDeg(NAV_LAT0 / 1e7);
+  lla0.lon = RadOfDeg(NAV_LON0 / 1e7);
+  lla0.alt = (NAV_ALT0 + NAV_MSL0) / 1e3;
+  struct EcefCoor_d ecef0;
+  ecef_of_lla_d(&ecef0, &lla0);
+  ltp_def_from_ecef_d(&rigid.ltpdef, &ecef0);
+  rigid.hmsl0 = NAV_ALT0 / 1e3;
+
+  fdm.time = 0.;
+  fdm.on_ground = TRUE;
+
+  fdm.ltp_g.x = 0.;
+  fdm.ltp_g.y = 0.;
+  fdm.ltp_g.z = NPS_RIGID_G;
+
+  fdm.ltp_h.x = 0.4912;
+  fdm.ltp_h.y = 0.1225;
+  fdm.ltp_h.z = 0.8624;
+
+  get_derivatives(rigid.state, rigid.commands, rigid.state_dot);
+  fetch_state();
+
+}
+
+void nps_fdm_run_step(double* commands) {
+
+  for (int i = 0; i < NPS_RIGID_NB_MOTORS; i++)
+    rigid.commands[i] = Chop(commands[i], 0., 1.);
+
+  rk4_step(rigid.dt);
+
+  /* renormalize attitude quaternion */
+  double qnorm = sqrt(rigid.state[NRS_QI] * rigid.state[NRS_QI] +
+                      rigid.state[NRS_QX] * rigid.state[NRS_QX] +
+                      rigid.state[NRS_QY] * rigid.state[NRS_QY] +
+                      rigid.state[NRS_QZ] * rigid.state[NRS_QZ]);
+  for (int i = NRS_QI; i <= NRS_QZ; i++)
+    rigid.state[i] /= qnorm;
+
+  ground_contact();
+
+  get_derivatives(rigid.state, rigid.commands, rigid.state_dot);
+  fdm.time += rigid.dt;
+  fetch_state();
+
+}
+
+/* wind speed in m/s, NED frame */
+void nps_fdm_set_wind(double speed_north, double speed_east, double speed_down) {
+  rigid.wind.x = speed_north;
+  rigid.wind.y = speed_east;
+  rigid.wind.z = speed_down;
+}
+
+void nps_fdm_set_initial_heading(double psi) {
+  rigid.state[NRS_QI] = cos(psi / 2.);
+  rigid.state[NRS_QX] = 0.;
+  rigid.state[NRS_QY] = 0.;
+  rigid.state[NRS_QZ] = sin(psi / 2.);
+  get_derivatives(rigid.state, rigid.commands, rigid.state_dot);
+  fetch_state();
+}
+
+
+static void rk4_step(double dt) {
+
+  static double k1[NRS_SIZE], k2[NRS_SIZE], k3[NRS_SIZE], k4[NRS_SIZE];
+  static double tmp[NRS_SIZE];
+  double* X = rigid.state;
+  int i;
+
+  get_derivatives(X, rigid.commands, k1);
+  for (i = 0; i < NRS_SIZE; i++) tmp[i] = X[i] + 0.5 * dt * k1[i];
+  get_derivatives(tmp, rigid.commands, k2);
+  for (i = 0; i < NRS_SIZE; i++) tmp[i] = X[i] + 0.5 * dt * k2[i];
+  get_derivatives(tmp, rigid.commands, k3);
+  for (i = 0; i < NRS_SIZE; i++) tmp[i] = X[i] + dt * k3[i];
+  get_derivatives(tmp, rigid.commands, k4);
+
+  for (i = 0; i < NRS_SIZE; i++)
+    X[i] += dt / 6. * (k1[i] + 2. * k2[i] + 2. * k3[i] + k4[i]);
+
+}
+
+
+static void get_derivatives(const double* X, const double* u, double* Xdot) {
+
+  const double* q = &X[NRS_QI];
+  struct DoubleRates rates = { X[NRS_P], X[NRS_Q], X[NRS_R] };
+
+  /* motors */
+  double thrust = 0.;
+  struct DoubleVect3 moment = { 0., 0., 0. };
+  for (int i = 0; i < NPS_RIGID_NB_MOTORS; i++) {
+    double om = X[NRS_MOT + i];
+    Xdot[NRS_MOT + i] = (u[i] - om) / NPS_RIGID_MOTOR_TAU;
+    double t = NPS_RIGID_MOTOR_THRUST_MAX * om;
+    thrust += t;
+    moment.x += NPS_RIGID_ARM_LENGTH * motor_roll[i] * t;
+    moment.y += NPS_RIGID_ARM_LENGTH * motor_pitch[i] * t;
+    moment.z += NPS_RIGID_MOTOR_TORQUE_COEF * motor_yaw[i] * t;
+  }
+
+  /* forces in ltp frame: thrust, gravity and drag */
+  struct DoubleVect3 thrust_body = { 0., 0., -thrust };
+  struct DoubleVect3 force_ltp;
+  quat_transp_vmult(&force_ltp, q, &thrust_body);
+  force_ltp.z += NPS_RIGID_MASS * NPS_RIGID_G;
+  struct DoubleVect3 airspeed = { X[NRS_XD] - rigid.wind.x,
+                                  X[NRS_YD] - rigid.wind.y,
+                                  X[NRS_ZD] - rigid.wind.z };
+  double norm_airspeed = sqrt(airspeed.x * airspeed.x + airspeed.y * airspeed.y + airspeed.z * airspeed.z);
+  force_ltp.x -= NPS_RIGID_DRAG * norm_airspeed * airspeed.x;
+  force_ltp.y -= NPS_RIGID_DRAG * norm_airspeed * airspeed.y;
+  force_ltp.z -= NPS_RIGID_DRAG * norm_airspeed * airspeed.z;
+
+  Xdot[NRS_X] = X[NRS_XD];
+  Xdot[NRS_Y] = X[NRS_YD];
+  Xdot[NRS_Z] = X[NRS_ZD];
+
+  /* resting on the ground: reaction cancels everything but lift off */
+  if (fdm.on_ground && force_ltp.z >= 0.) {
+    Xdot[NRS_XD] = 0.;
+    Xdot[NRS_YD] = 0.;
+    Xdot[NRS_ZD] = 0.;
+    Xdot[NRS_QI] = 0.;
+    Xdot[NRS_QX] = 0.;
+    Xdot[NRS_QY] = 0.;
+    Xdot[NRS_QZ] = 0.;
+    Xdot[NRS_P] = 0.;
+    Xdot[NRS_Q] = 0.;
+    Xdot[NRS_R] = 0.;
+    return;
+  }
+
+  Xdot[NRS_XD] = force_ltp.x / NPS_RIGID_MASS;
+  Xdot[NRS_YD] = force_ltp.y / NPS_RIGID_MASS;
+  Xdot[NRS_ZD] = force_ltp.z / NPS_RIGID_MASS;
+
+  /* attitude kinematic */
+  struct DoubleQuat qd;
+  struct DoubleQuat qs = { q[0], q[1], q[2], q[3] };
+  FLOAT_QUAT_DERIVATIVE(qd, rates, qs);
+  Xdot[NRS_QI] = qd.qi;
+  Xdot[NRS_QX] = qd.qx;
+  Xdot[NRS_QY] = qd.qy;
+  Xdot[NRS_QZ] = qd.qz;
+
+  /* Newton in body frame, diagonal inertia */
+  Xdot[NRS_P] = (moment.x - (NPS_RIGID_IZZ - NPS_RIGID_IYY) * rates.q * rates.r) / NPS_RIGID_IXX;
+  Xdot[NRS_Q] = (moment.y - (NPS_RIGID_IXX - NPS_RIGID_IZZ) * rates.p * rates.r) / NPS_RIGID_IYY;
+  Xdot[NRS_R] = (moment.z - (NPS_RIGID_IYY - NPS_RIGID_IXX) * rates.p * rates.q) / NPS_RIGID_IZZ;
+
+}
+
+
+/* flat ground at the altitude of the reference point */
+static void ground_contact(void) {
+  double* X = rigid.state;
+  if (X[NRS_Z] >= 0.) {
+    X[NRS_Z] = 0.;
+    if (X[NRS_ZD] > 0.) {
+      X[NRS_XD] = 0.;
+      X[NRS_YD] = 0.;
+      X[NRS_ZD] = 0.;
+      X[NRS_P] = 0.;
+      X[NRS_Q] = 0.;
+      X[NRS_R] = 0.;
+    }
+    fdm.on_ground = TRUE;
+  }
+  else
+    fdm.on_ground = FALSE;
+}
+
+
+static void fetch_state(void) {
+
+  const double* X = rigid.state;
+  const double* Xdot = rigid.state_dot;
+
+  /* position */
+  fdm.ltpprz_pos.x = X[NRS_X];
+  fdm.ltpprz_pos.y = X[NRS_Y];
+  fdm.ltpprz_pos.z = X[NRS_Z];
+  ecef_of_ned_point_d(&fdm.ecef_pos, &rigid.ltpdef, &fdm.ltpprz_pos);
+  lla_of_ecef_d(&fdm.lla_pos, &fdm.ecef_pos);
+  fdm.lla_pos_pprz = fdm.lla_pos;
+  fdm.lla_pos_geod = fdm.lla_pos;
+  fdm.lla_pos_geoc = fdm.lla_pos;
+  fdm.hmsl = rigid.hmsl0 - X[NRS_Z];
+  fdm.agl = -X[NRS_Z];
+
+  /* velocity and acceleration, the ltp being also the pprz ltp */
+  fdm.ltp_ecef_vel.x = X[NRS_XD];
+  fdm.ltp_ecef_vel.y = X[NRS_YD];
+  fdm.ltp_ecef_vel.z = X[NRS_ZD];
+  fdm.ltp_ecef_accel.x = Xdot[NRS_XD];
+  fdm.ltp_ecef_accel.y = Xdot[NRS_YD];
+  fdm.ltp_ecef_accel.z = Xdot[NRS_ZD];
+  fdm.ltpprz_ecef_vel = fdm.ltp_ecef_vel;
+  fdm.ltpprz_ecef_accel = fdm.ltp_ecef_accel;
+  ecef_of_ned_vect_d(&fdm.ecef_ecef_vel, &rigid.ltpdef, &fdm.ltp_ecef_vel);
+  ecef_of_ned_vect_d(&fdm.ecef_ecef_accel, &rigid.ltpdef, &fdm.ltp_ecef_accel);
+
+  /* attitude */
+  fdm.ltp_to_body_quat.qi = X[NRS_QI];
+  fdm.ltp_to_body_quat.qx = X[NRS_QX];
+  fdm.ltp_to_body_quat.qy = X[NRS_QY];
+  fdm.ltp_to_body_quat.qz = X[NRS_QZ];
+  DOUBLE_EULERS_OF_QUAT(fdm.ltp_to_body_eulers, fdm.ltp_to_body_quat);
+  QUAT_COPY(fdm.ltpprz_to_body_quat, fdm.ltp_to_body_quat);
+  EULERS_COPY(fdm.ltpprz_to_body_eulers, fdm.ltp_to_body_eulers);
+
+  /* body frame */
+  quat_vmult(&fdm.body_ecef_vel, &X[NRS_QI], (struct DoubleVect3*)&fdm.ltp_ecef_vel);
+  quat_vmult(&fdm.body_ecef_accel, &X[NRS_QI], (struct DoubleVect3*)&fdm.ltp_ecef_accel);
+
+  /* rotational speed and accelerations */
+  fdm.body_ecef_rotvel.p = X[NRS_P];
+  fdm.body_ecef_rotvel.q = X[NRS_Q];
+  fdm.body_ecef_rotvel.r = X[NRS_R];
+  fdm.body_ecef_rotaccel.p = Xdot[NRS_P];
+  fdm.body_ecef_rotaccel.q = Xdot[NRS_Q];
+  fdm.body_ecef_rotaccel.r = Xdot[NRS_R];
+
+}
+
+
+/* rotation matrix (ltp to body) of quaternion q */
+#define RIGID_RMAT_OF_QUAT(_m, _q) {                                    \
+    const double qi2 = _q[0]*_q[0], qx2 = _q[1]*_q[1];                  \
+    const double qy2 = _q[2]*_q[2], qz2 = _q[3]*_q[3];                  \
+    _m[0] = qi2 + qx2 - qy2 - qz2;                                      \
+    _m[1] = 2. * (_q[1]*_q[2] + _q[0]*_q[3]);                           \
+    _m[2] = 2. * (_q[1]*_q[3] - _q[0]*_q[2]);                           \
+    _m[3] = 2. * (_q[1]*_q[2] - _q[0]*_q[3]);                           \
+    _m[4] = qi2 - qx2 + qy2 - qz2;                                      \
+    _m[5] = 2. * (_q[2]*_q[3] + _q[0]*_q[1]);                           \
+    _m[6] = 2. * (_q[1]*_q[3] + _q[0]*_q[2]);                           \
+    _m[7] = 2. * (_q[2]*_q[3] - _q[0]*_q[1]);                           \
+    _m[8] = qi2 - qx2 - qy2 + qz2;                                      \
+  }
+
+static inline void quat_vmult(struct DoubleVect3* v_out, const double* q, const struct DoubleVect3* v_in) {
+  double m[9];
+  RIGID_RMAT_OF_QUAT(m, q);
+  DOUBLE_MAT33_VECT3_MUL(*v_out, m, *v_in);
+}
+
+static inline void quat_transp_vmult(struct DoubleVect3* v_out, const double* q, const struct DoubleVect3* v_in) {
+  double m[9];
+  RIGID_RMAT_OF_QUAT(m, q);
+  DOUBLE_MAT33_VECT3_TRANSP_MUL(*v_out, m, *v_in);
+}
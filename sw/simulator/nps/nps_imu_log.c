@@ -0,0 +1,61 @@
+#include "nps_imu_log.h"
+
+#include "nps_fdm.h"
+#include "nps_sensors.h"
+#include "math/pprz_algebra_double.h"
+#include "math/pprz_algebra_float.h"
+
+/* from fms_autopilot_msg.h, as in run_ahrs_on_flight_log */
+#define VI_IMU_DATA_VALID      0
+#define VI_MAG_DATA_VALID      1
+
+static FILE* log_file;
+static struct DoubleQuat body_to_imu_quat;
+
+void nps_imu_log_init(FILE* f) {
+  log_file = f;
+  FLOAT_QUAT_OF_RMAT(body_to_imu_quat, sensors.body_to_imu_rmat);
+}
+
+/* undo sensitivity and neutral: real = (value - neutral) / sensitivity */
+#define NPS_IMU_LOG_REAL(_r, _s) {					\
+    (_r).x = ((_s).value.x - (_s).neutral.x) / MAT33_ELMT((_s).sensitivity, 0, 0); \
+    (_r).y = ((_s).value.y - (_s).neutral.y) / MAT33_ELMT((_s).sensitivity, 1, 1); \
+    (_r).z = ((_s).value.z - (_s).neutral.z) / MAT33_ELMT((_s).sensitivity, 2, 2); \
+  }
+
+/*
+ * Must be called after nps_sensors_run_step and before the autopilot
+ * consumes the data_available flags.
+ */
+void nps_imu_log_run_step(double time) {
+
+  if (!log_file || !sensors.gyro.data_available)
+    return;
+
+  uint8_t flag = 0;
+  struct DoubleVect3 gyro, accel, mag = { 0., 0., 0. };
+  NPS_IMU_LOG_REAL(gyro, sensors.gyro);
+  if (sensors.accel.data_available)
+    flag |= 1 << VI_IMU_DATA_VALID;
+  NPS_IMU_LOG_REAL(accel, sensors.accel);
+  if (sensors.mag.data_available) {
+    flag |= 1 << VI_MAG_DATA_VALID;
+    struct DoubleVect3 mag_sensor;
+    NPS_IMU_LOG_REAL(mag_sensor, sensors.mag);
+    DOUBLE_MAT33_VECT3_TRANSP_MUL(mag, sensors.mag.imu_to_sensor_rmat.m, mag_sensor);
+  }
+
+  struct DoubleQuat ltp_to_imu_quat;
+  FLOAT_QUAT_COMP(ltp_to_imu_quat, fdm.ltp_to_body_quat, body_to_imu_quat);
+
+  fprintf(log_file, "%.6f\t%d\t%f %f %f\t%f %f %f\t%f %f %f\t%f %f %f\t%f %f %f\t%f\t%f %f %f %f\n",
+          time, flag,
+          gyro.x, gyro.y, gyro.z,
+          accel.x, accel.y, accel.z,
+          mag.x, mag.y, mag.z,
+          sensors.gps.ecef_pos.x, sensors.gps.ecef_pos.y, sensors.gps.ecef_pos.z,
+          sensors.gps.ecef_vel.x, sensors.gps.ecef_vel.y, sensors.gps.ecef_vel.z,
+          sensors.baro.value,
+          ltp_to_imu_quat.qi, ltp_to_imu_quat.qx, ltp_to_imu_quat.qy, ltp_to_imu_quat.qz);
+}
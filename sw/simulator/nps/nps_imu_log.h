@@ -0,0 +1,21 @@
+#ifndef NPS_IMU_LOG_H
+#define NPS_IMU_LOG_H
+
+#include <stdio.h>
+#include "std.h"
+
+/*
+ * Sensor log for replaying the simulated IMU through the attitude
+ * estimators (sw/airborne/test/ahrs/bench_ahrs_on_log.c).
+ *
+ * One line per gyro sample, in the format of run_ahrs_on_flight_log:
+ *   time flag gyro(3) accel(3) mag(3) gps_pecef(3) gps_vecef(3) baro
+ * followed by the true ltp_to_imu quaternion qi qx qy qz.
+ * Sensors are in real units in the IMU frame (rad/s, m/s2, normalised
+ * field), flag bit 0 is set for imu data, bit 1 for mag data.
+ */
+
+extern void nps_imu_log_init(FILE* f);
+extern void nps_imu_log_run_step(double time);
+
+#endif /* NPS_IMU_LOG_H */
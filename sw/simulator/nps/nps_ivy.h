@@ -1,7 +1,7 @@
 #ifndef NPS_IVY
 #define NPS_IVY
 
-extern void nps_ivy_init(void);
+extern void nps_ivy_init(const char* ivy_bus);
 extern void nps_ivy_display(void);
 
 #endif /* NPS_IVY */
@@ -12,6 +12,10 @@
 #include "nps_autopilot.h"
 #include "nps_ivy.h"
 #include "nps_flightgear.h"
+#include "nps_random.h"
+#include "nps_metrics.h"
+#include "nps_imu_log.h"
+#include "subsystems/navigation/common_flight_plan.h"
 
 #define SIM_DT     (1./512.)
 #define DISPLAY_DT (1./30.)
@@ -28,6 +32,19 @@ static struct {
   char* js_dev;
   char* spektrum_dev;
   int rc_script;
+  /* batch mode: run as fast as possible, no wall clock pacing */
+  bool_t batch;
+  double sim_end;        /* stop at this sim time (s), <= 0 to run forever */
+  int stop_block;        /* stop when entering this flight plan block, < 0 for none */
+  unsigned long seed;
+  /* Monte-Carlo perturbations */
+  struct NedCoor_d wind;
+  double psi0;
+  bool_t set_psi0;
+  double dpsi0;          /* offset added to the initial heading of the fdm */
+  char* ivy_bus;
+  char* metrics_file;
+  char* imu_log_file;
 } nps_main;
 
 static bool_t nps_main_parse_options(int argc, char** argv);
@@ -35,6 +52,8 @@ static void nps_main_init(void);
 static void nps_main_display(void);
 static void nps_main_run_sim_step(void);
 static gboolean nps_main_periodic(gpointer data __attribute__ ((unused)));
+static void nps_main_run_batch(void);
+static bool_t nps_main_stop_condition(void);
 
 int pauseSignal = 0;
 
@@ -64,6 +83,11 @@ int main ( int argc, char** argv) {
 
   nps_main_init();
 
+  if (nps_main.batch) {
+    nps_main_run_batch();
+    return 0;
+  }
+
   signal(SIGCONT, cont_hdl);
   signal(SIGTSTP, tstp_hdl);
   printf("Time factor is %f. (Press Ctrl-Z to change)\n", nps_main.host_time_factor);
@@ -85,9 +109,23 @@ static void nps_main_init(void) {
   nps_main.scaled_initial_time = time_to_double(&t);
   nps_main.host_time_factor = HOST_TIME_FACTOR;
 
-  nps_ivy_init();
+  nps_random_init(nps_main.seed);
+
+  nps_ivy_init(nps_main.ivy_bus);
   nps_fdm_init(SIM_DT);
+  if (nps_main.set_psi0)
+    nps_fdm_set_initial_heading(nps_main.psi0);
+  if (nps_main.dpsi0 != 0.)
+    nps_fdm_set_initial_heading(fdm.ltp_to_body_eulers.psi + nps_main.dpsi0);
+  nps_fdm_set_wind(nps_main.wind.x, nps_main.wind.y, nps_main.wind.z);
   nps_sensors_init(nps_main.sim_time);
+  nps_metrics_init();
+  if (nps_main.imu_log_file) {
+    FILE* f = fopen(nps_main.imu_log_file, "w");
+    if (!f)
+      perror(nps_main.imu_log_file);
+    nps_imu_log_init(f);
+  }
 
   enum NpsRadioControlType rc_type;
   char* rc_dev = NULL;
@@ -118,8 +156,12 @@ static void nps_main_run_sim_step(void) {
 
   nps_sensors_run_step(nps_main.sim_time);
 
+  nps_imu_log_run_step(nps_main.sim_time);
+
   nps_autopilot_run_step(nps_main.sim_time);
 
+  nps_metrics_run_step(SIM_DT);
+
 }
 
 
@@ -131,6 +173,58 @@ static void nps_main_display(void) {
 }
 
 
+/*
+ * Batch mode: step the simulation as fast as the CPU allows, without
+ * display. The glib context is still polled once per display period so
+ * that Ivy datalink messages (settings, blocks) are processed.
+ */
+static void nps_main_run_batch(void) {
+  timeval t;
+  gettimeofday(&t, NULL);
+  double host_time_start = time_to_double(&t);
+
+  printf("Batch mode, seed %lu", nps_main.seed);
+  if (nps_main.sim_end > 0.)
+    printf(", end at %.1fs", nps_main.sim_end);
+  if (nps_main.stop_block >= 0)
+    printf(", stop on block %d", nps_main.stop_block);
+  printf("\n");
+
+  while (!nps_main_stop_condition()) {
+    nps_main_run_sim_step();
+    nps_main.sim_time += SIM_DT;
+    if (nps_main.display_time < nps_main.sim_time) {
+      g_main_context_iteration(NULL, FALSE);
+      nps_main.display_time += DISPLAY_DT;
+    }
+  }
+
+  gettimeofday(&t, NULL);
+  double host_time_elapsed = time_to_double(&t) - host_time_start;
+  printf("Simulated %.2fs in %.2fs (x%.1f)\n", nps_main.sim_time, host_time_elapsed,
+         host_time_elapsed > 0. ? nps_main.sim_time / host_time_elapsed : 0.);
+
+  if (nps_main.metrics_file) {
+    FILE* f = fopen(nps_main.metrics_file, "w");
+    if (f) {
+      nps_metrics_write(f);
+      fclose(f);
+    }
+    else
+      perror(nps_main.metrics_file);
+  }
+}
+
+
+static bool_t nps_main_stop_condition(void) {
+  if (nps_main.sim_end > 0. && nps_main.sim_time >= nps_main.sim_end)
+    return TRUE;
+  if (nps_main.stop_block >= 0 && nav_block == nps_main.stop_block)
+    return TRUE;
+  return FALSE;
+}
+
+
 static gboolean nps_main_periodic(gpointer data __attribute__ ((unused))) {
   struct timeval tv_now;
   double  host_time_now;
@@ -188,6 +282,18 @@ static bool_t nps_main_parse_options(int argc, char** argv) {
   nps_main.js_dev = NULL;
   nps_main.spektrum_dev = NULL;
   nps_main.rc_script = 0;
+  nps_main.batch = FALSE;
+  nps_main.sim_end = 0.;
+  nps_main.stop_block = -1;
+  nps_main.seed = NPS_RANDOM_DEFAULT_SEED;
+  nps_main.wind.x = 0.;
+  nps_main.wind.y = 0.;
+  nps_main.wind.z = 0.;
+  nps_main.set_psi0 = FALSE;
+  nps_main.dpsi0 = 0.;
+  nps_main.ivy_bus = "127.255.255.255";
+  nps_main.metrics_file = NULL;
+  nps_main.imu_log_file = NULL;
 
   static const char* usage =
 "Usage: %s [options]\n"
@@ -196,7 +302,17 @@ static bool_t nps_main_parse_options(int argc, char** argv) {
 "   --fg_port flight gear port\n"
 "   -j --js_dev joystick device\n"
 "   --spektrum_dev spektrum device\n"
-"   --rc_script no\n";
+"   --rc_script no\n"
+"   --batch run as fast as possible, without display\n"
+"   --sim_end stop after this simulated time (s)\n"
+"   --stop_block stop when entering this flight plan block\n"
+"   --seed random generator seed\n"
+"   --wind_n --wind_e --wind_d wind speed (m/s)\n"
+"   --psi0 initial heading (deg)\n"
+"   --dpsi0 offset added to the initial heading of the fdm (deg)\n"
+"   --metrics file where flight metrics are written at the end of a batch run\n"
+"   --imu_log file where imu, mag, gps and true attitude are logged\n"
+"   --ivy_bus ivy bus (default 127.255.255.255)\n";
 
 
   while (1) {
@@ -207,6 +323,18 @@ static bool_t nps_main_parse_options(int argc, char** argv) {
       {"js_dev", 1, NULL, 0},
       {"spektrum_dev", 1, NULL, 0},
       {"rc_script", 1, NULL, 0},
+      {"batch", 0, NULL, 0},
+      {"sim_end", 1, NULL, 0},
+      {"stop_block", 1, NULL, 0},
+      {"seed", 1, NULL, 0},
+      {"wind_n", 1, NULL, 0},
+      {"wind_e", 1, NULL, 0},
+      {"wind_d", 1, NULL, 0},
+      {"psi0", 1, NULL, 0},
+      {"metrics", 1, NULL, 0},
+      {"imu_log", 1, NULL, 0},
+      {"dpsi0", 1, NULL, 0},
+      {"ivy_bus", 1, NULL, 0},
       {0, 0, 0, 0}
     };
     int option_index = 0;
@@ -228,6 +356,32 @@ static bool_t nps_main_parse_options(int argc, char** argv) {
         nps_main.spektrum_dev = strdup(optarg); break;
       case 4:
         nps_main.rc_script = atoi(optarg); break;
+      case 5:
+        nps_main.batch = TRUE; break;
+      case 6:
+        nps_main.sim_end = atof(optarg); break;
+      case 7:
+        nps_main.stop_block = atoi(optarg); break;
+      case 8:
+        nps_main.seed = strtoul(optarg, NULL, 0); break;
+      case 9:
+        nps_main.wind.x = atof(optarg); break;
+      case 10:
+        nps_main.wind.y = atof(optarg); break;
+      case 11:
+        nps_main.wind.z = atof(optarg); break;
+      case 12:
+        nps_main.psi0 = RadOfDeg(atof(optarg));
+        nps_main.set_psi0 = TRUE;
+        break;
+      case 13:
+        nps_main.metrics_file = strdup(optarg); break;
+      case 14:
+        nps_main.imu_log_file = strdup(optarg); break;
+      case 15:
+        nps_main.dpsi0 = RadOfDeg(atof(optarg)); break;
+      case 16:
+        nps_main.ivy_bus = strdup(optarg); break;
       }
       break;
 
@@ -0,0 +1,76 @@
+#include "nps_metrics.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "nps_fdm.h"
+#include "math/pprz_geodetic_double.h"
+#include "math/pprz_geodetic_int.h"
+#include "subsystems/ins.h"
+#include "firmwares/rotorcraft/navigation.h"
+
+struct NpsMetrics nps_metrics;
+
+/* navigation frame, as defined by the autopilot ins */
+static bool_t nav_ltp_initialised;
+static struct LtpDef_d nav_ltp_def;
+
+void nps_metrics_init(void) {
+  memset(&nps_metrics, 0, sizeof(nps_metrics));
+  nav_ltp_initialised = FALSE;
+}
+
+void nps_metrics_run_step(double dt) {
+
+  nps_metrics.duration += dt;
+  nps_metrics.block_time[nav_block] += dt;
+
+  double max_att = Max(fabs(fdm.ltp_to_body_eulers.phi), fabs(fdm.ltp_to_body_eulers.theta));
+  if (max_att > nps_metrics.max_attitude)
+    nps_metrics.max_attitude = max_att;
+
+  if (!ins_ltp_initialised)
+    return;
+
+  if (!nav_ltp_initialised) {
+    struct EcefCoor_d ecef_ref = { M_OF_CM((double)ins_ltp_def.ecef.x),
+                                   M_OF_CM((double)ins_ltp_def.ecef.y),
+                                   M_OF_CM((double)ins_ltp_def.ecef.z) };
+    ltp_def_from_ecef_d(&nav_ltp_def, &ecef_ref);
+    nav_ltp_initialised = TRUE;
+  }
+
+  /* true position in the navigation frame vs carrot */
+  struct EnuCoor_d pos;
+  enu_of_ecef_point_d(&pos, &nav_ltp_def, &fdm.ecef_pos);
+  double dx = pos.x - POS_FLOAT_OF_BFP(navigation_carrot.x);
+  double dy = pos.y - POS_FLOAT_OF_BFP(navigation_carrot.y);
+  double err2 = dx*dx + dy*dy;
+
+  nps_metrics.tracking_err_sum2 += err2;
+  nps_metrics.tracking_nb_samples++;
+  double err = sqrt(err2);
+  if (err > nps_metrics.tracking_err_max)
+    nps_metrics.tracking_err_max = err;
+}
+
+/*
+ * one line of space separated key=value pairs, time in blocks as
+ * block_time=<block>:<time>,<block>:<time>,...
+ */
+void nps_metrics_write(FILE* f) {
+  double rms = 0.;
+  if (nps_metrics.tracking_nb_samples > 0)
+    rms = sqrt(nps_metrics.tracking_err_sum2 / nps_metrics.tracking_nb_samples);
+  fprintf(f, "duration=%.3f tracking_rms=%.3f tracking_max=%.3f max_attitude=%.4f block_time=",
+          nps_metrics.duration, rms, nps_metrics.tracking_err_max, nps_metrics.max_attitude);
+  bool_t first = TRUE;
+  for (int i = 0; i < NPS_METRICS_NB_BLOCK; i++) {
+    if (nps_metrics.block_time[i] > 0.) {
+      fprintf(f, "%s%d:%.2f", first ? "" : ",", i, nps_metrics.block_time[i]);
+      first = FALSE;
+    }
+  }
+  fprintf(f, "\n");
+  fflush(f);
+}
@@ -0,0 +1,31 @@
+#ifndef NPS_METRICS_H
+#define NPS_METRICS_H
+
+#include <stdio.h>
+#include "std.h"
+
+#define NPS_METRICS_NB_BLOCK 256
+
+/*
+ * Per-run flight metrics, accumulated at every simulation step
+ * and written as a single line at the end of a (batch) run.
+ */
+struct NpsMetrics {
+  double duration;
+  /* horizontal distance between true position and nav carrot (m) */
+  double tracking_err_sum2;
+  double tracking_err_max;
+  unsigned long tracking_nb_samples;
+  /* max of |phi| and |theta| (rad) */
+  double max_attitude;
+  /* time spent in each flight plan block (s) */
+  double block_time[NPS_METRICS_NB_BLOCK];
+};
+
+extern struct NpsMetrics nps_metrics;
+
+extern void nps_metrics_init(void);
+extern void nps_metrics_run_step(double dt);
+extern void nps_metrics_write(FILE* f);
+
+#endif /* NPS_METRICS_H */
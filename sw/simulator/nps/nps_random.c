@@ -2,61 +2,49 @@
 
 
 #include <math.h>
-#include <limits.h>
+#include <stdlib.h>
 
 
-#if 0
-/*
- * R250
- * Kirkpatrick, S., and E. Stoll, 1981; "A Very Fast
- * Shift-Register Sequence Random Number Generator",
- * Journal of Computational Physics, V.40
- *
- */
+/* empty buffer: seeded with the default seed on first use */
+struct NpsRandom nps_random = { 0, NPS_RANDOM_BUF_SIZE, { 0. } };
 
-static void         r250_init(int seed);
-//static unsigned int r250( void );
-static double       dr250( void );
+static void zigset(void);
+static double nfix(struct NpsRandom* rng, int32_t hz, uint32_t iz);
 
-/*
- * randclg
- * Linear Congruential Method, the "minimal standard generator"
- * Park & Miller, 1988, Comm of the ACM, 31(10), pp. 1192-1201
- *
- */
-
-static long              set_seed(long);
-//static long              get_seed(void);
-static unsigned long int randlcg(void);
-#endif
 
+void nps_random_init(unsigned long seed) {
+  nps_random_seed(&nps_random, seed);
+}
 
+double get_gaussian_noise(void) {
+  return nps_random_gaussian(&nps_random);
+}
 
 
 void double_vect3_add_gaussian_noise(struct DoubleVect3* vect, struct DoubleVect3* std_dev) {
-  vect->x += get_gaussian_noise() * std_dev->x;
-  vect->y += get_gaussian_noise() * std_dev->y;
-  vect->z += get_gaussian_noise() * std_dev->z;
+  vect->x += nps_random_gaussian(&nps_random) * std_dev->x;
+  vect->y += nps_random_gaussian(&nps_random) * std_dev->y;
+  vect->z += nps_random_gaussian(&nps_random) * std_dev->z;
 }
 
 void float_vect3_add_gaussian_noise(struct FloatVect3* vect, struct FloatVect3* std_dev) {
-  vect->x += get_gaussian_noise() * std_dev->x;
-  vect->y += get_gaussian_noise() * std_dev->y;
-  vect->z += get_gaussian_noise() * std_dev->z;
+  vect->x += nps_random_gaussian(&nps_random) * std_dev->x;
+  vect->y += nps_random_gaussian(&nps_random) * std_dev->y;
+  vect->z += nps_random_gaussian(&nps_random) * std_dev->z;
 }
 
 void float_rates_add_gaussian_noise(struct FloatRates* vect, struct FloatRates* std_dev) {
-  vect->p += get_gaussian_noise() * std_dev->p;
-  vect->q += get_gaussian_noise() * std_dev->q;
-  vect->r += get_gaussian_noise() * std_dev->r;
+  vect->p += nps_random_gaussian(&nps_random) * std_dev->p;
+  vect->q += nps_random_gaussian(&nps_random) * std_dev->q;
+  vect->r += nps_random_gaussian(&nps_random) * std_dev->r;
 }
 
 
 
 void double_vect3_get_gaussian_noise(struct DoubleVect3* vect, struct DoubleVect3* std_dev) {
-  vect->x = get_gaussian_noise() * std_dev->x;
-  vect->y = get_gaussian_noise() * std_dev->y;
-  vect->z = get_gaussian_noise() * std_dev->z;
+  vect->x = nps_random_gaussian(&nps_random) * std_dev->x;
+  vect->y = nps_random_gaussian(&nps_random) * std_dev->y;
+  vect->z = nps_random_gaussian(&nps_random) * std_dev->z;
 }
 
 
@@ -72,203 +60,110 @@ void double_vect3_update_random_walk(struct DoubleVect3* rw, struct DoubleVect3*
 
 
 
-
-
-#if 0
 /*
-   http://www.taygeta.com/random/gaussian.html
-*/
-double get_gaussian_noise(void) {
-
-  double x1;
-  static int nb_call = 0;
-  static double x2, w;
-  if (nb_call==0) r250_init(0);
-  nb_call++;
-  if (nb_call%2) {
-    do {
-      x1 = 2.0 * dr250() - 1.0;
-      x2 = 2.0 * dr250() - 1.0;
-      w = x1 * x1 + x2 * x2;
-    } while ( w >= 1.0 );
-
-    w = sqrt( (-2.0 * log( w ) ) / w );
-    return x1 * w;
-  }
-  else
-    return x2 * w;
-}
-#else
-#include <gsl/gsl_rng.h>
-#include <gsl/gsl_randist.h>
-#include <stdlib.h>
-double get_gaussian_noise(void) {
-  static gsl_rng * r = NULL;
-  // select random number generator 
-  if (!r)  r = gsl_rng_alloc (gsl_rng_mt19937);
-  return gsl_ran_gaussian(r, 1.);
-}
-#endif
-
-
-#if 0
-/*
- * R250
- * Kirkpatrick, S., and E. Stoll, 1981; "A Very Fast
- * Shift-Register Sequence Random Number Generator",
- * Journal of Computational Physics, V.40
- *
+ * xorshift64*
+ * Vigna, S., 2014; "An experimental exploration of Marsaglia's
+ * xorshift generators, scrambled"
  */
-
-/* defines to allow for 16 or 32 bit integers */
-#define BITS 31
-
-
-#if WORD_BIT == 32
-#ifndef BITS
-#define BITS	32
-#endif
-#else
-#ifndef BITS
-#define BITS    16
-#endif
-#endif
-
-#if BITS == 31
-#define MSB          0x40000000L
-#define ALL_BITS     0x7fffffffL
-#define HALF_RANGE   0x20000000L
-#define STEP         7
-#endif
-
-#if BITS == 32
-#define MSB          0x80000000L
-#define ALL_BITS     0xffffffffL
-#define HALF_RANGE   0x40000000L
-#define STEP         7
-#endif
-
-#if BITS == 16
-#define MSB         0x8000
-#define ALL_BITS    0xffff
-#define HALF_RANGE  0x4000
-#define STEP        11
-#endif
-
-static unsigned int r250_buffer[ 250 ];
-static int r250_index;
-
-static void r250_init(int sd) {
-  int j, k;
-  unsigned int mask, msb;
-  set_seed( sd );
-
-  r250_index = 0;
-  for (j = 0; j < 250; j++)      /* fill r250 buffer with BITS-1 bit values */
-    r250_buffer[j] = randlcg();
-
-  for (j = 0; j < 250; j++)	/* set some MSBs to 1 */
-    if ( randlcg() > HALF_RANGE )
-      r250_buffer[j] |= MSB;
-
-  msb = MSB;	        /* turn on diagonal bit */
-  mask = ALL_BITS;	/* turn off the leftmost bits */
-
-  for (j = 0; j < BITS; j++)  {
-    k = STEP * j + 3;	/* select a word to operate on */
-    r250_buffer[k] &= mask; /* turn off bits left of the diagonal */
-    r250_buffer[k] |= msb;	/* turn on the diagonal bit */
-    mask >>= 1;
-    msb  >>= 1;
-  }
-
+static inline uint64_t xorshift64s(struct NpsRandom* rng) {
+  uint64_t x = rng->state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  rng->state = x;
+  return x * 2685821657736338717ULL;
 }
 
-#if 0
-/* returns a random unsigned integer */
-static unsigned int r250(void) {
-  register int	j;
-  register unsigned int new_rand;
-
-  if ( r250_index >= 147 )
-    j = r250_index - 147;	/* wrap pointer around */
-  else
-    j = r250_index + 103;
-
-  new_rand = r250_buffer[ r250_index ] ^ r250_buffer[ j ];
-  r250_buffer[ r250_index ] = new_rand;
-
-  if ( r250_index >= 249 )	/* increment pointer for next time */
-    r250_index = 0;
-  else
-    r250_index++;
-
-  return new_rand;
-
+/* uniform in ]0..1[ */
+static inline double uni(struct NpsRandom* rng) {
+  return ((xorshift64s(rng) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
 }
-#endif
-
-/* returns a random double in range 0..1 */
-static double dr250(void) {
-  register int	j;
-  register unsigned int new_rand;
-
-  if ( r250_index >= 147 )
-    j = r250_index - 147;	/* wrap pointer around */
-  else
-    j = r250_index + 103;
 
-  new_rand = r250_buffer[ r250_index ] ^ r250_buffer[ j ];
-  r250_buffer[ r250_index ] = new_rand;
-
-  if ( r250_index >= 249 )	/* increment pointer for next time */
-    r250_index = 0;
-  else
-    r250_index++;
-
-  return (double)new_rand / ALL_BITS;
 
+void nps_random_seed(struct NpsRandom* rng, unsigned long seed) {
+  static int zig_initialised = 0;
+  if (!zig_initialised) {
+    zigset();
+    zig_initialised = 1;
+  }
+  /* splitmix64 of the seed, state must not be zero */
+  uint64_t z = (uint64_t)seed + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  rng->state = z ? z : 0x9E3779B97F4A7C15ULL;
+  rng->idx = NPS_RANDOM_BUF_SIZE;
 }
 
+
 /*
- * randclg
- * Linear Congruential Method, the "minimal standard generator"
- * Park & Miller, 1988, Comm of the ACM, 31(10), pp. 1192-1201
+ * Ziggurat gaussian sampler
+ * Marsaglia, G., and W. W. Tsang, 2000; "The Ziggurat Method for
+ * Generating Random Variables", Journal of Statistical Software, V.5
  *
+ * 98.8% of the samples only need one random integer, one table
+ * lookup and one multiplication.
  */
 
-static long int quotient  = LONG_MAX / 16807L;
-static long int my_remainder = LONG_MAX % 16807L;
-
-static long int seed_val = 1L;
-
-static long set_seed(long int sd) {
-  return seed_val = sd;
+#define ZIG_N 128
+#define ZIG_R 3.442619855899
+
+static uint32_t kn[ZIG_N];
+static double wn[ZIG_N], fn[ZIG_N];
+
+static void zigset(void) {
+  const double m1 = 2147483648.0;
+  const double vn = 9.91256303526217e-3;
+  double dn = ZIG_R, tn = dn;
+  double q = vn / exp(-.5 * dn * dn);
+
+  kn[0] = (uint32_t)((dn / q) * m1);
+  kn[1] = 0;
+  wn[0] = q / m1;
+  wn[ZIG_N - 1] = dn / m1;
+  fn[0] = 1.;
+  fn[ZIG_N - 1] = exp(-.5 * dn * dn);
+
+  for (int i = ZIG_N - 2; i >= 1; i--) {
+    dn = sqrt(-2. * log(vn / dn + exp(-.5 * dn * dn)));
+    kn[i + 1] = (uint32_t)((dn / tn) * m1);
+    tn = dn;
+    fn[i] = exp(-.5 * dn * dn);
+    wn[i] = dn / m1;
+  }
 }
 
-//static long get_seed(void) {
-//  return seed_val;
-//}
-
-/* returns a random unsigned integer */
-unsigned long int randlcg() {
-  if ( seed_val <= quotient )
-    seed_val = (seed_val * 16807L) % LONG_MAX;
-  else
-    {
-      long int high_part = seed_val / quotient;
-      long int low_part  = seed_val % quotient;
-
-      long int test = 16807L * low_part - my_remainder * high_part;
-
-      if ( test > 0 )
-	seed_val = test;
-      else
-	seed_val = test + LONG_MAX;
-
+/* slow path: base strip tail or wedge rejection */
+static double nfix(struct NpsRandom* rng, int32_t hz, uint32_t iz) {
+  for (;;) {
+    double x = hz * wn[iz];
+    if (iz == 0) {
+      double y;
+      do {
+        x = -log(uni(rng)) / ZIG_R;
+        y = -log(uni(rng));
+      } while (y + y < x * x);
+      return (hz > 0) ? ZIG_R + x : -ZIG_R - x;
     }
-
-  return seed_val;
+    if (fn[iz] + uni(rng) * (fn[iz - 1] - fn[iz]) < exp(-.5 * x * x))
+      return x;
+    hz = (int32_t)(xorshift64s(rng) >> 32);
+    iz = hz & (ZIG_N - 1);
+    if ((uint32_t)llabs(hz) < kn[iz])
+      return hz * wn[iz];
+  }
 }
 
-#endif /* 0*/
+void nps_random_refill(struct NpsRandom* rng) {
+  if (rng->state == 0)
+    nps_random_seed(rng, NPS_RANDOM_DEFAULT_SEED);
+  for (int i = 0; i < NPS_RANDOM_BUF_SIZE; i++) {
+    int32_t hz = (int32_t)(xorshift64s(rng) >> 32);
+    uint32_t iz = hz & (ZIG_N - 1);
+    if ((uint32_t)llabs(hz) < kn[iz])
+      rng->buf[i] = hz * wn[iz];
+    else
+      rng->buf[i] = nfix(rng, hz, iz);
+  }
+  rng->idx = 0;
+}
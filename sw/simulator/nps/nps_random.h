@@ -1,8 +1,38 @@
 #ifndef NPS_RANDOM_H
 #define NPS_RANDOM_H
 
+#include <inttypes.h>
 #include "math/pprz_algebra_double.h"
 
+#define NPS_RANDOM_DEFAULT_SEED 0
+
+/* number of gaussian samples generated at once */
+#define NPS_RANDOM_BUF_SIZE 256
+
+/*
+ * Random generator state: xorshift64* uniform generator feeding a
+ * ziggurat gaussian sampler. Gaussian samples are generated by blocks
+ * into buf and handed out one by one.
+ */
+struct NpsRandom {
+  uint64_t state;
+  unsigned int idx;
+  double buf[NPS_RANDOM_BUF_SIZE];
+};
+
+/* default generator, used by all sensor models */
+extern struct NpsRandom nps_random;
+
+extern void nps_random_seed(struct NpsRandom* rng, unsigned long seed);
+extern void nps_random_refill(struct NpsRandom* rng);
+
+static inline double nps_random_gaussian(struct NpsRandom* rng) {
+  if (rng->idx >= NPS_RANDOM_BUF_SIZE)
+    nps_random_refill(rng);
+  return rng->buf[rng->idx++];
+}
+
+extern void nps_random_init(unsigned long seed);
 extern double get_gaussian_noise(void);
 extern void double_vect3_add_gaussian_noise(struct DoubleVect3* vect, struct DoubleVect3* std_dev);
 extern void double_vect3_get_gaussian_noise(struct DoubleVect3* vect, struct DoubleVect3* std_dev);
@@ -14,4 +44,3 @@ extern void float_rates_add_gaussian_noise(struct FloatRates* vect, struct Float
 
 
 #endif /* NPS_RANDOM_H */
-
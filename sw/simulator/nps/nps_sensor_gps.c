@@ -24,6 +24,10 @@ void nps_sensor_gps_init(struct NpsSensorGps* gps, double time) {
 			   NPS_GPS_POS_BIAS_RANDOM_WALK_STD_DEV_Y,
 			   NPS_GPS_POS_BIAS_RANDOM_WALK_STD_DEV_Z);
   FLOAT_VECT3_ZERO(gps->pos_bias_random_walk_value);
+  nps_sensor_history_init(&gps->hmsl_history);
+  nps_sensor_history_init(&gps->pos_history);
+  nps_sensor_history_init(&gps->lla_history);
+  nps_sensor_history_init(&gps->speed_history);
   gps->next_update = time;
   gps->data_available = FALSE;
 }
@@ -1,14 +1,13 @@
 #ifndef NPS_SENSOR_GPS_H
 #define NPS_SENSOR_GPS_H
 
-#include <glib.h>
-
 #include "math/pprz_algebra.h"
 #include "math/pprz_algebra_double.h"
 #include "math/pprz_algebra_float.h"
 #include "math/pprz_geodetic_double.h"
 
 #include "std.h"
+#include "nps_sensors_utils.h"
 
 struct NpsSensorGps {
   struct EcefCoor_d ecef_pos;
@@ -22,10 +21,10 @@ struct NpsSensorGps {
   struct DoubleVect3  pos_bias_random_walk_value;
   double pos_latency;
   double speed_latency;
-  GSList* hmsl_history;
-  GSList* pos_history;
-  GSList* lla_history;
-  GSList* speed_history;
+  struct NpsSensorHistory hmsl_history;
+  struct NpsSensorHistory pos_history;
+  struct NpsSensorHistory lla_history;
+  struct NpsSensorHistory speed_history;
   double next_update;
   bool_t data_available;
 };
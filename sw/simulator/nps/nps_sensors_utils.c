@@ -1,46 +1,45 @@
 #include "nps_sensors_utils.h"
 
-//#include <string.h>
 #include "math/pprz_algebra.h"
 
-void UpdateSensorLatency(double time, gpointer cur_reading, GSList **history, double latency, gpointer sensor_reading) {
-  /* add new reading */
-  struct BoozDatedSensor* cur_read = g_new(struct BoozDatedSensor, 1);
-  cur_read->time = time;
-  cur_read->value = (struct DoubleVect3*) g_memdup(cur_reading, sizeof(struct DoubleVect3));
-  *history = g_slist_prepend(*history, cur_read);
-  /* remove old readings */
-  GSList* last =  g_slist_last(*history);
-  while (last && ((struct BoozDatedSensor*)last->data)->time < time - latency) {
-    *history = g_slist_remove_link(*history, last);
-	g_free(((struct BoozDatedSensor*)last->data)->value);
-	g_free((struct BoozDatedSensor*)last->data);
-    g_slist_free_1(last);
-    last = g_slist_last(*history);
-  }
-  /* update sensor        */
-  //g_memmove((gpointer)sensor_reading, (gpointer)((struct BoozDatedSensor*)last->data)->value, sizeof(struct DoubleVect3));
-  VECT3_COPY(*((struct DoubleVect3*)sensor_reading), *((struct BoozDatedSensor*)last->data)->value);
+void nps_sensor_history_init(struct NpsSensorHistory* history) {
+  history->head = 0;
+  history->nb = 0;
 }
 
-void UpdateSensorLatency_Single(double time, gpointer cur_reading, GSList **history, double latency, gpointer sensor_reading) {
-  /* add new reading */
-  struct BoozDatedSensor_Single* cur_read = g_new(struct BoozDatedSensor_Single, 1);
-  cur_read->time = time;
-  cur_read->value = (double*) g_memdup(cur_reading, sizeof(double));
-  *history = g_slist_prepend(*history, cur_read);
-  /* remove old readings */
-  GSList* last =  g_slist_last(*history);
-  while (last && ((struct BoozDatedSensor_Single*)last->data)->time < time - latency) {
-    *history = g_slist_remove_link(*history, last);
-	g_free(((struct BoozDatedSensor_Single*)last->data)->value);
-	g_free((struct BoozDatedSensor_Single*)last->data);
-    g_slist_free_1(last);
-    last = g_slist_last(*history);
+/* add new reading, remove the ones older than latency, return the oldest left */
+static struct DoubleVect3* history_update(struct NpsSensorHistory* history, double time,
+                                          struct DoubleVect3* cur_reading, double latency) {
+  unsigned int idx;
+  if (history->nb == NPS_SENSOR_HISTORY_SIZE) {
+    /* full: overwrite oldest */
+    idx = history->head;
+    history->head = (history->head + 1) & NPS_SENSOR_HISTORY_MASK;
+  }
+  else {
+    idx = (history->head + history->nb) & NPS_SENSOR_HISTORY_MASK;
+    history->nb++;
+  }
+  VECT3_COPY(history->value[idx], *cur_reading);
+  history->time[idx] = time;
+
+  /* the newest reading is always kept */
+  while (history->nb > 1 && history->time[history->head] < time - latency) {
+    history->head = (history->head + 1) & NPS_SENSOR_HISTORY_MASK;
+    history->nb--;
   }
+  return &history->value[history->head];
+}
 
-  /* update sensor        */
-  //g_memmove((gpointer)sensor_reading, (gpointer)((struct BoozDatedSensor*)last->data)->value, sizeof(struct DoubleVect3));
-  *((double*)sensor_reading) = *(((struct BoozDatedSensor_Single*)last->data)->value);
+void UpdateSensorLatency(double time, void* cur_reading, struct NpsSensorHistory* history,
+                         double latency, void* sensor_reading) {
+  struct DoubleVect3* out = history_update(history, time, (struct DoubleVect3*)cur_reading, latency);
+  VECT3_COPY(*((struct DoubleVect3*)sensor_reading), *out);
+}
 
+void UpdateSensorLatency_Single(double time, double* cur_reading, struct NpsSensorHistory* history,
+                                double latency, double* sensor_reading) {
+  struct DoubleVect3 cur = { *cur_reading, 0., 0. };
+  struct DoubleVect3* out = history_update(history, time, &cur, latency);
+  *sensor_reading = out->x;
 }
@@ -1,25 +1,33 @@
 #ifndef NPS_SENSORS_UTILS_H
 #define NPS_SENSORS_UTILS_H
 
-#include <glib.h>
 #include "math/pprz_algebra_double.h"
 
-struct BoozDatedSensor {
-  struct DoubleVect3* value;
-  double time;
-};
+/* capacity of the latency history, must be a power of two */
+#ifndef NPS_SENSOR_HISTORY_SIZE
+#define NPS_SENSOR_HISTORY_SIZE 1024
+#endif
+#define NPS_SENSOR_HISTORY_MASK (NPS_SENSOR_HISTORY_SIZE - 1)
 
-struct BoozDatedSensor_Single {
-  double* value;
-  double time;
+/*
+ * fixed capacity ring of dated readings, oldest first
+ * when full, the oldest reading is overwritten
+ */
+struct NpsSensorHistory {
+  struct DoubleVect3 value[NPS_SENSOR_HISTORY_SIZE];
+  double time[NPS_SENSOR_HISTORY_SIZE];
+  unsigned int head;  /* index of oldest reading */
+  unsigned int nb;    /* number of readings */
 };
 
+extern void nps_sensor_history_init(struct NpsSensorHistory* history);
+
 /* cur_reading and sensor_reading must be of a type that can be cast to DoubleVect3* */
-extern void UpdateSensorLatency(double time, gpointer cur_reading, GSList **history,
-								double latency, gpointer sensor_reading);
+extern void UpdateSensorLatency(double time, void* cur_reading, struct NpsSensorHistory* history,
+                                double latency, void* sensor_reading);
 
 /* ...and the same for single double values */
-extern void UpdateSensorLatency_Single(double time, gpointer cur_reading, GSList **history,
-								double latency, gpointer sensor_reading);
+extern void UpdateSensorLatency_Single(double time, double* cur_reading, struct NpsSensorHistory* history,
+                                       double latency, double* sensor_reading);
 
 #endif /* NPS_SENSORS_UTILS_H */
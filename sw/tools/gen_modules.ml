@@ -82,6 +82,37 @@ let print_status = fun modules ->
     (Xml.children m))
   modules
 
+(** Profiling ids of the init, periodic and event functions, numbered
+ * after the core entries of sys_prof (SYS_PROF_CORE_NB) *)
+let prof_ids = ref []
+
+let print_prof_ids = fun modules ->
+  let n = ref 0 in
+  List.iter (fun m ->
+    let module_name = ExtXml.attrib m "name" in
+    List.iter (fun i ->
+      match Xml.tag i with
+        "init" | "periodic" | "event" ->
+          prof_ids := (i, (!n, module_name^"."^get_status_shortname i)) :: !prof_ids;
+          incr n
+      | _ -> ())
+    (Xml.children m))
+  modules;
+  prof_ids := List.rev !prof_ids;
+  nl ();
+  lprintf out_h "#define SYS_PROF_MODULES_NB %d\n" !n;
+  lprintf out_h "#define SYS_PROF_MODULES_NAMES { %s }\n"
+    (String.concat ", " (List.map (fun (_, (_, name)) -> sprintf "\"%s\"" name) !prof_ids));
+  lprintf out_h "#ifndef SYS_PROF\n";
+  lprintf out_h "#define SysProfStart(_id) {}\n";
+  lprintf out_h "#define SysProfStop(_id) {}\n";
+  lprintf out_h "#endif\n"
+
+(** Print a function call wrapped by the profiling macros *)
+let print_call = fun f ->
+  let id = fst (List.assq f !prof_ids) in
+  lprintf out_h "SysProfStart(SYS_PROF_CORE_NB+%d); %s; SysProfStop(SYS_PROF_CORE_NB+%d);\n" id (Xml.attrib f "fun") id
+
 let print_init_functions = fun modules ->
   lprintf out_h "\nstatic inline void modules_init(void) {\n";
   right ();
@@ -89,7 +120,7 @@ let print_init_functions = fun modules ->
     let module_name = ExtXml.attrib m "name" in
     List.iter (fun i ->
       match Xml.tag i with
-        "init" -> lprintf out_h "%s;\n" (Xml.attrib i "fun")
+        "init" -> print_call i
       | "periodic" -> if not (is_status_lock i) then
           lprintf out_h "%s = %s;\n" (get_status_name i module_name) (try match Xml.attrib i "autorun" with
               "TRUE" | "true" -> "MODULES_START"
@@ -166,11 +197,11 @@ let print_periodic_functions = fun modules ->
     if p = 1 then
       begin
         if (is_status_lock func) then
-          lprintf out_h "%s;\n" function_name
+          print_call func
         else begin
           lprintf out_h "if (%s == MODULES_RUN) {\n" (get_status_name func name);
           right ();
-          lprintf out_h "%s;\n" function_name;
+          print_call func;
           left ();
           lprintf out_h "}\n";
         end
@@ -203,7 +234,7 @@ let print_periodic_functions = fun modules ->
           i := !i + incr;
         end;
         right ();
-        lprintf out_h "%s;\n" function_name;
+        print_call func;
         left ();
         lprintf out_h "}\n"
       end;
@@ -217,7 +248,7 @@ let print_event_functions = fun modules ->
   List.iter (fun m ->
     List.iter (fun i ->
       match Xml.tag i with
-        "event" -> lprintf out_h "%s;\n" (Xml.attrib i "fun")
+        "event" -> print_call i
       | _ -> ())
     (Xml.children m))
   modules;
@@ -245,6 +276,7 @@ let print_datalink_functions = fun modules ->
 let parse_modules modules =
   print_headers modules;
   print_status modules;
+  print_prof_ids modules;
   nl ();
   fprintf out_h "#ifdef MODULES_C\n";
   print_init_functions modules;
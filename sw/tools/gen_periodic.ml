@@ -39,7 +39,74 @@ let lprintf = fun c f ->
   fprintf c "%s" (String.make !margin ' ');
   fprintf c f
 
-let output_modes = fun avr_h process_name channel_name modes freq modules ->
+(** Bytes added to the payload on the link: ac_id and msg_id, then
+ * the pprz transport overhead (STX, length and two checksum bytes) *)
+let message_overhead = 2 + 4
+
+(** Size on the link of the messages of the telemetry class, arrays are
+ * counted with a single element *)
+let messages_size = fun messages_xml ->
+  let telemetry = ExtXml.child ~select:(fun x -> Xml.attrib x "name" = "telemetry") messages_xml "class" in
+  let size_of_type = fun t ->
+    let n = String.length t in
+    try
+      if n >= 2 && String.sub t (n-2) 2 = "[]" then
+        1 + (List.assoc (String.sub t 0 (n-2)) Pprz.types).Pprz.size
+      else
+        (List.assoc t Pprz.types).Pprz.size
+    with Not_found -> failwith (sprintf "Error: '%s' unknown type" t) in
+  List.map (fun msg ->
+    let fields = List.filter (fun f -> Xml.tag f = "field") (Xml.children msg) in
+    let size = List.fold_left (fun s f -> s + size_of_type (ExtXml.attrib f "type")) 0 fields in
+    (ExtXml.attrib msg "name", message_overhead + size))
+    (List.filter (fun m -> Xml.tag m = "message") (Xml.children telemetry))
+
+let rec gcd = fun a b -> if b = 0 then a else gcd b (a mod b)
+
+(** Length of the load histogram used to spread the messages: the least
+ * common multiple of the periods, bounded to keep the generation fast *)
+let max_hyperperiod = 10000
+let hyperperiod = fun periods ->
+  List.fold_left (fun h p -> min max_hyperperiod (h / (gcd h p) * p)) 1 periods
+
+(** Assign a phase to each message so that the bytes sent per tick are as
+ * flat as possible. Messages are placed from the shortest period, the
+ * largest first, on the phase giving the lowest peak load. A "phase"
+ * attribute forces the phase of a message.
+ * Returns the (message, period, size, phase) list and the load histogram *)
+let schedule = fun freq messages ->
+  let h = hyperperiod (List.map (fun (_, p, _) -> p) messages) in
+  let load = Array.make h 0 in
+  let add = fun p phase size ->
+    let t = ref phase in
+    while !t < h do load.(!t) <- load.(!t) + size; t := !t + p done in
+  let peak = fun p phase size ->
+    let t = ref phase and m = ref 0 in
+    while !t < h do m := max !m (load.(!t) + size); t := !t + p done;
+    !m in
+  let forced_phase = fun msg p ->
+    try Some ((int_of_float (float_of_string (Xml.attrib msg "phase") *. float_of_int freq)) mod p)
+    with _ -> None in
+  (* forced phases first, they constrain the others *)
+  let forced, free = List.partition (fun (m, p, _) -> forced_phase m p <> None) messages in
+  let forced = List.map (fun (m, p, s) ->
+    let phase = match forced_phase m p with Some ph -> ph | None -> 0 in
+    add p phase s;
+    (m, p, s, phase)) forced in
+  let free = List.sort (fun (_, p, s) (_, p', s') -> if p = p' then compare s' s else compare p p') free in
+  let free = List.map (fun (m, p, s) ->
+    let best = ref 0 and best_peak = ref max_int in
+    for phase = 0 to (min p h) - 1 do
+      let pk = peak p phase s in
+      if pk < !best_peak then begin best := phase; best_peak := pk end
+    done;
+    add p !best s;
+    (m, p, s, !best)) free in
+  (* shortest periods first in the table: they get the budget first at runtime *)
+  let scheduled = List.sort (fun (_, p, _, _) (_, p', _, _) -> compare p p') (forced @ free) in
+  (scheduled, load)
+
+let output_modes = fun avr_h process_name channel_name modes freq modules sizes ->
   let min_period = 1./.float freq in
   let max_period = 65536. /. float freq in
   (** For each mode in this process *)
@@ -53,42 +120,51 @@ let output_modes = fun avr_h process_name channel_name modes freq modules ->
       let filtered_msg = List.filter (fun msg ->
         try let att = Xml.attrib msg "module" in List.exists (fun name -> String.compare name att = 0) modules with _ -> true
         ) (Xml.children mode) in
-      (** Computes the required modulos *)
+      (** Computes the periods in ticks and the sizes *)
       let messages = List.map (fun x ->
+        let name = ExtXml.attrib x "name" in
         let p = float_of_string (ExtXml.attrib x "period") in
         if p < min_period || p > max_period then
-          fprintf stderr "Warning: period is bound between %.3fs and %.3fs for message %s\n%!" min_period max_period (ExtXml.attrib x "name");
-        (x, min 65535 (max 1 (int_of_float (p*.float_of_int freq))))
+          fprintf stderr "Warning: period is bound between %.3fs and %.3fs for message %s\n%!" min_period max_period name;
+        let size = try List.assoc name sizes with Not_found ->
+          fprintf stderr "Warning: message %s not found in the telemetry class\n%!" name; message_overhead in
+        (x, min 65535 (max 1 (int_of_float (p*.float_of_int freq))), min 255 size)
         ) filtered_msg in
-      let modulos = GC.singletonize (List.map snd messages) in
-      List.iter (fun m ->
-        let v = sprintf "i%d" m in
-        let _type = if m >= 256 then "uint16_t" else "uint8_t" in
-        lprintf avr_h "static %s %s = 0; %s++; if (%s>=%d) %s=0;\\\n" _type v v v m v;
-        ) modulos;
-
-      (** For each message in this mode *)
-      let messages = List.sort (fun (_,p) (_,p') -> compare p p') messages in
-      let i = ref 0 in (** Basic balancing:1 message every 10Hz *)
-      let phase = ref 0 in
-      let l = ref [] in
-      List.iter
-        (fun (message, p) ->
-          let message_name = ExtXml.attrib message "name" in
-          i := !i mod p;
-          (* if phase attribute is present, use it, otherwise shedule at 10Hz *)
-          let message_phase = try int_of_float (float_of_string (ExtXml.attrib message "phase")*.float_of_int freq) with _ -> !i in
-          phase := message_phase;
-          let else_ = if List.mem_assoc p !l && not (List.mem (p, !phase) !l) then "else " else "" in
-          lprintf avr_h "%sif (i%d == %d) {\\\n" else_ p !phase;
-          l := (p, !phase) :: !l;
-          i := !i + freq/10;
-          right ();
-          lprintf avr_h "PERIODIC_SEND_%s(%s);\\\n" message_name channel_name;
-          left ();
-          lprintf avr_h "} \\\n"
-        )
-        messages;
+
+      if messages <> [] then begin
+        let scheduled, load = schedule freq messages in
+        let nb = List.length scheduled in
+        let peak = Array.fold_left max 0 load
+        and avg = float (Array.fold_left (+) 0 load) /. float (Array.length load) in
+        lprintf avr_h "/* %d messages, bytes per tick: %.1f average, %d peak */\\\n" nb avg peak;
+        let table = fun f -> String.concat ", " (List.map f scheduled) in
+        lprintf avr_h "static const uint16_t periodic_period[%d] = { %s };\\\n" nb (table (fun (_, p, _, _) -> string_of_int p));
+        lprintf avr_h "static const uint8_t periodic_size[%d] = { %s };\\\n" nb (table (fun (_, _, s, _) -> string_of_int s));
+        lprintf avr_h "static uint16_t periodic_cnt[%d] = { %s };\\\n" nb (table (fun (_, _, _, ph) -> string_of_int (ph+1)));
+        lprintf avr_h "uint8_t periodic_i;\\\n";
+        lprintf avr_h "for (periodic_i = 0; periodic_i < %d; periodic_i++) {\\\n" nb;
+        right ();
+        lprintf avr_h "if (--periodic_cnt[periodic_i] == 0) {\\\n";
+        right ();
+        lprintf avr_h "if (!PeriodicBudgetAvailable(periodic_bytes, periodic_size[periodic_i])) { periodic_cnt[periodic_i] = 1; continue; }\\\n";
+        lprintf avr_h "periodic_cnt[periodic_i] = PeriodicSlowdown(periodic_period[periodic_i], periodic_slowdown);\\\n";
+        lprintf avr_h "periodic_bytes += periodic_size[periodic_i];\\\n";
+        lprintf avr_h "switch (periodic_i) {\\\n";
+        right ();
+        let i = ref 0 in
+        List.iter
+          (fun (message, _, _, _) ->
+            lprintf avr_h "case %d: PERIODIC_SEND_%s(%s); break;\\\n" !i (ExtXml.attrib message "name") channel_name;
+            incr i)
+          scheduled;
+        lprintf avr_h "default: break;\\\n";
+        left ();
+        lprintf avr_h "}\\\n";
+        left ();
+        lprintf avr_h "}\\\n";
+        left ();
+        lprintf avr_h "}\\\n"
+      end;
       left ();
       lprintf avr_h "}\\\n")
     modes
@@ -100,6 +176,7 @@ let _ =
   end;
 
   let freq = int_of_string(Sys.argv.(4)) in
+  let sizes = messages_size (ExtXml.parse_file Sys.argv.(2)) in
   let telemetry_xml =
     try
       Xml.parse_file Sys.argv.(3)
@@ -113,7 +190,17 @@ let _ =
   fprintf avr_h "/* This file has been generated from %s and %s */\n" Sys.argv.(2) Sys.argv.(3);
   fprintf avr_h "/* Please DO NOT EDIT */\n\n";
   fprintf avr_h "#ifndef _VAR_PERIODIC_H_\n";
-  fprintf avr_h "#define _VAR_PERIODIC_H_\n";
+  fprintf avr_h "#define _VAR_PERIODIC_H_\n\n";
+
+  (** Runtime rate control shared by the processes *)
+  fprintf avr_h "/* Periods are multiplied by up to TELEMETRY_MAX_SLOWDOWN after overruns\n";
+  fprintf avr_h "   (downlink_nb_ovrn), and recover after one second without overrun */\n";
+  fprintf avr_h "#ifndef TELEMETRY_MAX_SLOWDOWN\n#define TELEMETRY_MAX_SLOWDOWN 4\n#endif\n";
+  fprintf avr_h "#define PeriodicSlowdown(_p, _s) ((uint32_t)(_p) * (_s) > 0xffff ? 0xffff : (uint16_t)((_p) * (_s)))\n\n";
+  fprintf avr_h "/* Optional link budget: a message that would exceed it is delayed by one tick */\n";
+  fprintf avr_h "#ifdef TELEMETRY_BYTES_PER_TICK\n";
+  fprintf avr_h "#define PeriodicBudgetAvailable(_bytes, _size) ((_bytes) == 0 || (_bytes) + (_size) <= TELEMETRY_BYTES_PER_TICK)\n";
+  fprintf avr_h "#else\n#define PeriodicBudgetAvailable(_bytes, _size) TRUE\n#endif\n";
 
   (** For each process *)
   List.iter
@@ -142,7 +229,17 @@ let _ =
 
       lprintf avr_h "#define PeriodicSend%s(%s) {  /* %dHz */ \\\n" process_name channel_name freq;
       right ();
-      output_modes avr_h process_name channel_name modes freq modules_name;
+      lprintf avr_h "static uint8_t periodic_ovrn = 0;\\\n";
+      lprintf avr_h "static uint8_t periodic_slowdown = 1;\\\n";
+      lprintf avr_h "static uint16_t periodic_calm = 0;\\\n";
+      lprintf avr_h "uint16_t periodic_bytes = 0;\\\n";
+      lprintf avr_h "if (downlink_nb_ovrn != periodic_ovrn) {\\\n";
+      lprintf avr_h "  periodic_ovrn = downlink_nb_ovrn; periodic_calm = 0;\\\n";
+      lprintf avr_h "  if (periodic_slowdown < TELEMETRY_MAX_SLOWDOWN) periodic_slowdown++;\\\n";
+      lprintf avr_h "} else if (periodic_slowdown > 1 && ++periodic_calm >= %d) {\\\n" freq;
+      lprintf avr_h "  periodic_slowdown--; periodic_calm = 0;\\\n";
+      lprintf avr_h "}\\\n";
+      output_modes avr_h process_name channel_name modes freq modules_name sizes;
       left ();
       lprintf avr_h "}\n"
     )